@@ -12,6 +12,7 @@
 #include <cups/cups.h>
 #include "string-private.h"
 #include "debug-internal.h"
+#include "thread.h"
 
 
 //
@@ -25,14 +26,37 @@
 // Types and structures...
 //
 
+typedef struct _cups_avec_s		// Shared array storage
+{
+  size_t		refcount;	// Reference count
+  void			**elements;	// Array elements
+  size_t		*hashes,	// Hash values of elements
+			*slots;		// Hash table of element indices
+  struct _cups_avec_s	*next;		// Next storage to release, if any
+  cups_afree_cb_t	freefunc;	// Free function
+  void			*data;		// User data passed to free function
+  size_t		num_frees,	// Number of elements to free
+			alloc_frees;	// Allocated elements to free
+  void			**frees;	// Elements to free with this storage
+} _cups_avec_t;
+
 struct _cups_array_s			// CUPS array structure
 {
   // The current implementation uses an insertion sort into an array of
-  // sorted pointers.  We leave the array type private/opaque so that we
-  // can change the underlying implementation without affecting the users
-  // of this API.
+  // sorted pointers.  Hash arrays instead append to the array of pointers
+  // and use an open addressing table of indices for lookups; removed
+  // elements leave a `NULL` hole that is compacted later.  We leave the
+  // array type private/opaque so that we can change the underlying
+  // implementation without affecting the users of this API.
+  //
+  // Snapshots share the element storage ("vec") with the array until one of
+  // them changes it, at which point the changing array makes its own copy.
+  // Storage that is still used by snapshots is "retired" to a list of
+  // storage, and elements removed from the array are only freed once all of
+  // the retired storage that might refer to them has been freed.
 
   size_t		num_elements,	// Number of array elements
+			num_holes,	// Number of removed elements (hash arrays)
 			alloc_elements,	// Allocated array elements
 			current,	// Current element
 			insert,		// Last inserted element
@@ -41,22 +65,53 @@ struct _cups_array_s			// CUPS array structure
 					// Saved elements
   void			**elements;	// Array elements
   cups_array_cb_t	compare;	// Element comparison function
-  bool			unique;		// Are all elements unique?
+  bool			unique,		// Are all elements unique?
+			batch,		// Adding a batch of elements?
+			batchunique;	// Skip duplicates in batch?
+  size_t		batchstart;	// First element added in batch
   void			*data;		// User data passed to compare
   cups_ahash_cb_t	hashfunc;	// Hash function
   size_t		hashsize,	// Size of hash
 			*hash;		// Hash array
+  size_t		*hashes,	// Hash values of elements (hash arrays)
+			num_slots,	// Number of hash table slots (power of 2)
+			*slots;		// Hash table of element indices
+  unsigned		slotshift;	// Shift for hash table slot numbers
+  bool			sorted,		// Iterate hash array in sorted order?
+			unsorted;	// Are hash array elements out of order?
   cups_acopy_cb_t	copyfunc;	// Copy function
   cups_afree_cb_t	freefunc;	// Free function
+  _cups_avec_t		*vec,		// Storage shared with snapshots
+			*lastvec;	// Newest retired storage
 };
 
 
+//
+// Local globals...
+//
+
+static cups_mutex_t	array_mutex = CUPS_MUTEX_INITIALIZER;
+					// Mutex for shared storage
+
+
 //
 // Local functions...
 //
 
 static bool	cups_array_add(cups_array_t *a, void *e, bool insert);
+static void	cups_array_compact(cups_array_t *a);
 static size_t	cups_array_find(cups_array_t *a, void *e, size_t prev, int *rdiff);
+static void	cups_array_free(cups_array_t *a, void *e);
+static bool	cups_array_grow(cups_array_t *a, size_t count);
+static size_t	cups_array_hfind(cups_array_t *a, void *e, size_t h, size_t *rslot);
+static void	cups_array_merge(cups_array_t *a);
+static void	**cups_array_msort(cups_array_t *a, void **e, void **temp, size_t count);
+static bool	cups_array_rehash(cups_array_t *a, size_t num_slots);
+static void	cups_array_release(_cups_avec_t *vec);
+static bool	cups_array_retire(cups_array_t *a);
+static size_t	cups_array_slot(cups_array_t *a, size_t h);
+static void	cups_array_sort(cups_array_t *a);
+static bool	cups_array_unshare(cups_array_t *a);
 
 
 //
@@ -81,6 +136,69 @@ cupsArrayAdd(cups_array_t *a,		// I - Array
 }
 
 
+//
+// 'cupsArrayAddBatch()' - Add multiple elements to an array.
+//
+// This function adds "num_elements" elements to an array.  The result is the
+// same as calling @link cupsArrayAdd@ for each element, but sorted arrays are
+// only sorted once after all of the elements have been added.
+//
+
+bool					// O - `true` on success, `false` on failure
+cupsArrayAddBatch(cups_array_t *a,	// I - Array
+                  void         **elements,
+					// I - Elements to add
+                  size_t       num_elements)
+					// I - Number of elements
+{
+  bool		batch,			// Already adding a batch?
+		status = true;		// Return status
+  size_t	i,			// Looping var
+		num_slots;		// Number of hash table slots
+
+
+  // Range check input...
+  if (!a || (num_elements > 0 && !elements))
+    return (false);
+
+  if (num_elements == 0)
+    return (true);
+
+  // Allocate memory for the new elements up front...
+  if (a->vec && !cups_array_unshare(a))
+    return (false);
+
+  if (!cups_array_grow(a, num_elements))
+    return (false);
+
+  if (a->slots)
+  {
+    for (num_slots = a->num_slots; (a->num_elements + num_elements) > (num_slots / 2); num_slots *= 2);
+
+    if (num_slots != a->num_slots && !cups_array_rehash(a, num_slots))
+      return (false);
+  }
+
+  // Add the elements...
+  if ((batch = a->batch) == false)
+    cupsArrayBeginBatch(a, false);
+
+  for (i = 0; i < num_elements; i ++)
+  {
+    if (!elements[i] || !cups_array_add(a, elements[i], false))
+    {
+      status = false;
+      break;
+    }
+  }
+
+  if (!batch)
+    cupsArrayEndBatch(a);
+
+  return (status);
+}
+
+
 //
 // 'cupsArrayAddStrings()' - Add zero or more delimited strings to an array.
 //
@@ -134,6 +252,12 @@ cupsArrayAddStrings(cups_array_t *a,	// I - Array
   }
   else
   {
+    // Add the strings as a batch...
+    bool batch = a->batch;		// Already adding a batch?
+
+    if (!batch)
+      cupsArrayBeginBatch(a, true);
+
     for (start = end = buffer; *end; start = end)
     {
       // Find the end of the current delimited string and see if we need to add it...
@@ -178,10 +302,13 @@ cupsArrayAddStrings(cups_array_t *a,	// I - Array
           end ++;
       }
 
-      if (!cupsArrayFind(a, start))
+      if ((a->batch && a->batchunique) || !cupsArrayFind(a, start))
         status &= cupsArrayAdd(a, start);
     }
 
+    if (!batch)
+      cupsArrayEndBatch(a);
+
     free(buffer);
   }
 
@@ -189,6 +316,47 @@ cupsArrayAddStrings(cups_array_t *a,	// I - Array
 }
 
 
+//
+// 'cupsArrayBeginBatch()' - Start adding a batch of elements to an array.
+//
+// This function starts adding a batch of elements to an array.  Elements
+// added to a sorted array with @link cupsArrayAdd@ or @link cupsArrayInsert@
+// are appended to the end of the array and then sorted all at once by
+// @link cupsArrayEndBatch@ or the next function that needs the sorted array,
+// such as @link cupsArrayFind@ or @link cupsArrayGetFirst@.  The current
+// element and saved elements are reset when the batch is sorted.
+//
+// Elements that compare as equal are placed after any equal elements already
+// in the array, in the order they were added.  This matches adding them one
+// at a time with @link cupsArrayAdd@; while a batch is active,
+// @link cupsArrayInsert@ does not place elements at the beginning of a run of
+// identical elements.
+//
+// If "unique" is `true`, elements that compare as equal to an element already
+// in the array or added earlier in the batch are discarded, as if each element
+// had been added only when @link cupsArrayFind@ returned `NULL`.
+//
+
+bool					// O - `true` on success, `false` on failure
+cupsArrayBeginBatch(cups_array_t *a,	// I - Array
+                    bool         unique)// I - `true` to discard duplicate elements, `false` to keep them
+{
+  // Range check input...
+  if (!a)
+    return (false);
+
+  // Sort any elements from a previous batch and start a new batch...
+  if (a->batch)
+    cups_array_merge(a);
+
+  a->batch       = true;
+  a->batchunique = unique;
+  a->batchstart  = a->num_elements;
+
+  return (true);
+}
+
+
 //
 // 'cupsArrayClear()' - Clear an array.
 //
@@ -200,7 +368,7 @@ void
 cupsArrayClear(cups_array_t *a)		// I - Array
 {
   // Range check input...
-  if (!a)
+  if (!a || (a->vec && !cups_array_unshare(a)))
     return;
 
   // Free the existing elements as needed..
@@ -209,16 +377,26 @@ cupsArrayClear(cups_array_t *a)		// I - Array
     size_t	i;			// Looping var
     void	**e;			// Current element
 
-    for (i = a->num_elements, e = a->elements; i > 0; i --, e ++)
-      (a->freefunc)(*e, a->data);
+    for (i = a->num_elements + a->num_holes, e = a->elements; i > 0; i --, e ++)
+    {
+      if (*e)
+        cups_array_free(a, *e);
+    }
   }
 
+  // Empty the hash table as needed...
+  if (a->slots)
+    memset(a->slots, -1, a->num_slots * sizeof(size_t));
+
   // Set the number of elements to 0; we don't actually free the memory
   // here - that is done in cupsArrayDelete()...
   a->num_elements = 0;
+  a->num_holes    = 0;
+  a->batchstart   = 0;
   a->current      = SIZE_MAX;
   a->insert       = SIZE_MAX;
   a->unique       = true;
+  a->unsorted     = false;
   a->num_saved    = 0;
 }
 
@@ -233,15 +411,41 @@ cupsArrayClear(cups_array_t *a)		// I - Array
 void
 cupsArrayDelete(cups_array_t *a)	// I - Array
 {
+  bool	owned = true;			// Do we own the storage?
+
+
   // Range check input...
   if (!a)
     return;
 
-  // Clear the array...
-  cupsArrayClear(a);
+  // Stop sharing the storage with any snapshots...
+  if (a->vec)
+    owned = cups_array_retire(a);
+
+  // Free the elements as needed...
+  if (a->freefunc)
+  {
+    size_t	i;			// Looping var
+    void	**e;			// Current element
+
+    for (i = a->num_elements + a->num_holes, e = a->elements; i > 0; i --, e ++)
+    {
+      if (*e)
+        cups_array_free(a, *e);
+    }
+  }
 
   // Free the other buffers...
-  free(a->elements);
+  if (owned)
+  {
+    free(a->elements);
+    free(a->hashes);
+    free(a->slots);
+  }
+
+  if (a->lastvec)
+    cups_array_release(a->lastvec);
+
   free(a->hash);
   free(a);
 }
@@ -261,6 +465,13 @@ cupsArrayDup(cups_array_t *a)		// I - Array
   if (!a)
     return (NULL);
 
+  // Sort any batch and remove any holes left by cupsArrayRemove...
+  if (a->batch)
+    cups_array_merge(a);
+
+  if (a->num_holes)
+    cups_array_compact(a);
+
   // Allocate memory for the array...
   da = calloc(1, sizeof(cups_array_t));
   if (!da)
@@ -306,11 +517,59 @@ cupsArrayDup(cups_array_t *a)		// I - Array
     da->alloc_elements = a->num_elements;
   }
 
+  if (a->slots)
+  {
+    // Copy the hash values and build the hash table...
+    da->hashfunc = a->hashfunc;
+    da->sorted   = a->sorted;
+    da->unsorted = a->unsorted;
+
+    if (a->num_elements)
+    {
+      if ((da->hashes = malloc(a->num_elements * sizeof(size_t))) == NULL)
+      {
+        cupsArrayDelete(da);
+        return (NULL);
+      }
+
+      memcpy(da->hashes, a->hashes, a->num_elements * sizeof(size_t));
+    }
+
+    if (!cups_array_rehash(da, a->num_slots))
+    {
+      cupsArrayDelete(da);
+      return (NULL);
+    }
+  }
+
   // Return the new array...
   return (da);
 }
 
 
+//
+// 'cupsArrayEndBatch()' - Finish adding a batch of elements to an array.
+//
+// This function sorts the elements added since @link cupsArrayBeginBatch@
+// and returns the array to normal operation.
+//
+
+bool					// O - `true` on success, `false` if not adding a batch
+cupsArrayEndBatch(cups_array_t *a)	// I - Array
+{
+  // Range check input...
+  if (!a || !a->batch)
+    return (false);
+
+  // Sort the batch...
+  cups_array_merge(a);
+
+  a->batch = false;
+
+  return (true);
+}
+
+
 //
 // 'cupsArrayFind()' - Find an element in an array.
 //
@@ -328,8 +587,24 @@ cupsArrayFind(cups_array_t *a,		// I - Array
   if (!a || !a->num_elements || !e)
     return (NULL);
 
+  if (a->batch)
+    cups_array_merge(a);
+
   // Look for a match...
-  if (a->hash)
+  if (a->slots)
+  {
+    // Use the hash table...
+    if ((current = cups_array_hfind(a, e, (a->hashfunc)(e, a->data), NULL)) == SIZE_MAX)
+    {
+      a->current = SIZE_MAX;
+      return (NULL);
+    }
+
+    a->current = current;
+
+    return (a->elements[current]);
+  }
+  else if (a->hash)
   {
     if ((hash = (*(a->hashfunc))(e, a->data)) >= a->hashsize)
     {
@@ -381,7 +656,15 @@ cupsArrayFind(cups_array_t *a,		// I - Array
 size_t					// O - Number of elements
 cupsArrayGetCount(cups_array_t *a)	// I - Array
 {
-  return (a ? a->num_elements : 0);
+  // Range check input...
+  if (!a)
+    return (0);
+
+  // Remove duplicates from a batch as needed...
+  if (a->batch && a->batchunique)
+    cups_array_merge(a);
+
+  return (a->num_elements);
 }
 
 
@@ -401,7 +684,7 @@ cupsArrayGetCurrent(cups_array_t *a)	// I - Array
     return (NULL);
 
   // Return the current element...
-  if (a->current < a->num_elements)
+  if (a->current < (a->num_elements + a->num_holes))
     return (a->elements[a->current]);
   else
     return (NULL);
@@ -431,7 +714,18 @@ cupsArrayGetFirst(cups_array_t *a)	// I - Array
 size_t					// O - Index of the current element, starting at 0
 cupsArrayGetIndex(cups_array_t *a)	// I - Array
 {
-  return (a ? a->current : SIZE_MAX);
+  // Range check input...
+  if (!a)
+    return (SIZE_MAX);
+
+  // Sort any batch and remove any holes so the index is accurate...
+  if (a->batch)
+    cups_array_merge(a);
+
+  if (a->num_holes)
+    cups_array_compact(a);
+
+  return (a->current);
 }
 
 
@@ -445,7 +739,18 @@ cupsArrayGetIndex(cups_array_t *a)	// I - Array
 size_t					// O - Index of the last added or inserted element, starting at 0
 cupsArrayGetInsert(cups_array_t *a)	// I - Array
 {
-  return (a ? a->insert : SIZE_MAX);
+  // Range check input...
+  if (!a)
+    return (SIZE_MAX);
+
+  // Sort any batch and remove any holes so the index is accurate...
+  if (a->batch)
+    cups_array_merge(a);
+
+  if (a->num_holes)
+    cups_array_compact(a);
+
+  return (a->insert);
 }
 
 
@@ -461,6 +766,16 @@ cupsArrayGetElement(cups_array_t *a,	// I - Array
   if (!a || n >= a->num_elements)
     return (NULL);
 
+  // Sort batches, remove holes, and sort hash arrays as needed...
+  if (a->batch)
+    cups_array_merge(a);
+
+  if (a->num_holes)
+    cups_array_compact(a);
+
+  if (a->unsorted)
+    cups_array_sort(a);
+
   a->current = n;
 
   return (a->elements[n]);
@@ -495,13 +810,31 @@ cupsArrayGetLast(cups_array_t *a)	// I - Array
 void *					// O - Next element or @code NULL@
 cupsArrayGetNext(cups_array_t *a)	// I - Array
 {
+  size_t	i,			// Looping var
+		count;			// Number of elements and holes
+
+
   // Range check input...
   if (!a || a->num_elements == 0)
     return (NULL);
-  else if (a->current == SIZE_MAX)
+
+  if (a->batch)
+    cups_array_merge(a);
+
+  if (a->current == SIZE_MAX)
     return (cupsArrayGetElement(a, 0));
-  else
-    return (cupsArrayGetElement(a, a->current + 1));
+
+  // Skip any holes left by cupsArrayRemove...
+  for (i = a->current + 1, count = a->num_elements + a->num_holes; i < count; i ++)
+  {
+    if (a->elements[i])
+    {
+      a->current = i;
+      return (a->elements[i]);
+    }
+  }
+
+  return (NULL);
 }
 
 
@@ -517,11 +850,30 @@ cupsArrayGetNext(cups_array_t *a)	// I - Array
 void *					// O - Previous element or @code NULL@
 cupsArrayGetPrev(cups_array_t *a)	// I - Array
 {
+  size_t	i;			// Looping var
+
+
   // Range check input...
-  if (!a || a->num_elements == 0 || a->current == 0 || a->current == SIZE_MAX)
+  if (!a || a->num_elements == 0)
     return (NULL);
-  else
-    return (cupsArrayGetElement(a, a->current - 1));
+
+  if (a->batch)
+    cups_array_merge(a);
+
+  if (a->current == 0 || a->current == SIZE_MAX)
+    return (NULL);
+
+  // Skip any holes left by cupsArrayRemove...
+  for (i = a->current, a->current = SIZE_MAX; i > 0; i --)
+  {
+    if (i <= (a->num_elements + a->num_holes) && a->elements[i - 1])
+    {
+      a->current = i - 1;
+      return (a->elements[i - 1]);
+    }
+  }
+
+  return (NULL);
 }
 
 
@@ -542,7 +894,9 @@ cupsArrayGetUserData(cups_array_t *a)	// I - Array
 // This function inserts an element in an array.  When inserting an element
 // in a sorted array, non-unique elements are inserted at the beginning of the
 // run of identical elements.  For unsorted arrays, the element is inserted at
-// the beginning of the array.
+// the beginning of the array.  While adding a batch of elements to a sorted
+// array (see @link cupsArrayBeginBatch@), the element is placed as if it was
+// added with @link cupsArrayAdd@.
 //
 
 bool					// O - `true` on success, `false` on failure
@@ -558,6 +912,130 @@ cupsArrayInsert(cups_array_t *a,	// I - Array
 }
 
 
+//
+// 'cupsArrayIterFirst()' - Get the first element in an array using an iterator.
+//
+// This function initializes an iterator and returns the first element in an
+// array.  Unlike @link cupsArrayGetFirst@, iterators do not use or change the
+// current element of the array, so any number of threads can iterate over the
+// same array at the same time as long as no thread changes the array.
+//
+// Iterators return the elements in the order they are stored without sorting
+// a batch (see @link cupsArrayBeginBatch@) or a sorted hash array (see
+// @link cupsArrayNewHash@) first.
+//
+
+void *					// O - First element or `NULL` if the array is empty
+cupsArrayIterFirst(
+    cups_array_t      *a,		// I - Array
+    cups_array_iter_t *iter)		// I - Iterator
+{
+  // Range check input...
+  if (!iter)
+    return (NULL);
+
+  // Start before the first element...
+  iter->array = a;
+  iter->index = SIZE_MAX;
+
+  return (cupsArrayIterNext(iter));
+}
+
+
+//
+// 'cupsArrayIterLast()' - Get the last element in an array using an iterator.
+//
+// This function initializes an iterator and returns the last element in an
+// array.  See @link cupsArrayIterFirst@ for more information.
+//
+
+void *					// O - Last element or `NULL` if the array is empty
+cupsArrayIterLast(
+    cups_array_t      *a,		// I - Array
+    cups_array_iter_t *iter)		// I - Iterator
+{
+  // Range check input...
+  if (!iter)
+    return (NULL);
+
+  // Start after the last element...
+  iter->array = a;
+  iter->index = a ? a->num_elements + a->num_holes : 0;
+
+  return (cupsArrayIterPrev(iter));
+}
+
+
+//
+// 'cupsArrayIterNext()' - Get the next element in an array using an iterator.
+//
+
+void *					// O - Next element or `NULL` at the end of the array
+cupsArrayIterNext(
+    cups_array_iter_t *iter)		// I - Iterator
+{
+  cups_array_t	*a;			// Array
+  size_t	i,			// Looping var
+		count;			// Number of elements and holes
+
+
+  // Range check input...
+  if (!iter || (a = iter->array) == NULL)
+    return (NULL);
+
+  // Find the next element, skipping any holes left by cupsArrayRemove...
+  count = a->num_elements + a->num_holes;
+
+  for (i = iter->index == SIZE_MAX ? 0 : iter->index + 1; i < count; i ++)
+  {
+    if (a->elements[i])
+    {
+      iter->index = i;
+      return (a->elements[i]);
+    }
+  }
+
+  iter->index = count;
+
+  return (NULL);
+}
+
+
+//
+// 'cupsArrayIterPrev()' - Get the previous element in an array using an iterator.
+//
+
+void *					// O - Previous element or `NULL` at the beginning of the array
+cupsArrayIterPrev(
+    cups_array_iter_t *iter)		// I - Iterator
+{
+  cups_array_t	*a;			// Array
+  size_t	i,			// Looping var
+		count;			// Number of elements and holes
+
+
+  // Range check input...
+  if (!iter || (a = iter->array) == NULL || iter->index == SIZE_MAX)
+    return (NULL);
+
+  // Find the previous element, skipping any holes left by cupsArrayRemove...
+  count = a->num_elements + a->num_holes;
+
+  for (i = iter->index < count ? iter->index : count; i > 0; i --)
+  {
+    if (a->elements[i - 1])
+    {
+      iter->index = i - 1;
+      return (a->elements[i - 1]);
+    }
+  }
+
+  iter->index = SIZE_MAX;
+
+  return (NULL);
+}
+
+
 //
 // 'cupsArrayNew()' - Create a new array with callback functions.
 //
@@ -660,27 +1138,94 @@ cupsArrayNew(cups_array_cb_t  f,	// I - Comparison callback function or `NULL` f
 
 
 //
-// 'cupsArrayNewStrings()' - Create a new array of delimited strings.
+// 'cupsArrayNewHash()' - Create a new hash array with callback functions.
 //
-// This function creates an array that holds zero or more strings.  The created
-// array automatically manages copies of the strings passed and sorts them in
-// ascending order using a case-sensitive comparison.  If the string pointer "s"
-// is `NULL` or the empty string, no strings are added to the newly created
-// array.
+// This function creates a new array that uses a hash table for lookups, so
+// @link cupsArrayAdd@, @link cupsArrayFind@, and @link cupsArrayRemove@ take
+// constant time on average regardless of the number of elements.  The
+// comparison callback function ("f") returns `0` when two elements are equal
+// and is required.  The hash callback function ("hf") is also required and
+// must return the same value for elements that compare as equal.  Unlike the
+// hash function used with @link cupsArrayNew@, the value can be any `size_t`:
 //
-// Additional strings can be added using the @link cupsArrayAdd@ or
-// @link cupsArrayAddStrings@ functions.
+// ```
+// size_t // Return hash value
+// hash_cb(void *e, void *d)
+// {
+//   ... "e" is the element, "d" is the user data pointer
+// }
+// ```
+//
+// Elements are appended to the array in the order they are added.  If the
+// "sorted" argument is `true`, the array is sorted using the comparison
+// function when @link cupsArrayGetElement@, @link cupsArrayGetFirst@, or
+// @link cupsArrayGetLast@ is called after elements have been added out of
+// order.  Otherwise the elements are returned in the order they were added.
+//
+// @link cupsArrayInsert@ adds an element to the beginning of a hash array and
+// requires rebuilding the hash table.  @link cupsArrayRemove@ leaves the
+// current element undefined (@link cupsArrayGetNext@ and
+// @link cupsArrayGetPrev@ still work) and elements removed while iterating
+// are simply skipped.
+//
+// The copy ("cf") and free ("ff") callback functions are the same as for
+// @link cupsArrayNew@.
 //
 
 cups_array_t *				// O - Array
-cupsArrayNewStrings(const char *s,	// I - Delimited strings or `NULL` to create an empty array
-                    char       delim)	// I - Delimiter character
+cupsArrayNewHash(cups_array_cb_t f,	// I - Comparison callback function
+                 void            *d,	// I - User data or `NULL`
+                 cups_ahash_cb_t hf,	// I - Hash callback function
+                 bool            sorted,// I - `true` to iterate in sorted order, `false` to iterate in the order added
+                 cups_acopy_cb_t cf,	// I - Copy callback function or `NULL` for none
+                 cups_afree_cb_t ff)	// I - Free callback function or `NULL` for none
 {
   cups_array_t	*a;			// Array
 
 
-  if ((a = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, (cups_acopy_cb_t)_cupsStrAlloc, (cups_afree_cb_t)_cupsStrFree)) != NULL)
-    cupsArrayAddStrings(a, s, delim);
+  // Range check input...
+  if (!f || !hf)
+    return (NULL);
+
+  // Allocate memory for the array and hash table...
+  if ((a = cupsArrayNew(f, d, NULL, 0, cf, ff)) == NULL)
+    return (NULL);
+
+  a->hashfunc = hf;
+  a->sorted   = sorted;
+
+  if (!cups_array_rehash(a, 16))
+  {
+    cupsArrayDelete(a);
+    return (NULL);
+  }
+
+  return (a);
+}
+
+
+//
+// 'cupsArrayNewStrings()' - Create a new array of delimited strings.
+//
+// This function creates an array that holds zero or more strings.  The created
+// array automatically manages copies of the strings passed and sorts them in
+// ascending order using a case-sensitive comparison.  If the string pointer "s"
+// is `NULL` or the empty string, no strings are added to the newly created
+// array.
+//
+// Additional strings can be added using the @link cupsArrayAdd@ or
+// @link cupsArrayAddStrings@ functions.
+//
+
+cups_array_t *				// O - Array
+cupsArrayNewStrings(const char *s,	// I - Delimited strings or `NULL` to create an empty array
+                    char       delim)	// I - Delimiter character
+{
+  cups_array_t	*a;			// Array
+
+
+  if ((a = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, (cups_acopy_cb_t)_cupsStrAlloc, (cups_afree_cb_t)_cupsStrFree)) != NULL)
+    cupsArrayAddStrings(a, s, delim);
 
   return (a);
 }
@@ -706,16 +1251,70 @@ cupsArrayRemove(cups_array_t *a,	// I - Array
   if (!a || a->num_elements == 0 || !e)
     return (false);
 
+  if (a->batch)
+    cups_array_merge(a);
+
+  if (a->slots)
+  {
+    // Hash array, look up the element and remove it from the hash table...
+    size_t	slot,			// Hash table slot
+		next,			// Next slot
+		home,			// Home slot of next element
+		mask = a->num_slots - 1;// Mask for slot numbers
+
+    if ((current = cups_array_hfind(a, e, (a->hashfunc)(e, a->data), &slot)) == SIZE_MAX)
+      return (false);
+
+    if (a->vec && !cups_array_unshare(a))
+      return (false);
+
+    // Shift following entries in the probe sequence back so that lookups
+    // don't need tombstones...
+    for (next = (slot + 1) & mask; a->slots[next] != SIZE_MAX; next = (next + 1) & mask)
+    {
+      home = cups_array_slot(a, a->hashes[a->slots[next]]);
+
+      if (slot <= next ? (home <= slot || home > next) : (home <= slot && home > next))
+      {
+        a->slots[slot] = a->slots[next];
+        slot           = next;
+      }
+    }
+
+    a->slots[slot] = SIZE_MAX;
+
+    // Then leave a hole in the elements so that the cursor and saved indices
+    // remain valid...
+    if (a->freefunc)
+      cups_array_free(a, a->elements[current]);
+
+    a->elements[current] = NULL;
+    a->num_elements --;
+    a->num_holes ++;
+
+    if (current == a->insert)
+      a->insert = SIZE_MAX;
+
+    // Trim holes from the end of the array...
+    while (a->num_holes > 0 && !a->elements[a->num_elements + a->num_holes - 1])
+      a->num_holes --;
+
+    return (true);
+  }
+
   // See if the element is in the array...
   current = cups_array_find(a, e, a->current, &diff);
   if (diff)
     return (false);
 
   // Yes, now remove it...
+  if (a->vec && !cups_array_unshare(a))
+    return (false);
+
   a->num_elements --;
 
   if (a->freefunc)
-    (a->freefunc)(a->elements[current], a->data);
+    cups_array_free(a, a->elements[current]);
 
   if (current < a->num_elements)
     memmove(a->elements + current, a->elements + current + 1, (a->num_elements - current) * sizeof(void *));
@@ -760,7 +1359,7 @@ cupsArrayRestore(cups_array_t *a)	// I - Array
   a->num_saved --;
   a->current = a->saved[a->num_saved];
 
-  if (a->current < a->num_elements)
+  if (a->current < (a->num_elements + a->num_holes))
     return (a->elements[a->current]);
   else
     return (NULL);
@@ -784,6 +1383,9 @@ cupsArraySave(cups_array_t *a)		// I - Array
   if (!a || a->num_saved >= _CUPS_MAXSAVE)
     return (false);
 
+  if (a->batch)
+    cups_array_merge(a);
+
   a->saved[a->num_saved] = a->current;
   a->num_saved ++;
 
@@ -791,6 +1393,97 @@ cupsArraySave(cups_array_t *a)		// I - Array
 }
 
 
+//
+// 'cupsArraySnapshot()' - Create a snapshot of an array.
+//
+// This function creates a snapshot of the current contents of an array.  The
+// snapshot shares storage with the array, so creating one takes constant time;
+// the first change to the array afterwards copies the element pointers (and
+// hash table) so that the snapshot is unaffected.  Elements removed from the
+// array are not freed until every snapshot that might contain them has been
+// deleted with @link cupsArrayDelete@.
+//
+// This allows a writer to publish versions of an array that readers traverse
+// without holding a lock: the writer (or a reader, while holding the lock that
+// protects the array) calls `cupsArraySnapshot` and each reader uses its own
+// snapshot.  Snapshots can also be created from other snapshots.
+//
+// Snapshots support all of the array functions, but do not copy or free
+// elements.  Changes made to a snapshot are not visible in the array.
+//
+
+cups_array_t *				// O - Snapshot or `NULL` on error
+cupsArraySnapshot(cups_array_t *a)	// I - Array
+{
+  cups_array_t	*sa;			// Snapshot
+
+
+  // Range check input...
+  if (!a)
+    return (NULL);
+
+  // Allocate memory for the snapshot...
+  if ((sa = calloc(1, sizeof(cups_array_t))) == NULL)
+    return (NULL);
+
+  // Share the storage...
+  cupsMutexLock(&array_mutex);
+
+  if (!a->vec)
+  {
+    if ((a->vec = calloc(1, sizeof(_cups_avec_t))) == NULL)
+    {
+      cupsMutexUnlock(&array_mutex);
+      free(sa);
+      return (NULL);
+    }
+
+    a->vec->refcount = 1;
+    a->vec->elements = a->elements;
+    a->vec->hashes   = a->hashes;
+    a->vec->slots    = a->slots;
+    a->vec->freefunc = a->freefunc;
+    a->vec->data     = a->data;
+
+    if (!a->freefunc && a->lastvec)
+    {
+      // Snapshot of a changed snapshot, keep the storage that holds the
+      // original array's removed elements...
+      a->vec->next = a->lastvec;
+      a->lastvec->refcount ++;
+    }
+  }
+
+  a->vec->refcount ++;
+  sa->vec = a->vec;
+
+  cupsMutexUnlock(&array_mutex);
+
+  // Copy the rest of the array state...
+  sa->num_elements   = a->num_elements;
+  sa->num_holes      = a->num_holes;
+  sa->alloc_elements = a->alloc_elements;
+  sa->current        = SIZE_MAX;
+  sa->insert         = SIZE_MAX;
+  sa->elements       = a->elements;
+  sa->compare        = a->compare;
+  sa->unique         = a->unique;
+  sa->batch          = a->batch;
+  sa->batchunique    = a->batchunique;
+  sa->batchstart     = a->batchstart;
+  sa->data           = a->data;
+  sa->hashfunc       = a->hashfunc;
+  sa->hashes         = a->hashes;
+  sa->num_slots      = a->num_slots;
+  sa->slots          = a->slots;
+  sa->slotshift      = a->slotshift;
+  sa->sorted         = a->sorted;
+  sa->unsorted       = a->unsorted;
+
+  return (sa);
+}
+
+
 //
 // 'cups_array_add()' - Insert or append an element to the array.
 //
@@ -805,31 +1498,114 @@ cups_array_add(cups_array_t *a,		// I - Array
   int		diff;			// Comparison with current element
 
 
+  if (a->batch && a->batchunique && a->num_elements > 0)
+  {
+    // Skip duplicates in hash and unsorted arrays; sorted arrays remove them
+    // when the batch is sorted...
+    if (a->slots)
+    {
+      if (cups_array_hfind(a, e, (a->hashfunc)(e, a->data), NULL) != SIZE_MAX)
+        return (true);
+    }
+    else if (!a->compare)
+    {
+      cups_array_find(a, e, SIZE_MAX, &diff);
+
+      if (!diff)
+        return (true);
+    }
+  }
+
+  // Stop sharing the storage with any snapshots...
+  if (a->vec && !cups_array_unshare(a))
+    return (false);
+
+  // Reuse the space of removed elements if there are enough of them...
+  if (a->num_holes > 0 && (a->num_elements + a->num_holes) >= a->alloc_elements && a->num_holes >= (a->alloc_elements / 4))
+    cups_array_compact(a);
+
   // Verify we have room for the new element...
-  if (a->num_elements >= a->alloc_elements)
+  if (!cups_array_grow(a, 1))
+    return (false);
+
+  if (a->slots)
   {
-    // Allocate additional elements; start with 16 elements, then double the
-    // size until 1024 elements, then add 1024 elements thereafter...
-    void	**temp;			// New array elements
-    size_t	count;			// New allocation count
+    // Hash array, keep the hash table at most half full...
+    size_t	h = (a->hashfunc)(e, a->data),
+					// Hash value
+		slot;			// Hash table slot
+    bool	rebuild = false;	// Rebuild the hash table?
 
-    if (a->alloc_elements == 0)
-      count = 16;
-    else if (a->alloc_elements < 1024)
-      count = a->alloc_elements * 2;
-    else
-      count = a->alloc_elements + 1024;
+    if ((a->num_elements + 1) > (a->num_slots / 2) && !cups_array_rehash(a, 2 * a->num_slots))
+      return (false);
 
-    if ((temp = realloc(a->elements, count * sizeof(void *))) == NULL)
+    if (a->copyfunc && (e = (a->copyfunc)(e, a->data)) == NULL)
       return (false);
 
-    a->alloc_elements = count;
-    a->elements       = temp;
+    if (insert && a->num_elements > 0)
+    {
+      // Shift all of the elements to the right; this changes every index
+      // so the hash table needs to be rebuilt...
+      if (a->num_holes)
+        cups_array_compact(a);
+
+      memmove(a->elements + 1, a->elements, a->num_elements * sizeof(void *));
+      memmove(a->hashes + 1, a->hashes, a->num_elements * sizeof(size_t));
+
+      if (a->current != SIZE_MAX)
+        a->current ++;
+
+      for (i = 0; i < a->num_saved; i ++)
+      {
+        if (a->saved[i] != SIZE_MAX)
+          a->saved[i] ++;
+      }
+
+      current = 0;
+      rebuild = true;
+    }
+    else
+    {
+      current = a->num_elements + a->num_holes;
+    }
+
+    a->elements[current] = e;
+    a->hashes[current]   = h;
+    a->num_elements ++;
+    a->insert = current;
+
+    // Note when the new element is out of order...
+    if (a->sorted && !a->unsorted && a->num_elements > 1)
+    {
+      if (current == 0)
+        a->unsorted = (*(a->compare))(a->elements[0], a->elements[1], a->data) > 0;
+      else
+        a->unsorted = (*(a->compare))(a->elements[current], a->elements[current - 1], a->data) < 0;
+    }
+
+    // Add the new element to the hash table...
+    if (rebuild)
+    {
+      cups_array_rehash(a, a->num_slots);
+    }
+    else
+    {
+      for (slot = cups_array_slot(a, h); a->slots[slot] != SIZE_MAX; slot = (slot + 1) & (a->num_slots - 1));
+
+      a->slots[slot] = current;
+    }
+
+    return (true);
   }
 
   // Find the insertion point for the new element; if there is no compare
   // function or elements, just add it to the beginning or end...
-  if (!a->num_elements || !a->compare)
+  if (a->batch && a->compare)
+  {
+    // Adding a batch, append and sort later...
+    current = a->num_elements;
+  }
+  else if (!a->num_elements || !a->compare)
   {
     // No elements or comparison function, insert/append as needed...
     if (insert)
@@ -904,6 +1680,74 @@ cups_array_add(cups_array_t *a,		// I - Array
 }
 
 
+//
+// 'cups_array_compact()' - Remove the holes left by removing elements from a hash array.
+//
+
+static void
+cups_array_compact(cups_array_t *a)	// I - Array
+{
+  size_t	i,			// Looping var
+		from,			// Old index
+		to,			// New index
+		count = a->num_elements + a->num_holes,
+					// Number of elements and holes
+		*indices[_CUPS_MAXSAVE + 2],
+					// Indices to update
+		num_indices = 0;	// Number of indices
+
+
+  if (a->vec && !cups_array_unshare(a))
+    return;
+
+  // Collect the indices that refer to elements; each index is updated to
+  // refer to the same element or, if that element has been removed, the
+  // previous one so that cupsArrayGetNext continues with the next element...
+  if (a->current != SIZE_MAX)
+    indices[num_indices ++] = &a->current;
+  if (a->insert != SIZE_MAX)
+    indices[num_indices ++] = &a->insert;
+
+  for (i = 0; i < a->num_saved; i ++)
+  {
+    if (a->saved[i] != SIZE_MAX)
+      indices[num_indices ++] = a->saved + i;
+  }
+
+  for (i = 0; i < num_indices; i ++)
+  {
+    size_t	index = *indices[i];	// Old index
+
+    for (from = 0, to = 0; from < index && from < count; from ++)
+    {
+      if (a->elements[from])
+        to ++;
+    }
+
+    if (index < count && a->elements[index])
+      *indices[i] = to;
+    else
+      *indices[i] = to > 0 ? to - 1 : SIZE_MAX;
+  }
+
+  // Move the remaining elements down...
+  for (from = 0, to = 0; from < count; from ++)
+  {
+    if (a->elements[from])
+    {
+      a->elements[to] = a->elements[from];
+      a->hashes[to]   = a->hashes[from];
+      to ++;
+    }
+  }
+
+  a->num_holes = 0;
+
+  // Rebuild the hash table with the new indices...
+  cups_array_rehash(a, a->num_slots);
+}
+
+
 //
 // 'cups_array_find()' - Find an element in the array.
 //
@@ -1001,3 +1845,647 @@ cups_array_find(cups_array_t *a,	// I - Array
 
   return (current);
 }
+
+
+//
+// 'cups_array_free()' - Free a removed element.
+//
+// Elements are not freed until any retired storage that might still contain
+// them has been released.
+//
+
+static void
+cups_array_free(cups_array_t *a,	// I - Array
+                void         *e)	// I - Element
+{
+  _cups_avec_t	*vec;			// Retired storage
+
+
+  if ((vec = a->lastvec) != NULL)
+  {
+    cupsMutexLock(&array_mutex);
+
+    if (vec->refcount > 1)
+    {
+      // Storage is still used by a snapshot, free the element later...
+      if (vec->num_frees >= vec->alloc_frees)
+      {
+        void	**temp;			// New elements to free
+        size_t	alloc = vec->alloc_frees ? 2 * vec->alloc_frees : 16;
+					// New allocation count
+
+        if ((temp = realloc(vec->frees, alloc * sizeof(void *))) == NULL)
+        {
+          // Not enough memory, leak the element rather than freeing it while
+          // it is still in use...
+          cupsMutexUnlock(&array_mutex);
+          DEBUG_printf("4cups_array_free: Unable to defer free of %p.", e);
+          return;
+        }
+
+        vec->frees       = temp;
+        vec->alloc_frees = alloc;
+      }
+
+      vec->frees[vec->num_frees ++] = e;
+
+      cupsMutexUnlock(&array_mutex);
+      return;
+    }
+
+    // No more snapshots, release the retired storage...
+    a->lastvec = NULL;
+
+    cupsMutexUnlock(&array_mutex);
+
+    cups_array_release(vec);
+  }
+
+  (a->freefunc)(e, a->data);
+}
+
+
+//
+// 'cups_array_grow()' - Make room for additional elements.
+//
+
+static bool				// O - `true` on success, `false` on failure
+cups_array_grow(cups_array_t *a,	// I - Array
+                size_t       count)	// I - Number of elements to add
+{
+  void		**temp;			// New array elements
+  size_t	alloc,			// New allocation count
+		*htemp;			// New hash values
+
+
+  if ((a->num_elements + a->num_holes + count) <= a->alloc_elements)
+    return (true);
+
+  // Allocate additional elements; start with 16 elements, then double the
+  // size until 1024 elements, then add 1024 elements thereafter...
+  if (a->alloc_elements == 0)
+    alloc = 16;
+  else if (a->alloc_elements < 1024)
+    alloc = a->alloc_elements * 2;
+  else
+    alloc = a->alloc_elements + 1024;
+
+  if (alloc < (a->num_elements + a->num_holes + count))
+    alloc = a->num_elements + a->num_holes + count;
+
+  if ((temp = realloc(a->elements, alloc * sizeof(void *))) == NULL)
+    return (false);
+
+  a->elements = temp;
+
+  if (a->slots)
+  {
+    if ((htemp = realloc(a->hashes, alloc * sizeof(size_t))) == NULL)
+      return (false);
+
+    a->hashes = htemp;
+  }
+
+  a->alloc_elements = alloc;
+
+  return (true);
+}
+
+
+//
+// 'cups_array_hfind()' - Find an element in the hash table.
+//
+
+static size_t				// O - Index of element or `SIZE_MAX` if not found
+cups_array_hfind(cups_array_t *a,	// I - Array
+                 void         *e,	// I - Element
+                 size_t       h,	// I - Hash value of element
+                 size_t       *rslot)	// O - Hash table slot or `NULL`
+{
+  size_t	slot,			// Current slot
+		current;		// Current element
+
+
+  // Search the probe sequence for a matching element...
+  for (slot = cups_array_slot(a, h); (current = a->slots[slot]) != SIZE_MAX; slot = (slot + 1) & (a->num_slots - 1))
+  {
+    if (a->hashes[current] == h && !(*(a->compare))(e, a->elements[current], a->data))
+      break;
+  }
+
+  if (rslot)
+    *rslot = slot;
+
+  return (current);
+}
+
+
+//
+// 'cups_array_merge()' - Sort the elements added in a batch.
+//
+// The batch is sorted with a merge sort and then merged from the end of the
+// array with the existing elements.  Equal elements keep the order they were
+// added and go after existing equal elements, so the result is the same as
+// calling cupsArrayAdd for each element (including elements that were added
+// with cupsArrayInsert).
+//
+
+static void
+cups_array_merge(cups_array_t *a)	// I - Array
+{
+  void		**temp,			// Temporary array
+		**sorted;		// Sorted batch
+  size_t	i,			// Current existing element
+		j,			// Current batch element
+		k,			// Current output element
+		count,			// Number of elements in batch
+		drops = 0;		// Number of duplicates removed
+  int		diff;			// Difference between elements
+
+
+  // Hash and unsorted arrays don't need sorting...
+  if (a->batchstart >= a->num_elements || !a->compare || a->slots)
+  {
+    a->batchstart = a->num_elements;
+    return;
+  }
+
+  if (a->vec && !cups_array_unshare(a))
+    return;
+
+  count        = a->num_elements - a->batchstart;
+  a->current   = SIZE_MAX;
+  a->insert    = SIZE_MAX;
+  a->num_saved = 0;
+
+  if ((temp = malloc(count * sizeof(void *))) == NULL)
+  {
+    // Not enough memory, insert the batch elements one at a time...
+    void	*e;			// Current element
+    size_t	left,			// Left side of search
+		right,			// Right side of search
+		middle;			// Middle of search
+
+    for (i = a->batchstart, k = a->batchstart; i < a->num_elements; i ++)
+    {
+      // Find the insertion point after any equal elements...
+      for (e = a->elements[i], left = 0, right = k; left < right;)
+      {
+        middle = (left + right) / 2;
+
+        if ((*(a->compare))(e, a->elements[middle], a->data) < 0)
+          right = middle;
+        else
+          left = middle + 1;
+      }
+
+      j    = left;
+      diff = j > 0 ? (*(a->compare))(e, a->elements[j - 1], a->data) : 1;
+
+      if (j > 0 && !diff)
+      {
+        if (a->batchunique)
+        {
+          if (a->freefunc)
+            cups_array_free(a, e);
+          continue;
+        }
+
+        a->unique = false;
+      }
+
+      memmove(a->elements + j + 1, a->elements + j, (k - j) * sizeof(void *));
+      a->elements[j] = e;
+      k ++;
+    }
+
+    a->num_elements = k;
+    a->batchstart   = k;
+    return;
+  }
+
+  // Sort the batch into the temporary array...
+  if ((sorted = cups_array_msort(a, a->elements + a->batchstart, temp, count)) != temp)
+    memcpy(temp, sorted, count * sizeof(void *));
+
+  // Remove or note duplicates in the batch...
+  for (i = 1, k = 1; i < count; i ++)
+  {
+    if (!(*(a->compare))(temp[i], temp[k - 1], a->data))
+    {
+      if (a->batchunique)
+      {
+        if (a->freefunc)
+          cups_array_free(a, temp[i]);
+        continue;
+      }
+
+      a->unique = false;
+    }
+
+    temp[k ++] = temp[i];
+  }
+
+  count = k;
+
+  // Merge from the end so that existing elements are only moved once; on a
+  // tie the existing element goes first...
+  for (i = a->batchstart, j = count, k = a->batchstart + count; j > 0;)
+  {
+    diff = i > 0 ? (*(a->compare))(a->elements[i - 1], temp[j - 1], a->data) : -1;
+
+    if (diff > 0)
+    {
+      a->elements[-- k] = a->elements[-- i];
+    }
+    else if (!diff && a->batchunique)
+    {
+      j --;
+      drops ++;
+
+      if (a->freefunc)
+        cups_array_free(a, temp[j]);
+    }
+    else
+    {
+      if (!diff)
+        a->unique = false;
+
+      a->elements[-- k] = temp[-- j];
+    }
+  }
+
+  // Close the gap left by any duplicates...
+  if (drops)
+    memmove(a->elements + i, a->elements + k, (a->batchstart + count - k) * sizeof(void *));
+
+  a->num_elements = a->batchstart + count - drops;
+  a->batchstart   = a->num_elements;
+
+  free(temp);
+}
+
+
+//
+// 'cups_array_msort()' - Sort elements using a bottom-up merge sort.
+//
+// Equal elements stay in the same order.  The sorted elements are returned in
+// either "e" or "temp".
+//
+
+static void **				// O - Sorted elements
+cups_array_msort(cups_array_t *a,	// I - Array
+                 void         **e,	// I - Elements to sort
+                 void         **temp,	// I - Temporary array
+                 size_t       count)	// I - Number of elements
+{
+  void		**src,			// Source array
+		**dst,			// Destination array
+		**swap;			// Swap pointer
+  size_t	i,			// Looping var
+		out,			// Current output element
+		width,			// Width of each run
+		left,			// Current element in left run
+		leftend,		// End of left run
+		right,			// Current element in right run
+		rightend;		// End of right run
+
+
+  // Merge runs of increasing width...
+  for (width = 1, src = e, dst = temp; width < count; width *= 2, swap = src, src = dst, dst = swap)
+  {
+    for (i = 0; i < count; i += 2 * width)
+    {
+      out      = i;
+      left     = i;
+      leftend  = i + width < count ? i + width : count;
+      right    = leftend;
+      rightend = i + 2 * width < count ? i + 2 * width : count;
+
+      while (left < leftend && right < rightend)
+      {
+        if ((*(a->compare))(src[right], src[left], a->data) < 0)
+          dst[out ++] = src[right ++];
+        else
+          dst[out ++] = src[left ++];
+      }
+
+      while (left < leftend)
+        dst[out ++] = src[left ++];
+
+      while (right < rightend)
+        dst[out ++] = src[right ++];
+    }
+  }
+
+  return (src);
+}
+
+
+//
+// 'cups_array_rehash()' - Rebuild the hash table.
+//
+// When "num_slots" is the current number of slots the existing table is
+// reused and this function cannot fail.
+//
+
+static bool				// O - `true` on success, `false` on failure
+cups_array_rehash(cups_array_t *a,	// I - Array
+                  size_t       num_slots)
+					// I - Number of slots (power of 2)
+{
+  size_t	i,			// Looping var
+		count,			// Number of elements and holes
+		slot;			// Current slot
+
+
+  // Allocate a new table as needed...
+  if (num_slots != a->num_slots)
+  {
+    size_t	*slots;			// New hash table
+
+    if ((slots = malloc(num_slots * sizeof(size_t))) == NULL)
+      return (false);
+
+    free(a->slots);
+
+    a->slots     = slots;
+    a->num_slots = num_slots;
+
+    for (a->slotshift = 64; num_slots > 1; num_slots /= 2)
+      a->slotshift --;
+  }
+
+  // Add all of the elements to the table...
+  memset(a->slots, -1, a->num_slots * sizeof(size_t));
+
+  for (i = 0, count = a->num_elements + a->num_holes; i < count; i ++)
+  {
+    if (!a->elements[i])
+      continue;
+
+    for (slot = cups_array_slot(a, a->hashes[i]); a->slots[slot] != SIZE_MAX; slot = (slot + 1) & (a->num_slots - 1));
+
+    a->slots[slot] = i;
+  }
+
+  return (true);
+}
+
+
+//
+// 'cups_array_release()' - Release a reference to shared storage.
+//
+// When the last reference is released, the storage is freed along with any
+// elements that were removed while it was in use.  Each retired storage holds
+// a reference to the next (newer) retired storage so that elements are only
+// freed after all of the older storage is gone, and storage shared with a
+// snapshot of a changed snapshot holds a reference to the storage that keeps
+// the snapshot's elements.
+//
+
+static void
+cups_array_release(_cups_avec_t *vec)	// I - Shared storage
+{
+  _cups_avec_t	*next;			// Next storage
+  size_t	i;			// Looping var
+
+
+  while (vec)
+  {
+    cupsMutexLock(&array_mutex);
+
+    if (-- vec->refcount > 0)
+    {
+      cupsMutexUnlock(&array_mutex);
+      break;
+    }
+
+    next = vec->next;
+
+    cupsMutexUnlock(&array_mutex);
+
+    for (i = 0; i < vec->num_frees; i ++)
+      (vec->freefunc)(vec->frees[i], vec->data);
+
+    free(vec->frees);
+    free(vec->elements);
+    free(vec->hashes);
+    free(vec->slots);
+    free(vec);
+
+    vec = next;
+  }
+}
+
+
+//
+// 'cups_array_retire()' - Stop using shared storage.
+//
+// If the array has a free function, the storage is kept as the newest retired
+// storage so that removed elements can be freed once the snapshots using it
+// are deleted.  Otherwise, if the storage belongs to an array that frees its
+// elements, the array is a snapshot and keeps the first storage it retires so
+// that elements removed from the original array remain valid until the
+// snapshot is deleted.  Storage that never frees elements is released right
+// away, so it is freed as soon as the last snapshot using it is deleted.
+//
+
+static bool				// O - `true` if the array owns the storage, `false` if it is still shared
+cups_array_retire(cups_array_t *a)	// I - Array
+{
+  _cups_avec_t	*vec = a->vec,		// Shared storage
+		*old = NULL;		// Storage to release
+  bool		owned;			// Does the array own the storage?
+
+
+  cupsMutexLock(&array_mutex);
+
+  a->vec = NULL;
+
+  if ((owned = vec->refcount == 1) == true)
+  {
+    // Nobody else uses the buffers, so take them...
+    vec->elements = NULL;
+    vec->hashes   = NULL;
+    vec->slots    = NULL;
+  }
+
+  if (a->freefunc && !owned)
+  {
+    // Keep our reference as the newest retired storage...
+    if ((old = a->lastvec) != NULL)
+    {
+      old->next = vec;
+      vec->refcount ++;
+    }
+
+    a->lastvec = vec;
+  }
+  else if (!a->freefunc && !a->lastvec && (vec->freefunc || vec->next))
+  {
+    // Keep our reference so the original array defers freeing the elements
+    // we still use...
+    a->lastvec = vec;
+  }
+  else
+  {
+    // Release our reference, which might free elements removed by the
+    // original array...
+    old = vec;
+  }
+
+  cupsMutexUnlock(&array_mutex);
+
+  if (old)
+    cups_array_release(old);
+
+  return (owned);
+}
+
+
+//
+// 'cups_array_slot()' - Get the home slot for a hash value.
+//
+// The hash value is scrambled using Fibonacci hashing so that weak hash
+// functions (sequential integers, pointers, etc.) still spread across the
+// table.
+//
+
+static size_t				// O - Slot number
+cups_array_slot(cups_array_t *a,	// I - Array
+                size_t       h)		// I - Hash value
+{
+  return ((size_t)(((uint64_t)h * 0x9e3779b97f4a7c15ULL) >> a->slotshift));
+}
+
+
+//
+// 'cups_array_sort()' - Sort the elements of a hash array.
+//
+// This uses a merge sort so that equal elements stay in the order they were
+// added.
+//
+
+static void
+cups_array_sort(cups_array_t *a)	// I - Array
+{
+  void		**temp,			// Temporary array
+		**sorted;		// Sorted elements
+  size_t	i;			// Looping var
+
+
+  // Remove any holes and allocate a temporary array; on failure the array is
+  // iterated unsorted...
+  if (a->vec && !cups_array_unshare(a))
+    return;
+
+  if (a->num_holes)
+    cups_array_compact(a);
+
+  if ((temp = malloc(a->num_elements * sizeof(void *))) == NULL)
+    return;
+
+  // Sort the elements...
+  if ((sorted = cups_array_msort(a, a->elements, temp, a->num_elements)) != a->elements)
+    memcpy(a->elements, sorted, a->num_elements * sizeof(void *));
+
+  free(temp);
+
+  // Update the hash values and table for the new order...
+  for (i = 0; i < a->num_elements; i ++)
+    a->hashes[i] = (a->hashfunc)(a->elements[i], a->data);
+
+  cups_array_rehash(a, a->num_slots);
+
+  // Saved and current indices refer to the old order...
+  a->current  = SIZE_MAX;
+  a->insert   = SIZE_MAX;
+  a->unsorted = false;
+
+  for (i = 0; i < a->num_saved; i ++)
+    a->saved[i] = SIZE_MAX;
+}
+
+
+//
+// 'cups_array_unshare()' - Stop sharing storage with snapshots.
+//
+// If no snapshots are left, the array takes back the storage.  Otherwise the
+// element pointers and hash table are copied and the shared storage is
+// retired.
+//
+
+static bool				// O - `true` on success, `false` on failure
+cups_array_unshare(cups_array_t *a)	// I - Array
+{
+  bool		shared;			// Is the storage still shared?
+  void		**elements = NULL;	// Copy of elements
+  size_t	*hashes = NULL,		// Copy of hash values
+		*slots = NULL;		// Copy of hash table
+
+
+  // See if the snapshots have all been deleted...
+  cupsMutexLock(&array_mutex);
+
+  shared = a->vec->refcount > 1;
+
+  cupsMutexUnlock(&array_mutex);
+
+  if (!shared)
+  {
+    cups_array_retire(a);
+    return (true);
+  }
+
+  // Copy the storage...
+  if (a->alloc_elements > 0)
+  {
+    if ((elements = malloc(a->alloc_elements * sizeof(void *))) == NULL)
+      goto error;
+
+    memcpy(elements, a->elements, (a->num_elements + a->num_holes) * sizeof(void *));
+
+    if (a->hashes)
+    {
+      if ((hashes = malloc(a->alloc_elements * sizeof(size_t))) == NULL)
+        goto error;
+
+      memcpy(hashes, a->hashes, (a->num_elements + a->num_holes) * sizeof(size_t));
+    }
+  }
+
+  if (a->slots)
+  {
+    if ((slots = malloc(a->num_slots * sizeof(size_t))) == NULL)
+      goto error;
+
+    memcpy(slots, a->slots, a->num_slots * sizeof(size_t));
+  }
+
+  // Retire the shared storage and use the copy; if the last snapshot was
+  // deleted in the meantime, keep the original storage instead...
+  if (cups_array_retire(a))
+  {
+    free(elements);
+    free(hashes);
+    free(slots);
+  }
+  else
+  {
+    a->elements = elements;
+    a->hashes   = hashes;
+    a->slots    = slots;
+  }
+
+  return (true);
+
+  // If we get here, we were unable to allocate memory for the copy...
+  error:
+
+  free(elements);
+  free(hashes);
+  free(slots);
+
+  return (false);
+}
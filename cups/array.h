@@ -34,16 +34,25 @@ typedef void *(*cups_acopy_cb_t)(void *element, void *data);
 typedef void (*cups_afree_cb_t)(void *element, void *data);
 					// Array element free function
 
+typedef struct cups_array_iter_s	// Array iterator
+{
+  cups_array_t	*array;			// Array
+  size_t	index;			// Index of current element
+} cups_array_iter_t;
+
 
 //
 // Functions...
 //
 
 extern bool		cupsArrayAdd(cups_array_t *a, void *e) _CUPS_PUBLIC;
+extern bool		cupsArrayAddBatch(cups_array_t *a, void **elements, size_t num_elements) _CUPS_PUBLIC;
 extern bool		cupsArrayAddStrings(cups_array_t *a, const char *s, char delim) _CUPS_PUBLIC;
+extern bool		cupsArrayBeginBatch(cups_array_t *a, bool unique) _CUPS_PUBLIC;
 extern void		cupsArrayClear(cups_array_t *a) _CUPS_PUBLIC;
 extern void		cupsArrayDelete(cups_array_t *a) _CUPS_PUBLIC;
 extern cups_array_t	*cupsArrayDup(cups_array_t *a) _CUPS_PUBLIC;
+extern bool		cupsArrayEndBatch(cups_array_t *a) _CUPS_PUBLIC;
 extern void		*cupsArrayFind(cups_array_t *a, void *e) _CUPS_PUBLIC;
 extern size_t		cupsArrayGetCount(cups_array_t *a) _CUPS_PUBLIC;
 extern void		*cupsArrayGetCurrent(cups_array_t *a) _CUPS_PUBLIC;
@@ -56,11 +65,17 @@ extern void		*cupsArrayGetNext(cups_array_t *a) _CUPS_PUBLIC;
 extern void		*cupsArrayGetPrev(cups_array_t *a) _CUPS_PUBLIC;
 extern void		*cupsArrayGetUserData(cups_array_t *a) _CUPS_PUBLIC;
 extern bool		cupsArrayInsert(cups_array_t *a, void *e) _CUPS_PUBLIC;
+extern void		*cupsArrayIterFirst(cups_array_t *a, cups_array_iter_t *iter) _CUPS_PUBLIC;
+extern void		*cupsArrayIterLast(cups_array_t *a, cups_array_iter_t *iter) _CUPS_PUBLIC;
+extern void		*cupsArrayIterNext(cups_array_iter_t *iter) _CUPS_PUBLIC;
+extern void		*cupsArrayIterPrev(cups_array_iter_t *iter) _CUPS_PUBLIC;
 extern cups_array_t	*cupsArrayNew(cups_array_cb_t f, void *d, cups_ahash_cb_t hf, size_t hsize, cups_acopy_cb_t cf, cups_afree_cb_t ff) _CUPS_PUBLIC;
+extern cups_array_t	*cupsArrayNewHash(cups_array_cb_t f, void *d, cups_ahash_cb_t hf, bool sorted, cups_acopy_cb_t cf, cups_afree_cb_t ff) _CUPS_PUBLIC;
 extern cups_array_t	*cupsArrayNewStrings(const char *s, char delim) _CUPS_PUBLIC;
 extern bool		cupsArrayRemove(cups_array_t *a, void *e) _CUPS_PUBLIC;
 extern void		*cupsArrayRestore(cups_array_t *a) _CUPS_PUBLIC;
 extern bool		cupsArraySave(cups_array_t *a) _CUPS_PUBLIC;
+extern cups_array_t	*cupsArraySnapshot(cups_array_t *a) _CUPS_PUBLIC;
 
 #  ifdef __cplusplus
 }
@@ -241,6 +241,12 @@ typedef struct cups_option_s		// Printer Options
   char		*value;			// Value of option
 } cups_option_t;
 
+typedef struct _cups_optset_s cups_optset_t;
+					// Option set
+
+typedef struct _ipp_preset_s ipp_preset_t;
+					// Compiled option preset
+
 typedef struct cups_dest_s		// Destination
 {
   char		*name,			// Printer or class name
@@ -383,6 +389,17 @@ extern const char	*cupsLocalizeDestValue(http_t *http, cups_dest_t *dest, cups_d
 extern char		*cupsLocalizeNotifySubject(cups_lang_t *lang, ipp_t *event) _CUPS_PUBLIC;
 extern char		*cupsLocalizeNotifyText(cups_lang_t *lang, ipp_t *event) _CUPS_PUBLIC;
 
+extern bool		cupsOptSetAdd(cups_optset_t *set, const char *name, const char *value) _CUPS_PUBLIC;
+extern void		cupsOptSetClear(cups_optset_t *set) _CUPS_PUBLIC;
+extern void		cupsOptSetDelete(cups_optset_t *set) _CUPS_PUBLIC;
+extern size_t		cupsOptSetExport(cups_optset_t *set, size_t num_options, cups_option_t **options) _CUPS_PUBLIC;
+extern size_t		cupsOptSetGetCount(cups_optset_t *set) _CUPS_PUBLIC;
+extern const char	*cupsOptSetGetName(cups_optset_t *set, size_t n) _CUPS_PUBLIC;
+extern const char	*cupsOptSetGetValue(cups_optset_t *set, const char *name) _CUPS_PUBLIC;
+extern cups_optset_t	*cupsOptSetNew(void) _CUPS_PUBLIC;
+extern bool		cupsOptSetParse(cups_optset_t *set, const char *arg, const char **end) _CUPS_PUBLIC;
+extern bool		cupsOptSetRemove(cups_optset_t *set, const char *name) _CUPS_PUBLIC;
+
 extern size_t		cupsParseOptions(const char *arg, const char **end, size_t num_options, cups_option_t **options) _CUPS_PUBLIC;
 extern http_status_t	cupsPutFd(http_t *http, const char *resource, int fd) _CUPS_PUBLIC;
 extern http_status_t	cupsPutFile(http_t *http, const char *resource, const char *filename) _CUPS_PUBLIC;
@@ -408,6 +425,10 @@ extern http_status_t	cupsStartDestDocument(http_t *http, cups_dest_t *dest, cups
 
 extern http_status_t	cupsWriteRequestData(http_t *http, const char *buffer, size_t length) _CUPS_PUBLIC;
 
+extern bool		ippPresetApply(ipp_preset_t *preset, ipp_t *ipp) _CUPS_PUBLIC;
+extern ipp_preset_t	*ippPresetCompile(ipp_op_t op, ipp_tag_t group_tag, size_t num_options, cups_option_t *options) _CUPS_PUBLIC;
+extern void		ippPresetDelete(ipp_preset_t *preset) _CUPS_PUBLIC;
+
 
 #  ifdef __cplusplus
 }
@@ -1718,6 +1718,7 @@ cups_create_media_db(
 
 
   db = cupsArrayNew((cups_array_cb_t)cups_compare_media_db, NULL, NULL, 0, (cups_acopy_cb_t)cups_copy_media_db, (cups_afree_cb_t)cups_free_media_db);
+  cupsArrayBeginBatch(db, false);
 
   if (flags == CUPS_MEDIA_FLAGS_READY)
   {
@@ -1960,6 +1961,9 @@ cups_create_media_db(
       }
     }
   }
+
+  // Sort the database...
+  cupsArrayEndBatch(db);
 }
 
 
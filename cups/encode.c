@@ -273,11 +273,24 @@ static const _ipp_option_t ipp_options[] =
 };
 
 
+//
+// Types and structures...
+//
+
+struct _ipp_preset_s			// Compiled option preset
+{
+  ipp_op_t		op;		// Operation
+  ipp_t			*ipp;		// Encoded attributes
+};
+
+
 //
 // Local functions...
 //
 
 static int	compare_ipp_options(_ipp_option_t *a, _ipp_option_t *b);
+static void	ipp_preset_const(ipp_t *ipp, bool set);
+static bool	ipp_preset_copy(ipp_t *dst, ipp_t *src);
 
 
 //
@@ -512,6 +525,9 @@ _cupsEncodeOption(
 	  ippSetCollection(ipp, &attr, i, collection);
 	  cupsEncodeOptions(collection, num_cols, cols, IPP_TAG_JOB);
 	  cupsFreeOptions(num_cols, cols);
+
+	  // Release our reference to the collection...
+	  ippDelete(collection);
 	  break;
 
       default :
@@ -713,6 +729,91 @@ _ippFindOption(const char *name)	// I - Option/attribute name
 }
 
 
+//
+// 'ippPresetApply()' - Add the attributes in a compiled preset to an IPP message.
+//
+// This function adds the attributes that @link cupsEncodeOptions@ would add
+// for the preset's options.  The operation of the IPP message must match the
+// operation passed to @link ippPresetCompile@.
+//
+// String values are shared with the preset, so the preset must not be deleted
+// before the IPP message.  A preset is not changed when it is applied, so
+// multiple threads can apply the same preset at the same time.
+//
+
+bool					// O - `true` on success, `false` on error
+ippPresetApply(ipp_preset_t *preset,	// I - Preset
+               ipp_t        *ipp)	// I - IPP request/response
+{
+  // Range check input...
+  if (!preset || !ipp || ippGetOperation(ipp) != preset->op)
+    return (false);
+
+  // Copy the attributes...
+  return (ipp_preset_copy(ipp, preset->ipp));
+}
+
+
+//
+// 'ippPresetCompile()' - Compile options into a preset for an operation and group.
+//
+// This function encodes options once as @link cupsEncodeOptions@ would for an
+// IPP message with the given operation and group.  Use @link ippPresetApply@
+// to add the encoded attributes to IPP messages, which is much faster than
+// encoding the options for each message when many messages use the same
+// options.
+//
+
+ipp_preset_t *				// O - Preset or `NULL` on error
+ippPresetCompile(
+    ipp_op_t      op,			// I - Operation
+    ipp_tag_t     group_tag,		// I - Group to encode
+    size_t        num_options,		// I - Number of options
+    cups_option_t *options)		// I - Options
+{
+  ipp_preset_t	*preset;		// Preset
+
+
+  // Allocate memory for the preset...
+  if ((preset = (ipp_preset_t *)calloc(1, sizeof(ipp_preset_t))) == NULL)
+    return (NULL);
+
+  if ((preset->ipp = ippNew()) == NULL)
+  {
+    free(preset);
+    return (NULL);
+  }
+
+  preset->op = op;
+  ippSetOperation(preset->ipp, op);
+
+  // Encode the options and mark the strings as constant so that they are
+  // shared when the preset is applied...
+  cupsEncodeOptions(preset->ipp, num_options, options, group_tag);
+  ipp_preset_const(preset->ipp, true);
+
+  return (preset);
+}
+
+
+//
+// 'ippPresetDelete()' - Free the memory used by a compiled preset.
+//
+
+void
+ippPresetDelete(ipp_preset_t *preset)	// I - Preset
+{
+  // Range check input...
+  if (!preset)
+    return;
+
+  // Restore the strings so that ippDelete frees them...
+  ipp_preset_const(preset->ipp, false);
+  ippDelete(preset->ipp);
+  free(preset);
+}
+
+
 //
 // 'compare_ipp_options()' - Compare two IPP options.
 //
@@ -723,3 +824,106 @@ compare_ipp_options(_ipp_option_t *a,	// I - First option
 {
   return (strcmp(a->name, b->name));
 }
+
+
+//
+// 'ipp_preset_const()' - Set or clear the constant flag on preset strings.
+//
+
+static void
+ipp_preset_const(ipp_t *ipp,		// I - IPP message
+                 bool  set)		// I - `true` to set, `false` to clear
+{
+  ipp_attribute_t	*attr;		// Current attribute
+  size_t		i;		// Looping var
+
+
+  for (attr = ipp->attrs; attr; attr = attr->next)
+  {
+    switch (attr->value_tag & IPP_TAG_CUPS_MASK)
+    {
+      case IPP_TAG_TEXT :
+      case IPP_TAG_NAME :
+      case IPP_TAG_RESERVED_STRING :
+      case IPP_TAG_KEYWORD :
+      case IPP_TAG_URI :
+      case IPP_TAG_URISCHEME :
+      case IPP_TAG_CHARSET :
+      case IPP_TAG_LANGUAGE :
+      case IPP_TAG_MIMETYPE :
+          if (set)
+            attr->value_tag = (ipp_tag_t)(attr->value_tag | IPP_TAG_CUPS_CONST);
+          else
+            attr->value_tag = (ipp_tag_t)(attr->value_tag & IPP_TAG_CUPS_MASK);
+          break;
+
+      case IPP_TAG_BEGIN_COLLECTION :
+          for (i = 0; i < attr->num_values; i ++)
+          {
+            if (attr->values[i].collection)
+              ipp_preset_const(attr->values[i].collection, set);
+          }
+          break;
+
+      default :
+          break;
+    }
+  }
+}
+
+
+//
+// 'ipp_preset_copy()' - Copy preset attributes to an IPP message.
+//
+// Collections are copied rather than shared since sharing changes their use
+// counts.
+//
+
+static bool				// O - `true` on success, `false` on error
+ipp_preset_copy(ipp_t *dst,		// I - Destination IPP message
+                ipp_t *src)		// I - Preset attributes
+{
+  ipp_attribute_t	*srcattr,	// Source attribute
+			*dstattr;	// Destination attribute
+  size_t		i;		// Looping var
+  ipp_t			*col;		// Copy of collection
+  bool			ret;		// Return value
+
+
+  for (srcattr = src->attrs; srcattr; srcattr = srcattr->next)
+  {
+    if ((srcattr->value_tag & IPP_TAG_CUPS_MASK) != IPP_TAG_BEGIN_COLLECTION)
+    {
+      // Quick copy, which shares the constant strings...
+      if (!ippCopyAttribute(dst, srcattr, true))
+        return (false);
+
+      continue;
+    }
+
+    for (i = 0, dstattr = NULL; i < srcattr->num_values; i ++)
+    {
+      if (!srcattr->values[i].collection)
+        continue;
+
+      if ((col = ippNew()) == NULL || !ipp_preset_copy(col, srcattr->values[i].collection))
+      {
+        ippDelete(col);
+        return (false);
+      }
+
+      // Add the copy, then release our reference to it...
+      if (dstattr)
+        ret = ippSetCollection(dst, &dstattr, ippGetCount(dstattr), col);
+      else
+        ret = (dstattr = ippAddCollection(dst, srcattr->group_tag, srcattr->name, col)) != NULL;
+
+      ippDelete(col);
+
+      if (!ret)
+        return (false);
+    }
+  }
+
+  return (true);
+}
@@ -18,32 +18,109 @@
 #include "debug-internal.h"
 #include <sys/stat.h>
 #include <sys/types.h>
+#ifndef _WIN32
+#  include <sys/mman.h>
+#endif // !_WIN32
 #include <zlib.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#  define _CUPS_FILE_SIMD 1		// Use SSE2 line scanning
+#endif // __GNUC__ && (__x86_64__ || __i386__)
 #ifndef va_copy
 #  define va_copy(__list1, __list2) ((void)(__list1 = __list2))
 #endif
 
 
+//
+// Local constants...
+//
+
+#define _CUPS_FILE_BUFSIZE	4096	// Default buffer size
+#define _CUPS_FILE_MAX_BUFSIZE	(16 * 1024 * 1024)
+					// Maximum buffer size
+#define _CUPS_FILE_BLOCK	(128 * 1024)
+					// Input bytes per compression block
+#define _CUPS_FILE_DICT		(32 * 1024)
+					// Size of deflate dictionary
+#define _CUPS_FILE_MAX_THREADS	64	// Maximum number of compression threads
+#define _CUPS_FILE_SPAN		(1024 * 1024)
+					// Default bytes between checkpoints
+
+
 //
 // Internal structures...
 //
 
+typedef enum _cups_file_bstate_e	// Block states
+{
+  _CUPS_FILE_BLOCK_EMPTY,		// Empty or being filled
+  _CUPS_FILE_BLOCK_QUEUED,		// Waiting for a compression thread
+  _CUPS_FILE_BLOCK_ENCODING,		// Being compressed
+  _CUPS_FILE_BLOCK_DONE			// Compressed and ready to write
+} _cups_file_bstate_t;
+
+typedef struct _cups_file_block_s	// Block of data for threaded compression
+{
+  _cups_file_bstate_t	state;		// Current state
+  Bytef			*input,		// Dictionary and input data
+			*output;	// Compressed data
+  size_t		dictsize,	// Bytes of dictionary data
+			inused,		// Bytes of input data
+			outsize,	// Size of compressed data buffer
+			outused;	// Bytes of compressed data
+  bool			last,		// Last block in stream?
+			error;		// Did compression fail?
+  uLong			crc;		// CRC of input data
+} _cups_file_block_t;
+
+typedef struct _cups_file_point_s	// Checkpoint for seeking in gzip'd files
+{
+  off_t			out,		// Uncompressed position
+			in;		// Compressed position
+  int			bits;		// Unused bits in previous compressed byte
+  uLong			crc;		// CRC of uncompressed data before "out"
+  uInt			winsize;	// Size of inflate window
+  Bytef			*window;	// Inflate window (data before "out")
+} _cups_file_point_t;
+
 struct _cups_file_s			// CUPS file structure...
 {
   int		fd;			// File descriptor
-  bool		compressed;		// Compression used?
+  bool		compressed,		// Compression used?
+		gzipped;		// gzip'd file, even after the end of the stream?
   char		mode,			// Mode ('r' or 'w')
-		buf[4096],		// Buffer
+		*buf,			// Buffer
 		*ptr,			// Pointer into buffer
 		*end;			// End of buffer data
   bool		is_stdio,		// stdin/out/err?
 		eof;			// End of file?
   off_t		pos,			// Position in file
 		bufpos;			// File position for start of buffer
+  char		*map;			// Memory-mapped file data, if any
+  size_t	mapsize;		// Size of memory-mapped data
 
+  size_t	bufsize;		// Size of buffers
   z_stream	stream;			// (De)compression stream
-  Bytef		cbuf[4096];		// (De)compression buffer
+  Bytef		*cbuf;			// (De)compression buffer
   uLong		crc;			// (De)compression CRC
+  int		level;			// Compression level
+
+  size_t	num_threads;		// Number of compression threads
+  cups_thread_t	*threads;		// Compression threads
+  cups_mutex_t	block_mutex;		// Mutex for blocks
+  cups_cond_t	block_cond;		// Condition for block state changes
+  bool		block_stop;		// Stop compression threads?
+  size_t	num_blocks,		// Number of blocks
+		fill_block,		// Block being filled
+		write_block;		// Next block to write
+  _cups_file_block_t *blocks;		// Blocks of data
+
+  off_t		index_span;		// Uncompressed bytes between checkpoints or 0 for none
+  size_t	num_points,		// Number of checkpoints
+		alloc_points;		// Allocated checkpoints
+  _cups_file_point_t *points;		// Checkpoints for seeking
+  char		*index_file;		// Checkpoint index file, if any
+  bool		index_changed;		// Have checkpoints been added?
 
   char		*printf_buffer;		// cupsFilePrintf buffer
   size_t	printf_size;		// Size of cupsFilePrintf buffer
@@ -54,8 +131,24 @@ struct _cups_file_s			// CUPS file structure...
 // Local functions...
 //
 
+static bool	cups_block_add(cups_file_t *fp, const char *buf, size_t bytes);
+static bool	cups_block_finish(cups_file_t *fp);
+static void	cups_block_stop(cups_file_t *fp);
+static void	*cups_block_thread(cups_file_t *fp);
+static bool	cups_block_write(cups_file_t *fp, _cups_file_block_t *until);
 static bool	cups_compress(cups_file_t *fp, const char *buf, size_t bytes);
+static char	*cups_eol(const char *ptr, size_t bytes);
+#ifdef _CUPS_FILE_SIMD
+static const char *cups_eol_sse2(const char *ptr, const char *end);
+#endif // _CUPS_FILE_SIMD
 static ssize_t	cups_fill(cups_file_t *fp);
+static void	cups_index_add(cups_file_t *fp, off_t out);
+static bool	cups_index_load(cups_file_t *fp);
+static bool	cups_index_save(cups_file_t *fp);
+static bool	cups_index_seek(cups_file_t *fp, off_t pos);
+#ifndef _WIN32
+static void	cups_map(cups_file_t *fp);
+#endif // !_WIN32
 static int	cups_open(const char *filename, int oflag, int mode);
 static ssize_t	cups_read(cups_file_t *fp, char *buf, size_t bytes);
 static bool	cups_write(cups_file_t *fp, const char *buf, size_t bytes);
@@ -99,20 +192,28 @@ cupsFileClose(cups_file_t *fp)		// I - CUPS file
 
       fp->stream.avail_in = 0;
 
-      for (done = false;;)
+      if (fp->num_threads > 1)
       {
-        if (fp->stream.next_out > fp->cbuf)
-	{
-	  status = cups_write(fp, (char *)fp->cbuf, (size_t)(fp->stream.next_out - fp->cbuf));
+        // Compress and write the last block...
+        status = cups_block_finish(fp);
+      }
+      else
+      {
+        for (done = false;;)
+        {
+	  if (fp->stream.next_out > fp->cbuf)
+	  {
+	    status = cups_write(fp, (char *)fp->cbuf, (size_t)(fp->stream.next_out - fp->cbuf));
 
-	  fp->stream.next_out  = fp->cbuf;
-	  fp->stream.avail_out = sizeof(fp->cbuf);
-	}
+	    fp->stream.next_out  = fp->cbuf;
+	    fp->stream.avail_out = (uInt)fp->bufsize;
+	  }
 
-        if (done || !status)
-	  break;
+	  if (done || !status)
+	    break;
 
-        done = deflate(&fp->stream, Z_FINISH) == Z_STREAM_END && fp->stream.next_out == fp->cbuf;
+	  done = deflate(&fp->stream, Z_FINISH) == Z_STREAM_END && fp->stream.next_out == fp->cbuf;
+        }
       }
 
       // Write the CRC and length...
@@ -132,6 +233,33 @@ cupsFileClose(cups_file_t *fp)		// I - CUPS file
     }
   }
 
+  // Stop any compression threads...
+  if (fp->num_threads > 1)
+    cups_block_stop(fp);
+
+  // Save and free any checkpoints...
+  if (fp->index_file)
+  {
+    if (fp->index_changed)
+      cups_index_save(fp);
+
+    free(fp->index_file);
+    fp->index_file = NULL;
+  }
+
+  if (fp->points)
+  {
+    size_t	i;			// Looping var
+
+    for (i = 0; i < fp->num_points; i ++)
+      free(fp->points[i].window);
+
+    free(fp->points);
+    fp->points       = NULL;
+    fp->num_points   = 0;
+    fp->alloc_points = 0;
+  }
+
   // If this is one of the cupsFileStdin/out/err files, return now and don't
   // actually free memory or close (these last the life of the process...)
   if (fp->is_stdio)
@@ -141,6 +269,13 @@ cupsFileClose(cups_file_t *fp)		// I - CUPS file
   fd   = fp->fd;
   mode = fp->mode;
 
+#ifndef _WIN32
+  if (fp->map)
+    munmap(fp->map, fp->mapsize);
+#endif // !_WIN32
+
+  free(fp->buf);
+  free(fp->cbuf);
   free(fp->printf_buffer);
   free(fp);
 
@@ -431,9 +566,10 @@ cupsFileGetLine(cups_file_t *fp,	// I - File to read from
                 char        *buf,	// I - Buffer
                 size_t      buflen)	// I - Size of buffer
 {
-  int		ch;			// Character from file
   char		*ptr,			// Current position in line buffer
-		*end;			// End of line buffer
+		*end,			// End of line buffer
+		*eol;			// End of line in file buffer
+  size_t	bytes;			// Bytes to copy
 
 
   // Range check input...
@@ -449,10 +585,22 @@ cupsFileGetLine(cups_file_t *fp,	// I - File to read from
         break;
     }
 
-    *ptr++ = ch = *(fp->ptr)++;
-    fp->pos ++;
+    // Copy everything up to and including the next CR or LF...
+    if ((bytes = (size_t)(fp->end - fp->ptr)) > (size_t)(end - ptr))
+      bytes = (size_t)(end - ptr);
 
-    if (ch == '\r')
+    if ((eol = cups_eol(fp->ptr, bytes)) != NULL)
+      bytes = (size_t)(eol - fp->ptr) + 1;
+
+    memcpy(ptr, fp->ptr, bytes);
+    ptr     += bytes;
+    fp->ptr += bytes;
+    fp->pos += (off_t)bytes;
+
+    if (!eol)
+      continue;
+
+    if (*eol == '\r')
     {
       // Check for CR LF...
       if (fp->ptr >= fp->end)
@@ -466,14 +614,9 @@ cupsFileGetLine(cups_file_t *fp,	// I - File to read from
         *ptr++ = *(fp->ptr)++;
 	fp->pos ++;
       }
-
-      break;
-    }
-    else if (ch == '\n')
-    {
-      // Line feed ends a line...
-      break;
     }
+
+    break;
   }
 
   *ptr = '\0';
@@ -493,7 +636,9 @@ cupsFileGets(cups_file_t *fp,		// I - CUPS file
 {
   int		ch;			// Character from file
   char		*ptr,			// Current position in line buffer
-		*end;			// End of line buffer
+		*end,			// End of line buffer
+		*eol;			// End of line in file buffer
+  size_t	bytes;			// Bytes to copy
 
 
   // Range check input...
@@ -514,6 +659,22 @@ cupsFileGets(cups_file_t *fp,		// I - CUPS file
       }
     }
 
+    // Copy everything up to the next CR or LF...
+    if ((bytes = (size_t)(fp->end - fp->ptr)) > (size_t)(end - ptr))
+      bytes = (size_t)(end - ptr);
+
+    if ((eol = cups_eol(fp->ptr, bytes)) != NULL)
+      bytes = (size_t)(eol - fp->ptr);
+
+    memcpy(ptr, fp->ptr, bytes);
+    ptr     += bytes;
+    fp->ptr += bytes;
+    fp->pos += (off_t)bytes;
+
+    if (!eol)
+      continue;
+
+    // Skip the CR, LF, or CR LF that ends the line...
     ch = *(fp->ptr)++;
     fp->pos ++;
 
@@ -531,18 +692,9 @@ cupsFileGets(cups_file_t *fp,		// I - CUPS file
         fp->ptr ++;
 	fp->pos ++;
       }
-
-      break;
-    }
-    else if (ch == '\n')
-    {
-      // Line feed ends a line...
-      break;
-    }
-    else
-    {
-      *ptr++ = (char)ch;
     }
+
+    break;
   }
 
   *ptr = '\0';
@@ -608,6 +760,10 @@ cupsFileNumber(cups_file_t *fp)		// I - CUPS file
 // existing file, "a" to append to an existing file or create a new file,
 // or "s" to open a socket connection.
 //
+// When opening for reading ("r"), an optional 'm' suffix ("rm") memory-maps
+// regular uncompressed files so that reads, seeks, and line scanning work
+// directly on the file data.  Other files are read normally.
+//
 // When opening for writing ("w"), an optional number from `1` to `9` can be
 // supplied which enables Flate compression of the file.  Compression is
 // not supported for the "a" (append) mode.
@@ -724,6 +880,10 @@ cupsFileOpen(const char *filename,	// I - Name of file
 // The "mode" argument can be "r" to read, "w" to write, "a" to append,
 // or "s" to treat the file descriptor as a bidirectional socket connection.
 //
+// When opening for reading ("r"), an optional 'm' suffix ("rm") memory-maps
+// regular uncompressed files that are positioned at the beginning.  Other
+// files are read normally.
+//
 // When opening for writing ("w"), an optional number from `1` to `9` can be
 // supplied which enables Flate compression of the file.  Compression is
 // not supported for the "a" (append) mode.
@@ -744,6 +904,15 @@ cupsFileOpenFd(int        fd,		// I - File descriptor
   if ((fp = calloc(1, sizeof(cups_file_t))) == NULL)
     return (NULL);
 
+  fp->bufsize = _CUPS_FILE_BUFSIZE;
+
+  if ((fp->buf = malloc(fp->bufsize)) == NULL || (fp->cbuf = malloc(fp->bufsize)) == NULL)
+  {
+    free(fp->buf);
+    free(fp);
+    return (NULL);
+  }
+
   // Open the file...
   fp->fd = fd;
 
@@ -756,7 +925,7 @@ cupsFileOpenFd(int        fd,		// I - File descriptor
 
 	fp->mode = 'w';
 	fp->ptr  = fp->buf;
-	fp->end  = fp->buf + sizeof(fp->buf);
+	fp->end  = fp->buf + fp->bufsize;
 
 	if (mode[1] >= '1' && mode[1] <= '9')
 	{
@@ -782,19 +951,27 @@ cupsFileOpenFd(int        fd,		// I - File descriptor
           // Initialize the compressor...
           if (deflateInit2(&(fp->stream), mode[1] - '0', Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) < Z_OK)
           {
+            free(fp->buf);
+            free(fp->cbuf);
             free(fp);
 	    return (NULL);
           }
 
 	  fp->stream.next_out  = fp->cbuf;
-	  fp->stream.avail_out = sizeof(fp->cbuf);
+	  fp->stream.avail_out = (uInt)fp->bufsize;
 	  fp->compressed       = true;
 	  fp->crc              = crc32(0L, Z_NULL, 0);
+	  fp->level            = mode[1] - '0';
 	}
         break;
 
     case 'r' :
 	fp->mode = 'r';
+
+#ifndef _WIN32
+        if (mode[1] == 'm')
+          cups_map(fp);
+#endif // !_WIN32
 	break;
 
     case 's' :
@@ -802,6 +979,9 @@ cupsFileOpenFd(int        fd,		// I - File descriptor
 	break;
 
     default : // Remove bogus compiler warning...
+        free(fp->buf);
+        free(fp->cbuf);
+        free(fp);
         return (NULL);
   }
 
@@ -923,7 +1103,7 @@ cupsFilePrintf(cups_file_t *fp,		// I - CUPS file
 
   fp->pos += bytes;
 
-  if ((size_t)bytes > sizeof(fp->buf))
+  if ((size_t)bytes > fp->bufsize)
   {
     if (fp->compressed)
       return (cups_compress(fp, fp->printf_buffer, (size_t)bytes));
@@ -1068,7 +1248,7 @@ cupsFilePuts(cups_file_t *fp,		// I - CUPS file
 
   fp->pos += bytes;
 
-  if (bytes > sizeof(fp->buf))
+  if (bytes > fp->bufsize)
   {
     if (fp->compressed)
       return (cups_compress(fp, s, bytes) > 0);
@@ -1157,7 +1337,16 @@ cupsFileRewind(cups_file_t *fp)		// I - CUPS file
     return (-1);
 
   // Handle special cases...
-  if (fp->bufpos == 0)
+  if (fp->map)
+  {
+    // Memory-mapped files just reset the pointer...
+    fp->pos = 0;
+    fp->ptr = fp->map;
+    fp->eof = false;
+
+    return (0);
+  }
+  else if (fp->bufpos == 0)
   {
     // No seeking necessary...
     fp->pos = 0;
@@ -1210,6 +1399,16 @@ cupsFileSeek(cups_file_t *fp,		// I - CUPS file
   if (pos == 0)
     return (cupsFileRewind(fp));
 
+  if (fp->map)
+  {
+    // Memory-mapped files just move the pointer...
+    fp->pos = pos;
+    fp->ptr = fp->map + ((size_t)pos < fp->mapsize ? (size_t)pos : fp->mapsize);
+    fp->eof = false;
+
+    return (pos);
+  }
+
   if (fp->ptr)
   {
     bytes = (ssize_t)(fp->end - fp->buf);
@@ -1235,66 +1434,248 @@ cupsFileSeek(cups_file_t *fp,		// I - CUPS file
   // Seek forwards or backwards...
   fp->eof = false;
 
-  if (pos < fp->bufpos)
+  if (fp->gzipped)
   {
-    // Need to seek backwards...
-    if (fp->compressed)
+    // Resume decompression from the nearest checkpoint or from the start of
+    // the file as needed...
+    if (!cups_index_seek(fp, pos) && pos < fp->bufpos)
     {
-      inflateEnd(&fp->stream);
+      if (fp->compressed)
+      {
+        inflateEnd(&fp->stream);
+        fp->compressed = false;
+      }
 
       lseek(fp->fd, 0, SEEK_SET);
       fp->bufpos = 0;
       fp->pos    = 0;
       fp->ptr    = NULL;
       fp->end    = NULL;
-
-      while ((bytes = cups_fill(fp)) > 0)
-      {
-        if (pos >= fp->bufpos && pos < (fp->bufpos + bytes))
-	  break;
-      }
-
-      if (bytes <= 0)
-        return (-1);
-
-      fp->ptr = fp->buf + pos - fp->bufpos;
-      fp->pos = pos;
     }
-    else
+
+    // Decompress data until we get to the requested position...
+    while ((bytes = cups_fill(fp)) > 0)
     {
-      fp->bufpos = lseek(fp->fd, pos, SEEK_SET);
-      fp->pos    = fp->bufpos;
-      fp->ptr    = NULL;
-      fp->end    = NULL;
+      if (pos >= fp->bufpos && pos < (fp->bufpos + bytes))
+	break;
     }
+
+    if (bytes <= 0)
+      return (-1);
+
+    fp->ptr = fp->buf + pos - fp->bufpos;
+    fp->pos = pos;
   }
   else
   {
-    // Need to seek forwards...
+    fp->bufpos = lseek(fp->fd, pos, SEEK_SET);
+    fp->pos    = fp->bufpos;
+    fp->ptr    = NULL;
+    fp->end    = NULL;
+  }
+
+  return (fp->pos);
+}
+
+
+//
+// 'cupsFileSetBufferSize()' - Set the size of the file buffers.
+//
+// By default files use 4k buffers.  Larger buffers reduce the number of read
+// and write calls and speed up line scanning for large files, while smaller
+// buffers use less memory when many files are open.  The "bufsize" argument
+// must be between 1k and 16M.
+//
+// This function must be called before any data is read from the file, or for
+// files opened for writing when no data is buffered, for example right after
+// the file is opened with @link cupsFileOpen@ or after @link cupsFileFlush@ for
+// uncompressed files.  It has no effect on memory-mapped files.
+//
+
+bool					// O - `true` on success, `false` on error
+cupsFileSetBufferSize(
+    cups_file_t *fp,			// I - CUPS file
+    size_t      bufsize)		// I - Buffer size in bytes
+{
+  char		*buf;			// New buffer
+  Bytef		*cbuf;			// New (de)compression buffer
+
+
+  // Range check input...
+  if (!fp || bufsize < 1024 || bufsize > _CUPS_FILE_MAX_BUFSIZE)
+    return (false);
+
+  if (fp->map || bufsize == fp->bufsize)
+    return (true);
+
+  if (fp->mode == 'w')
+  {
+    // Writing, make sure nothing is buffered...
+    if (fp->ptr != fp->buf || (fp->compressed && fp->stream.next_out != fp->cbuf))
+      return (false);
+  }
+  else if (fp->ptr)
+  {
+    // Reading, make sure nothing has been read...
+    return (false);
+  }
+
+  // Reallocate the buffers...
+  if ((buf = realloc(fp->buf, bufsize)) == NULL)
+    return (false);
+
+  fp->buf = buf;
+
+  if ((cbuf = realloc(fp->cbuf, bufsize)) == NULL)
+    return (false);
+
+  fp->cbuf    = cbuf;
+  fp->bufsize = bufsize;
+
+  if (fp->mode == 'w')
+  {
+    fp->ptr = fp->buf;
+    fp->end = fp->buf + fp->bufsize;
+
     if (fp->compressed)
     {
-      while ((bytes = cups_fill(fp)) > 0)
-      {
-        if (pos >= fp->bufpos && pos < (fp->bufpos + bytes))
-	  break;
-      }
+      fp->stream.next_out  = fp->cbuf;
+      fp->stream.avail_out = (uInt)fp->bufsize;
+    }
+  }
+
+  return (true);
+}
 
-      if (bytes <= 0)
-        return (-1);
 
-      fp->ptr = fp->buf + pos - fp->bufpos;
-      fp->pos = pos;
-    }
-    else
+//
+// 'cupsFileSetIndex()' - Enable checkpoints for seeking in a gzip'd file.
+//
+// By default, seeking backwards in a gzip'd file decompresses the file again
+// from the beginning.  This function enables checkpoints that are recorded
+// every "span" bytes of uncompressed data as the file is read, allowing
+// @link cupsFileSeek@ to resume decompression from the nearest checkpoint.
+// Each checkpoint uses up to 32k of memory.  A "span" of `0` uses a default
+// of 1MB.
+//
+// If "indexfile" is not `NULL`, checkpoints are loaded from that file when it
+// was saved for the current file, and any new checkpoints are saved to it when
+// the file is closed.
+//
+// This function only applies to seekable files opened for reading.
+//
+
+bool					// O - `true` on success, `false` on error
+cupsFileSetIndex(
+    cups_file_t *fp,			// I - CUPS file
+    size_t      span,			// I - Uncompressed bytes between checkpoints or `0` for the default
+    const char  *indexfile)		// I - Checkpoint index file or `NULL` for none
+{
+  // Range check input...
+  if (!fp || fp->mode != 'r' || lseek(fp->fd, 0, SEEK_CUR) < 0)
+    return (false);
+
+  fp->index_span = span > 0 ? (off_t)span : _CUPS_FILE_SPAN;
+
+  free(fp->index_file);
+  fp->index_file = indexfile ? strdup(indexfile) : NULL;
+
+  // Load any saved checkpoints...
+  if (fp->index_file && fp->num_points == 0)
+    cups_index_load(fp);
+
+  return (true);
+}
+
+
+//
+// 'cupsFileSetThreads()' - Set the number of threads used to compress a file.
+//
+// By default data written to a compressed file is compressed on the calling
+// thread.  When "num_threads" is greater than 1, the data is split into 128k
+// blocks that are compressed by a pool of threads and written in order, which
+// can speed up the output of large files on multi-core systems.  Each block
+// uses the previous 32k of data as its dictionary, so the result is a single
+// standard gzip stream that can be read with @link cupsFileOpen@ or `gunzip`.
+//
+// Compressed blocks are written from the calling thread during later writes
+// and when the file is closed, so write errors may be reported after the fact.
+//
+// This function only applies to compressed files opened for writing and must
+// be called before any data is compressed, for example right after the file
+// is opened with @link cupsFileOpen@.
+//
+
+bool					// O - `true` on success, `false` on error
+cupsFileSetThreads(
+    cups_file_t *fp,			// I - CUPS file
+    size_t      num_threads)		// I - Number of threads (`0` or `1` for none)
+{
+  size_t	i;			// Looping var
+
+
+  // Range check input...
+  if (!fp || fp->mode != 'w')
+    return (false);
+
+  if (num_threads > _CUPS_FILE_MAX_THREADS)
+    num_threads = _CUPS_FILE_MAX_THREADS;
+  else if (num_threads < 1)
+    num_threads = 1;
+
+  if (num_threads == fp->num_threads || (num_threads == 1 && fp->num_threads == 0) || !fp->compressed)
+    return (true);
+
+  if (fp->num_threads > 1 || fp->stream.total_in > 0)
+    return (false);			// Already compressing data
+
+  // Allocate two blocks per thread so that data can be collected while other
+  // blocks are compressed...
+  if ((fp->blocks = calloc(2 * num_threads, sizeof(_cups_file_block_t))) == NULL || (fp->threads = calloc(num_threads, sizeof(cups_thread_t))) == NULL)
+  {
+    free(fp->blocks);
+    fp->blocks = NULL;
+    return (false);
+  }
+
+  cupsMutexInit(&fp->block_mutex);
+  cupsCondInit(&fp->block_cond);
+
+  fp->num_blocks  = 2 * num_threads;
+  fp->fill_block  = 0;
+  fp->write_block = 0;
+  fp->block_stop  = false;
+
+  for (i = 0; i < fp->num_blocks; i ++)
+  {
+    // The output buffer needs room for the deflate bound and the trailing
+    // sync marker...
+    fp->blocks[i].outsize = compressBound(_CUPS_FILE_BLOCK) + 64;
+
+    if ((fp->blocks[i].input = malloc(_CUPS_FILE_DICT + _CUPS_FILE_BLOCK)) == NULL || (fp->blocks[i].output = malloc(fp->blocks[i].outsize)) == NULL)
     {
-      fp->bufpos = lseek(fp->fd, pos, SEEK_SET);
-      fp->pos    = fp->bufpos;
-      fp->ptr    = NULL;
-      fp->end    = NULL;
+      cups_block_stop(fp);
+      return (false);
     }
   }
 
-  return (fp->pos);
+  for (i = 0; i < num_threads; i ++)
+  {
+    if ((fp->threads[i] = cupsThreadCreate((cups_thread_func_t)cups_block_thread, fp)) == CUPS_THREAD_INVALID)
+      break;
+  }
+
+  fp->num_threads = i;
+
+  if (i < 2)
+  {
+    // Unable to create enough threads, go back to compressing on the calling
+    // thread...
+    cups_block_stop(fp);
+    return (false);
+  }
+
+  return (true);
 }
 
 
@@ -1436,7 +1817,7 @@ cupsFileWrite(cups_file_t *fp,		// I - CUPS file
 
   fp->pos += (off_t)bytes;
 
-  if (bytes > sizeof(fp->buf))
+  if (bytes > fp->bufsize)
   {
     if (fp->compressed)
       return (cups_compress(fp, buf, bytes));
@@ -1453,38 +1834,57 @@ cupsFileWrite(cups_file_t *fp,		// I - CUPS file
 
 
 //
-// 'cups_compress()' - Compress a buffer of data.
+// 'cups_block_add()' - Add data to the current compression block.
+//
+// Full blocks are queued for compression and any finished blocks are written.
 //
 
 static bool				// O - `true` on success, `false` on error
-cups_compress(cups_file_t *fp,		// I - CUPS file
-              const char  *buf,		// I - Buffer
-	      size_t      bytes)	// I - Number bytes
+cups_block_add(cups_file_t *fp,		// I - CUPS file
+               const char  *buf,	// I - Buffer
+	       size_t      bytes)	// I - Number of bytes
 {
-  int	status;				// Deflate status
+  _cups_file_block_t	*block,		// Current block
+			*next;		// Next block
+  size_t		count;		// Bytes to copy
 
 
-  // Update the CRC...
-  fp->crc = crc32(fp->crc, (const Bytef *)buf, (uInt)bytes);
+  while (bytes > 0)
+  {
+    // Copy as much as will fit in the current block...
+    block = fp->blocks + fp->fill_block;
 
-  // Deflate the bytes...
-  fp->stream.next_in  = (Bytef *)buf;
-  fp->stream.avail_in = (uInt)bytes;
+    if ((count = _CUPS_FILE_BLOCK - block->inused) > bytes)
+      count = bytes;
 
-  while (fp->stream.avail_in > 0)
-  {
-    // Flush the current buffer...
-    if (fp->stream.avail_out < (uInt)(sizeof(fp->cbuf) / 8))
-    {
-      if (!cups_write(fp, (char *)fp->cbuf, (size_t)(fp->stream.next_out - fp->cbuf)))
-        return (false);
+    memcpy(block->input + _CUPS_FILE_DICT + block->inused, buf, count);
+    block->inused += count;
+    buf           += count;
+    bytes         -= count;
 
-      fp->stream.next_out  = fp->cbuf;
-      fp->stream.avail_out = sizeof(fp->cbuf);
-    }
+    if (block->inused < _CUPS_FILE_BLOCK)
+      break;
 
-    if ((status = deflate(&(fp->stream), Z_NO_FLUSH)) < Z_OK && status != Z_BUF_ERROR)
+    // Queue the full block for compression...
+    cupsMutexLock(&fp->block_mutex);
+    block->state = _CUPS_FILE_BLOCK_QUEUED;
+    cupsCondBroadcast(&fp->block_cond);
+    cupsMutexUnlock(&fp->block_mutex);
+
+    fp->fill_block = (fp->fill_block + 1) % fp->num_blocks;
+    next           = fp->blocks + fp->fill_block;
+
+    // Write finished blocks, waiting for the next block to become available...
+    if (!cups_block_write(fp, next))
       return (false);
+
+    // Prime the next block with the end of the queued block, which is not
+    // modified until it is written...
+    next->dictsize = _CUPS_FILE_DICT;
+    next->inused   = 0;
+    next->last     = false;
+
+    memcpy(next->input, block->input + _CUPS_FILE_BLOCK, _CUPS_FILE_DICT);
   }
 
   return (true);
@@ -1492,31 +1892,333 @@ cups_compress(cups_file_t *fp,		// I - CUPS file
 
 
 //
-// 'cups_fill()' - Fill the input buffer.
+// 'cups_block_finish()' - Compress and write the last block.
 //
 
-static ssize_t				// O - Number of bytes or -1
-cups_fill(cups_file_t *fp)		// I - CUPS file
+static bool				// O - `true` on success, `false` on error
+cups_block_finish(cups_file_t *fp)	// I - CUPS file
 {
-  ssize_t		bytes;		// Number of bytes read
-  int			status;		// Decompression status
-  const unsigned char	*ptr,		// Pointer into buffer
-			*end;		// End of buffer
+  _cups_file_block_t	*block = fp->blocks + fp->fill_block;
+					// Current block
 
 
-  if (fp->ptr && fp->end)
-    fp->bufpos += fp->end - fp->buf;
+  // Queue the (possibly empty) last block...
+  cupsMutexLock(&fp->block_mutex);
+  block->last  = true;
+  block->state = _CUPS_FILE_BLOCK_QUEUED;
+  cupsCondBroadcast(&fp->block_cond);
+  cupsMutexUnlock(&fp->block_mutex);
 
-  while (!fp->ptr || fp->compressed)
+  // Wait for it to be written...
+  return (cups_block_write(fp, block));
+}
+
+
+//
+// 'cups_block_stop()' - Stop the compression threads and free the blocks.
+//
+
+static void
+cups_block_stop(cups_file_t *fp)	// I - CUPS file
+{
+  size_t	i;			// Looping var
+
+
+  if (fp->threads)
+  {
+    cupsMutexLock(&fp->block_mutex);
+    fp->block_stop = true;
+    cupsCondBroadcast(&fp->block_cond);
+    cupsMutexUnlock(&fp->block_mutex);
+
+    for (i = 0; i < fp->num_threads; i ++)
+      cupsThreadWait(fp->threads[i]);
+
+    cupsCondDestroy(&fp->block_cond);
+    cupsMutexDestroy(&fp->block_mutex);
+  }
+
+  for (i = 0; i < fp->num_blocks; i ++)
+  {
+    free(fp->blocks[i].input);
+    free(fp->blocks[i].output);
+  }
+
+  free(fp->blocks);
+  free(fp->threads);
+
+  fp->blocks      = NULL;
+  fp->threads     = NULL;
+  fp->num_blocks  = 0;
+  fp->num_threads = 0;
+}
+
+
+//
+// 'cups_block_thread()' - Compress blocks of data.
+//
+// Each block is compressed as a raw deflate stream using the previous 32k of
+// data as a dictionary and ends with a sync flush so that the blocks can be
+// concatenated.  The last block finishes the deflate stream.
+//
+
+static void *				// O - Thread exit status
+cups_block_thread(cups_file_t *fp)	// I - CUPS file
+{
+  size_t		i;		// Looping var
+  _cups_file_block_t	*block;		// Current block
+  z_stream		stream;		// Compression stream
+  bool			ok;		// Is the compression stream usable?
+  int			status;		// Deflate status
+
+
+  memset(&stream, 0, sizeof(stream));
+  ok = deflateInit2(&stream, fp->level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) >= Z_OK;
+
+  cupsMutexLock(&fp->block_mutex);
+
+  while (!fp->block_stop)
+  {
+    // Find the oldest queued block...
+    for (i = 0, block = NULL; i < fp->num_blocks; i ++)
+    {
+      block = fp->blocks + (fp->write_block + i) % fp->num_blocks;
+
+      if (block->state == _CUPS_FILE_BLOCK_QUEUED)
+        break;
+    }
+
+    if (i >= fp->num_blocks)
+    {
+      cupsCondWait(&fp->block_cond, &fp->block_mutex, 0.0);
+      continue;
+    }
+
+    block->state = _CUPS_FILE_BLOCK_ENCODING;
+    cupsMutexUnlock(&fp->block_mutex);
+
+    // Compress the block...
+    block->crc   = crc32(0L, block->input + _CUPS_FILE_DICT, (uInt)block->inused);
+    block->error = !ok || deflateReset(&stream) < Z_OK || (block->dictsize > 0 && deflateSetDictionary(&stream, block->input + _CUPS_FILE_DICT - block->dictsize, (uInt)block->dictsize) < Z_OK);
+
+    if (!block->error)
+    {
+      stream.next_in   = block->input + _CUPS_FILE_DICT;
+      stream.avail_in  = (uInt)block->inused;
+      stream.next_out  = block->output;
+      stream.avail_out = (uInt)block->outsize;
+
+      status         = deflate(&stream, block->last ? Z_FINISH : Z_SYNC_FLUSH);
+      block->outused = block->outsize - stream.avail_out;
+      block->error   = block->last ? status != Z_STREAM_END : (status != Z_OK || stream.avail_out == 0);
+    }
+
+    cupsMutexLock(&fp->block_mutex);
+    block->state = _CUPS_FILE_BLOCK_DONE;
+    cupsCondBroadcast(&fp->block_cond);
+  }
+
+  cupsMutexUnlock(&fp->block_mutex);
+
+  if (ok)
+    deflateEnd(&stream);
+
+  return (NULL);
+}
+
+
+//
+// 'cups_block_write()' - Write compressed blocks in order.
+//
+// Finished blocks are written until one is still being compressed.  If
+// "until" is not `NULL`, this function waits for blocks to finish until that
+// block has been written.
+//
+
+static bool				// O - `true` on success, `false` on error
+cups_block_write(
+    cups_file_t        *fp,		// I - CUPS file
+    _cups_file_block_t *until)		// I - Block to wait for or `NULL`
+{
+  _cups_file_block_t	*block;		// Current block
+  bool			ret = true;	// Return value
+
+
+  cupsMutexLock(&fp->block_mutex);
+
+  for (;;)
+  {
+    block = fp->blocks + fp->write_block;
+
+    if (block->state == _CUPS_FILE_BLOCK_EMPTY)
+      break;
+
+    if (block->state != _CUPS_FILE_BLOCK_DONE)
+    {
+      if (!until || until->state == _CUPS_FILE_BLOCK_EMPTY)
+        break;
+
+      cupsCondWait(&fp->block_cond, &fp->block_mutex, 0.0);
+      continue;
+    }
+
+    cupsMutexUnlock(&fp->block_mutex);
+
+    if (block->error || !cups_write(fp, (char *)block->output, block->outused))
+      ret = false;
+    else
+      fp->crc = crc32_combine(fp->crc, block->crc, (z_off_t)block->inused);
+
+    cupsMutexLock(&fp->block_mutex);
+
+    block->state    = _CUPS_FILE_BLOCK_EMPTY;
+    fp->write_block = (fp->write_block + 1) % fp->num_blocks;
+  }
+
+  cupsMutexUnlock(&fp->block_mutex);
+
+  return (ret);
+}
+
+
+//
+// 'cups_compress()' - Compress a buffer of data.
+//
+
+static bool				// O - `true` on success, `false` on error
+cups_compress(cups_file_t *fp,		// I - CUPS file
+              const char  *buf,		// I - Buffer
+	      size_t      bytes)	// I - Number bytes
+{
+  int	status;				// Deflate status
+
+
+  // Use the compression threads, if any...
+  if (fp->num_threads > 1)
+    return (cups_block_add(fp, buf, bytes));
+
+  // Update the CRC...
+  fp->crc = crc32(fp->crc, (const Bytef *)buf, (uInt)bytes);
+
+  // Deflate the bytes...
+  fp->stream.next_in  = (Bytef *)buf;
+  fp->stream.avail_in = (uInt)bytes;
+
+  while (fp->stream.avail_in > 0)
+  {
+    // Flush the current buffer...
+    if (fp->stream.avail_out < (uInt)(fp->bufsize / 8))
+    {
+      if (!cups_write(fp, (char *)fp->cbuf, (size_t)(fp->stream.next_out - fp->cbuf)))
+        return (false);
+
+      fp->stream.next_out  = fp->cbuf;
+      fp->stream.avail_out = (uInt)fp->bufsize;
+    }
+
+    if ((status = deflate(&(fp->stream), Z_NO_FLUSH)) < Z_OK && status != Z_BUF_ERROR)
+      return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'cups_eol()' - Find the next CR or LF in a buffer.
+//
+
+static char *				// O - Pointer to CR or LF or `NULL` if none
+cups_eol(const char *ptr,		// I - Start of buffer
+         size_t     bytes)		// I - Number of bytes
+{
+  const char	*end = ptr + bytes;	// End of buffer
+
+
+#ifdef _CUPS_FILE_SIMD
+  // Scan 16 bytes at a time...
+  if (bytes >= 16 && __builtin_cpu_supports("sse2"))
+    ptr = cups_eol_sse2(ptr, end);
+#endif // _CUPS_FILE_SIMD
+
+  // Check the remaining bytes...
+  for (; ptr < end; ptr ++)
+  {
+    if (*ptr == '\n' || *ptr == '\r')
+      return ((char *)ptr);
+  }
+
+  return (NULL);
+}
+
+
+#ifdef _CUPS_FILE_SIMD
+//
+// 'cups_eol_sse2()' - Find the next CR or LF in a buffer using SSE2.
+//
+// The returned pointer is the CR or LF, or the start of the remaining bytes
+// (less than 16) that have not been checked.
+//
+
+__attribute__((target("sse2")))
+static const char *			// O - Pointer to CR, LF, or remaining bytes
+cups_eol_sse2(const char *ptr,		// I - Start of buffer
+              const char *end)		// I - End of buffer
+{
+  __m128i	cr = _mm_set1_epi8('\r'),// CR bytes
+		lf = _mm_set1_epi8('\n');// LF bytes
+  int		mask;			// Match mask
+
+
+  for (; (end - ptr) >= 16; ptr += 16)
+  {
+    __m128i data = _mm_loadu_si128((const __m128i *)ptr);
+					// Next 16 bytes
+
+    if ((mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(data, cr), _mm_cmpeq_epi8(data, lf)))) != 0)
+      return (ptr + __builtin_ctz((unsigned)mask));
+  }
+
+  return (ptr);
+}
+#endif // _CUPS_FILE_SIMD
+
+
+//
+// 'cups_fill()' - Fill the input buffer.
+//
+
+static ssize_t				// O - Number of bytes or -1
+cups_fill(cups_file_t *fp)		// I - CUPS file
+{
+  ssize_t		bytes;		// Number of bytes read
+  int			status;		// Decompression status
+  const unsigned char	*ptr,		// Pointer into buffer
+			*end;		// End of buffer
+
+
+  if (fp->map)
+  {
+    // Memory-mapped files have no more data past the end of the mapping...
+    fp->eof = true;
+
+    return (0);
+  }
+
+  if (fp->ptr && fp->end)
+    fp->bufpos += fp->end - fp->buf;
+
+  while (!fp->ptr || fp->compressed)
   {
     // Check to see if we have read any data yet; if not, see if we have a compressed file...
     if (!fp->ptr)
     {
       // Reset the file position in case we are seeking...
       fp->compressed = false;
+      fp->gzipped    = false;
 
       // Read the first bytes in the file to determine if we have a gzip'd file...
-      if ((bytes = cups_read(fp, (char *)fp->buf, sizeof(fp->buf))) < 0)
+      if ((bytes = cups_read(fp, (char *)fp->buf, fp->bufsize)) < 0)
       {
         // Can't read from file!
         fp->eof = true;
@@ -1640,6 +2342,7 @@ cups_fill(cups_file_t *fp)		// I - CUPS file
       }
 
       fp->compressed = true;
+      fp->gzipped    = true;
     }
 
     if (fp->compressed)
@@ -1651,7 +2354,7 @@ cups_fill(cups_file_t *fp)		// I - CUPS file
       // Fill the decompression buffer as needed...
       if (fp->stream.avail_in == 0)
       {
-	if ((bytes = cups_read(fp, (char *)fp->cbuf, sizeof(fp->cbuf))) <= 0)
+	if ((bytes = cups_read(fp, (char *)fp->cbuf, fp->bufsize)) <= 0)
 	{
 	  fp->eof = true;
 
@@ -1664,13 +2367,23 @@ cups_fill(cups_file_t *fp)		// I - CUPS file
 
       // Decompress data from the buffer...
       fp->stream.next_out  = (Bytef *)fp->buf;
-      fp->stream.avail_out = sizeof(fp->buf);
+      fp->stream.avail_out = (uInt)fp->bufsize;
 
-      status = inflate(&(fp->stream), Z_NO_FLUSH);
+      status = inflate(&(fp->stream), fp->index_span ? Z_BLOCK : Z_NO_FLUSH);
 
       if (fp->stream.next_out > (Bytef *)fp->buf)
         fp->crc = crc32(fp->crc, (Bytef *)fp->buf, (uInt)(fp->stream.next_out - (Bytef *)fp->buf));
 
+      if (fp->index_span && status == Z_OK && (fp->stream.data_type & 192) == 128)
+      {
+        // At the end of a deflate block, add a checkpoint as needed...
+        off_t	out = fp->bufpos + (fp->stream.next_out - (Bytef *)fp->buf);
+					// Uncompressed position
+
+        if (out >= ((fp->num_points ? fp->points[fp->num_points - 1].out : 0) + fp->index_span))
+          cups_index_add(fp, out);
+      }
+
       if (status == Z_STREAM_END)
       {
         // Read the CRC and length...
@@ -1729,7 +2442,7 @@ cups_fill(cups_file_t *fp)		// I - CUPS file
 	return (-1);
       }
 
-      bytes = (ssize_t)sizeof(fp->buf) - (ssize_t)fp->stream.avail_out;
+      bytes = (ssize_t)fp->bufsize - (ssize_t)fp->stream.avail_out;
 
       // Return the decompressed data...
       fp->ptr = fp->buf;
@@ -1741,7 +2454,7 @@ cups_fill(cups_file_t *fp)		// I - CUPS file
   }
 
   // Read a buffer's full of data...
-  if ((bytes = cups_read(fp, fp->buf, sizeof(fp->buf))) <= 0)
+  if ((bytes = cups_read(fp, fp->buf, fp->bufsize)) <= 0)
   {
     // Can't read from file!
     fp->eof = true;
@@ -1760,6 +2473,336 @@ cups_fill(cups_file_t *fp)		// I - CUPS file
 }
 
 
+//
+// 'cups_index_add()' - Add a checkpoint for the current inflate state.
+//
+
+static void
+cups_index_add(cups_file_t *fp,		// I - CUPS file
+               off_t       out)		// I - Uncompressed position
+{
+  off_t			in;		// Compressed position
+  _cups_file_point_t	*point;		// New checkpoint
+
+
+  if ((in = lseek(fp->fd, 0, SEEK_CUR)) < 0)
+  {
+    // Not seekable, stop adding checkpoints...
+    fp->index_span = 0;
+    return;
+  }
+
+  if (fp->num_points >= fp->alloc_points)
+  {
+    if ((point = realloc(fp->points, (fp->alloc_points + 16) * sizeof(_cups_file_point_t))) == NULL)
+      return;
+
+    fp->points       = point;
+    fp->alloc_points += 16;
+  }
+
+  point = fp->points + fp->num_points;
+
+  if ((point->window = malloc(_CUPS_FILE_DICT)) == NULL)
+    return;
+
+  point->winsize = _CUPS_FILE_DICT;
+
+  if (inflateGetDictionary(&fp->stream, point->window, &point->winsize) != Z_OK)
+  {
+    free(point->window);
+    return;
+  }
+
+  point->out  = out;
+  point->in   = in - (off_t)fp->stream.avail_in;
+  point->bits = fp->stream.data_type & 7;
+  point->crc  = fp->crc;
+
+  fp->num_points ++;
+  fp->index_changed = true;
+}
+
+
+//
+// 'cups_index_load()' - Load checkpoints from the index file.
+//
+// The index file starts with a line containing the size and modification time
+// of the gzip'd file and the number of checkpoints.  Each checkpoint is a line
+// with the uncompressed and compressed positions, bit offset, CRC, and window
+// size, followed by the Flate-compressed window data.
+//
+
+static bool				// O - `true` on success, `false` on error
+cups_index_load(cups_file_t *fp)	// I - CUPS file
+{
+  cups_file_t		*ifp;		// Index file
+  struct stat		fileinfo;	// File information
+  char			line[256];	// Line from index file
+  long long		size,		// File size
+			mtime,		// File modification time
+			out,		// Uncompressed position
+			in;		// Compressed position
+  size_t		i,		// Looping var
+			count;		// Number of checkpoints
+  int			bits;		// Bit offset
+  unsigned long		num,		// Number of checkpoints in file
+			crc;		// CRC
+  unsigned		winsize,	// Window size
+			clen;		// Compressed window size
+  Bytef			cwindow[_CUPS_FILE_DICT + 1024];
+					// Compressed window
+  uLongf		wlen;		// Uncompressed window size
+  _cups_file_point_t	*point;		// Current checkpoint
+  bool			ret = false;	// Return value
+
+
+  if (fstat(fp->fd, &fileinfo) || (ifp = cupsFileOpen(fp->index_file, "r")) == NULL)
+    return (false);
+
+  if (!cupsFileGets(ifp, line, sizeof(line)) || sscanf(line, "CUPS-GZIP-INDEX 1 %lld %lld %lu", &size, &mtime, &num) != 3 || size != (long long)fileinfo.st_size || mtime != (long long)fileinfo.st_mtime || num == 0 || num > 1000000)
+    goto done;
+
+  count = (size_t)num;
+
+  if ((fp->points = calloc(count, sizeof(_cups_file_point_t))) == NULL)
+    goto done;
+
+  fp->alloc_points = count;
+
+  for (i = 0; i < count; i ++)
+  {
+    point = fp->points + i;
+
+    if (!cupsFileGets(ifp, line, sizeof(line)) || sscanf(line, "%lld %lld %d %lu %u %u", &out, &in, &bits, &crc, &winsize, &clen) != 6 || out <= (i ? fp->points[i - 1].out : 0) || in <= 0 || bits < 0 || bits > 7 || winsize > _CUPS_FILE_DICT || clen > sizeof(cwindow) || cupsFileRead(ifp, (char *)cwindow, clen) != (ssize_t)clen)
+      goto done;
+
+    if ((point->window = malloc(_CUPS_FILE_DICT)) == NULL)
+      goto done;
+
+    wlen = _CUPS_FILE_DICT;
+
+    if (uncompress(point->window, &wlen, cwindow, clen) != Z_OK || wlen != winsize)
+    {
+      free(point->window);
+      goto done;
+    }
+
+    point->out     = (off_t)out;
+    point->in      = (off_t)in;
+    point->bits    = bits;
+    point->crc     = (uLong)crc;
+    point->winsize = (uInt)winsize;
+
+    fp->num_points ++;
+  }
+
+  ret = true;
+
+  done:
+
+  cupsFileClose(ifp);
+
+  if (!ret)
+  {
+    // Discard a partial index...
+    for (i = 0; i < fp->num_points; i ++)
+      free(fp->points[i].window);
+
+    free(fp->points);
+
+    fp->points       = NULL;
+    fp->num_points   = 0;
+    fp->alloc_points = 0;
+  }
+
+  return (ret);
+}
+
+
+//
+// 'cups_index_save()' - Save checkpoints to the index file.
+//
+
+static bool				// O - `true` on success, `false` on error
+cups_index_save(cups_file_t *fp)	// I - CUPS file
+{
+  cups_file_t		*ifp;		// Index file
+  struct stat		fileinfo;	// File information
+  size_t		i;		// Looping var
+  _cups_file_point_t	*point;		// Current checkpoint
+  Bytef			cwindow[_CUPS_FILE_DICT + 1024];
+					// Compressed window
+  uLongf		clen;		// Compressed window size
+  bool			ret = true;	// Return value
+
+
+  if (fp->num_points == 0 || fstat(fp->fd, &fileinfo) || (ifp = cupsFileOpen(fp->index_file, "w")) == NULL)
+    return (false);
+
+  ret = cupsFilePrintf(ifp, "CUPS-GZIP-INDEX 1 %lld %lld %lu\n", (long long)fileinfo.st_size, (long long)fileinfo.st_mtime, (unsigned long)fp->num_points);
+
+  for (i = 0, point = fp->points; ret && i < fp->num_points; i ++, point ++)
+  {
+    clen = sizeof(cwindow);
+
+    if (compress(cwindow, &clen, point->window, point->winsize) != Z_OK)
+      ret = false;
+    else
+      ret = cupsFilePrintf(ifp, "%lld %lld %d %lu %u %u\n", (long long)point->out, (long long)point->in, point->bits, (unsigned long)point->crc, (unsigned)point->winsize, (unsigned)clen) && cupsFileWrite(ifp, (char *)cwindow, (size_t)clen);
+  }
+
+  if (!cupsFileClose(ifp))
+    ret = false;
+
+  if (ret)
+    fp->index_changed = false;
+  else
+    unlink(fp->index_file);
+
+  return (ret);
+}
+
+
+//
+// 'cups_index_seek()' - Resume decompression from the nearest checkpoint.
+//
+// This function returns `false` when there is no suitable checkpoint before
+// the position or the current buffer is closer.  If the checkpoint cannot be
+// restored, the file is rewound to the beginning.
+//
+
+static bool				// O - `true` if resumed from a checkpoint, `false` otherwise
+cups_index_seek(cups_file_t *fp,	// I - CUPS file
+                off_t       pos)	// I - Uncompressed position
+{
+  size_t		left,		// Left checkpoint
+			right,		// Right checkpoint
+			mid;		// Middle checkpoint
+  _cups_file_point_t	*point;		// Checkpoint to use
+  ssize_t		bytes;		// Bytes read
+
+
+  if (fp->num_points == 0 || pos < fp->points[0].out)
+    return (false);
+
+  // Find the last checkpoint at or before the position...
+  for (left = 0, right = fp->num_points - 1; left < right;)
+  {
+    mid = (left + right + 1) / 2;
+
+    if (fp->points[mid].out <= pos)
+      left = mid;
+    else
+      right = mid - 1;
+  }
+
+  point = fp->points + left;
+
+  if (fp->ptr && pos >= fp->bufpos && point->out <= (fp->bufpos + (fp->end - fp->buf)))
+    return (false);			// Just keep reading...
+
+  // Restart decompression at the checkpoint...
+  if (fp->compressed)
+  {
+    inflateEnd(&fp->stream);
+    fp->compressed = false;
+  }
+
+  fp->stream.zalloc = (alloc_func)0;
+  fp->stream.zfree  = (free_func)0;
+  fp->stream.opaque = (voidpf)0;
+
+  if (lseek(fp->fd, point->in - (point->bits ? 1 : 0), SEEK_SET) < 0 || (bytes = cups_read(fp, (char *)fp->cbuf, fp->bufsize)) <= 0 || inflateInit2(&(fp->stream), -15) != Z_OK)
+    goto rewind;
+
+  fp->compressed = true;
+
+  if (point->bits)
+  {
+    // Prime the remaining bits of the previous byte...
+    if (inflatePrime(&(fp->stream), point->bits, fp->cbuf[0] >> (8 - point->bits)) != Z_OK)
+      goto rewind;
+
+    fp->stream.next_in  = fp->cbuf + 1;
+    fp->stream.avail_in = (uInt)bytes - 1;
+  }
+  else
+  {
+    fp->stream.next_in  = fp->cbuf;
+    fp->stream.avail_in = (uInt)bytes;
+  }
+
+  if (inflateSetDictionary(&(fp->stream), point->window, point->winsize) != Z_OK)
+    goto rewind;
+
+  fp->crc    = point->crc;
+  fp->bufpos = point->out;
+  fp->pos    = point->out;
+  fp->ptr    = fp->buf;
+  fp->end    = fp->buf;
+  fp->eof    = false;
+
+  return (true);
+
+  // If we get here the checkpoint could not be used, so start over...
+  rewind:
+
+  if (fp->compressed)
+  {
+    inflateEnd(&fp->stream);
+    fp->compressed = false;
+  }
+
+  lseek(fp->fd, 0, SEEK_SET);
+  fp->bufpos = 0;
+  fp->pos    = 0;
+  fp->ptr    = NULL;
+  fp->end    = NULL;
+
+  return (false);
+}
+
+
+#ifndef _WIN32
+//
+// 'cups_map()' - Memory-map a file for reading.
+//
+// Only regular files that are positioned at the beginning and are not gzip'd
+// are mapped.  Otherwise the file is read through the file buffer.
+//
+
+static void
+cups_map(cups_file_t *fp)		// I - CUPS file
+{
+  struct stat	fileinfo;		// File information
+  char		*map;			// Mapped data
+
+
+  if (fstat(fp->fd, &fileinfo) || !S_ISREG(fileinfo.st_mode) || fileinfo.st_size <= 0 || (unsigned long long)fileinfo.st_size > SIZE_MAX || lseek(fp->fd, 0, SEEK_CUR) != 0)
+    return;
+
+  if ((map = mmap(NULL, (size_t)fileinfo.st_size, PROT_READ, MAP_PRIVATE, fp->fd, 0)) == MAP_FAILED)
+  {
+    DEBUG_printf("2cups_map: mmap failed - %s", strerror(errno));
+    return;
+  }
+
+  if (fileinfo.st_size >= 10 && map[0] == 0x1f && (map[1] & 255) == 0x8b && map[2] == 8 && (map[3] & 0xe0) == 0)
+  {
+    // gzip'd file, use the normal read path to decompress it...
+    munmap(map, (size_t)fileinfo.st_size);
+    return;
+  }
+
+  fp->map     = map;
+  fp->mapsize = (size_t)fileinfo.st_size;
+  fp->ptr     = map;
+  fp->end     = map + fp->mapsize;
+}
+#endif // !_WIN32
+
+
 //
 // 'cups_open()' - Safely open a file for writing.
 //
@@ -21,6 +21,57 @@
 #endif // _WIN32
 
 
+//
+// Local types...
+//
+
+typedef struct _http_addrcache_s	// Address cache entry
+{
+  char			*hostname,	// Hostname
+			*service;	// Service name or port number
+  int			family;		// Address family
+  int			error;		// getaddrinfo() error, if any
+  double		expires;	// Expiration time
+  http_addrlist_t	*addrlist;	// Address list or `NULL` for negative entry
+  struct _http_addrcache_s *prev,	// Previous (more recently used) entry
+			*next;		// Next (less recently used) entry
+} _http_addrcache_t;
+
+
+//
+// Local functions...
+//
+
+static int		http_addrcache_compare(_http_addrcache_t *a, _http_addrcache_t *b, void *data);
+static void		http_addrcache_delete(_http_addrcache_t *entry);
+static bool		http_addrcache_get(const char *hostname, int family, const char *service, http_addrlist_t **addrlist, int *error);
+static void		http_addrcache_put(const char *hostname, int family, const char *service, http_addrlist_t *addrlist, int error);
+static void		http_addrcache_remove(_http_addrcache_t *entry);
+static void		http_addrcache_use(_http_addrcache_t *entry);
+
+
+//
+// Local globals...
+//
+
+static cups_mutex_t	addrcache_mutex = CUPS_MUTEX_INITIALIZER;
+					// Mutex for address cache
+static cups_array_t	*addrcache = NULL;
+					// Address cache
+static _http_addrcache_t *addrcache_first = NULL,
+					// Most recently used entry
+			*addrcache_last = NULL;
+					// Least recently used entry
+static int		addrcache_ttl = -1,
+					// Time-to-live for addresses, in seconds
+			addrcache_negative_ttl = -1,
+					// Time-to-live for lookup failures, in seconds
+			addrcache_size = -1;
+					// Maximum number of cache entries
+static http_addrcache_stats_t addrcache_stats = { 0 };
+					// Cache statistics
+
+
 //
 // 'httpAddrConnect()' - Connect to any of the addresses in the list with a
 //                       timeout and optional cancel.
@@ -396,6 +447,29 @@ httpAddrCopyList(
 }
 
 
+//
+// 'httpAddrFlushCache()' - Flush the address lookup cache.
+//
+// This function removes all cached hostname lookups so that subsequent calls
+// to @link httpAddrGetList@ perform fresh lookups.
+//
+
+void
+httpAddrFlushCache(void)
+{
+  cupsMutexLock(&addrcache_mutex);
+
+  cupsArrayDelete(addrcache);
+  addrcache       = NULL;
+  addrcache_first = NULL;
+  addrcache_last  = NULL;
+
+  addrcache_stats.entries = 0;
+
+  cupsMutexUnlock(&addrcache_mutex);
+}
+
+
 //
 // 'httpAddrFreeList()' - Free an address list.
 //
@@ -419,9 +493,34 @@ httpAddrFreeList(
 }
 
 
+//
+// 'httpAddrGetCacheStatistics()' - Get the address lookup cache statistics.
+//
+// This function copies the current address lookup cache counters to "stats".
+//
+
+void
+httpAddrGetCacheStatistics(
+    http_addrcache_stats_t *stats)	// O - Cache statistics
+{
+  if (!stats)
+    return;
+
+  cupsMutexLock(&addrcache_mutex);
+  *stats = addrcache_stats;
+  cupsMutexUnlock(&addrcache_mutex);
+}
+
+
 //
 // 'httpAddrGetList()' - Get a list of addresses for a hostname.
 //
+// This function looks up the addresses for the named host and service.
+// Successful and failed hostname lookups are cached for a short time as
+// configured by the "ResolverCacheSize", "ResolverCacheTTL", and
+// "ResolverCacheNegativeTTL" directives in the "client.conf" file.  Call
+// @link httpAddrFlushCache@ to discard cached lookups.
+//
 
 http_addrlist_t	*			// O - List of addresses or NULL
 httpAddrGetList(const char *hostname,	// I - Hostname, IP address, or NULL for passive listen address
@@ -530,7 +629,21 @@ httpAddrGetList(const char *hostname,	// I - Hostname, IP address, or NULL for p
       }
     }
 
-    if ((error = getaddrinfo(hostname, service, &hints, &results)) == 0)
+    if (hostname && http_addrcache_get(hostname, family, service, &first, &error))
+    {
+      // Use the cached lookup...
+      for (addr = first; addr && addr->next; addr = addr->next);
+
+      if (!first)
+      {
+#  ifdef _WIN32 // Really, Microsoft?!?
+	_cupsSetError(IPP_STATUS_ERROR_INTERNAL, gai_strerrorA(error), 0);
+#  else
+	_cupsSetError(IPP_STATUS_ERROR_INTERNAL, gai_strerror(error), 0);
+#  endif // _WIN32
+      }
+    }
+    else if ((error = getaddrinfo(hostname, service, &hints, &results)) == 0)
     {
       // Copy the results to our own address list structure...
       for (current = results; current; current = current->ai_next)
@@ -567,11 +680,17 @@ httpAddrGetList(const char *hostname,	// I - Hostname, IP address, or NULL for p
 
       // Free the results from getaddrinfo()...
       freeaddrinfo(results);
+
+      // Cache the addresses...
+      if (hostname && first)
+        http_addrcache_put(hostname, family, service, first, 0);
     }
     else
     {
       if (error == EAI_FAIL)
         cg->need_res_init = 1;
+      else if (hostname && error == EAI_NONAME)
+        http_addrcache_put(hostname, family, service, NULL, error);
 
 #  ifdef _WIN32 // Really, Microsoft?!?
       _cupsSetError(IPP_STATUS_ERROR_INTERNAL, gai_strerrorA(error), 0);
@@ -735,3 +854,295 @@ httpAddrGetList(const char *hostname,	// I - Hostname, IP address, or NULL for p
   // Return the address list...
   return (first);
 }
+
+
+//
+// '_httpAddrSetCacheOptions()' - Set the address cache options.
+//
+// This is called with the "client.conf" values when the client defaults are
+// loaded.
+//
+
+void
+_httpAddrSetCacheOptions(
+    int size,				// I - Maximum number of entries (0 to disable)
+    int ttl,				// I - Time-to-live for addresses, in seconds
+    int negative_ttl)			// I - Time-to-live for lookup failures, in seconds
+{
+  cupsMutexLock(&addrcache_mutex);
+
+  addrcache_size         = size;
+  addrcache_ttl          = ttl;
+  addrcache_negative_ttl = negative_ttl;
+
+  if (addrcache_size == 0 && addrcache)
+  {
+    cupsArrayDelete(addrcache);
+    addrcache       = NULL;
+    addrcache_first = NULL;
+    addrcache_last  = NULL;
+
+    addrcache_stats.entries = 0;
+  }
+
+  cupsMutexUnlock(&addrcache_mutex);
+}
+
+
+//
+// 'http_addrcache_compare()' - Compare two address cache entries.
+//
+
+static int				// O - Result of comparison
+http_addrcache_compare(
+    _http_addrcache_t *a,		// I - First entry
+    _http_addrcache_t *b,		// I - Second entry
+    void              *data)		// I - Callback data (unused)
+{
+  int	result;				// Result of comparison
+
+
+  (void)data;
+
+  if ((result = a->family - b->family) != 0)
+    return (result);
+  else if ((result = _cups_strcasecmp(a->hostname, b->hostname)) != 0)
+    return (result);
+  else
+    return (strcmp(a->service ? a->service : "", b->service ? b->service : ""));
+}
+
+
+//
+// 'http_addrcache_delete()' - Free an address cache entry.
+//
+
+static void
+http_addrcache_delete(
+    _http_addrcache_t *entry)		// I - Cache entry
+{
+  httpAddrFreeList(entry->addrlist);
+  free(entry->hostname);
+  free(entry->service);
+  free(entry);
+}
+
+
+//
+// 'http_addrcache_get()' - Get a cached address lookup.
+//
+// The address list is copied and must be freed by the caller.  A negative
+// cache entry returns `true` with a `NULL` address list.
+//
+
+static bool				// O - `true` if found, `false` otherwise
+http_addrcache_get(
+    const char      *hostname,		// I - Hostname
+    int             family,		// I - Address family
+    const char      *service,		// I - Service name or port number
+    http_addrlist_t **addrlist,		// O - Address list
+    int             *error)		// O - getaddrinfo() error
+{
+  bool			ret = false;	// Return value
+  _http_addrcache_t	key,		// Search key
+			*entry;		// Matching entry
+
+
+  *addrlist = NULL;
+  *error    = 0;
+
+  key.hostname = (char *)hostname;
+  key.service  = (char *)service;
+  key.family   = family;
+
+  cupsMutexLock(&addrcache_mutex);
+
+  if (addrcache_size < 0)
+  {
+    // Load the cache settings from "client.conf" the first time the cache is
+    // used...
+    cupsMutexUnlock(&addrcache_mutex);
+    _cupsSetDefaults();
+    cupsMutexLock(&addrcache_mutex);
+  }
+
+  if (addrcache_size <= 0)
+  {
+    cupsMutexUnlock(&addrcache_mutex);
+    return (false);
+  }
+
+  if ((entry = (_http_addrcache_t *)cupsArrayFind(addrcache, &key)) != NULL)
+  {
+    if (entry->expires <= cupsGetClock())
+    {
+      // Expired, remove from the cache...
+      http_addrcache_remove(entry);
+      addrcache_stats.expirations ++;
+    }
+    else if (entry->addrlist)
+    {
+      // Positive entry, copy the addresses...
+      if ((*addrlist = httpAddrCopyList(entry->addrlist)) != NULL)
+      {
+        http_addrcache_use(entry);
+        addrcache_stats.hits ++;
+        ret = true;
+      }
+    }
+    else
+    {
+      // Negative entry...
+      http_addrcache_use(entry);
+      *error = entry->error;
+      addrcache_stats.negative_hits ++;
+      ret = true;
+    }
+  }
+
+  if (!ret)
+    addrcache_stats.misses ++;
+
+  cupsMutexUnlock(&addrcache_mutex);
+
+  DEBUG_printf("4http_addrcache_get(hostname=\"%s\", family=%d, service=\"%s\") returning %s", hostname, family, service, ret ? "true" : "false");
+
+  return (ret);
+}
+
+
+//
+// 'http_addrcache_put()' - Add a lookup result to the address cache.
+//
+
+static void
+http_addrcache_put(
+    const char      *hostname,		// I - Hostname
+    int             family,		// I - Address family
+    const char      *service,		// I - Service name or port number
+    http_addrlist_t *addrlist,		// I - Address list or `NULL` for failure
+    int             error)		// I - getaddrinfo() error
+{
+  _http_addrcache_t	*entry,		// New entry
+			*current;	// Current entry
+  double		now;		// Current time
+  int			ttl;		// Time-to-live
+
+
+  cupsMutexLock(&addrcache_mutex);
+
+  ttl = addrlist ? addrcache_ttl : addrcache_negative_ttl;
+
+  if (addrcache_size <= 0 || ttl <= 0)
+    goto done;
+
+  if ((entry = (_http_addrcache_t *)calloc(1, sizeof(_http_addrcache_t))) == NULL)
+    goto done;
+
+  now = cupsGetClock();
+
+  entry->hostname = strdup(hostname);
+  entry->service  = service ? strdup(service) : NULL;
+  entry->family   = family;
+  entry->error    = error;
+  entry->expires  = now + ttl;
+  entry->addrlist = addrlist ? httpAddrCopyList(addrlist) : NULL;
+
+  if (!entry->hostname || (service && !entry->service) || (addrlist && !entry->addrlist))
+  {
+    http_addrcache_delete(entry);
+    goto done;
+  }
+
+  if (!addrcache)
+    addrcache = cupsArrayNew((cups_array_cb_t)http_addrcache_compare, NULL, NULL, 0, NULL, (cups_afree_cb_t)http_addrcache_delete);
+
+  // Replace any existing entry...
+  if ((current = (_http_addrcache_t *)cupsArrayFind(addrcache, entry)) != NULL)
+    http_addrcache_remove(current);
+
+  // Make room as needed, evicting the least recently used entries...
+  while (cupsArrayGetCount(addrcache) >= (size_t)addrcache_size && (current = addrcache_last) != NULL)
+  {
+    if (current->expires <= now)
+      addrcache_stats.expirations ++;
+    else
+      addrcache_stats.evictions ++;
+
+    http_addrcache_remove(current);
+  }
+
+  if (cupsArrayAdd(addrcache, entry))
+  {
+    http_addrcache_use(entry);
+    addrcache_stats.entries ++;
+  }
+  else
+    http_addrcache_delete(entry);
+
+  done:
+
+  cupsMutexUnlock(&addrcache_mutex);
+}
+
+
+//
+// 'http_addrcache_remove()' - Remove and free an address cache entry.
+//
+// The caller must hold the address cache mutex.
+//
+
+static void
+http_addrcache_remove(
+    _http_addrcache_t *entry)		// I - Cache entry
+{
+  if (entry->prev)
+    entry->prev->next = entry->next;
+  else
+    addrcache_first = entry->next;
+
+  if (entry->next)
+    entry->next->prev = entry->prev;
+  else
+    addrcache_last = entry->prev;
+
+  cupsArrayRemove(addrcache, entry);
+  addrcache_stats.entries --;
+}
+
+
+//
+// 'http_addrcache_use()' - Make a cache entry the most recently used entry.
+//
+// The caller must hold the address cache mutex.
+//
+
+static void
+http_addrcache_use(
+    _http_addrcache_t *entry)		// I - Cache entry
+{
+  if (entry == addrcache_first)
+    return;
+
+  if (entry->prev)
+  {
+    // Unlink from the current position...
+    entry->prev->next = entry->next;
+
+    if (entry->next)
+      entry->next->prev = entry->prev;
+    else
+      addrcache_last = entry->prev;
+  }
+
+  // Insert at the head of the list...
+  entry->prev = NULL;
+  entry->next = addrcache_first;
+
+  if (addrcache_first)
+    addrcache_first->prev = entry;
+  else
+    addrcache_last = entry;
+
+  addrcache_first = entry;
+}
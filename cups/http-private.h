@@ -51,6 +51,9 @@ extern "C" {
 //
 
 #  define _HTTP_MAX_SBUFFER	65536	// Size of (de)compression buffer
+#  define _HTTP_MAX_WBUFFER	65536	// Maximum size of write buffer
+#  define _HTTP_WBUFFER_HEAD	16	// Space for chunk header before write buffer
+#  define _HTTP_WBUFFER_TAIL	8	// Space for chunk trailer after write buffer
 
 #  define _HTTP_TLS_NONE	0	// No TLS options
 #  define _HTTP_TLS_ALLOW_RC4	1	// Allow RC4 cipher suites
@@ -133,6 +136,7 @@ struct _http_s				// HTTP connection structure
   http_encoding_t	data_encoding;	// Chunked or not
   off_t			data_remaining;	// Number of bytes left
   int			used;		// Number of bytes used in buffer
+  int			bufpos;		// Offset of first unused byte in buffer
   char			buffer[HTTP_MAX_BUFFER];
 					// Buffer for incoming data
   char			algorithm[65],	// Algorithm from WWW-Authenticate
@@ -151,9 +155,9 @@ struct _http_s				// HTTP connection structure
   _http_tls_credentials_t *tls_credentials;
 					// TLS credentials
   bool			tls_upgrade;	// `true` if we are doing an upgrade
-  char			wbuffer[HTTP_MAX_BUFFER];
-					// Buffer for outgoing data
+  char			*wbuffer;	// Buffer for outgoing data
   int			wused;		// Write buffer bytes used
+  int			wsize;		// Write buffer size
 					// TLS credentials
   http_timeout_cb_t	timeout_cb;	// Timeout callback
   void			*timeout_data;	// User data pointer
@@ -162,6 +166,8 @@ struct _http_s				// HTTP connection structure
   _http_coding_t	coding;		// _HTTP_CODING_xxx
   void			*stream;	// (De)compression stream
   unsigned char		*sbuffer;	// (De)compression buffer
+  http_stats_t		*stats;		// Statistics, if enabled
+  double		stats_request;	// Time last request was sent
 };
 
 
@@ -179,6 +185,8 @@ extern const char *_cups_hstrerror(int error);
 // Prototypes...
 //
 
+extern void		_httpAddLatency(http_t *http, http_latency_t type, double start) _CUPS_PRIVATE;
+extern void		_httpAddrSetCacheOptions(int size, int ttl, int negative_ttl) _CUPS_PRIVATE;
 extern _http_tls_credentials_t *_httpCreateCredentials(const char *credentials, const char *key) _CUPS_PRIVATE;
 extern char		*_httpDecodeURI(char *dst, const char *src, size_t dstsize) _CUPS_PRIVATE;
 extern void		_httpDisconnect(http_t *http) _CUPS_PRIVATE;
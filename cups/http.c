@@ -23,6 +23,17 @@
 #include <zlib.h>
 
 
+//
+// Local types...
+//
+
+typedef struct _http_iovec_s		// Output data segment
+{
+  const char	*data;			// Pointer to data
+  size_t	length;			// Length of data
+} _http_iovec_t;
+
+
 //
 // Local functions...
 //
@@ -36,13 +47,18 @@ static void		http_debug_hex(const char *prefix, const char *buffer, int bytes);
 #endif // DEBUG
 static ssize_t		http_read(http_t *http, char *buffer, size_t length);
 static ssize_t		http_read_buffered(http_t *http, char *buffer, size_t length);
+static bool		http_read_chunk_line(http_t *http, char *line, size_t linesize);
 static ssize_t		http_read_chunk(http_t *http, char *buffer, size_t length);
 static bool		http_send(http_t *http, http_state_t request, const char *uri);
 static ssize_t		http_write(http_t *http, const char *buffer, size_t length);
-static ssize_t		http_write_chunk(http_t *http, const char *buffer, size_t length);
+static ssize_t		http_write_chunk(http_t *http, const char *buffer, size_t length, bool last);
+static bool		http_write_resize(http_t *http, size_t size);
+static ssize_t		http_writev(http_t *http, _http_iovec_t *iov, size_t niov);
 static off_t		http_set_length(http_t *http);
 static void		http_set_timeout(int fd, double timeout);
 static void		http_set_wait(http_t *http);
+static void		http_stats_add(http_stats_t *stats, http_latency_t type, double elapsed);
+static void		http_stats_merge(http_stats_t *stats);
 static bool		http_tls_upgrade(http_t *http);
 
 
@@ -50,6 +66,12 @@ static bool		http_tls_upgrade(http_t *http);
 // Local globals...
 //
 
+static cups_mutex_t	http_stats_mutex = CUPS_MUTEX_INITIALIZER;
+					// Mutex for global statistics
+static bool		http_stats_default = false;
+					// Collect statistics for new connections?
+static http_stats_t	http_stats_total;
+					// Aggregate statistics
 static const char * const http_fields[HTTP_FIELD_MAX] =
 {
   "Accept",
@@ -266,6 +288,23 @@ httpClearFields(http_t *http)		// I - HTTP connection
 }
 
 
+//
+// '_httpAddLatency()' - Add a latency sample to the connection statistics.
+//
+// The caller only calls this function when statistics are enabled, i.e.
+// "http->stats" is not `NULL`.
+//
+
+void
+_httpAddLatency(http_t         *http,	// I - HTTP connection
+                http_latency_t type,	// I - Type of latency
+                double         start)	// I - Start time from @link cupsGetClock@
+{
+  if (http && http->stats)
+    http_stats_add(http->stats, type, cupsGetClock() - start);
+}
+
+
 //
 // 'httpClose()' - Close a HTTP connection.
 //
@@ -291,6 +330,15 @@ httpClose(http_t *http)			// I - HTTP connection
   free(http->authstring);
   free(http->cookie);
 
+  if (http->wbuffer)
+    free(http->wbuffer - _HTTP_WBUFFER_HEAD);
+
+  if (http->stats)
+  {
+    http_stats_merge(http->stats);
+    free(http->stats);
+  }
+
   _httpFreeCredentials(http->tls_credentials);
 
   free(http);
@@ -359,6 +407,7 @@ httpConnectAgain(http_t *http,		// I - HTTP connection
 {
   http_addrlist_t	*addr;		// Connected address
   char			*orig_creds;	// Original peer credentials
+  double		start = 0.0;	// Start time for statistics
 #ifdef DEBUG
   http_addrlist_t	*current;	// Current address
   char			temp[256];	// Temporary address string
@@ -398,6 +447,7 @@ httpConnectAgain(http_t *http,		// I - HTTP connection
   http->keep_alive      = HTTP_KEEPALIVE_OFF;
   http->data_encoding   = HTTP_ENCODING_FIELDS;
   http->used            = 0;
+  http->bufpos          = 0;
   http->data_remaining  = 0;
   http->hostaddr        = NULL;
   http->wused           = 0;
@@ -408,6 +458,9 @@ httpConnectAgain(http_t *http,		// I - HTTP connection
     DEBUG_printf("2httpConnectAgain: Address %s:%d", httpAddrGetString(&(current->addr), temp, sizeof(temp)), httpAddrGetPort(&(current->addr)));
 #endif // DEBUG
 
+  if (http->stats)
+    start = cupsGetClock();
+
   if ((addr = httpAddrConnect(http->hostlist, &(http->fd), msec, cancel)) == NULL)
   {
     // Unable to connect...
@@ -427,6 +480,12 @@ httpConnectAgain(http_t *http,		// I - HTTP connection
 
   DEBUG_printf("2httpConnectAgain: New socket=%d", http->fd);
 
+  if (http->stats)
+  {
+    http->stats->connections ++;
+    _httpAddLatency(http, HTTP_LATENCY_CONNECT, start);
+  }
+
   if (http->timeout_value > 0)
     http_set_timeout(http->fd, http->timeout_value);
 
@@ -704,7 +763,7 @@ httpFlushWrite(http_t *http)		// I - HTTP connection
   }
 
   if (http->data_encoding == HTTP_ENCODING_CHUNKED)
-    bytes = http_write_chunk(http, http->wbuffer, (size_t)http->wused);
+    bytes = http_write_chunk(http, http->wbuffer, (size_t)http->wused, false);
   else
     bytes = http_write(http, http->wbuffer, (size_t)http->wused);
 
@@ -779,7 +838,6 @@ httpGetContentEncoding(http_t *http)	// I - HTTP connection
 		*start,			// Start of coding value
 		*end;			// End of coding value
     double	qvalue;			// "qvalue" for coding
-    struct lconv *loc = localeconv();	// Locale data
     static const char * const codings[] =
     {					// Supported content codings
       "deflate",
@@ -802,7 +860,7 @@ httpGetContentEncoding(http_t *http)	// I - HTTP connection
       {
         // Grab the qvalue as needed...
         if (!strncmp(end, ";q=", 3))
-          qvalue = _cupsStrScand(end + 3, NULL, loc);
+          qvalue = _cupsStrScand(end + 3, NULL);
 
         // Skip past all attributes...
         *end++ = '\0';
@@ -1148,7 +1206,7 @@ httpGets(http_t *http,			// I - HTTP connection
     }
 
     // Now copy as much of the current line as possible...
-    for (bufptr = http->buffer, bufend = http->buffer + http->used; lineptr < lineend && bufptr < bufend;)
+    for (bufptr = http->buffer + http->bufpos, bufend = bufptr + http->used; lineptr < lineend && bufptr < bufend;)
     {
       if (*bufptr == 0x0a)
       {
@@ -1166,9 +1224,8 @@ httpGets(http_t *http,			// I - HTTP connection
       }
     }
 
-    http->used -= (int)(bufptr - http->buffer);
-    if (http->used > 0)
-      memmove(http->buffer, bufptr, (size_t)http->used);
+    http->used   = (int)(bufend - bufptr);
+    http->bufpos = http->used > 0 ? (int)(bufptr - http->buffer) : 0;
 
     if (eol)
     {
@@ -1200,6 +1257,48 @@ httpGetState(http_t *http)		// I - HTTP connection
 }
 
 
+//
+// 'httpGetStatistics()' - Get the statistics for a connection.
+//
+// This function copies the statistics for the connection "http" to "stats".
+// When "http" is `NULL`, the aggregate statistics for all connections that
+// have been closed are copied.  Statistics are only collected when enabled
+// using the @link httpSetStatistics@ function.
+//
+
+bool					// O - `true` on success, `false` if statistics are not enabled
+httpGetStatistics(http_t       *http,	// I - HTTP connection or `NULL` for aggregate statistics
+                  http_stats_t *stats)	// O - Statistics
+{
+  bool	ret = true;			// Return value
+
+
+  if (!stats)
+    return (false);
+
+  if (http)
+  {
+    if (http->stats)
+    {
+      *stats = *http->stats;
+    }
+    else
+    {
+      memset(stats, 0, sizeof(http_stats_t));
+      ret = false;
+    }
+  }
+  else
+  {
+    cupsMutexLock(&http_stats_mutex);
+    *stats = http_stats_total;
+    cupsMutexUnlock(&http_stats_mutex);
+  }
+
+  return (ret);
+}
+
+
 //
 // 'httpGetStatus()' - Get the status of the last HTTP request.
 //
@@ -1428,7 +1527,7 @@ httpPeek(http_t *http,			// I - HTTP connection
   {
     DEBUG_puts("2httpPeek: Getting chunk length...");
 
-    if (httpGets(http, len, sizeof(len)) == NULL)
+    if (!http_read_chunk_line(http, len, sizeof(len)))
     {
       DEBUG_puts("1httpPeek: Could not get length!");
       return (0);
@@ -1437,7 +1536,7 @@ httpPeek(http_t *http,			// I - HTTP connection
     if (!len[0])
     {
       DEBUG_puts("1httpPeek: Blank chunk length, trying again...");
-      if (!httpGets(http, len, sizeof(len)))
+      if (!http_read_chunk_line(http, len, sizeof(len)))
       {
 	DEBUG_puts("1httpPeek: Could not get chunk length.");
 	return (0);
@@ -1462,7 +1561,7 @@ httpPeek(http_t *http,			// I - HTTP connection
       http_content_coding_finish(http);
 
     if (http->data_encoding == HTTP_ENCODING_CHUNKED)
-      httpGets(http, len, sizeof(len));
+      http_read_chunk_line(http, len, sizeof(len));
 
     if (http->state == HTTP_STATE_LOCK_RECV || http->state == HTTP_STATE_POST_RECV || http->state == HTTP_STATE_PROPFIND_RECV || http->state == HTTP_STATE_PROPPATCH_RECV)
       http->state ++;
@@ -1541,13 +1640,11 @@ httpPeek(http_t *http,			// I - HTTP connection
 
       DEBUG_printf("1httpPeek: Copying %d more bytes of data into decompression buffer.", (int)buflen);
 
-      memcpy(http->sbuffer + ((z_stream *)http->stream)->avail_in, http->buffer, buflen);
+      memcpy(http->sbuffer + ((z_stream *)http->stream)->avail_in, http->buffer + http->bufpos, buflen);
       ((z_stream *)http->stream)->avail_in += buflen;
       http->used            -= (int)buflen;
+      http->bufpos          = http->used > 0 ? http->bufpos + (int)buflen : 0;
       http->data_remaining  -= (off_t)buflen;
-
-      if (http->used > 0)
-        memmove(http->buffer, http->buffer + buflen, (size_t)http->used);
     }
 
     DEBUG_printf("2httpPeek: length=%d, avail_in=%d", (int)length, (int)((z_stream *)http->stream)->avail_in);
@@ -1587,7 +1684,7 @@ httpPeek(http_t *http,			// I - HTTP connection
 
     DEBUG_printf("2httpPeek: grabbing %d bytes from input buffer...", (int)bytes);
 
-    memcpy(buffer, http->buffer, length);
+    memcpy(buffer, http->buffer + http->bufpos, length);
   }
   else
   {
@@ -1723,7 +1820,7 @@ httpRead(http_t *http,			// I - HTTP connection
 
       if (bytes == 0)
       {
-        ssize_t buflen = HTTP_MAX_BUFFER - (ssize_t)((z_stream *)http->stream)->avail_in;
+        ssize_t buflen = _HTTP_MAX_SBUFFER - (ssize_t)((z_stream *)http->stream)->avail_in;
 					// Additional bytes for buffer
 
         if (buflen > 0)
@@ -1766,7 +1863,7 @@ httpRead(http_t *http,			// I - HTTP connection
 	    // Read the trailing blank line now...
 	    char	len[32];		// Length string
 
-	    httpGets(http, len, sizeof(len));
+	    http_read_chunk_line(http, len, sizeof(len));
 	  }
 
           bytes = 0;
@@ -1790,7 +1887,7 @@ httpRead(http_t *http,			// I - HTTP connection
         // Read the trailing blank line now...
         char	len[32];		// Length string
 
-        httpGets(http, len, sizeof(len));
+        http_read_chunk_line(http, len, sizeof(len));
       }
     }
   }
@@ -1815,7 +1912,7 @@ httpRead(http_t *http,			// I - HTTP connection
         // Read the trailing blank line now...
         char	len[32];		// Length string
 
-        httpGets(http, len, sizeof(len));
+        http_read_chunk_line(http, len, sizeof(len));
       }
     }
   }
@@ -2262,6 +2359,38 @@ httpSetLength(http_t *http,		// I - HTTP connection
 }
 
 
+//
+// 'httpSetStatistics()' - Enable or disable statistics for a connection.
+//
+// This function enables or disables the collection of statistics for the
+// connection "http".  When "http" is `NULL`, the default for new connections is
+// set.  Disabling statistics adds the connection statistics to the aggregate
+// statistics reported by @link httpGetStatistics@.
+//
+
+void
+httpSetStatistics(http_t *http,		// I - HTTP connection or `NULL` for the default
+                  bool   enable)	// I - `true` to collect statistics, `false` otherwise
+{
+  if (!http)
+  {
+    cupsMutexLock(&http_stats_mutex);
+    http_stats_default = enable;
+    cupsMutexUnlock(&http_stats_mutex);
+  }
+  else if (enable && !http->stats)
+  {
+    http->stats = (http_stats_t *)calloc(1, sizeof(http_stats_t));
+  }
+  else if (!enable && http->stats)
+  {
+    http_stats_merge(http->stats);
+    free(http->stats);
+    http->stats = NULL;
+  }
+}
+
+
 //
 // 'httpSetTimeout()' - Set read/write timeouts and an optional callback.
 //
@@ -2552,6 +2681,7 @@ _httpWait(http_t *http,			// I - HTTP connection
 {
   struct pollfd		pfd;		// Polled file descriptor
   int			nfds;		// Result from select()/poll()
+  double		start = 0.0;	// Start time for statistics
 
 
   DEBUG_printf("4_httpWait(http=%p, msec=%d, usessl=%d)", (void *)http, msec, usessl);
@@ -2573,6 +2703,9 @@ _httpWait(http_t *http,			// I - HTTP connection
   pfd.fd     = http->fd;
   pfd.events = POLLIN;
 
+  if (http->stats)
+    start = cupsGetClock();
+
   do
   {
     nfds = poll(&pfd, 1, msec);
@@ -2583,6 +2716,9 @@ _httpWait(http_t *http,			// I - HTTP connection
   while (nfds < 0 && (errno == EINTR || errno == EAGAIN));
 #endif // _WIN32
 
+  if (http->stats)
+    _httpAddLatency(http, HTTP_LATENCY_WAIT, start);
+
   DEBUG_printf("5_httpWait: returning with nfds=%d, errno=%d...", nfds, errno);
 
   return (nfds > 0);
@@ -2687,7 +2823,7 @@ httpWrite(http_t     *http,		// I - HTTP connection
         DEBUG_printf("1httpWrite: Writing intermediate chunk, len=%d", (int)slen);
 
 	if (slen > 0 && http->data_encoding == HTTP_ENCODING_CHUNKED)
-	  sret = http_write_chunk(http, (char *)http->sbuffer, slen);
+	  sret = http_write_chunk(http, (char *)http->sbuffer, slen, false);
 	else if (slen > 0)
 	  sret = http_write(http, (char *)http->sbuffer, slen);
 	else
@@ -2708,14 +2844,26 @@ httpWrite(http_t     *http,		// I - HTTP connection
   }
   else if (length > 0)
   {
-    if (http->wused && (length + (size_t)http->wused) > sizeof(http->wbuffer))
+    if (!http->wbuffer && !http_write_resize(http, HTTP_MAX_BUFFER))
+    {
+      DEBUG_puts("1httpWrite: Unable to allocate write buffer, returning -1.");
+      http->error = ENOMEM;
+      return (-1);
+    }
+
+    if (http->wused && (length + (size_t)http->wused) > (size_t)http->wsize)
     {
       DEBUG_printf("2httpWrite: Flushing buffer (wused=%d, length=" CUPS_LLFMT ")", http->wused, CUPS_LLCAST length);
 
       httpFlushWrite(http);
+
+      // Sustained streaming of small writes - grow the buffer so that we send
+      // fewer, larger chunks.  On failure the current buffer is kept...
+      if (http->wsize < _HTTP_MAX_WBUFFER)
+        http_write_resize(http, 2 * (size_t)http->wsize);
     }
 
-    if ((length + (size_t)http->wused) <= sizeof(http->wbuffer) && length < sizeof(http->wbuffer))
+    if ((length + (size_t)http->wused) <= (size_t)http->wsize && length < (size_t)http->wsize)
     {
       // Write to buffer...
       DEBUG_printf("2httpWrite: Copying " CUPS_LLFMT " bytes to wbuffer...", CUPS_LLCAST length);
@@ -2730,7 +2878,7 @@ httpWrite(http_t     *http,		// I - HTTP connection
       DEBUG_printf("2httpWrite: Writing " CUPS_LLFMT " bytes to socket...", CUPS_LLCAST length);
 
       if (http->data_encoding == HTTP_ENCODING_CHUNKED)
-	bytes = (ssize_t)http_write_chunk(http, buffer, length);
+	bytes = (ssize_t)http_write_chunk(http, buffer, length, false);
       else
 	bytes = (ssize_t)http_write(http, buffer, length);
 
@@ -2753,7 +2901,7 @@ httpWrite(http_t     *http,		// I - HTTP connection
     if (http->coding == _HTTP_CODING_GZIP || http->coding == _HTTP_CODING_DEFLATE)
       http_content_coding_finish(http);
 
-    if (http->wused)
+    if (http->wused && http->data_encoding != HTTP_ENCODING_CHUNKED)
     {
       if (httpFlushWrite(http) < 0)
         return (-1);
@@ -2761,8 +2909,22 @@ httpWrite(http_t     *http,		// I - HTTP connection
 
     if (http->data_encoding == HTTP_ENCODING_CHUNKED)
     {
-      // Send a 0-length chunk at the end of the request...
-      http_write(http, "0\r\n\r\n", 5);
+      // Send any buffered data along with the 0-length chunk at the end of the
+      // request...
+      if (http->wused)
+      {
+        ssize_t	wbytes;			// Bytes written
+
+        wbytes      = http_write_chunk(http, http->wbuffer, (size_t)http->wused, true);
+        http->wused = 0;
+
+        if (wbytes < 0)
+          return (-1);
+      }
+      else
+      {
+        http_write(http, "0\r\n\r\n", 5);
+      }
 
       // Reset the data state...
       http->data_encoding  = HTTP_ENCODING_FIELDS;
@@ -2840,6 +3002,10 @@ httpWriteRequest(http_t     *http,	// I - HTTP connection
 //
 // 'httpWriteResponse()' - Write a HTTP response to a client connection.
 //
+// When the "Content-Encoding" field is set and the response uses chunking, the
+// content is compressed as it is written.  Responses with a "Content-Length"
+// are sent as-is, allowing pre-compressed content to be served.
+//
 
 bool					// O - `true` on success, `false` on error
 httpWriteResponse(http_t        *http,	// I - HTTP connection
@@ -2914,6 +3080,9 @@ httpWriteResponse(http_t        *http,	// I - HTTP connection
   old_remaining       = http->data_remaining;
   http->data_encoding = HTTP_ENCODING_FIELDS;
 
+  if (http->stats)
+    http->stats->requests ++;
+
   if (httpPrintf(http, "HTTP/%d.%d %d %s\r\n", http->version / 100, http->version % 100, (int)status, _httpStatusString(lang, status)) < 0)
   {
     http->status = HTTP_STATUS_ERROR;
@@ -3002,9 +3171,13 @@ httpWriteResponse(http_t        *http,	// I - HTTP connection
     if (http->state == HTTP_STATE_COPY || http->state == HTTP_STATE_DELETE || http->state == HTTP_STATE_GET || http->state == HTTP_STATE_LOCK_RECV || http->state == HTTP_STATE_MOVE || http->state == HTTP_STATE_POST_RECV || http->state == HTTP_STATE_PROPFIND_RECV || http->state == HTTP_STATE_PROPPATCH_RECV)
       http->state ++;
 
-    // Then start any content encoding...
-    DEBUG_puts("1httpWriteResponse: Calling http_content_coding_start.");
-    http_content_coding_start(http, httpGetField(http, HTTP_FIELD_CONTENT_ENCODING));
+    // Then start any content encoding, unless the content has a fixed length
+    // in which case it has already been encoded...
+    if (http->data_encoding != HTTP_ENCODING_LENGTH)
+    {
+      DEBUG_puts("1httpWriteResponse: Calling http_content_coding_start.");
+      http_content_coding_start(http, httpGetField(http, HTTP_FIELD_CONTENT_ENCODING));
+    }
   }
 
   return (true);
@@ -3141,7 +3314,7 @@ http_content_coding_finish(
 	    DEBUG_printf("1http_content_coding_finish: Writing trailing chunk, len=%d", (int)bytes);
 
 	    if (http->data_encoding == HTTP_ENCODING_CHUNKED)
-	      http_write_chunk(http, (char *)http->sbuffer, bytes);
+	      http_write_chunk(http, (char *)http->sbuffer, bytes, false);
 	    else
 	      http_write(http, (char *)http->sbuffer, bytes);
           }
@@ -3348,6 +3521,8 @@ http_create(
   char		service[255];		// Service name
   http_addrlist_t *myaddrlist = NULL;	// My address list
   _cups_globals_t *cg = _cupsGlobals();	// Thread global data
+  bool		stats;			// Collect statistics?
+  double	start = 0.0;		// Start time for statistics
 
 
   DEBUG_printf("4http_create(host=\"%s\", port=%d, addrlist=%p, family=%d, encryption=%d, blocking=%s, mode=%d)", host, port, (void *)addrlist, family, encryption, blocking ? "true" : "false", mode);
@@ -3357,6 +3532,10 @@ http_create(
 
   httpInitialize();
 
+  cupsMutexLock(&http_stats_mutex);
+  stats = http_stats_default;
+  cupsMutexUnlock(&http_stats_mutex);
+
   // Lookup the host...
   if (addrlist)
   {
@@ -3366,6 +3545,9 @@ http_create(
   {
     snprintf(service, sizeof(service), "%d", port);
 
+    if (stats)
+      start = cupsGetClock();
+
     myaddrlist = httpAddrGetList(host, family, service);
   }
 
@@ -3389,6 +3571,9 @@ http_create(
   http->status   = HTTP_STATUS_CONTINUE;
   http->version  = HTTP_VERSION_1_1;
 
+  if (stats && (http->stats = (http_stats_t *)calloc(1, sizeof(http_stats_t))) != NULL && start > 0.0)
+    _httpAddLatency(http, HTTP_LATENCY_RESOLVE, start);
+
   if (host)
   {
     DEBUG_printf("5http_create: host=\"%s\"", host);
@@ -3526,6 +3711,9 @@ http_read(http_t *http,			// I - HTTP connection
     else
       bytes = recv(http->fd, buffer, length, 0);
 
+    if (http->stats)
+      http->stats->read_calls ++;
+
     if (bytes < 0)
     {
 #ifdef _WIN32
@@ -3570,6 +3758,18 @@ http_read(http_t *http,			// I - HTTP connection
   while (bytes < 0);
 
   DEBUG_printf("8http_read: Read " CUPS_LLFMT " bytes into buffer.", CUPS_LLCAST bytes);
+
+  if (http->stats && bytes > 0)
+  {
+    http->stats->bytes_in += (size_t)bytes;
+
+    if (http->stats_request > 0.0)
+    {
+      // First byte of the response...
+      _httpAddLatency(http, HTTP_LATENCY_FIRST_BYTE, http->stats_request);
+      http->stats_request = 0.0;
+    }
+  }
 #ifdef DEBUG
   if (bytes > 0)
     http_debug_hex("http_read", buffer, (int)bytes);
@@ -3610,11 +3810,9 @@ http_read_buffered(http_t *http,	// I - HTTP connection
 
     DEBUG_printf("8http_read: Grabbing %d bytes from input buffer.", (int)bytes);
 
-    memcpy(buffer, http->buffer, (size_t)bytes);
-    http->used -= (int)bytes;
-
-    if (http->used > 0)
-      memmove(http->buffer, http->buffer + bytes, (size_t)http->used);
+    memcpy(buffer, http->buffer + http->bufpos, (size_t)bytes);
+    http->used   -= (int)bytes;
+    http->bufpos = http->used > 0 ? http->bufpos + (int)bytes : 0;
   }
   else
     bytes = http_read(http, buffer, length);
@@ -3641,7 +3839,7 @@ http_read_chunk(http_t *http,		// I - HTTP connection
   {
     char	len[32];		// Length string
 
-    if (!httpGets(http, len, sizeof(len)))
+    if (!http_read_chunk_line(http, len, sizeof(len)))
     {
       DEBUG_puts("8http_read_chunk: Could not get chunk length.");
       return (0);
@@ -3650,7 +3848,7 @@ http_read_chunk(http_t *http,		// I - HTTP connection
     if (!len[0])
     {
       DEBUG_puts("8http_read_chunk: Blank chunk length, trying again...");
-      if (!httpGets(http, len, sizeof(len)))
+      if (!http_read_chunk_line(http, len, sizeof(len)))
       {
 	DEBUG_puts("8http_read_chunk: Could not get chunk length.");
 	return (0);
@@ -3670,7 +3868,7 @@ http_read_chunk(http_t *http,		// I - HTTP connection
     if (http->data_remaining == 0)
     {
       // 0-length chunk, grab trailing blank line...
-      httpGets(http, len, sizeof(len));
+      http_read_chunk_line(http, len, sizeof(len));
     }
   }
 
@@ -3685,6 +3883,48 @@ http_read_chunk(http_t *http,		// I - HTTP connection
 }
 
 
+//
+// 'http_read_chunk_line()' - Read a chunk header or trailer line.
+//
+// Chunk framing lines are normally already in the input buffer, so they are
+// parsed in place without the byte-at-a-time loop in @link httpGets@, which is
+// only used when the line spans more than one read.
+//
+
+static bool				// O - `true` on success, `false` on error
+http_read_chunk_line(
+    http_t *http,			// I - HTTP connection
+    char   *line,			// I - Line buffer
+    size_t linesize)			// I - Size of line buffer
+{
+  char		*start,			// Start of line
+		*eol;			// End of line
+  size_t	count,			// Bytes to consume
+		linelen;		// Length of line
+
+
+  if (http->used <= 0 || (eol = memchr(start = http->buffer + http->bufpos, '\n', (size_t)http->used)) == NULL)
+    return (httpGets(http, line, linesize) != NULL);
+
+  count   = (size_t)(eol - start) + 1;
+  linelen = count - 1;
+
+  if (linelen > 0 && start[linelen - 1] == '\r')
+    linelen --;
+
+  if (linelen >= linesize)
+    linelen = linesize - 1;
+
+  memcpy(line, start, linelen);
+  line[linelen] = '\0';
+
+  http->used   -= (int)count;
+  http->bufpos = http->used > 0 ? http->bufpos + (int)count : 0;
+
+  return (true);
+}
+
+
 //
 // 'http_send()' - Send a request with all fields and the trailing blank line.
 //
@@ -3799,6 +4039,9 @@ http_send(http_t       *http,		// I - HTTP connection
     httpSetField(http, HTTP_FIELD_UPGRADE, "TLS/1.3,TLS/1.2,TLS/1.1,TLS/1.0");
   }
 
+  if (http->stats)
+    http->stats->requests ++;
+
   if (httpPrintf(http, "%s %s HTTP/1.1\r\n", codes[request], buf) < 1)
   {
     http->status = HTTP_STATUS_ERROR;
@@ -3856,6 +4099,9 @@ http_send(http_t       *http,		// I - HTTP connection
   if (httpFlushWrite(http) < 0)
     return (false);
 
+  if (http->stats)
+    http->stats_request = cupsGetClock();
+
   http_set_length(http);
   httpClearFields(http);
 
@@ -3959,6 +4205,73 @@ http_set_wait(http_t *http)		// I - HTTP connection
 }
 
 
+//
+// 'http_stats_add()' - Add a latency sample to statistics.
+//
+// Bucket 0 counts samples under 1 microsecond, bucket N counts samples from
+// 2^(N-1) up to 2^N microseconds, and the last bucket counts everything longer.
+//
+
+static void
+http_stats_add(http_stats_t   *stats,	// I - Statistics
+               http_latency_t type,	// I - Type of latency
+               double         elapsed)	// I - Elapsed time in seconds
+{
+  int		bucket;			// Histogram bucket
+  double	usecs;			// Elapsed time in microseconds
+
+
+  if (elapsed < 0.0)
+    elapsed = 0.0;
+
+  for (bucket = 0, usecs = elapsed * 1000000.0; usecs >= 1.0 && bucket < (HTTP_STATS_BUCKETS - 1); bucket ++)
+    usecs *= 0.5;
+
+  stats->count[type] ++;
+  stats->total[type] += elapsed;
+  stats->histogram[type][bucket] ++;
+
+  if (elapsed > stats->maximum[type])
+    stats->maximum[type] = elapsed;
+}
+
+
+//
+// 'http_stats_merge()' - Add connection statistics to the aggregate statistics.
+//
+
+static void
+http_stats_merge(http_stats_t *stats)	// I - Connection statistics
+{
+  int	type,				// Type of latency
+	bucket;				// Histogram bucket
+
+
+  cupsMutexLock(&http_stats_mutex);
+
+  http_stats_total.connections += stats->connections;
+  http_stats_total.requests    += stats->requests;
+  http_stats_total.bytes_in    += stats->bytes_in;
+  http_stats_total.bytes_out   += stats->bytes_out;
+  http_stats_total.read_calls  += stats->read_calls;
+  http_stats_total.write_calls += stats->write_calls;
+
+  for (type = 0; type < HTTP_LATENCY_MAX; type ++)
+  {
+    http_stats_total.count[type] += stats->count[type];
+    http_stats_total.total[type] += stats->total[type];
+
+    if (stats->maximum[type] > http_stats_total.maximum[type])
+      http_stats_total.maximum[type] = stats->maximum[type];
+
+    for (bucket = 0; bucket < HTTP_STATS_BUCKETS; bucket ++)
+      http_stats_total.histogram[type][bucket] += stats->histogram[type][bucket];
+  }
+
+  cupsMutexUnlock(&http_stats_mutex);
+}
+
+
 //
 // 'http_tls_upgrade()' - Force upgrade to TLS encryption.
 //
@@ -4036,18 +4349,170 @@ static ssize_t				// O - Number of bytes written
 http_write(http_t     *http,		// I - HTTP connection
            const char *buffer,		// I - Buffer for data
 	   size_t     length)		// I - Number of bytes to write
+{
+  _http_iovec_t	iov;			// Output segment
+
+
+  iov.data   = buffer;
+  iov.length = length;
+
+  return (http_writev(http, &iov, 1));
+}
+
+
+//
+// 'http_write_chunk()' - Write a chunked buffer.
+//
+// The chunk header, data, and trailer are sent using a single write call.  When
+// the data is in the write buffer the header and trailer are placed in the
+// space reserved around it, otherwise the segments are gathered with
+// `sendmsg`/`WSASend` or, for TLS connections, copied into the write buffer so
+// that they go out as a single TLS record.
+//
+
+static ssize_t				// O - Number bytes written
+http_write_chunk(http_t     *http,	// I - HTTP connection
+                 const char *buffer,	// I - Buffer to write
+		 size_t     length,	// I - Length of buffer
+		 bool       last)	// I - `true` to also write the 0-length chunk
+{
+  char		header[16];		// Chunk header
+  size_t	hlen;			// Length of chunk header
+  const char	*trailer;		// Chunk trailer
+  size_t	tlen;			// Length of chunk trailer
+  ssize_t	bytes;			// Bytes written
+
+
+  DEBUG_printf("7http_write_chunk(http=%p, buffer=%p, length=" CUPS_LLFMT ", last=%s)", (void *)http, (void *)buffer, CUPS_LLCAST length, last ? "true" : "false");
+
+  snprintf(header, sizeof(header), "%x\r\n", (unsigned)length);
+  hlen = strlen(header);
+
+  if (last)
+  {
+    trailer = "\r\n0\r\n\r\n";
+    tlen    = 7;
+  }
+  else
+  {
+    trailer = "\r\n";
+    tlen    = 2;
+  }
+
+  if (http->tls && buffer != http->wbuffer && !http->wused && length <= _HTTP_MAX_WBUFFER && ((size_t)http->wsize >= length || http_write_resize(http, length)))
+  {
+    // Copy the data into the (empty) write buffer so the TLS layer sees a
+    // single buffer...
+    memcpy(http->wbuffer, buffer, length);
+    buffer = http->wbuffer;
+  }
+
+  if (buffer == http->wbuffer)
+  {
+    // Assemble the chunk in place around the write buffer contents...
+    char	*start = http->wbuffer - hlen;
+					// Start of chunk
+
+    memcpy(start, header, hlen);
+    memcpy(http->wbuffer + length, trailer, tlen);
+
+    bytes = http_write(http, start, hlen + length + tlen);
+  }
+  else
+  {
+    // Gather the chunk header, data, and trailer...
+    _http_iovec_t	iov[3];		// Output segments
+
+    iov[0].data   = header;
+    iov[0].length = hlen;
+    iov[1].data   = buffer;
+    iov[1].length = length;
+    iov[2].data   = trailer;
+    iov[2].length = tlen;
+
+    bytes = http_writev(http, iov, 3);
+  }
+
+  if (bytes < 0)
+  {
+    DEBUG_puts("8http_write_chunk: http_write of chunk failed.");
+    return (-1);
+  }
+
+  return ((ssize_t)length);
+}
+
+
+//
+// 'http_write_resize()' - Resize the write buffer.
+//
+// The write buffer is allocated with room for a chunk header before and a
+// chunk trailer after the data.  The buffer must be empty.
+//
+
+static bool				// O - `true` on success, `false` on error
+http_write_resize(http_t *http,		// I - HTTP connection
+                  size_t size)		// I - New size of buffer
+{
+  char	*wbuffer;			// New write buffer
+
+
+  if (size < HTTP_MAX_BUFFER)
+    size = HTTP_MAX_BUFFER;
+  else if (size > _HTTP_MAX_WBUFFER)
+    size = _HTTP_MAX_WBUFFER;
+
+  if ((wbuffer = realloc(http->wbuffer ? http->wbuffer - _HTTP_WBUFFER_HEAD : NULL, size + _HTTP_WBUFFER_HEAD + _HTTP_WBUFFER_TAIL)) == NULL)
+  {
+    DEBUG_printf("8http_write_resize: Unable to allocate " CUPS_LLFMT " bytes: %s", CUPS_LLCAST size, strerror(errno));
+    return (false);
+  }
+
+  DEBUG_printf("8http_write_resize: Write buffer is now " CUPS_LLFMT " bytes.", CUPS_LLCAST size);
+
+  http->wbuffer = wbuffer + _HTTP_WBUFFER_HEAD;
+  http->wsize   = (int)size;
+
+  return (true);
+}
+
+
+//
+// 'http_writev()' - Write one or more buffers to a HTTP connection.
+//
+
+static ssize_t				// O - Number of bytes written
+http_writev(http_t        *http,	// I - HTTP connection
+            _http_iovec_t *iov,		// I - Output segments
+	    size_t        niov)		// I - Number of segments
 {
   ssize_t	tbytes,			// Total bytes sent
 		bytes;			// Bytes sent
+  size_t	i;			// Looping var
+#ifdef _WIN32
+  WSABUF	wsabuf[4];		// Gathered output buffers
+  DWORD		wsabytes;		// Bytes sent by WSASend
+#else
+  struct iovec	vec[4];			// Gathered output buffers
+  struct msghdr	msg;			// Message header
+#endif // _WIN32
 
 
-  DEBUG_printf("7http_write(http=%p, buffer=%p, length=" CUPS_LLFMT ")", (void *)http, (void *)buffer, CUPS_LLCAST length);
+  DEBUG_printf("7http_writev(http=%p, iov=%p, niov=" CUPS_LLFMT ")", (void *)http, (void *)iov, CUPS_LLCAST niov);
   http->error = 0;
   tbytes      = 0;
 
-  while (length > 0)
+  while (niov > 0)
   {
-    DEBUG_printf("8http_write: About to write %d bytes.", (int)length);
+    if (iov->length == 0)
+    {
+      // Skip empty segments...
+      iov ++;
+      niov --;
+      continue;
+    }
+
+    DEBUG_printf("8http_writev: About to write %d bytes.", (int)iov->length);
 
     if (http->timeout_value > 0.0)
     {
@@ -4088,12 +4553,46 @@ http_write(http_t     *http,		// I - HTTP connection
       while (nfds <= 0);
     }
 
+    if (http->stats)
+      http->stats->write_calls ++;
+
     if (http->tls)
-      bytes = _httpTLSWrite(http, buffer, (int)length);
+    {
+      bytes = _httpTLSWrite(http, iov->data, (int)iov->length);
+    }
+    else if (niov == 1)
+    {
+      bytes = send(http->fd, iov->data, iov->length, 0);
+    }
     else
-      bytes = send(http->fd, buffer, length, 0);
+    {
+      // Gather up to 4 segments into a single system call...
+      for (i = 0; i < niov && i < (sizeof(vec) / sizeof(vec[0])); i ++)
+      {
+#ifdef _WIN32
+        wsabuf[i].buf = (CHAR *)iov[i].data;
+        wsabuf[i].len = (ULONG)iov[i].length;
+#else
+        vec[i].iov_base = (void *)iov[i].data;
+        vec[i].iov_len  = iov[i].length;
+#endif // _WIN32
+      }
 
-    DEBUG_printf("8http_write: Write of " CUPS_LLFMT " bytes returned " CUPS_LLFMT ".", CUPS_LLCAST length, CUPS_LLCAST bytes);
+#ifdef _WIN32
+      if (WSASend(http->fd, wsabuf, (DWORD)i, &wsabytes, 0, NULL, NULL))
+        bytes = -1;
+      else
+        bytes = (ssize_t)wsabytes;
+#else
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov    = vec;
+      msg.msg_iovlen = i;
+
+      bytes = sendmsg(http->fd, &msg, 0);
+#endif // _WIN32
+    }
+
+    DEBUG_printf("8http_writev: Write returned " CUPS_LLFMT ".", CUPS_LLCAST bytes);
 
     if (bytes < 0)
     {
@@ -4133,60 +4632,36 @@ http_write(http_t     *http,		// I - HTTP connection
       }
 #endif // _WIN32
 
-      DEBUG_printf("8http_write: error writing data (%s).", strerror(http->error));
+      DEBUG_printf("8http_writev: error writing data (%s).", strerror(http->error));
 
       return (-1);
     }
 
-    buffer += bytes;
-    tbytes += bytes;
-    length -= (size_t)bytes;
-  }
-
 #ifdef DEBUG
-  http_debug_hex("http_write", buffer - tbytes, (int)tbytes);
+    http_debug_hex("http_writev", iov->data, (int)(bytes < (ssize_t)iov->length ? bytes : (ssize_t)iov->length));
 #endif // DEBUG
 
-  DEBUG_printf("8http_write: Returning " CUPS_LLFMT ".", CUPS_LLCAST tbytes);
-
-  return (tbytes);
-}
-
-
-//
-// 'http_write_chunk()' - Write a chunked buffer.
-//
-
-static ssize_t				// O - Number bytes written
-http_write_chunk(http_t     *http,	// I - HTTP connection
-                 const char *buffer,	// I - Buffer to write
-		 size_t        length)	// I - Length of buffer
-{
-  char		header[16];		// Chunk header
-  ssize_t	bytes;			// Bytes written
-
+    // Advance past the bytes that were written...
+    tbytes += bytes;
 
-  DEBUG_printf("7http_write_chunk(http=%p, buffer=%p, length=" CUPS_LLFMT ")", (void *)http, (void *)buffer, CUPS_LLCAST length);
+    if (http->stats)
+      http->stats->bytes_out += (size_t)bytes;
 
-  // Write the chunk header, data, and trailer.
-  snprintf(header, sizeof(header), "%x\r\n", (unsigned)length);
-  if (http_write(http, header, strlen(header)) < 0)
-  {
-    DEBUG_puts("8http_write_chunk: http_write of length failed.");
-    return (-1);
-  }
+    while (niov > 0 && (size_t)bytes >= iov->length)
+    {
+      bytes -= (ssize_t)iov->length;
+      iov ++;
+      niov --;
+    }
 
-  if ((bytes = http_write(http, buffer, length)) < 0)
-  {
-    DEBUG_puts("8http_write_chunk: http_write of buffer failed.");
-    return (-1);
+    if (niov > 0)
+    {
+      iov->data   += bytes;
+      iov->length -= (size_t)bytes;
+    }
   }
 
-  if (http_write(http, "\r\n", 2) < 0)
-  {
-    DEBUG_puts("8http_write_chunk: http_write of CR LF failed.");
-    return (-1);
-  }
+  DEBUG_printf("8http_writev: Returning " CUPS_LLFMT ".", CUPS_LLCAST tbytes);
 
-  return (bytes);
+  return (tbytes);
 }
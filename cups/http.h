@@ -78,6 +78,7 @@ extern "C" {
 #  define HTTP_MAX_URI		1024	// Max length of URI string
 #  define HTTP_MAX_HOST		256	// Max length of hostname string
 #  define HTTP_MAX_BUFFER	2048	// Max length of data buffer
+#  define HTTP_STATS_BUCKETS	32	// Number of latency histogram buckets
 #  define HTTP_MAX_VALUE	256	// Max header field value length
 
 
@@ -338,6 +339,16 @@ typedef enum http_status_e		// HTTP status codes
   HTTP_STATUS_CUPS_PKI_ERROR		// Error negotiating a secure connection
 } http_status_t;
 
+typedef enum http_latency_e		// HTTP latency statistics
+{
+  HTTP_LATENCY_RESOLVE,			// Hostname lookup
+  HTTP_LATENCY_CONNECT,			// Socket connection
+  HTTP_LATENCY_TLS,			// TLS handshake
+  HTTP_LATENCY_FIRST_BYTE,		// Request sent to first byte of response
+  HTTP_LATENCY_WAIT,			// Waiting for data in @link httpWait@
+  HTTP_LATENCY_MAX			// Number of latency statistics @private@
+} http_latency_t;
+
 typedef enum http_trust_e		// Level of trust for credentials
 {
   HTTP_TRUST_OK = 0,			// Credentials are OK/trusted
@@ -402,6 +413,34 @@ typedef struct http_addrlist_s		// Socket address list, which is used to enumera
   http_addr_t		addr;		// Address
 } http_addrlist_t;
 
+typedef struct http_addrcache_stats_s	// Address lookup cache statistics
+{
+  size_t		entries,	// Number of cached lookups
+			hits,		// Number of cache hits
+			negative_hits,	// Number of cache hits for failed lookups
+			misses,		// Number of cache misses
+			expirations,	// Number of expired entries
+			evictions;	// Number of entries removed to make room
+} http_addrcache_stats_t;
+
+typedef struct http_stats_s		// HTTP connection statistics
+{
+  size_t		connections,	// Number of connections
+			requests,	// Number of requests or responses sent
+			bytes_in,	// Number of bytes read
+			bytes_out,	// Number of bytes written
+			read_calls,	// Number of socket/TLS read calls
+			write_calls;	// Number of socket/TLS write calls
+  size_t		count[HTTP_LATENCY_MAX];
+					// Number of samples for each latency
+  double		total[HTTP_LATENCY_MAX],
+					// Total time in seconds for each latency
+			maximum[HTTP_LATENCY_MAX];
+					// Maximum time in seconds for each latency
+  size_t		histogram[HTTP_LATENCY_MAX][HTTP_STATS_BUCKETS];
+					// Latency histograms, bucket N counts samples from 2^(N-1) to 2^N-1 microseconds
+} http_stats_t;
+
 typedef struct _http_s http_t;		// HTTP connection type
 
 typedef bool (*http_resolve_cb_t)(void *data);
@@ -418,7 +457,9 @@ extern http_t		*httpAcceptConnection(int fd, bool blocking) _CUPS_PUBLIC;
 extern bool		httpAddrClose(http_addr_t *addr, int fd) _CUPS_PUBLIC;
 extern http_addrlist_t	*httpAddrConnect(http_addrlist_t *addrlist, int *sock, int msec, int *cancel) _CUPS_PUBLIC;
 extern http_addrlist_t	*httpAddrCopyList(http_addrlist_t *src) _CUPS_PUBLIC;
+extern void		httpAddrFlushCache(void) _CUPS_PUBLIC;
 extern void		httpAddrFreeList(http_addrlist_t *addrlist) _CUPS_PUBLIC;
+extern void		httpAddrGetCacheStatistics(http_addrcache_stats_t *stats) _CUPS_PUBLIC;
 extern int		httpAddrGetFamily(http_addr_t *addr) _CUPS_PUBLIC;
 extern size_t		httpAddrGetLength(const http_addr_t *addr) _CUPS_PUBLIC;
 extern http_addrlist_t	*httpAddrGetList(const char *hostname, int family, const char *service) _CUPS_PUBLIC;
@@ -471,6 +512,7 @@ extern size_t		httpGetReady(http_t *http) _CUPS_PUBLIC;
 extern size_t		httpGetRemaining(http_t *http) _CUPS_PUBLIC;
 extern const char	*httpGetSecurity(http_t *http, char *buffer, size_t bufsize) _CUPS_PUBLIC;
 extern http_state_t	httpGetState(http_t *http) _CUPS_PUBLIC;
+extern bool		httpGetStatistics(http_t *http, http_stats_t *stats) _CUPS_PUBLIC;
 extern http_status_t	httpGetStatus(http_t *http) _CUPS_PUBLIC;
 extern char		*httpGetSubField(http_t *http, http_field_t field, const char *name, char *value, size_t valuelen) _CUPS_PUBLIC;
 extern http_version_t	httpGetVersion(http_t *http) _CUPS_PUBLIC;
@@ -499,6 +541,7 @@ extern void		httpSetExpect(http_t *http, http_status_t expect) _CUPS_PUBLIC;
 extern void		httpSetField(http_t *http, http_field_t field, const char *value) _CUPS_PUBLIC;
 extern void		httpSetKeepAlive(http_t *http, http_keepalive_t keep_alive) _CUPS_PUBLIC;
 extern void		httpSetLength(http_t *http, size_t length) _CUPS_PUBLIC;
+extern void		httpSetStatistics(http_t *http, bool enable) _CUPS_PUBLIC;
 extern void		httpSetTimeout(http_t *http, double timeout, http_timeout_cb_t cb, void *user_data) _CUPS_PUBLIC;
 extern void		httpShutdown(http_t *http) _CUPS_PUBLIC;
 extern const char	*httpStateString(http_state_t state) _CUPS_PUBLIC;
@@ -228,7 +228,6 @@ cupsJSONExportString(cups_json_t *json)	// I - JSON root node
   char		*s,			// JSON string
 		*ptr;			// Pointer into string
   const char	*value;			// Pointer into string value
-  struct lconv	*loc;			// Locale data
 
 
   DEBUG_printf("cupsJSONExportString(json=%p)", (void *)json);
@@ -327,7 +326,6 @@ cupsJSONExportString(cups_json_t *json)	// I - JSON root node
 
   current = json;
   ptr     = s;
-  loc     = localeconv();
 
   while (current)
   {
@@ -366,7 +364,7 @@ cupsJSONExportString(cups_json_t *json)	// I - JSON root node
           break;
 
       case CUPS_JTYPE_NUMBER :
-          _cupsStrFormatd(ptr, s + length, current->value.number, loc);
+          _cupsStrFormatd(ptr, s + length, current->value.number);
           ptr += strlen(ptr);
           break;
 
@@ -696,7 +694,6 @@ cupsJSONImportString(const char *s)	// I - JSON string
 		*prev = NULL,		// Previous node
 		*current;		// Current node
   size_t	count;			// Number of children
-  struct lconv	*loc;			// Locale data
   static const char *sep = ",]} \n\r\t";// Separator chars
 
 
@@ -727,7 +724,6 @@ cupsJSONImportString(const char *s)	// I - JSON string
   // Parse until we get to the end...
   parent = json;
   count  = 0;
-  loc    = localeconv();
   s ++;
 
   while (*s)
@@ -955,7 +951,7 @@ cupsJSONImportString(const char *s)	// I - JSON string
       if ((current = cupsJSONNew(parent, prev, CUPS_JTYPE_NUMBER)) == NULL)
         goto error;
 
-      current->value.number = _cupsStrScand(s, (char **)&s, loc);
+      current->value.number = _cupsStrScand(s, (char **)&s);
       count ++;
       prev = current;
 
@@ -12,12 +12,47 @@
 #include "cups-private.h"
 
 
+//
+// Types and structures...
+//
+
+typedef struct _cups_optbuf_s		// Option set arena block
+{
+  struct _cups_optbuf_s	*prev;		// Previous (smaller) block
+  size_t		size,		// Size of block
+			used;		// Bytes used
+  char			data[];		// Data
+} _cups_optbuf_t;
+
+typedef struct _cups_optval_s		// Option set name/value pair
+{
+  const char		*name,		// Name of option
+			*value;		// Value of option
+  size_t		hash;		// Hash of name
+} _cups_optval_t;
+
+struct _cups_optset_s			// Option set
+{
+  _cups_optbuf_t	*buf;		// Current arena block
+  size_t		num_opts,	// Number of options
+			alloc_opts;	// Allocated options
+  _cups_optval_t	*opts;		// Options in the order they were added
+  size_t		num_slots,	// Number of hash table slots
+			*slots;		// Hash table of option indices
+};
+
+
 //
 // Local functions...
 //
 
 static int	cups_compare_options(cups_option_t *a, cups_option_t *b);
 static size_t	cups_find_option(const char *name, size_t num_options, cups_option_t *option, int *rdiff);
+static bool	cups_optset_add(cups_optset_t *set, const char *name, const char *value);
+static char	*cups_optset_alloc(cups_optset_t *set, size_t size);
+static size_t	cups_optset_find(cups_optset_t *set, const char *name, size_t hash, size_t *rslot);
+static size_t	cups_optset_hash(const char *name);
+static bool	cups_optset_rehash(cups_optset_t *set, size_t num_slots);
 
 
 //
@@ -191,6 +226,445 @@ cupsGetOption(const char    *name,	// I - Name of option
   return (NULL);
 }
 
+//
+// 'cupsOptSetAdd()' - Add an option to an option set.
+//
+// This function adds or replaces an option in an option set.  The name and
+// value are copied into the option set.
+//
+
+bool					// O - `true` on success, `false` on failure
+cupsOptSetAdd(cups_optset_t *set,	// I - Option set
+              const char    *name,	// I - Name of option
+              const char    *value)	// I - Value of option
+{
+  size_t	namelen,		// Length of name
+		valuelen;		// Length of value
+  char		*copy;			// Copy of name and value
+
+
+  // Range check input...
+  if (!set || !name || !*name || !value)
+    return (false);
+
+  // Copy the name and value to the arena...
+  namelen  = strlen(name) + 1;
+  valuelen = strlen(value) + 1;
+
+  if ((copy = cups_optset_alloc(set, namelen + valuelen)) == NULL)
+    return (false);
+
+  memcpy(copy, name, namelen);
+  memcpy(copy + namelen, value, valuelen);
+
+  return (cups_optset_add(set, copy, copy + namelen));
+}
+
+
+//
+// 'cupsOptSetClear()' - Remove all options from an option set.
+//
+// This function removes all options but keeps the memory that was allocated
+// for them, so that an option set can be reused to parse many option strings
+// of similar size without allocating memory.
+//
+
+void
+cupsOptSetClear(cups_optset_t *set)	// I - Option set
+{
+  _cups_optbuf_t	*buf,		// Current block
+			*prev;		// Previous block
+
+
+  // Range check input...
+  if (!set)
+    return;
+
+  // Free all but the last (largest) arena block...
+  if ((buf = set->buf) != NULL)
+  {
+    for (prev = buf->prev; prev; prev = buf->prev)
+    {
+      buf->prev = prev->prev;
+      free(prev);
+    }
+
+    buf->used = 0;
+  }
+
+  // Empty the options and hash table...
+  set->num_opts = 0;
+
+  if (set->slots)
+    memset(set->slots, 0xff, set->num_slots * sizeof(size_t));
+}
+
+
+//
+// 'cupsOptSetDelete()' - Free the memory used by an option set.
+//
+
+void
+cupsOptSetDelete(cups_optset_t *set)	// I - Option set
+{
+  _cups_optbuf_t	*buf,		// Current block
+			*prev;		// Previous block
+
+
+  // Range check input...
+  if (!set)
+    return;
+
+  // Free memory...
+  for (buf = set->buf; buf; buf = prev)
+  {
+    prev = buf->prev;
+    free(buf);
+  }
+
+  free(set->opts);
+  free(set->slots);
+  free(set);
+}
+
+
+//
+// 'cupsOptSetExport()' - Add the options in an option set to an option array.
+//
+// This function adds the options in an option set to an option array, sorted
+// by name as if they were added using @link cupsAddOption@.  New option arrays
+// can be initialized simply by passing 0 for the "num_options" parameter.
+// The option array is freed using @link cupsFreeOptions@.
+//
+
+size_t					// O  - Number of options
+cupsOptSetExport(
+    cups_optset_t *set,			// I  - Option set
+    size_t        num_options,		// I  - Number of options
+    cups_option_t **options)		// IO - Pointer to options
+{
+  size_t		i;		// Looping var
+  _cups_optval_t	*opt;		// Current option
+  cups_option_t		*temp;		// New options
+
+
+  // Range check input...
+  if (!set || set->num_opts == 0 || !options)
+    return (num_options);
+
+  // Merge with existing options as needed...
+  if (num_options > 0)
+  {
+    for (i = set->num_opts, opt = set->opts; i > 0; i --, opt ++)
+      num_options = cupsAddOption(opt->name, opt->value, num_options, options);
+
+    return (num_options);
+  }
+
+  // Otherwise copy all of the options at once and sort them...
+  if ((temp = calloc(set->num_opts, sizeof(cups_option_t))) == NULL)
+    return (0);
+
+  for (i = 0, opt = set->opts; i < set->num_opts; i ++, opt ++)
+  {
+    temp[i].name  = _cupsStrAlloc(opt->name);
+    temp[i].value = _cupsStrAlloc(opt->value);
+  }
+
+  qsort(temp, set->num_opts, sizeof(cups_option_t), (int (*)(const void *, const void *))cups_compare_options);
+
+  *options = temp;
+
+  return (set->num_opts);
+}
+
+
+//
+// 'cupsOptSetGetCount()' - Get the number of options in an option set.
+//
+
+size_t					// O - Number of options
+cupsOptSetGetCount(cups_optset_t *set)	// I - Option set
+{
+  return (set ? set->num_opts : 0);
+}
+
+
+//
+// 'cupsOptSetGetName()' - Get the name of the N-th option in an option set.
+//
+// Options are numbered in the order they were first added, starting at 0.
+//
+
+const char *				// O - Option name or `NULL` if none
+cupsOptSetGetName(cups_optset_t *set,	// I - Option set
+                  size_t        n)	// I - Option number, starting at 0
+{
+  return (set && n < set->num_opts ? set->opts[n].name : NULL);
+}
+
+
+//
+// 'cupsOptSetGetValue()' - Get an option value from an option set.
+//
+
+const char *				// O - Option value or `NULL` if none
+cupsOptSetGetValue(cups_optset_t *set,	// I - Option set
+                   const char    *name)	// I - Name of option
+{
+  size_t	current;		// Matching option
+
+
+  // Range check input...
+  if (!set || !name || set->num_opts == 0)
+    return (NULL);
+
+  // Look up the option...
+  if ((current = cups_optset_find(set, name, cups_optset_hash(name), NULL)) == SIZE_MAX)
+    return (NULL);
+
+  return (set->opts[current].value);
+}
+
+
+//
+// 'cupsOptSetNew()' - Create a new option set.
+//
+// This function creates a new, empty option set.  Option sets store options
+// in a single block of memory with a hash table for lookups, and are faster
+// than option arrays for parsing and looking up many options.  Use
+// @link cupsOptSetExport@ to get an option array.
+//
+
+cups_optset_t *				// O - Option set or `NULL` on error
+cupsOptSetNew(void)
+{
+  return ((cups_optset_t *)calloc(1, sizeof(cups_optset_t)));
+}
+
+
+//
+// 'cupsOptSetParse()' - Parse options from a command-line argument into an option set.
+//
+// This function parses options the same way as @link cupsParseOptions@, but
+// the values are unescaped in a single copy of the argument string that is
+// stored in the option set.
+//
+// The "end" argument, if not `NULL`, receives a pointer to the end of the
+// options.
+//
+
+bool					// O - `true` on success, `false` on failure
+cupsOptSetParse(cups_optset_t *set,	// I - Option set
+                const char    *arg,	// I - Argument to parse
+                const char    **end)	// O - Pointer to end of options or `NULL` for "don't care"
+{
+  size_t	arglen;			// Length of argument
+  char		*copyarg,		// Copy of input string
+		*ptr,			// Pointer into string
+		*dst,			// Pointer to end of unescaped value
+		*vend,			// Pointer to end of value, if closed by a brace
+		*name,			// Pointer to name
+		*value,			// Pointer to value
+		sep,			// Separator character
+		quote;			// Quote character
+  bool		brace;			// Is the argument in braces?
+
+
+  // Range check input...
+  if (end)
+    *end = NULL;
+
+  if (!set || !arg)
+    return (false);
+
+  // Make a copy of the argument string in the arena and then divide it up...
+  arglen = strlen(arg) + 1;
+
+  if ((copyarg = cups_optset_alloc(set, arglen)) == NULL)
+  {
+    DEBUG_puts("1cupsOptSetParse: Unable to copy arg string");
+    return (false);
+  }
+
+  memcpy(copyarg, arg, arglen);
+
+  if ((brace = *copyarg == '{') == true)
+    ptr = copyarg + 1;
+  else
+    ptr = copyarg;
+
+  // Skip leading spaces...
+  while (_cups_isspace(*ptr))
+    ptr ++;
+
+  // Loop through the string...
+  while (*ptr != '\0')
+  {
+    // Get the name up to a SPACE, =, or end-of-string...
+    name = ptr;
+    while (!strchr("\f\n\r\t\v =", *ptr) && *ptr)
+      ptr ++;
+
+    // Avoid an empty name...
+    if (ptr == name)
+      break;
+
+    // End after the closing brace...
+    if (*ptr == '}' && brace)
+    {
+      *ptr++ = '\0';
+      break;
+    }
+
+    // Skip trailing spaces...
+    while (_cups_isspace(*ptr))
+      *ptr++ = '\0';
+
+    if ((sep = *ptr) == '=')
+      *ptr++ = '\0';
+
+    if (sep != '=')
+    {
+      // Boolean option...
+      if (!_cups_strncasecmp(name, "no", 2))
+      {
+        if (!cups_optset_add(set, name + 2, "false"))
+          return (false);
+      }
+      else if (!cups_optset_add(set, name, "true"))
+        return (false);
+
+      continue;
+    }
+
+    // Remove = and parse the value, copying unescaped characters to "dst"...
+    value = dst = ptr;
+    vend  = NULL;
+
+    while (*ptr && !_cups_isspace(*ptr))
+    {
+      if (*ptr == ',')
+      {
+        *dst++ = *ptr++;
+      }
+      else if (*ptr == '\'' || *ptr == '\"')
+      {
+        // Quoted string constant...
+	quote = *ptr++;
+
+	while (*ptr != quote && *ptr)
+	{
+	  if (*ptr == '\\' && ptr[1])
+	    ptr ++;
+
+	  *dst++ = *ptr++;
+	}
+
+	if (*ptr)
+	  ptr ++;
+      }
+      else if (*ptr == '{')
+      {
+        // Collection value...
+	int depth;			// Nesting depth for braces
+
+	for (depth = 0; *ptr;)
+	{
+	  if (*ptr == '{')
+	  {
+	    depth ++;
+	  }
+	  else if (*ptr == '}')
+	  {
+	    depth --;
+	    if (!depth)
+	    {
+	      *dst++ = *ptr++;
+	      break;
+	    }
+	  }
+	  else if (*ptr == '\\' && ptr[1])
+	  {
+	    ptr ++;
+	  }
+
+	  *dst++ = *ptr++;
+	}
+      }
+      else
+      {
+        // Normal space-delimited string...
+	while (*ptr && !_cups_isspace(*ptr))
+	{
+	  if (*ptr == '}' && brace)
+	  {
+	    if (!vend)
+	      vend = dst;
+
+	    ptr ++;
+	    break;
+	  }
+
+	  if (*ptr == '\\' && ptr[1])
+	    ptr ++;
+
+	  *dst++ = *ptr++;
+	}
+      }
+    }
+
+    if (*ptr != '\0')
+      ptr ++;
+
+    *(vend ? vend : dst) = '\0';
+
+    // Skip trailing whitespace...
+    while (_cups_isspace(*ptr))
+      ptr ++;
+
+    // Add the string value...
+    if (!cups_optset_add(set, name, value))
+      return (false);
+  }
+
+  // Save the progress in the input string...
+  if (end)
+    *end = arg + (ptr - copyarg);
+
+  return (true);
+}
+
+
+//
+// 'cupsOptSetRemove()' - Remove an option from an option set.
+//
+
+bool					// O - `true` if removed, `false` if not found
+cupsOptSetRemove(cups_optset_t *set,	// I - Option set
+                 const char    *name)	// I - Name of option
+{
+  size_t	current;		// Matching option
+
+
+  // Range check input...
+  if (!set || !name || set->num_opts == 0)
+    return (false);
+
+  // Look up the option...
+  if ((current = cups_optset_find(set, name, cups_optset_hash(name), NULL)) == SIZE_MAX)
+    return (false);
+
+  // Remove it, preserving the order of the remaining options, and rebuild the
+  // hash table...
+  set->num_opts --;
+
+  if (current < set->num_opts)
+    memmove(set->opts + current, set->opts + current + 1, (set->num_opts - current) * sizeof(_cups_optval_t));
+
+  return (cups_optset_rehash(set, set->num_slots));
+}
+
 
 //
 // 'cupsParseOptions()' - Parse options from a command-line argument.
@@ -411,7 +885,16 @@ cupsRemoveOption(
     _cupsStrFree(option->value);
 
     if (i > 0)
+    {
       memmove(option, option + 1, i * sizeof(cups_option_t));
+    }
+    else if (num_options == 0)
+    {
+      // Free the array since cupsAddOption and cupsFreeOptions ignore it when
+      // there are no options...
+      free(*options);
+      *options = NULL;
+    }
   }
 
   // Return the new number of options...
@@ -488,3 +971,190 @@ cups_find_option(
 
   return (current);
 }
+
+
+//
+// 'cups_optset_add()' - Add an option whose name and value are already stored.
+//
+
+static bool				// O - `true` on success, `false` on failure
+cups_optset_add(cups_optset_t *set,	// I - Option set
+                const char    *name,	// I - Name of option
+                const char    *value)	// I - Value of option
+{
+  size_t		hash,		// Hash of name
+			slot,		// Hash table slot
+			current;	// Matching option
+  _cups_optval_t	*opt;		// New option
+
+
+  if (!*name)
+    return (true);
+
+  // Like cupsAddOption, only keep one of the print quality options...
+  if (!_cups_strcasecmp(name, "cupsPrintQuality"))
+    cupsOptSetRemove(set, "print-quality");
+  else if (!_cups_strcasecmp(name, "print-quality"))
+    cupsOptSetRemove(set, "cupsPrintQuality");
+
+  // Replace the value of an existing option...
+  hash = cups_optset_hash(name);
+
+  if (set->num_opts > 0 && (current = cups_optset_find(set, name, hash, &slot)) != SIZE_MAX)
+  {
+    set->opts[current].value = value;
+    return (true);
+  }
+
+  // Otherwise add a new option, keeping the hash table at most half full...
+  if (set->num_opts >= set->alloc_opts)
+  {
+    size_t		alloc = set->alloc_opts ? 2 * set->alloc_opts : 16;
+					// New allocation count
+    _cups_optval_t	*temp;		// New options
+
+    if ((temp = realloc(set->opts, alloc * sizeof(_cups_optval_t))) == NULL)
+      return (false);
+
+    set->opts       = temp;
+    set->alloc_opts = alloc;
+  }
+
+  if ((set->num_opts + 1) > (set->num_slots / 2) && !cups_optset_rehash(set, set->num_slots ? 2 * set->num_slots : 32))
+    return (false);
+
+  opt        = set->opts + set->num_opts;
+  opt->name  = name;
+  opt->value = value;
+  opt->hash  = hash;
+
+  for (slot = hash & (set->num_slots - 1); set->slots[slot] != SIZE_MAX; slot = (slot + 1) & (set->num_slots - 1));
+
+  set->slots[slot] = set->num_opts ++;
+
+  return (true);
+}
+
+
+//
+// 'cups_optset_alloc()' - Allocate memory from the option set arena.
+//
+
+static char *				// O - Memory or `NULL` on error
+cups_optset_alloc(cups_optset_t *set,	// I - Option set
+                  size_t        size)	// I - Number of bytes
+{
+  _cups_optbuf_t	*buf;		// Current block
+  char			*ptr;		// Pointer to memory
+
+
+  if ((buf = set->buf) == NULL || (buf->size - buf->used) < size)
+  {
+    // Allocate a new block that is at least twice as large as the current
+    // one, so that after cupsOptSetClear the set usually has enough room...
+    size_t	bufsize = buf ? 2 * buf->size : 1024;
+					// Size of new block
+
+    if (bufsize < size)
+      bufsize = size;
+
+    if ((buf = malloc(sizeof(_cups_optbuf_t) + bufsize)) == NULL)
+      return (NULL);
+
+    buf->prev = set->buf;
+    buf->size = bufsize;
+    buf->used = 0;
+    set->buf  = buf;
+  }
+
+  ptr       = buf->data + buf->used;
+  buf->used += size;
+
+  return (ptr);
+}
+
+
+//
+// 'cups_optset_find()' - Find an option in the hash table.
+//
+
+static size_t				// O - Index of option or `SIZE_MAX` if not found
+cups_optset_find(cups_optset_t *set,	// I - Option set
+                 const char    *name,	// I - Name of option
+                 size_t        hash,	// I - Hash of name
+                 size_t        *rslot)	// O - Hash table slot or `NULL`
+{
+  size_t	slot,			// Current slot
+		current;		// Current option
+
+
+  for (slot = hash & (set->num_slots - 1); (current = set->slots[slot]) != SIZE_MAX; slot = (slot + 1) & (set->num_slots - 1))
+  {
+    if (set->opts[current].hash == hash && !_cups_strcasecmp(name, set->opts[current].name))
+      break;
+  }
+
+  if (rslot)
+    *rslot = slot;
+
+  return (current);
+}
+
+
+//
+// 'cups_optset_hash()' - Compute the case-insensitive hash of an option name.
+//
+
+static size_t				// O - Hash value
+cups_optset_hash(const char *name)	// I - Name of option
+{
+  size_t	hash = 2166136261U;	// FNV-1a hash
+
+
+  while (*name)
+  {
+    hash ^= (size_t)_cups_tolower(*name++ & 255);
+    hash *= 16777619U;
+  }
+
+  return (hash);
+}
+
+
+//
+// 'cups_optset_rehash()' - Rebuild the option set hash table.
+//
+
+static bool				// O - `true` on success, `false` on failure
+cups_optset_rehash(cups_optset_t *set,	// I - Option set
+                   size_t        num_slots)
+					// I - Number of slots (power of 2)
+{
+  size_t	i,			// Looping var
+		slot;			// Hash table slot
+
+
+  if (num_slots != set->num_slots)
+  {
+    size_t	*slots;			// New hash table
+
+    if ((slots = malloc(num_slots * sizeof(size_t))) == NULL)
+      return (false);
+
+    free(set->slots);
+
+    set->slots     = slots;
+    set->num_slots = num_slots;
+  }
+
+  memset(set->slots, 0xff, set->num_slots * sizeof(size_t));
+
+  for (i = 0; i < set->num_opts; i ++)
+  {
+    for (slot = set->opts[i].hash & (set->num_slots - 1); set->slots[slot] != SIZE_MAX; slot = (slot + 1) & (set->num_slots - 1));
+
+    set->slots[slot] = i;
+  }
+
+  return (true);
+}
@@ -13,6 +13,7 @@
 #  define _CUPS_RASTER_PRIVATE_H_
 #  include "raster.h"
 #  include "cups.h"
+#  include "thread.h"
 #  include "debug-private.h"
 #  include "string-private.h"
 #  ifdef _WIN32
@@ -28,9 +29,38 @@ extern "C" {
 
 
 //
-// Structure...
+// Structures...
 //
 
+typedef enum _cups_raster_bstate_e	// Band states
+{
+  _CUPS_RASTER_BAND_EMPTY,		// Empty or being filled
+  _CUPS_RASTER_BAND_QUEUED,		// Waiting for a compression thread
+  _CUPS_RASTER_BAND_ENCODING,		// Being compressed
+  _CUPS_RASTER_BAND_DONE		// Compressed and ready to write
+} _cups_raster_bstate_t;
+
+typedef struct _cups_raster_band_s	// Band of rows for threaded compression
+{
+  _cups_raster_bstate_t	state;		// Current state
+  unsigned		num_rows,	// Number of rows in band
+			max_rows,	// Maximum number of rows
+			*counts;	// Repeat count for each row
+  unsigned char		*pixels,	// Pixels for each row
+			*output;	// Compressed data
+  size_t		pixsize,	// Size of pixel buffer
+			outsize,	// Size of compressed data buffer
+			outused;	// Bytes of compressed data
+} _cups_raster_band_t;
+
+typedef struct _cups_raster_map_s	// Raster file data for random access
+{
+  unsigned char		*data;		// File data
+  size_t		size,		// Size of file data
+			pos;		// Current read position
+  bool			mapped;		// Mapped with mmap()?
+} _cups_raster_map_t;
+
 struct _cups_raster_s			// Raster stream data
 {
   unsigned		sync;		// Sync word from start of stream
@@ -47,6 +77,7 @@ struct _cups_raster_s			// Raster stream data
 			*pcurrent;	// Current byte in pixel buffer
   int			compressed,	// Non-zero if data is compressed
 			swapped;	// Non-zero if data is byte-swapped
+  bool			scalar;		// Only use scalar (non-SIMD) code?
   unsigned char		*buffer,	// Read/write buffer
 			*bufptr,	// Current (read) position in buffer
 			*bufend;	// End of current (read) buffer
@@ -56,6 +87,18 @@ struct _cups_raster_s			// Raster stream data
 			iocount;	// Number of bytes read/written
 #  endif // DEBUG
   unsigned		apple_page_count;// Apple raster page count
+  size_t		num_threads;	// Number of compression threads
+  cups_thread_t		*threads;	// Compression threads
+  cups_mutex_t		band_mutex;	// Mutex for bands
+  cups_cond_t		band_cond;	// Condition for band state changes
+  bool			band_stop;	// Stop compression threads?
+  size_t		num_bands,	// Number of bands
+			fill_band,	// Band being filled
+			write_band;	// Next band to write
+  _cups_raster_band_t	*bands;		// Bands of rows
+  _cups_raster_map_t	*map;		// Raster file data, if any
+  size_t		num_pages;	// Number of pages in index
+  size_t		*pages;		// Offset of each page header
 };
 
 
@@ -67,6 +110,7 @@ extern void		_cupsRasterAddError(const char *f, ...) _CUPS_FORMAT(1,2) _CUPS_PRI
 extern void		_cupsRasterClearError(void) _CUPS_PRIVATE;
 extern const char	*_cupsRasterColorSpaceString(cups_cspace_t cspace) _CUPS_PRIVATE;
 extern cups_raster_t	*_cupsRasterNew(cups_raster_cb_t iocb, void *ctx, cups_raster_mode_t mode) _CUPS_PRIVATE;
+extern void		_cupsRasterSetScalar(cups_raster_t *r, bool scalar) _CUPS_PRIVATE;
 
 #  ifdef __cplusplus
 }
@@ -11,6 +11,17 @@
 
 #include "raster-private.h"
 #include "debug-internal.h"
+#include <sys/stat.h>
+#ifndef _WIN32
+#  include <sys/mman.h>
+#endif // !_WIN32
+#ifndef O_BINARY
+#  define O_BINARY 0
+#endif // !O_BINARY
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#  define _CUPS_RASTER_SIMD 1		// Use SSE2/AVX2 run detection
+#endif // __GNUC__ && (__x86_64__ || __i386__)
 
 
 //
@@ -20,6 +31,10 @@
 #define _CUPS_MAX_BYTES_PER_LINE	(16 * 1024 * 1024)
 #define _CUPS_MAX_BITS_PER_COLOR	16
 #define _CUPS_MAX_BITS_PER_PIXEL	240
+#define _CUPS_MAX_THREADS		64
+#define _CUPS_BAND_BYTES		(1024 * 1024)
+#define _CUPS_BAND_ROWS			256
+#define _CUPS_INDEX_HEADER		"CUPS-RASTER-INDEX 1"
 
 
 //
@@ -27,6 +42,8 @@
 //
 
 typedef void (*_cups_copyfunc_t)(void *dst, const void *src, size_t bytes);
+typedef uint64_t (*_cups_eqmask_t)(const unsigned char *ptr, unsigned bpp);
+					// Pixel comparison kernel
 
 
 //
@@ -51,6 +68,21 @@ static const char * const apple_media_types[] =
   "other"
 };
 
+#ifdef _CUPS_RASTER_SIMD
+static const uint64_t	cups_pixel_starts[9] =
+{					// First byte of each pixel in a 64-byte block
+  0,
+  0xffffffffffffffffULL,
+  0x5555555555555555ULL,
+  0x1249249249249249ULL,
+  0x1111111111111111ULL,
+  0x0084210842108421ULL,
+  0x0041041041041041ULL,
+  0x0102040810204081ULL,
+  0x0101010101010101ULL
+};
+#endif // _CUPS_RASTER_SIMD
+
 #ifdef DEBUG
 static const char * const cups_modes[] =
 {					// Open modes
@@ -67,13 +99,39 @@ static const char * const cups_modes[] =
 // Local functions...
 //
 
+static ssize_t	cups_raster_band_add(cups_raster_t *r, const unsigned char *pixels);
+static bool	cups_raster_band_flush(cups_raster_t *r);
+static void	cups_raster_band_stop(cups_raster_t *r);
+static void	*cups_raster_band_thread(cups_raster_t *r);
+static bool	cups_raster_band_write(cups_raster_t *r, _cups_raster_band_t *until);
+static size_t	cups_raster_encode(cups_raster_t *r, unsigned rcount, const unsigned char *pixels, unsigned char *buffer);
+#ifdef _CUPS_RASTER_SIMD
+static uint64_t	cups_raster_eqmask_avx2(const unsigned char *ptr, unsigned bpp);
+static uint64_t	cups_raster_eqmask_sse2(const unsigned char *ptr, unsigned bpp);
+#endif // _CUPS_RASTER_SIMD
+#ifdef _CUPS_RASTER_SIMD
+static void	cups_raster_fill_sse2(unsigned char *dst, unsigned bpp, size_t bytes);
+#endif // _CUPS_RASTER_SIMD
+static void	cups_raster_fill(cups_raster_t *r, unsigned char *dst, size_t bytes);
+static bool	cups_raster_index(cups_raster_t *r);
+static bool	cups_raster_index_load(cups_raster_t *r, const char *indexfile, struct stat *fileinfo);
+static void	cups_raster_index_save(cups_raster_t *r, const char *indexfile, struct stat *fileinfo);
 static ssize_t	cups_raster_io(cups_raster_t *r, unsigned char *buf, size_t bytes);
 static ssize_t	cups_raster_read(cups_raster_t *r, unsigned char *buf, size_t bytes);
+static ssize_t	cups_raster_refill(cups_raster_t *r);
+static unsigned char *cups_raster_skip_row(unsigned char *ptr, unsigned char *end, unsigned bpl, unsigned bpp);
+static unsigned	cups_raster_span(_cups_eqmask_t eqmask, const unsigned char *ptr, const unsigned char *pend, unsigned bpp, bool same, unsigned max);
+static void	cups_raster_unmap(_cups_raster_map_t *map);
 static bool	cups_raster_update(cups_raster_t *r);
 static ssize_t	cups_raster_write(cups_raster_t *r, const unsigned char *pixels);
 static ssize_t	cups_read_fd(void *ctx, unsigned char *buf, size_t bytes);
+static ssize_t	cups_read_map(void *ctx, unsigned char *buf, size_t bytes);
 static void	cups_swap(unsigned char *buf, size_t bytes);
 static void	cups_swap_copy(unsigned char *dst, const unsigned char *src, size_t bytes);
+#ifdef _CUPS_RASTER_SIMD
+static void	cups_swap_copy_sse2(unsigned char *dst, const unsigned char *src, size_t bytes);
+static void	cups_swap_sse2(unsigned char *buf, size_t bytes);
+#endif // _CUPS_RASTER_SIMD
 static ssize_t	cups_write_fd(void *ctx, unsigned char *buf, size_t bytes);
 
 
@@ -172,13 +230,128 @@ cupsRasterClose(cups_raster_t *r)	// I - Stream to free
 {
   if (r != NULL)
   {
+    if (r->num_threads > 1)
+      cupsRasterSetThreads(r, 1);
+
+    if (r->map)
+      cups_raster_unmap(r->map);
+
     free(r->buffer);
     free(r->pixels);
+    free(r->pages);
     free(r);
   }
 }
 
 
+//
+// 'cupsRasterCopyPage()' - Copy a page from one raster stream to another.
+//
+// This function reads the next page header from the input stream, writes it
+// to the output stream, and copies the page data.  When both streams are
+// compressed and store pixels in the same byte order, the compressed data is
+// copied as-is and only the page header is converted to the output format,
+// for example from PWG Raster to Apple Raster.  Otherwise each line is decoded
+// and compressed again.
+//
+
+bool					// O - `true` on success, `false` on end of input or error
+cupsRasterCopyPage(
+    cups_raster_t *in,			// I - Input raster stream
+    cups_raster_t *out)			// I - Output raster stream
+{
+  cups_page_header_t	header;		// Page header
+  unsigned		bpl,		// Bytes per line
+			rows,		// Rows remaining
+			count;		// Row repeat count
+  unsigned char		*start,		// Start of complete rows
+			*ptr,		// Pointer into read buffer
+			*next;		// Next row
+
+
+  DEBUG_printf("cupsRasterCopyPage(in=%p, out=%p)", (void *)in, (void *)out);
+
+  if (!in || in->mode != CUPS_RASTER_READ || !out || out->mode == CUPS_RASTER_READ)
+    return (false);
+
+  if (!cupsRasterReadHeader(in, &header) || !cupsRasterWriteHeader(out, &header))
+    return (false);
+
+  bpl = header.cupsBytesPerLine;
+
+  if (!in->compressed || !out->compressed || out->rowheight != 1 || (in->swapped != out->swapped && (header.cupsBitsPerColor == 16 || header.cupsBitsPerPixel == 12 || header.cupsBitsPerPixel == 16)))
+  {
+    // Decode and compress each line...
+    unsigned char	*line;		// Line buffer
+    bool		ret = true;	// Return value
+
+    DEBUG_puts("1cupsRasterCopyPage: Decoding page.");
+
+    if ((line = malloc(bpl)) == NULL)
+    {
+      _cupsRasterAddError("Unable to allocate %u bytes for raster line: %s", bpl, strerror(errno));
+      return (false);
+    }
+
+    while (ret && in->remaining > 0)
+      ret = cupsRasterReadPixels(in, line, bpl) && cupsRasterWritePixels(out, line, bpl);
+
+    free(line);
+
+    return (ret);
+  }
+
+  // Copy complete compressed rows from the read buffer to the output...
+  DEBUG_puts("1cupsRasterCopyPage: Copying compressed page data.");
+
+  for (rows = in->remaining; rows > 0;)
+  {
+    for (start = ptr = in->bufptr; rows > 0 && (next = cups_raster_skip_row(ptr, in->bufend, bpl, in->bpp)) != NULL; ptr = next)
+    {
+      count = (unsigned)*ptr + 1;
+      rows  -= count < rows ? count : rows;
+    }
+
+    if (ptr > start)
+    {
+      if (cups_raster_io(out, start, (size_t)(ptr - start)) < (ssize_t)(ptr - start))
+        return (false);
+
+      in->bufptr = ptr;
+    }
+
+    if (rows > 0 && cups_raster_refill(in) <= 0)
+    {
+      _cupsRasterAddError("Unexpected end of raster data.");
+      return (false);
+    }
+  }
+
+  in->count      = 0;
+  in->remaining  = 0;
+  out->count     = 0;
+  out->remaining = 0;
+  out->pcurrent  = out->pixels;
+
+  return (true);
+}
+
+
+//
+// 'cupsRasterGetPageCount()' - Get the number of pages in a raster file.
+//
+// This function returns the number of pages in a raster file opened with the
+// @link cupsRasterOpenFile@ function.  `0` is returned for other streams.
+//
+
+size_t					// O - Number of pages
+cupsRasterGetPageCount(
+    cups_raster_t *r)			// I - Raster stream
+{
+  return (r ? r->num_pages : 0);
+}
+
+
 //
 // 'cupsRasterInitHeader()' - Initialize a page header for PWG Raster output.
 //
@@ -683,6 +856,153 @@ cupsRasterOpen(int                fd,	// I - File descriptor
 }
 
 
+//
+// 'cupsRasterOpenFile()' - Open a raster file for random page access.
+//
+// This function opens a raster file for reading and builds an index of its
+// pages so that they can be read in any order using the
+// @link cupsRasterSeekPage@ function.  Regular files are mapped into memory
+// when possible, and the index is built by skipping over the compressed page
+// data without decoding it.
+//
+// The "indexfile" argument specifies an optional file that caches the page
+// index.  The cached index is used when the size and modification time of the
+// raster file match, otherwise the index is rebuilt and saved to the file.
+// Pass `NULL` to always build the index.
+//
+// The stream is positioned at the first page.
+//
+
+cups_raster_t *				// O - New stream or `NULL` on error
+cupsRasterOpenFile(
+    const char *filename,		// I - Raster filename
+    const char *indexfile)		// I - Page index filename or `NULL` for none
+{
+  int			fd;		// File descriptor
+  struct stat		fileinfo;	// File information
+  _cups_raster_map_t	*map;		// Raster file data
+  cups_raster_t		*r;		// New stream
+
+
+  DEBUG_printf("cupsRasterOpenFile(filename=\"%s\", indexfile=\"%s\")", filename, indexfile);
+
+  _cupsRasterClearError();
+
+  if (!filename)
+    return (NULL);
+
+  // Open the file...
+  if ((fd = open(filename, O_RDONLY | O_BINARY)) < 0)
+  {
+    _cupsRasterAddError("Unable to open \"%s\": %s", filename, strerror(errno));
+    return (NULL);
+  }
+  else if (fstat(fd, &fileinfo))
+  {
+    _cupsRasterAddError("Unable to get information on \"%s\": %s", filename, strerror(errno));
+    close(fd);
+    return (NULL);
+  }
+
+  if ((map = calloc(1, sizeof(_cups_raster_map_t))) == NULL)
+  {
+    _cupsRasterAddError("Unable to allocate memory for raster file: %s", strerror(errno));
+    close(fd);
+    return (NULL);
+  }
+
+#ifndef _WIN32
+  // Map regular files into memory...
+  if (S_ISREG(fileinfo.st_mode) && fileinfo.st_size > 0 && (map->data = mmap(NULL, (size_t)fileinfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) != MAP_FAILED)
+  {
+    map->size   = (size_t)fileinfo.st_size;
+    map->mapped = true;
+  }
+  else
+#endif // !_WIN32
+  {
+    // Otherwise read the whole file into memory...
+    size_t		alloc = 0;	// Allocated bytes
+    unsigned char	*data;		// New file data
+    ssize_t		bytes = -1;	// Bytes read
+
+    map->data = NULL;
+
+    for (;;)
+    {
+      if (map->size >= alloc)
+      {
+        alloc = alloc ? 2 * alloc : (size_t)fileinfo.st_size + 65536;
+
+        if ((data = realloc(map->data, alloc)) == NULL)
+        {
+	  _cupsRasterAddError("Unable to allocate memory for raster file: %s", strerror(errno));
+	  break;
+        }
+
+        map->data = data;
+      }
+
+#ifdef _WIN32 // Sigh
+      if ((bytes = read(fd, map->data + map->size, (unsigned)(alloc - map->size))) < 0)
+#else
+      if ((bytes = read(fd, map->data + map->size, alloc - map->size)) < 0)
+#endif // _WIN32
+      {
+        if (errno == EINTR || errno == EAGAIN)
+          continue;
+
+        _cupsRasterAddError("Unable to read \"%s\": %s", filename, strerror(errno));
+        break;
+      }
+      else if (bytes == 0)
+      {
+        break;
+      }
+
+      map->size += (size_t)bytes;
+    }
+
+    if (bytes != 0)
+    {
+      cups_raster_unmap(map);
+      close(fd);
+      return (NULL);
+    }
+  }
+
+  close(fd);
+
+  // Open the stream and index the pages...
+  if ((r = _cupsRasterNew(cups_read_map, map, CUPS_RASTER_READ)) == NULL)
+  {
+    cups_raster_unmap(map);
+    return (NULL);
+  }
+
+  r->map = map;
+
+  if (!indexfile || !cups_raster_index_load(r, indexfile, &fileinfo))
+  {
+    if (!cups_raster_index(r))
+    {
+      cupsRasterClose(r);
+      return (NULL);
+    }
+
+    if (indexfile)
+      cups_raster_index_save(r, indexfile, &fileinfo);
+  }
+
+  if (r->num_pages > 0)
+    cupsRasterSeekPage(r, 1);
+
+  DEBUG_printf("1cupsRasterOpenFile: num_pages=%u, returning %p", (unsigned)r->num_pages, (void *)r);
+
+  return (r);
+}
+
+
 //
 // 'cupsRasterOpenIO()' - Open a raster stream using a callback function.
 //
@@ -898,7 +1218,14 @@ cupsRasterReadPixels(
 
     // Swap bytes as needed...
     if (r->swapped && (r->header.cupsBitsPerColor == 16 || r->header.cupsBitsPerPixel == 12 || r->header.cupsBitsPerPixel == 16))
+    {
+#ifdef _CUPS_RASTER_SIMD
+      if (!r->scalar && __builtin_cpu_supports("sse2"))
+        cups_swap_sse2(p, len);
+      else
+#endif // _CUPS_RASTER_SIMD
       cups_swap(p, len);
+    }
 
     // Return...
     DEBUG_printf("1cupsRasterReadPixels: Returning %u", len);
@@ -938,7 +1265,9 @@ cupsRasterReadPixels(
       while (bytes > 0)
       {
         // Get a new repeat count...
-        if (!cups_raster_read(r, &byte, 1))
+        if (r->bufptr < r->bufend)
+          byte = *(r->bufptr)++;
+        else if (!cups_raster_read(r, &byte, 1))
 	{
 	  DEBUG_puts("1cupsRasterReadPixels: Read error, returning 0.");
 	  return (0);
@@ -973,7 +1302,13 @@ cupsRasterReadPixels(
           if (count > (unsigned)bytes)
 	    count = (unsigned)bytes;
 
-          if (!cups_raster_read(r, temp, count))
+          if ((size_t)(r->bufend - r->bufptr) >= count)
+          {
+            // Copy directly from the read buffer...
+            memcpy(temp, r->bufptr, count);
+            r->bufptr += count;
+          }
+          else if (!cups_raster_read(r, temp, count))
 	  {
 	    DEBUG_puts("1cupsRasterReadPixels: Read error, returning 0.");
 	    return (0);
@@ -994,7 +1329,12 @@ cupsRasterReadPixels(
 
 	  bytes -= (ssize_t)count;
 
-          if (!cups_raster_read(r, temp, r->bpp))
+          if ((size_t)(r->bufend - r->bufptr) >= r->bpp)
+          {
+            memcpy(temp, r->bufptr, r->bpp);
+            r->bufptr += r->bpp;
+          }
+          else if (!cups_raster_read(r, temp, r->bpp))
 	  {
 	    DEBUG_puts("1cupsRasterReadPixels: Read error, returning 0.");
 	    return (0);
@@ -1003,12 +1343,20 @@ cupsRasterReadPixels(
 	  temp  += r->bpp;
 	  count -= r->bpp;
 
-	  while (count > 0)
+          if (r->scalar)
+          {
+	    while (count > 0)
+	    {
+	      memcpy(temp, temp - r->bpp, r->bpp);
+	      temp  += r->bpp;
+	      count -= r->bpp;
+            }
+	  }
+	  else
 	  {
-	    memcpy(temp, temp - r->bpp, r->bpp);
-	    temp  += r->bpp;
-	    count -= r->bpp;
-          }
+	    cups_raster_fill(r, temp, count);
+	    temp += count;
+	  }
 	}
       }
 
@@ -1016,6 +1364,11 @@ cupsRasterReadPixels(
       if ((r->header.cupsBitsPerColor == 16 || r->header.cupsBitsPerPixel == 12 || r->header.cupsBitsPerPixel == 16) && r->swapped)
       {
         DEBUG_puts("1cupsRasterReadPixels: Swapping bytes.");
+#ifdef _CUPS_RASTER_SIMD
+        if (!r->scalar && __builtin_cpu_supports("sse2"))
+          cups_swap_sse2(ptr, (size_t)cupsBytesPerLine);
+        else
+#endif // _CUPS_RASTER_SIMD
         cups_swap(ptr, (size_t)cupsBytesPerLine);
       }
 
@@ -1064,6 +1417,140 @@ cupsRasterReadPixels(
 }
 
 
+//
+// 'cupsRasterSeekPage()' - Position a raster file at the start of a page.
+//
+// This function positions a raster file opened with the
+// @link cupsRasterOpenFile@ function at the start of the specified page.
+// Pages are numbered starting at 1.  Use the @link cupsRasterReadHeader@ and
+// @link cupsRasterReadPixels@ functions to read the page.
+//
+
+bool					// O - `true` on success, `false` on error
+cupsRasterSeekPage(cups_raster_t *r,	// I - Raster stream
+                   size_t        page)	// I - Page number (1-based)
+{
+  DEBUG_printf("cupsRasterSeekPage(r=%p, page=%u)", (void *)r, (unsigned)page);
+
+  if (!r || !r->map || page < 1 || page > r->num_pages)
+    return (false);
+
+  // Move to the page header and discard any buffered data...
+  r->map->pos  = r->pages[page - 1];
+  r->bufptr    = r->buffer;
+  r->bufend    = r->buffer;
+  r->pcurrent  = r->pixels;
+  r->count     = 0;
+  r->remaining = 0;
+
+  return (true);
+}
+
+
+//
+// '_cupsRasterSetScalar()' - Enable or disable the SIMD code paths for a stream.
+//
+// This is used by the unit tests to compare the SIMD and scalar results.
+//
+
+void
+_cupsRasterSetScalar(
+    cups_raster_t *r,			// I - Raster stream
+    bool          scalar)		// I - `true` to only use scalar code
+{
+  if (r)
+    r->scalar = scalar;
+}
+
+
+//
+// 'cupsRasterSetThreads()' - Set the number of threads used to compress pages.
+//
+// By default rows are compressed on the calling thread as they are written.
+// When "num_threads" is greater than 1, rows are collected into bands that are
+// compressed by a pool of threads and written in order, which can speed up
+// the output of large pages on multi-core systems.  The compressed data is
+// identical in both cases.
+//
+// Compressed rows are written from the calling thread during later calls to
+// @link cupsRasterWritePixels@, at the end of each page, and when the stream
+// is closed, so write errors may be reported after the fact.
+//
+// This function only applies to compressed output streams.
+//
+
+bool					// O - `true` on success, `false` on error
+cupsRasterSetThreads(
+    cups_raster_t *r,			// I - Raster stream
+    size_t        num_threads)		// I - Number of threads (`0` or `1` for none)
+{
+  size_t	i;			// Looping var
+  bool		ret = true;		// Return value
+
+
+  DEBUG_printf("cupsRasterSetThreads(r=%p, num_threads=%u)", (void *)r, (unsigned)num_threads);
+
+  if (!r || r->mode == CUPS_RASTER_READ)
+    return (false);
+
+  if (num_threads > _CUPS_MAX_THREADS)
+    num_threads = _CUPS_MAX_THREADS;
+  else if (num_threads < 1)
+    num_threads = 1;
+
+  if (num_threads == r->num_threads || (num_threads == 1 && r->num_threads == 0))
+    return (true);
+
+  if (r->num_threads > 1)
+  {
+    // Write any pending rows and stop the current threads...
+    ret = cups_raster_band_flush(r);
+
+    cups_raster_band_stop(r);
+  }
+
+  if (num_threads < 2 || !r->compressed)
+    return (ret);
+
+  // Start the new threads, with two bands per thread so that rows can be
+  // collected while other bands are compressed...
+  if ((r->bands = calloc(2 * num_threads, sizeof(_cups_raster_band_t))) == NULL || (r->threads = calloc(num_threads, sizeof(cups_thread_t))) == NULL)
+  {
+    _cupsRasterAddError("Unable to allocate memory for raster threads: %s", strerror(errno));
+    free(r->bands);
+    r->bands = NULL;
+    return (false);
+  }
+
+  cupsMutexInit(&r->band_mutex);
+  cupsCondInit(&r->band_cond);
+
+  r->band_stop  = false;
+  r->num_bands  = 2 * num_threads;
+  r->fill_band  = 0;
+  r->write_band = 0;
+
+  for (i = 0; i < num_threads; i ++)
+  {
+    if ((r->threads[i] = cupsThreadCreate((cups_thread_func_t)cups_raster_band_thread, r)) == CUPS_THREAD_INVALID)
+      break;
+  }
+
+  r->num_threads = i;
+
+  if (i < 2)
+  {
+    // Unable to create enough threads, go back to compressing on the calling
+    // thread...
+    _cupsRasterAddError("Unable to create raster threads: %s", strerror(errno));
+    cups_raster_band_stop(r);
+    return (false);
+  }
+
+  return (ret);
+}
+
+
 //
 // '_cupsRasterWriteHeader()' - Write a raster page header.
 //
@@ -1078,6 +1565,10 @@ cupsRasterWriteHeader(
   if (r == NULL || r->mode == CUPS_RASTER_READ)
     return (false);
 
+  // Finish writing any rows from the previous page...
+  if (r->num_threads > 1 && !cups_raster_band_flush(r))
+    return (false);
+
   DEBUG_printf("1cupsRasterWriteHeader: cupsColorSpace=%s", _cupsRasterColorSpaceString(r->header.cupsColorSpace));
   DEBUG_printf("1cupsRasterWriteHeader: cupsBitsPerColor=%u", r->header.cupsBitsPerColor);
   DEBUG_printf("1cupsRasterWriteHeader: cupsBitsPerPixel=%u", r->header.cupsBitsPerPixel);
@@ -1374,54 +1865,801 @@ cupsRasterWritePixels(
 
 
 //
-// 'cups_raster_io()' - Read/write bytes from a context, handling interruptions.
+// 'cups_raster_band_add()' - Add a row to the current band.
+//
+// The band is queued for compression when it is full or the page is
+// complete, and any finished bands are written.
 //
 
-static ssize_t				// O - Bytes read/write or -1
-cups_raster_io(cups_raster_t *r,	// I - Raster stream
-               unsigned char *buf,	// I - Buffer for read/write
-               size_t        bytes)	// I - Number of bytes to read/write
+static ssize_t				// O - 1 on success, -1 on error
+cups_raster_band_add(
+    cups_raster_t       *r,		// I - Raster stream
+    const unsigned char *pixels)	// I - Pixel data to write
 {
-  ssize_t	count,			// Number of bytes read/written
-		total;			// Total bytes read/written
+  _cups_raster_band_t	*band = r->bands + r->fill_band;
+					// Current band
+  size_t		bpl = r->header.cupsBytesPerLine;
+					// Bytes per line
+  bool			ret = true;	// Return value
 
 
-  DEBUG_printf("5cups_raster_io(r=%p, buf=%p, bytes=" CUPS_LLFMT ")", (void *)r, (void *)buf, CUPS_LLCAST bytes);
-
-  for (total = 0; total < (ssize_t)bytes; total += count, buf += count)
+  if (band->num_rows == 0)
   {
-    count = (*r->iocb)(r->ctx, buf, bytes - (size_t)total);
-
-    DEBUG_printf("6cups_raster_io: count=%d, total=%d", (int)count, (int)total);
-    if (count == 0)
+    // Size the band for the current page...
+    band->max_rows = (unsigned)(_CUPS_BAND_BYTES / bpl);
+    if (band->max_rows < 1)
+      band->max_rows = 1;
+    else if (band->max_rows > _CUPS_BAND_ROWS)
+      band->max_rows = _CUPS_BAND_ROWS;
+
+    if (!band->counts && (band->counts = calloc(_CUPS_BAND_ROWS, sizeof(unsigned))) == NULL)
     {
-      break;
+      _cupsRasterAddError("Unable to allocate memory for raster band: %s", strerror(errno));
+      return (-1);
     }
-    else if (count < 0)
+
+    if ((band->max_rows * bpl) > band->pixsize)
     {
-      _cupsRasterAddError("I/O error");
-      DEBUG_puts("6cups_raster_io: Returning -1 on error.");
-      return (-1);
+      unsigned char *pixbuf;		// New pixel buffer
+
+      if ((pixbuf = realloc(band->pixels, band->max_rows * bpl)) == NULL)
+      {
+        _cupsRasterAddError("Unable to allocate memory for raster band: %s", strerror(errno));
+        return (-1);
+      }
+
+      band->pixels  = pixbuf;
+      band->pixsize = band->max_rows * bpl;
     }
 
-#ifdef DEBUG
-    r->iocount += (size_t)count;
-#endif // DEBUG
+    if ((band->max_rows * (2 * bpl + 2)) > band->outsize)
+    {
+      unsigned char *outbuf;		// New output buffer
+
+      if ((outbuf = realloc(band->output, band->max_rows * (2 * bpl + 2))) == NULL)
+      {
+        _cupsRasterAddError("Unable to allocate memory for raster band: %s", strerror(errno));
+        return (-1);
+      }
+
+      band->output  = outbuf;
+      band->outsize = band->max_rows * (2 * bpl + 2);
+    }
   }
 
-  DEBUG_printf("6cups_raster_io: iocount=" CUPS_LLFMT, CUPS_LLCAST r->iocount);
-  DEBUG_printf("6cups_raster_io: Returning " CUPS_LLFMT ".", CUPS_LLCAST total);
+  // Copy the row and its repeat count...
+  memcpy(band->pixels + band->num_rows * bpl, pixels, bpl);
+  band->counts[band->num_rows ++] = r->count;
 
-  return (total);
-}
+  if (band->num_rows < band->max_rows && r->remaining > 0)
+    return (1);
 
+  // Queue the band for compression...
+  cupsMutexLock(&r->band_mutex);
+  band->state = _CUPS_RASTER_BAND_QUEUED;
+  cupsCondBroadcast(&r->band_cond);
+  cupsMutexUnlock(&r->band_mutex);
 
-//
-// 'cups_raster_read()' - Read through the raster buffer.
-//
+  r->fill_band = (r->fill_band + 1) % r->num_bands;
 
-static ssize_t				// O - Number of bytes read
-cups_raster_read(cups_raster_t *r,	// I - Raster stream
+  if (r->remaining == 0)
+  {
+    // Write the rest of the page...
+    ret = cups_raster_band_write(r, band);
+  }
+  else
+  {
+    // Write finished bands, waiting for the next band to become available...
+    ret = cups_raster_band_write(r, r->bands + r->fill_band);
+  }
+
+  return (ret ? 1 : -1);
+}
+
+
+//
+// 'cups_raster_band_flush()' - Compress and write all pending rows.
+//
+
+static bool				// O - `true` on success, `false` on error
+cups_raster_band_flush(cups_raster_t *r)// I - Raster stream
+{
+  _cups_raster_band_t	*band = r->bands + r->fill_band;
+					// Current band
+
+
+  if (band->num_rows > 0)
+  {
+    // Queue the partial band...
+    cupsMutexLock(&r->band_mutex);
+    band->state = _CUPS_RASTER_BAND_QUEUED;
+    cupsCondBroadcast(&r->band_cond);
+    cupsMutexUnlock(&r->band_mutex);
+
+    r->fill_band = (r->fill_band + 1) % r->num_bands;
+  }
+
+  // Wait for the most recently queued band to be written...
+  return (cups_raster_band_write(r, r->bands + (r->fill_band + r->num_bands - 1) % r->num_bands));
+}
+
+
+//
+// 'cups_raster_band_stop()' - Stop the compression threads and free the bands.
+//
+
+static void
+cups_raster_band_stop(cups_raster_t *r)	// I - Raster stream
+{
+  size_t	i;			// Looping var
+
+
+  cupsMutexLock(&r->band_mutex);
+  r->band_stop = true;
+  cupsCondBroadcast(&r->band_cond);
+  cupsMutexUnlock(&r->band_mutex);
+
+  for (i = 0; i < r->num_threads; i ++)
+    cupsThreadWait(r->threads[i]);
+
+  for (i = 0; i < r->num_bands; i ++)
+  {
+    free(r->bands[i].counts);
+    free(r->bands[i].pixels);
+    free(r->bands[i].output);
+  }
+
+  free(r->bands);
+  free(r->threads);
+  cupsCondDestroy(&r->band_cond);
+  cupsMutexDestroy(&r->band_mutex);
+
+  r->bands       = NULL;
+  r->threads     = NULL;
+  r->num_bands   = 0;
+  r->num_threads = 0;
+}
+
+
+//
+// 'cups_raster_band_thread()' - Compress bands of rows.
+//
+
+static void *				// O - Thread exit status
+cups_raster_band_thread(
+    cups_raster_t *r)			// I - Raster stream
+{
+  size_t		i;		// Looping var
+  unsigned		row;		// Current row
+  size_t		bpl;		// Bytes per line
+  _cups_raster_band_t	*band;		// Current band
+
+
+  cupsMutexLock(&r->band_mutex);
+
+  while (!r->band_stop)
+  {
+    // Find the oldest queued band...
+    for (i = 0, band = NULL; i < r->num_bands; i ++)
+    {
+      band = r->bands + (r->write_band + i) % r->num_bands;
+
+      if (band->state == _CUPS_RASTER_BAND_QUEUED)
+        break;
+    }
+
+    if (i >= r->num_bands)
+    {
+      cupsCondWait(&r->band_cond, &r->band_mutex, 0.0);
+      continue;
+    }
+
+    band->state = _CUPS_RASTER_BAND_ENCODING;
+    cupsMutexUnlock(&r->band_mutex);
+
+    // Compress the rows...
+    bpl           = r->header.cupsBytesPerLine;
+    band->outused = 0;
+
+    for (row = 0; row < band->num_rows; row ++)
+      band->outused += cups_raster_encode(r, band->counts[row], band->pixels + row * bpl, band->output + band->outused);
+
+    cupsMutexLock(&r->band_mutex);
+    band->state = _CUPS_RASTER_BAND_DONE;
+    cupsCondBroadcast(&r->band_cond);
+  }
+
+  cupsMutexUnlock(&r->band_mutex);
+
+  return (NULL);
+}
+
+
+//
+// 'cups_raster_band_write()' - Write compressed bands in order.
+//
+// Finished bands are written until one is still being compressed.  If
+// "until" is not `NULL`, this function waits for bands to finish until that
+// band has been written.
+//
+
+static bool				// O - `true` on success, `false` on error
+cups_raster_band_write(
+    cups_raster_t       *r,		// I - Raster stream
+    _cups_raster_band_t *until)		// I - Band to wait for or `NULL`
+{
+  _cups_raster_band_t	*band;		// Current band
+  bool			ret = true;	// Return value
+
+
+  cupsMutexLock(&r->band_mutex);
+
+  for (;;)
+  {
+    band = r->bands + r->write_band;
+
+    if (band->state == _CUPS_RASTER_BAND_EMPTY)
+      break;
+
+    if (band->state != _CUPS_RASTER_BAND_DONE)
+    {
+      if (!until || until->state == _CUPS_RASTER_BAND_EMPTY)
+        break;
+
+      cupsCondWait(&r->band_cond, &r->band_mutex, 0.0);
+      continue;
+    }
+
+    cupsMutexUnlock(&r->band_mutex);
+
+    if (cups_raster_io(r, band->output, band->outused) < (ssize_t)band->outused)
+      ret = false;
+
+    cupsMutexLock(&r->band_mutex);
+
+    band->state    = _CUPS_RASTER_BAND_EMPTY;
+    band->num_rows = 0;
+    r->write_band  = (r->write_band + 1) % r->num_bands;
+  }
+
+  cupsMutexUnlock(&r->band_mutex);
+
+  return (ret);
+}
+
+
+//
+// 'cups_raster_encode()' - Compress a row of raster data.
+//
+// The buffer must hold at least `2 * cupsBytesPerLine + 2` bytes.  This
+// function only reads the stream state so that it can be called from the
+// compression threads.
+//
+
+static size_t				// O - Number of bytes in buffer
+cups_raster_encode(
+    cups_raster_t       *r,		// I - Raster stream
+    unsigned            rcount,		// I - Row repeat count
+    const unsigned char *pixels,	// I - Pixel data to write
+    unsigned char       *buffer)	// I - Output buffer
+{
+  const unsigned char	*start,		// Start of sequence
+			*ptr,		// Current pointer in sequence
+			*pend,		// End of raster buffer
+			*plast;		// Pointer to last pixel
+  unsigned char		*wptr;		// Pointer into write buffer
+  unsigned		bpp,		// Bytes per pixel
+			count;		// Count
+  _cups_copyfunc_t	cf;		// Copy function
+  _cups_eqmask_t	eqmask = NULL;	// Pixel comparison kernel
+
+
+  DEBUG_printf("3cups_raster_encode(r=%p, rcount=%u, pixels=%p, buffer=%p)", (void *)r, rcount, (void *)pixels, (void *)buffer);
+  DEBUG_printf("4cups_raster_encode: cupsBytesPerLine=%u", r->header.cupsBytesPerLine);
+
+  // Determine whether we need to swap bytes...
+  if (r->swapped && (r->header.cupsBitsPerColor == 16 || r->header.cupsBitsPerPixel == 12 || r->header.cupsBitsPerPixel == 16))
+  {
+    DEBUG_puts("4cups_raster_encode: Swapping bytes when writing.");
+#ifdef _CUPS_RASTER_SIMD
+    if (!r->scalar && __builtin_cpu_supports("sse2"))
+      cf = (_cups_copyfunc_t)cups_swap_copy_sse2;
+    else
+#endif // _CUPS_RASTER_SIMD
+    cf = (_cups_copyfunc_t)cups_swap_copy;
+  }
+  else
+    cf = (_cups_copyfunc_t)memcpy;
+
+#ifdef _CUPS_RASTER_SIMD
+  // Choose the widest pixel comparison kernel the CPU supports...
+  if (r->scalar)
+    eqmask = NULL;
+  else if (__builtin_cpu_supports("avx2"))
+    eqmask = cups_raster_eqmask_avx2;
+  else if (__builtin_cpu_supports("sse2"))
+    eqmask = cups_raster_eqmask_sse2;
+#endif // _CUPS_RASTER_SIMD
+
+  // Write the row repeat count...
+  bpp     = r->bpp;
+  pend    = pixels + r->header.cupsBytesPerLine;
+  plast   = pend - bpp;
+  wptr    = buffer;
+  *wptr++ = (unsigned char)(rcount - 1);
+
+  DEBUG_printf("4cups_raster_encode: bpp=%u, pend=%ld, plast=%ld, wptr=%ld", bpp, pend - pixels, plast - pixels, wptr - buffer);
+
+  // Write using a modified PackBits compression...
+  for (ptr = pixels; ptr < pend;)
+  {
+    start = ptr;
+    ptr += bpp;
+
+    if (ptr >= pend)
+    {
+      // Encode a single pixel at the end...
+      DEBUG_printf("4cups_raster_encode: SINGLE-END - ptr=%ld, pend=%ld, plast=%ld, start=%ld, wptr=%ld", ptr - pixels, pend - pixels, plast - pixels, start - pixels, wptr - buffer);
+
+      *wptr++ = 0;
+      (*cf)(wptr, start, bpp);
+      wptr += bpp;
+    }
+    else if (!memcmp(start, ptr, bpp))
+    {
+      // Encode a sequence of repeating pixels...
+      count = cups_raster_span(eqmask, ptr, pend, bpp, true, 126);
+      ptr   += count * bpp;
+      count += 2;
+
+      *wptr++ = (unsigned char)(count - 1);
+      (*cf)(wptr, ptr, bpp);
+      wptr += bpp;
+      ptr  += bpp;
+    }
+    else
+    {
+      // Encode a sequence of non-repeating pixels...
+      count = cups_raster_span(eqmask, ptr, pend, bpp, false, 127);
+      ptr   += count * bpp;
+      count += 1;
+
+      if (ptr >= plast && count < 128)
+      {
+        count ++;
+	ptr += bpp;
+      }
+
+      *wptr++ = (unsigned char)(257 - count);
+
+      count *= bpp;
+      (*cf)(wptr, start, count);
+      wptr += count;
+    }
+  }
+
+  return ((size_t)(wptr - buffer));
+}
+
+
+#ifdef _CUPS_RASTER_SIMD
+//
+// 'cups_raster_eqmask_avx2()' - Compare 64 bytes with the following pixel using AVX2.
+//
+// Bit N of the result is set when `ptr[N] == ptr[N + bpp]`.
+//
+
+__attribute__((target("avx2")))
+static uint64_t				// O - Byte equality mask
+cups_raster_eqmask_avx2(
+    const unsigned char *ptr,		// I - Start of block
+    unsigned            bpp)		// I - Bytes per pixel
+{
+  __m256i	lo0 = _mm256_loadu_si256((const __m256i *)ptr),
+		lo1 = _mm256_loadu_si256((const __m256i *)(ptr + bpp)),
+		hi0 = _mm256_loadu_si256((const __m256i *)(ptr + 32)),
+		hi1 = _mm256_loadu_si256((const __m256i *)(ptr + 32 + bpp));
+					// Current and next pixel data
+  uint64_t	mask;			// Byte equality mask
+
+
+  mask = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo0, lo1)) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi0, hi1)) << 32);
+
+  // Avoid AVX/SSE transition penalties in the SSE2 copy and swap code...
+  _mm256_zeroupper();
+
+  return (mask);
+}
+
+
+//
+// 'cups_raster_eqmask_sse2()' - Compare 64 bytes with the following pixel using SSE2.
+//
+// Bit N of the result is set when `ptr[N] == ptr[N + bpp]`.
+//
+
+__attribute__((target("sse2")))
+static uint64_t				// O - Byte equality mask
+cups_raster_eqmask_sse2(
+    const unsigned char *ptr,		// I - Start of block
+    unsigned            bpp)		// I - Bytes per pixel
+{
+  int		i;			// Looping var
+  uint64_t	mask = 0;		// Byte equality mask
+
+
+  for (i = 0; i < 64; i += 16)
+  {
+    __m128i a = _mm_loadu_si128((const __m128i *)(ptr + i)),
+	    b = _mm_loadu_si128((const __m128i *)(ptr + i + bpp));
+					// Current and next pixel data
+
+    mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) << i;
+  }
+
+  return (mask);
+}
+#endif // _CUPS_RASTER_SIMD
+
+
+//
+// 'cups_raster_fill()' - Repeat the pixel before "dst" for "bytes" bytes.
+//
+
+static void
+cups_raster_fill(cups_raster_t *r,	// I - Raster stream
+                 unsigned char *dst,	// I - Destination after first pixel
+                 size_t        bytes)	// I - Number of bytes to fill
+{
+  unsigned char	*src = dst - r->bpp;	// Start of pattern
+  size_t	filled = r->bpp,	// Bytes of pattern so far
+		count;			// Bytes to copy
+
+
+  if (r->bpp == 1)
+  {
+    memset(dst, *src, bytes);
+    return;
+  }
+
+#ifdef _CUPS_RASTER_SIMD
+  if (r->bpp <= 8 && (48 % r->bpp) == 0 && __builtin_cpu_supports("sse2"))
+  {
+    cups_raster_fill_sse2(dst, r->bpp, bytes);
+    return;
+  }
+#endif // _CUPS_RASTER_SIMD
+
+  // Double the repeated pattern on each pass...
+  while (bytes > 0)
+  {
+    count = bytes < filled ? bytes : filled;
+
+    memcpy(dst, src, count);
+
+    dst    += count;
+    bytes  -= count;
+    filled += count;
+  }
+}
+
+
+#ifdef _CUPS_RASTER_SIMD
+//
+// 'cups_raster_fill_sse2()' - Repeat a 2, 3, 4, 6, or 8 byte pixel using SSE2.
+//
+// 2, 4, and 8 byte pixels are broadcast to a single 16-byte vector, while 3
+// and 6 byte pixels use a 48-byte pattern stored as three vectors.
+//
+
+__attribute__((target("sse2")))
+static void
+cups_raster_fill_sse2(
+    unsigned char *dst,			// I - Destination after first pixel
+    unsigned      bpp,			// I - Bytes per pixel
+    size_t        bytes)		// I - Number of bytes to fill
+{
+  unsigned	i;			// Looping var
+  unsigned char	pattern[48];		// Repeated pixel
+  uint16_t	px16;			// 2 byte pixel
+  uint32_t	px32;			// 4 byte pixel
+  uint64_t	px64;			// 8 byte pixel
+  __m128i	v0, v1, v2;		// Repeated pixel vectors
+
+
+  switch (bpp)
+  {
+    case 2 :
+        memcpy(&px16, dst - 2, 2);
+        v0 = _mm_set1_epi16((short)px16);
+        break;
+
+    case 4 :
+        memcpy(&px32, dst - 4, 4);
+        v0 = _mm_set1_epi32((int)px32);
+        break;
+
+    case 8 :
+        memcpy(&px64, dst - 8, 8);
+        v0 = _mm_set1_epi64x((long long)px64);
+        break;
+
+    default :
+        for (i = 0; i < bpp; i ++)
+          pattern[i] = dst[(int)i - (int)bpp];
+        for (; i < sizeof(pattern); i ++)
+          pattern[i] = pattern[i - bpp];
+
+        v0 = _mm_loadu_si128((const __m128i *)pattern);
+        v1 = _mm_loadu_si128((const __m128i *)(pattern + 16));
+        v2 = _mm_loadu_si128((const __m128i *)(pattern + 32));
+
+        for (; bytes >= 48; bytes -= 48, dst += 48)
+        {
+          _mm_storeu_si128((__m128i *)dst, v0);
+          _mm_storeu_si128((__m128i *)(dst + 16), v1);
+          _mm_storeu_si128((__m128i *)(dst + 32), v2);
+        }
+        break;
+  }
+
+  if (bpp == 2 || bpp == 4 || bpp == 8)
+  {
+    for (; bytes >= 16; bytes -= 16, dst += 16)
+      _mm_storeu_si128((__m128i *)dst, v0);
+  }
+
+  // Copy any remaining bytes from the previous pixel...
+  for (; bytes > 0; bytes --, dst ++)
+    *dst = dst[-(int)bpp];
+}
+#endif // _CUPS_RASTER_SIMD
+
+
+//
+// 'cups_raster_index()' - Build the page index for a raster file.
+//
+// Each page header is read normally, after which the page data is skipped
+// using the row and run counts of the compressed data, without decoding any
+// pixels.  Indexing stops at the end of the file or at the first page header
+// that cannot be read.
+//
+
+static bool				// O - `true` on success, `false` on error
+cups_raster_index(cups_raster_t *r)	// I - Raster stream
+{
+  _cups_raster_map_t	*map = r->map;	// Raster file data
+  cups_page_header_t	header;		// Page header
+  size_t		offset,		// Offset of page header/data
+			length,		// Length of page data
+			alloc_pages = 0,// Allocated pages
+			*pages;		// New page array
+  unsigned char		*ptr,		// Pointer into page data
+			*next,		// Next row
+			*end = map->data + map->size;
+					// End of file data
+  unsigned		rows,		// Rows remaining
+			count;		// Row repeat count
+
+
+  r->num_pages = 0;
+
+  for (;;)
+  {
+    // Read the next page header...
+    if ((offset = map->pos - (size_t)(r->bufend - r->bufptr)) >= map->size)
+      break;
+
+    if (!cupsRasterReadHeader(r, &header))
+      break;
+
+    // Add the page to the index...
+    if (r->num_pages >= alloc_pages)
+    {
+      alloc_pages += 64;
+
+      if ((pages = realloc(r->pages, alloc_pages * sizeof(size_t))) == NULL)
+      {
+        _cupsRasterAddError("Unable to allocate memory for page index: %s", strerror(errno));
+        return (false);
+      }
+
+      r->pages = pages;
+    }
+
+    r->pages[r->num_pages ++] = offset;
+
+    // Skip the page data...
+    ptr = map->data + map->pos - (r->bufend - r->bufptr);
+
+    if (!r->compressed)
+    {
+      if ((length = (size_t)header.cupsBytesPerLine * r->remaining) > (size_t)(end - ptr))
+        length = (size_t)(end - ptr);
+
+      ptr += length;
+    }
+    else
+    {
+      for (rows = r->remaining; rows > 0; ptr = next)
+      {
+        if ((next = cups_raster_skip_row(ptr, end, header.cupsBytesPerLine, r->bpp)) == NULL)
+        {
+          // Truncated page...
+          ptr = end;
+          break;
+        }
+
+        count = (unsigned)*ptr + 1;
+        rows  -= count < rows ? count : rows;
+      }
+    }
+
+    // Continue with the next page header...
+    map->pos     = (size_t)(ptr - map->data);
+    r->bufptr    = r->buffer;
+    r->bufend    = r->buffer;
+    r->count     = 0;
+    r->remaining = 0;
+  }
+
+  DEBUG_printf("4cups_raster_index: num_pages=%u", (unsigned)r->num_pages);
+
+  return (true);
+}
+
+
+//
+// 'cups_raster_index_load()' - Load a cached page index for a raster file.
+//
+// The index file starts with a line containing the size and modification time
+// of the raster file followed by the number of pages, and is followed by the
+// offset of each page header on a separate line.
+//
+
+static bool				// O - `true` on success, `false` if missing/stale
+cups_raster_index_load(
+    cups_raster_t *r,			// I - Raster stream
+    const char    *indexfile,		// I - Page index filename
+    struct stat   *fileinfo)		// I - Raster file information
+{
+  cups_file_t		*fp;		// Page index file
+  char			line[256],	// Line from file
+			*ptr;		// Pointer into line
+  unsigned long long	size,		// Size of raster file
+			num_pages,	// Number of pages
+			offset;		// Offset of page header
+  long long		mtime;		// Modification time of raster file
+  size_t		i,		// Looping var
+			*pages;		// Page array
+
+
+  if ((fp = cupsFileOpen(indexfile, "r")) == NULL)
+    return (false);
+
+  // Validate the header line...
+  if (!cupsFileGets(fp, line, sizeof(line)) || strncmp(line, _CUPS_INDEX_HEADER " ", sizeof(_CUPS_INDEX_HEADER)) || sscanf(line + sizeof(_CUPS_INDEX_HEADER), "%llu%lld%llu", &size, &mtime, &num_pages) != 3 || size != r->map->size || mtime != (long long)fileinfo->st_mtime || num_pages == 0 || num_pages > r->map->size / 4)
+  {
+    DEBUG_printf("4cups_raster_index_load: Stale or invalid index file \"%s\".", indexfile);
+    cupsFileClose(fp);
+    return (false);
+  }
+
+  if ((pages = calloc((size_t)num_pages, sizeof(size_t))) == NULL)
+  {
+    cupsFileClose(fp);
+    return (false);
+  }
+
+  // Read the page offsets, which must be increasing...
+  for (i = 0; i < (size_t)num_pages; i ++)
+  {
+    if (!cupsFileGets(fp, line, sizeof(line)))
+      break;
+
+    offset = strtoull(line, &ptr, 10);
+
+    if (ptr == line || *ptr || offset >= size || (i > 0 && offset <= pages[i - 1]))
+      break;
+
+    pages[i] = (size_t)offset;
+  }
+
+  cupsFileClose(fp);
+
+  if (i < (size_t)num_pages)
+  {
+    DEBUG_printf("4cups_raster_index_load: Bad page offset in \"%s\".", indexfile);
+    free(pages);
+    return (false);
+  }
+
+  free(r->pages);
+
+  r->pages     = pages;
+  r->num_pages = (size_t)num_pages;
+
+  return (true);
+}
+
+
+//
+// 'cups_raster_index_save()' - Save the page index for a raster file.
+//
+// Errors are ignored since the index can always be rebuilt.
+//
+
+static void
+cups_raster_index_save(
+    cups_raster_t *r,			// I - Raster stream
+    const char    *indexfile,		// I - Page index filename
+    struct stat   *fileinfo)		// I - Raster file information
+{
+  cups_file_t	*fp;			// Page index file
+  size_t	i;			// Looping var
+
+
+  if (r->num_pages == 0 || (fp = cupsFileOpen(indexfile, "w")) == NULL)
+    return;
+
+  cupsFilePrintf(fp, _CUPS_INDEX_HEADER " %llu %lld %llu\n", (unsigned long long)r->map->size, (long long)fileinfo->st_mtime, (unsigned long long)r->num_pages);
+
+  for (i = 0; i < r->num_pages; i ++)
+    cupsFilePrintf(fp, "%llu\n", (unsigned long long)r->pages[i]);
+
+  cupsFileClose(fp);
+}
+
+
+//
+// 'cups_raster_io()' - Read/write bytes from a context, handling interruptions.
+//
+
+static ssize_t				// O - Bytes read/write or -1
+cups_raster_io(cups_raster_t *r,	// I - Raster stream
+               unsigned char *buf,	// I - Buffer for read/write
+               size_t        bytes)	// I - Number of bytes to read/write
+{
+  ssize_t	count,			// Number of bytes read/written
+		total;			// Total bytes read/written
+
+
+  DEBUG_printf("5cups_raster_io(r=%p, buf=%p, bytes=" CUPS_LLFMT ")", (void *)r, (void *)buf, CUPS_LLCAST bytes);
+
+  for (total = 0; total < (ssize_t)bytes; total += count, buf += count)
+  {
+    count = (*r->iocb)(r->ctx, buf, bytes - (size_t)total);
+
+    DEBUG_printf("6cups_raster_io: count=%d, total=%d", (int)count, (int)total);
+    if (count == 0)
+    {
+      break;
+    }
+    else if (count < 0)
+    {
+      _cupsRasterAddError("I/O error");
+      DEBUG_puts("6cups_raster_io: Returning -1 on error.");
+      return (-1);
+    }
+
+#ifdef DEBUG
+    r->iocount += (size_t)count;
+#endif // DEBUG
+  }
+
+  DEBUG_printf("6cups_raster_io: iocount=" CUPS_LLFMT, CUPS_LLCAST r->iocount);
+  DEBUG_printf("6cups_raster_io: Returning " CUPS_LLFMT ".", CUPS_LLCAST total);
+
+  return (total);
+}
+
+
+//
+// 'cups_raster_read()' - Read through the raster buffer.
+//
+
+static ssize_t				// O - Number of bytes read
+cups_raster_read(cups_raster_t *r,	// I - Raster stream
                  unsigned char *buf,	// I - Buffer
                  size_t        bytes)	// I - Number of bytes to read
 {
@@ -1544,6 +2782,226 @@ cups_raster_read(cups_raster_t *r,	// I - Raster stream
 }
 
 
+//
+// 'cups_raster_refill()' - Read more compressed data into the read buffer.
+//
+// Unread data is moved to the start of the buffer, which holds at least two
+// lines of raster data and therefore always holds a complete compressed row.
+//
+
+static ssize_t				// O - Bytes read, 0 on EOF, -1 on error
+cups_raster_refill(cups_raster_t *r)	// I - Raster stream
+{
+  size_t	bufsize,		// New buffer size
+		used;			// Unread bytes in buffer
+  unsigned char	*buffer;		// New buffer
+  ssize_t	bytes;			// Bytes read
+
+
+  // Move unread data to the start of the buffer...
+  used = (size_t)(r->bufend - r->bufptr);
+
+  if (used > 0 && r->bufptr > r->buffer)
+    memmove(r->buffer, r->bufptr, used);
+
+#ifdef DEBUG
+  r->iostart += (size_t)(r->bufptr - r->buffer);
+#endif // DEBUG
+
+  r->bufptr = r->buffer;
+  r->bufend = r->buffer + used;
+
+  // Grow the buffer as needed...
+  if ((bufsize = 2 * (size_t)r->header.cupsBytesPerLine + 2) < 65536)
+    bufsize = 65536;
+
+  if (bufsize > r->bufsize)
+  {
+    if ((buffer = realloc(r->buffer, bufsize)) == NULL)
+    {
+      _cupsRasterAddError("Unable to allocate memory for raster buffer: %s", strerror(errno));
+      return (-1);
+    }
+
+    r->buffer  = buffer;
+    r->bufptr  = buffer;
+    r->bufend  = buffer + used;
+    r->bufsize = bufsize;
+  }
+  else if (used >= r->bufsize)
+  {
+    return (-1);
+  }
+
+  // Read more data...
+  if ((bytes = (*r->iocb)(r->ctx, r->bufend, r->bufsize - used)) > 0)
+  {
+    r->bufend += bytes;
+
+#ifdef DEBUG
+    r->iocount += (size_t)bytes;
+#endif // DEBUG
+  }
+
+  return (bytes);
+}
+
+
+//
+// 'cups_raster_skip_row()' - Find the end of a compressed row.
+//
+// The row starts with its repeat count and ends after enough runs to fill a
+// line, matching the rules used by @link cupsRasterReadPixels@.
+//
+
+static unsigned char *			// O - Start of next row or `NULL` if incomplete
+cups_raster_skip_row(
+    unsigned char *ptr,			// I - Start of row
+    unsigned char *end,			// I - End of data
+    unsigned      bpl,			// I - Bytes per line
+    unsigned      bpp)			// I - Bytes per pixel
+{
+  unsigned	bytes;			// Bytes remaining in line
+  size_t	length;			// Length of run data
+  unsigned char	byte;			// Run control byte
+
+
+  if (ptr >= end)
+    return (NULL);
+
+  for (ptr ++, bytes = bpl; bytes > 0; ptr += length)
+  {
+    if (ptr >= end)
+      return (NULL);
+
+    if ((byte = *ptr++) == 128)
+    {
+      // Clear to end of line...
+      break;
+    }
+    else if (byte & 128)
+    {
+      // N literal pixels...
+      if ((length = (size_t)(257 - byte) * bpp) > bytes)
+        length = bytes;
+
+      bytes -= (unsigned)length;
+    }
+    else
+    {
+      // Repeat the next pixel N times...
+      if ((length = (size_t)(byte + 1) * bpp) > bytes)
+        length = bytes;
+
+      if (length < bpp)
+        break;
+
+      bytes  -= (unsigned)length;
+      length = bpp;
+    }
+
+    if (length > (size_t)(end - ptr))
+      return (NULL);
+  }
+
+  return (ptr);
+}
+
+
+//
+// 'cups_raster_span()' - Count the pixels that do (or do not) repeat.
+//
+// Starting at "ptr", this function counts the pixels that are equal to the
+// following pixel (`same == true`) or that differ from the following pixel
+// (`same == false`), stopping at the first pixel that breaks the run, the
+// last pixel in the line, or after "max" pixels.  When a comparison kernel
+// is supplied, whole 64-byte blocks are compared at once and the per-byte
+// results are folded into per-pixel results.
+//
+
+static unsigned				// O - Number of pixels in run
+cups_raster_span(
+    _cups_eqmask_t      eqmask,		// I - Comparison kernel or `NULL`
+    const unsigned char *ptr,		// I - First pixel to compare
+    const unsigned char *pend,		// I - End of line
+    unsigned            bpp,		// I - Bytes per pixel
+    bool                same,		// I - Count repeating pixels?
+    unsigned            max)		// I - Maximum number of pixels
+{
+  unsigned		count = 0;	// Number of pixels
+  const unsigned char	*plast = pend - bpp;
+					// Last pixel in line
+
+
+#ifdef _CUPS_RASTER_SIMD
+  if (eqmask && bpp <= 8)
+  {
+    unsigned	i,			// Looping var
+		npixels = 64 / bpp,	// Pixels per block
+		n;			// Pixels in run for this block
+    uint64_t	starts = cups_pixel_starts[bpp],
+					// First byte of each pixel
+		bytes,			// Byte equality mask
+		mask,			// Pixel equality mask
+		stop;			// Pixels that end the run
+
+    // Blocks are only compared while the loads stay inside the line...
+    while (count < max && (size_t)(pend - ptr) >= (64 + bpp))
+    {
+      // Fold the byte comparisons so that the first byte of each pixel
+      // reports whether the whole pixel matches...
+      bytes = (*eqmask)(ptr, bpp);
+      for (i = 1, mask = bytes; i < bpp; i ++)
+        mask &= bytes >> i;
+      mask &= starts;
+
+      stop = same ? (~mask & starts) : mask;
+      n    = stop ? (unsigned)__builtin_ctzll(stop) / bpp : npixels;
+
+      if (n > (max - count))
+        n = max - count;
+
+      count += n;
+      ptr   += n * bpp;
+
+      if (n < npixels)
+        return (count);
+    }
+  }
+#else
+  (void)eqmask;
+#endif // _CUPS_RASTER_SIMD
+
+  // Compare the remaining pixels one at a time...
+  for (; count < max && ptr < plast; count ++, ptr += bpp)
+  {
+    if (!memcmp(ptr, ptr + bpp, bpp) != same)
+      break;
+  }
+
+  return (count);
+}
+
+
+//
+// 'cups_raster_unmap()' - Free the data for a raster file.
+//
+
+static void
+cups_raster_unmap(
+    _cups_raster_map_t *map)		// I - Raster file data
+{
+#ifndef _WIN32
+  if (map->mapped)
+    munmap(map->data, map->size);
+  else
+#endif // !_WIN32
+  free(map->data);
+
+  free(map);
+}
+
+
 //
 // 'cups_raster_update()' - Update the raster header and row count for the
 //                          current page.
@@ -1746,114 +3204,44 @@ cups_raster_write(
     cups_raster_t       *r,		// I - Raster stream
     const unsigned char *pixels)	// I - Pixel data to write
 {
-  const unsigned char	*start,		// Start of sequence
-			*ptr,		// Current pointer in sequence
-			*pend,		// End of raster buffer
-			*plast;		// Pointer to last pixel
-  unsigned char		*wptr;		// Pointer into write buffer
-  unsigned		bpp,		// Bytes per pixel
-			count;		// Count
-  _cups_copyfunc_t	cf;		// Copy function
+  unsigned char	*buffer;		// Write buffer
+  size_t	bufsize,		// Size of write buffer
+		bytes;			// Bytes to write
 
 
   DEBUG_printf("3cups_raster_write(r=%p, pixels=%p)", (void *)r, (void *)pixels);
-  DEBUG_printf("4cups_raster_write: cupsBytesPerLine=%u", r->header.cupsBytesPerLine);
 
-  // Determine whether we need to swap bytes...
-  if (r->swapped && (r->header.cupsBitsPerColor == 16 || r->header.cupsBitsPerPixel == 12 || r->header.cupsBitsPerPixel == 16))
-  {
-    DEBUG_puts("4cups_raster_write: Swapping bytes when writing.");
-    cf = (_cups_copyfunc_t)cups_swap_copy;
-  }
-  else
-    cf = (_cups_copyfunc_t)memcpy;
+  // Hand the row to the compression threads as needed...
+  if (r->num_threads > 1)
+    return (cups_raster_band_add(r, pixels));
 
   // Allocate a write buffer as needed...
-  count = r->header.cupsBytesPerLine * 2;
-  if (count < 65536)
-    count = 65536;
+  bufsize = 2 * (size_t)r->header.cupsBytesPerLine + 2;
+  if (bufsize < 65536)
+    bufsize = 65536;
 
-  if ((size_t)count > r->bufsize)
+  if (bufsize > r->bufsize)
   {
     if (r->buffer)
-      wptr = realloc(r->buffer, count);
+      buffer = realloc(r->buffer, bufsize);
     else
-      wptr = malloc(count);
+      buffer = malloc(bufsize);
 
-    if (!wptr)
+    if (!buffer)
     {
-      DEBUG_printf("4cups_raster_write: Unable to allocate " CUPS_LLFMT " bytes for raster buffer: %s", CUPS_LLCAST count, strerror(errno));
+      DEBUG_printf("4cups_raster_write: Unable to allocate " CUPS_LLFMT " bytes for raster buffer: %s", CUPS_LLCAST bufsize, strerror(errno));
       return (-1);
     }
 
-    r->buffer  = wptr;
-    r->bufsize = count;
+    r->buffer  = buffer;
+    r->bufsize = bufsize;
   }
 
-  // Write the row repeat count...
-  bpp     = r->bpp;
-  pend    = pixels + r->header.cupsBytesPerLine;
-  plast   = pend - bpp;
-  wptr    = r->buffer;
-  *wptr++ = (unsigned char)(r->count - 1);
-
-  DEBUG_printf("4cups_raster_write: bpp=%u, pend=%ld, plast=%ld, wptr=%ld", bpp, pend - pixels, plast - pixels, wptr - r->buffer);
-
-  // Write using a modified PackBits compression...
-  for (ptr = pixels; ptr < pend;)
-  {
-    start = ptr;
-    ptr += bpp;
-
-    if (ptr >= pend)
-    {
-      // Encode a single pixel at the end...
-      DEBUG_printf("4cups_raster_write: SINGLE-END - ptr=%ld, pend=%ld, plast=%ld, start=%ld, wptr=%ld", ptr - pixels, pend - pixels, plast - pixels, start - pixels, wptr - r->buffer);
-
-      *wptr++ = 0;
-      (*cf)(wptr, start, bpp);
-      wptr += bpp;
-    }
-    else if (!memcmp(start, ptr, bpp))
-    {
-      // Encode a sequence of repeating pixels...
-      for (count = 2; count < 128 && ptr < plast; count ++, ptr += bpp)
-      {
-        if (memcmp(ptr, ptr + bpp, bpp))
-	  break;
-      }
-
-      *wptr++ = (unsigned char)(count - 1);
-      (*cf)(wptr, ptr, bpp);
-      wptr += bpp;
-      ptr  += bpp;
-    }
-    else
-    {
-      // Encode a sequence of non-repeating pixels...
-      for (count = 1; count < 128 && ptr < plast; count ++, ptr += bpp)
-      {
-        if (!memcmp(ptr, ptr + bpp, bpp))
-	  break;
-      }
-
-      if (ptr >= plast && count < 128)
-      {
-        count ++;
-	ptr += bpp;
-      }
-
-      *wptr++ = (unsigned char)(257 - count);
-
-      count *= bpp;
-      (*cf)(wptr, start, count);
-      wptr += count;
-    }
-  }
+  bytes = cups_raster_encode(r, r->count, pixels, r->buffer);
 
-  DEBUG_printf("4cups_raster_write: Writing " CUPS_LLFMT " bytes.", CUPS_LLCAST (wptr - r->buffer));
+  DEBUG_printf("4cups_raster_write: Writing " CUPS_LLFMT " bytes.", CUPS_LLCAST bytes);
 
-  return (cups_raster_io(r, r->buffer, (size_t)(wptr - r->buffer)));
+  return (cups_raster_io(r, r->buffer, bytes));
 }
 
 
@@ -1883,6 +3271,29 @@ cups_read_fd(void          *ctx,	// I - File descriptor as pointer
 }
 
 
+//
+// 'cups_read_map()' - Read bytes from raster file data.
+//
+
+static ssize_t				// O - Bytes read
+cups_read_map(void          *ctx,	// I - Raster file data
+              unsigned char *buf,	// I - Buffer for read
+	      size_t        bytes)	// I - Maximum number of bytes to read
+{
+  _cups_raster_map_t	*map = (_cups_raster_map_t *)ctx;
+					// Raster file data
+
+
+  if (bytes > (map->size - map->pos))
+    bytes = map->size - map->pos;
+
+  memcpy(buf, map->data + map->pos, bytes);
+  map->pos += bytes;
+
+  return ((ssize_t)bytes);
+}
+
+
 //
 // 'cups_swap()' - Swap bytes in raster data...
 //
@@ -1933,6 +3344,64 @@ cups_swap_copy(
 }
 
 
+#ifdef _CUPS_RASTER_SIMD
+//
+// 'cups_swap_copy_sse2()' - Copy and swap bytes in raster data using SSE2.
+//
+
+__attribute__((target("sse2")))
+static void
+cups_swap_copy_sse2(
+    unsigned char       *dst,		// I - Destination
+    const unsigned char *src,		// I - Source
+    size_t              bytes)		// I - Number of bytes to swap
+{
+  __m128i	v;			// 16-bit samples
+
+
+  for (; bytes >= 16; bytes -= 16, src += 16, dst += 16)
+  {
+    v = _mm_loadu_si128((const __m128i *)src);
+    _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+  }
+
+  for (; bytes > 1; bytes -= 2, src += 2, dst += 2)
+  {
+    dst[0] = src[1];
+    dst[1] = src[0];
+  }
+}
+
+
+//
+// 'cups_swap_sse2()' - Swap bytes in raster data using SSE2.
+//
+
+__attribute__((target("sse2")))
+static void
+cups_swap_sse2(unsigned char *buf,	// I - Buffer to swap
+               size_t        bytes)	// I - Number of bytes to swap
+{
+  __m128i	v;			// 16-bit samples
+
+
+  for (; bytes >= 16; bytes -= 16, buf += 16)
+  {
+    v = _mm_loadu_si128((const __m128i *)buf);
+    _mm_storeu_si128((__m128i *)buf, _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+  }
+
+  for (; bytes > 1; bytes -= 2, buf += 2)
+  {
+    unsigned char even = buf[0];	// Even byte
+
+    buf[0] = buf[1];
+    buf[1] = even;
+  }
+}
+#endif // _CUPS_RASTER_SIMD
+
+
 //
 // 'cups_write_fd()' - Write bytes to a file.
 //
@@ -11,12 +11,19 @@
 
 #include <config.h>
 #include <cups/raster.h>
+#include <cups/json.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/time.h>
 #include <signal.h>
 #include <unistd.h>
 #include <sys/wait.h>
+#ifdef __GLIBC__
+#  include <malloc.h>
+#  if __GLIBC_PREREQ(2,33)
+#    define HAVE_MALLINFO2 1		// Use mallinfo2() to measure memory use
+#  endif // __GLIBC_PREREQ(2,33)
+#endif // __GLIBC__
 
 
 //
@@ -28,16 +35,76 @@
 #define TEST_PAGES	16
 #define TEST_PASSES	20
 
+#define ENCODE_WIDTH	7016		// A3 at 600dpi
+#define ENCODE_LINES	9921
+#define TEST_THREADS	8		// Maximum number of thread counts to test
+
+#define MATRIX_LINES	64		// Number of unique lines per page
+#define MATRIX_PASSES	3		// Default number of matrix passes
+#define MATRIX_SLOWDOWN	10.0		// Default slowdown threshold in percent
+
+
+//
+// Local types...
+//
+
+typedef struct encode_buffer_s		// Compressed raster data
+{
+  unsigned char	*data;			// Raster data
+  size_t	used,			// Bytes used
+		size,			// Allocated size
+		pos;			// Current read position
+} encode_buffer_t;
+
+typedef enum matrix_content_e		// Matrix page content
+{
+  MATRIX_BLANK,				// Blank page
+  MATRIX_TEXT,				// Text-like lines of short runs
+  MATRIX_PHOTO,				// Gradients with noise
+  MATRIX_HALFTONE,			// Ordered dither of gradients
+  MATRIX_MAX
+} matrix_content_t;
+
+
+//
+// Local globals...
+//
+
+static const struct
+{
+  const char	*name;			// Name of color space
+  cups_cspace_t	cspace;			// Color space
+  unsigned	bits,			// Bits per color
+		colors;			// Number of colors
+}		encode_spaces[] =	// Color spaces to test
+{
+  { "sgray_8",  CUPS_CSPACE_SW,   8, 1 },
+  { "srgb_8",   CUPS_CSPACE_SRGB, 8, 3 },
+  { "cmyk_8",   CUPS_CSPACE_CMYK, 8, 4 },
+  { "sgray_16", CUPS_CSPACE_SW,   16, 1 },
+  { "srgb_16",  CUPS_CSPACE_SRGB, 16, 3 },
+  { "cmyk_16",  CUPS_CSPACE_CMYK, 16, 4 }
+};
+
 
 //
 // Local functions...
 //
 
-static double	compute_median(double *secs);
+static double	compute_median(double *secs, unsigned num_secs);
+static void	copy_test(void);
+static void	encode_data(unsigned char *data, size_t bpp);
+static void	encode_header(cups_page_header_t *header, size_t i);
+static void	encode_test(size_t max_threads);
+static ssize_t	encode_read(void *ctx, unsigned char *buffer, size_t length);
+static ssize_t	encode_write(void *ctx, unsigned char *buffer, size_t length);
 static double	get_time(void);
+static size_t	get_memory(void);
+static void	matrix_data(unsigned char *data, matrix_content_t content, size_t space, unsigned width);
+static int	matrix_test(unsigned passes, size_t num_threads, const char *jsonfile, const char *comparefile, double threshold);
 static void	read_test(int fd);
 static int	run_read_test(void);
-static void	write_test(int fd, cups_raster_mode_t mode);
+static void	write_test(int fd, cups_raster_mode_t mode, size_t num_threads);
 
 
 //
@@ -55,17 +122,112 @@ main(int  argc,				// I - Number of command-line args
 		write_secs,		// Write time
 		read_secs,		// Read time
 		pass_secs[TEST_PASSES];	// Total test times
-  cups_raster_mode_t mode;		// Write mode
+  cups_raster_mode_t mode = CUPS_RASTER_WRITE;
+					// Write mode
+  bool		copy = false,		// Run page copy benchmark?
+		encode = false,		// Run compression benchmark?
+		matrix = false;		// Run benchmark matrix?
+  size_t	num_threads = 1;	// Number of compression threads
+  unsigned	passes = MATRIX_PASSES;	// Number of matrix passes
+  double	threshold = MATRIX_SLOWDOWN;
+					// Slowdown threshold in percent
+  const char	*jsonfile = NULL,	// JSON results file
+		*comparefile = NULL;	// JSON baseline file
 
 
   // See if we have anything on the command-line...
-  if (argc > 2 || (argc == 2 && strcmp(argv[1], "-z")))
+  for (i = 1; i < argc; i ++)
   {
-    puts("Usage: rasterbench [-z]");
-    return (1);
+    if (!strcmp(argv[i], "--compare"))
+    {
+      i ++;
+      if (i >= argc)
+      {
+        puts("rasterbench: Expected baseline JSON file after '--compare'.");
+        return (1);
+      }
+
+      comparefile = argv[i];
+      matrix      = true;
+    }
+    else if (!strcmp(argv[i], "--json"))
+    {
+      i ++;
+      if (i >= argc)
+      {
+        puts("rasterbench: Expected JSON file after '--json'.");
+        return (1);
+      }
+
+      jsonfile = argv[i];
+      matrix   = true;
+    }
+    else if (!strcmp(argv[i], "--threshold"))
+    {
+      char	*end;			// End of number
+
+      i ++;
+      if (i >= argc || (threshold = strtod(argv[i], &end)) < 0.0 || *end)
+      {
+        puts("rasterbench: Expected slowdown percentage after '--threshold'.");
+        return (1);
+      }
+    }
+    else if (!strcmp(argv[i], "-c"))
+    {
+      copy = true;
+    }
+    else if (!strcmp(argv[i], "-e"))
+    {
+      encode = true;
+    }
+    else if (!strcmp(argv[i], "-m"))
+    {
+      matrix = true;
+    }
+    else if (!strcmp(argv[i], "-p"))
+    {
+      i ++;
+      if (i >= argc || (passes = (unsigned)strtoul(argv[i], NULL, 10)) < 1)
+      {
+        puts("rasterbench: Expected number of passes after '-p'.");
+        return (1);
+      }
+    }
+    else if (!strcmp(argv[i], "-t"))
+    {
+      i ++;
+      if (i >= argc || (num_threads = strtoul(argv[i], NULL, 10)) < 1)
+      {
+        puts("rasterbench: Expected number of threads after '-t'.");
+        return (1);
+      }
+    }
+    else if (!strcmp(argv[i], "-z"))
+    {
+      mode = CUPS_RASTER_WRITE_COMPRESSED;
+    }
+    else
+    {
+      puts("Usage: rasterbench [-c] [-e] [-m] [-p PASSES] [-t THREADS] [-z] [--compare BASELINE.json] [--json RESULTS.json] [--threshold PERCENT]");
+      return (1);
+    }
+  }
+
+  if (matrix)
+    return (matrix_test(passes, num_threads, jsonfile, comparefile, threshold));
+
+  if (copy)
+  {
+    copy_test();
+    return (0);
   }
 
-  mode = argc > 1 ? CUPS_RASTER_WRITE_COMPRESSED : CUPS_RASTER_WRITE;
+  if (encode)
+  {
+    encode_test(num_threads);
+    return (0);
+  }
 
   // Ignore SIGPIPE...
   signal(SIGPIPE, SIG_IGN);
@@ -80,7 +242,7 @@ main(int  argc,				// I - Number of command-line args
     ras_fd     = run_read_test();
     start_secs = get_time();
 
-    write_test(ras_fd, mode);
+    write_test(ras_fd, mode, num_threads);
 
     write_secs = get_time();
     printf(" %.3f write,", write_secs - start_secs);
@@ -95,7 +257,7 @@ main(int  argc,				// I - Number of command-line args
   }
 
   printf("\nMedian Total Time: %.3f seconds per document\n",
-         compute_median(pass_secs));
+         compute_median(pass_secs, TEST_PASSES));
 
   return (0);
 }
@@ -106,16 +268,17 @@ main(int  argc,				// I - Number of command-line args
 //
 
 static double				// O - Median time in seconds
-compute_median(double *secs)		// I - Array of time samples
+compute_median(double   *secs,		// I - Array of time samples
+               unsigned num_secs)	// I - Number of time samples
 {
-  int		i, j;			// Looping vars
+  unsigned	i, j;			// Looping vars
   double	temp;			// Swap variable
 
 
   // Sort the array into ascending order using a quicky bubble sort...
-  for (i = 0; i < (TEST_PASSES - 1); i ++)
+  for (i = 0; i < (num_secs - 1); i ++)
   {
-    for (j = i + 1; j < TEST_PASSES; j ++)
+    for (j = i + 1; j < num_secs; j ++)
     {
       if (secs[i] > secs[j])
       {
@@ -126,8 +289,391 @@ compute_median(double *secs)		// I - Array of time samples
     }
   }
 
-  // Return the average of the middle two samples...
-  return (0.5 * (secs[TEST_PASSES / 2 - 1] + secs[TEST_PASSES / 2]));
+  // Return the middle sample or the average of the middle two samples...
+  if (num_secs & 1)
+    return (secs[num_secs / 2]);
+  else
+    return (0.5 * (secs[num_secs / 2 - 1] + secs[num_secs / 2]));
+}
+
+
+//
+// 'copy_test()' - Benchmark copying PWG raster pages.
+//
+// Each page is copied to PWG and Apple raster using cupsRasterCopyPage and
+// compared to decoding and compressing the lines again.
+//
+
+static void
+copy_test(void)
+{
+  size_t		i;		// Looping var
+  unsigned		y,		// Current line
+			pass;		// Current pass
+  int			method;		// Copy method
+  cups_raster_t		*in,		// Input stream
+			*out;		// Output stream
+  cups_page_header_t	header;		// Page header
+  size_t		bpp;		// Bytes per pixel
+  encode_buffer_t	pwg,		// PWG raster data
+			copy;		// Copied raster data
+  unsigned char		*data;		// Raster data
+  double		start_secs,	// Start time
+			pass_secs[TEST_PASSES];
+					// Time for each pass
+  static const char * const methods[] =	// Copy methods
+  {
+    "decode+encode PWG",
+    "copy PWG",
+    "copy Apple"
+  };
+
+
+  printf("Test PWG raster page copies of %dx%d pixel pages...\n\n", ENCODE_WIDTH, ENCODE_LINES);
+
+  memset(&pwg, 0, sizeof(pwg));
+  memset(&copy, 0, sizeof(copy));
+
+  if ((data = malloc(33 * 8 * ENCODE_WIDTH)) == NULL)
+  {
+    perror("Unable to allocate raster data");
+    return;
+  }
+
+  for (i = 0; i < (sizeof(encode_spaces) / sizeof(encode_spaces[0])); i ++)
+  {
+    bpp = encode_spaces[i].bits * encode_spaces[i].colors / 8;
+
+    encode_data(data, bpp);
+    encode_header(&header, i);
+
+    // Write the page to be copied...
+    pwg.used = 0;
+
+    if ((out = cupsRasterOpenIO(encode_write, &pwg, CUPS_RASTER_WRITE_PWG)) == NULL)
+    {
+      perror("Unable to create raster output stream");
+      break;
+    }
+
+    cupsRasterWriteHeader(out, &header);
+
+    for (y = 0; y < ENCODE_LINES; y ++)
+      cupsRasterWritePixels(out, data + (y & 31) * bpp * ENCODE_WIDTH, header.cupsBytesPerLine);
+
+    cupsRasterClose(out);
+
+    for (method = 0; method < (int)(sizeof(methods) / sizeof(methods[0])); method ++)
+    {
+      for (pass = 0; pass < TEST_PASSES; pass ++)
+      {
+        pwg.pos    = 0;
+        copy.used  = 0;
+        start_secs = get_time();
+
+        in  = cupsRasterOpenIO(encode_read, &pwg, CUPS_RASTER_READ);
+        out = cupsRasterOpenIO(encode_write, &copy, method == 2 ? CUPS_RASTER_WRITE_APPLE : CUPS_RASTER_WRITE_PWG);
+
+        if (!in || !out)
+        {
+          perror("Unable to create raster streams");
+          cupsRasterClose(in);
+          cupsRasterClose(out);
+          break;
+        }
+
+        if (method == 0)
+        {
+          while (cupsRasterReadHeader(in, &header))
+          {
+            cupsRasterWriteHeader(out, &header);
+
+            for (y = 0; y < header.cupsHeight; y ++)
+            {
+              cupsRasterReadPixels(in, data + 32 * bpp * ENCODE_WIDTH, header.cupsBytesPerLine);
+              cupsRasterWritePixels(out, data + 32 * bpp * ENCODE_WIDTH, header.cupsBytesPerLine);
+            }
+          }
+        }
+        else
+        {
+          while (cupsRasterCopyPage(in, out));
+        }
+
+        cupsRasterClose(in);
+        cupsRasterClose(out);
+
+        pass_secs[pass] = get_time() - start_secs;
+      }
+
+      if (pass < TEST_PASSES)
+        break;
+
+      start_secs = compute_median(pass_secs, TEST_PASSES);
+
+      printf("%-8s %-17s %8.1f MiB/s raster, %8.1f MiB/s compressed\n", encode_spaces[i].name, methods[method], (double)header.cupsBytesPerLine * ENCODE_LINES / start_secs / 1048576.0, (double)pwg.used / start_secs / 1048576.0);
+    }
+
+    if (method < (int)(sizeof(methods) / sizeof(methods[0])))
+      break;
+  }
+
+  free(pwg.data);
+  free(copy.data);
+  free(data);
+}
+
+
+//
+// 'encode_data()' - Create raster lines for the compression benchmarks.
+//
+// 32 lines are created with runs of solid color and scattered random pixels to
+// simulate text and graphics on a white page.
+//
+
+static void
+encode_data(unsigned char *data,	// I - Raster data (32 lines)
+            size_t        bpp)		// I - Bytes per pixel
+{
+  size_t	j;			// Looping var
+  unsigned	x, y,			// Current position
+		count;			// Number of pixels to set
+
+
+  memset(data, 255, 32 * bpp * ENCODE_WIDTH);
+
+  for (y = 0; y < 28; y ++)
+  {
+    for (x = cupsGetRand() & 127, count = (cupsGetRand() & 15) + 1; x < ENCODE_WIDTH; x ++, count --)
+    {
+      if (count <= 0)
+      {
+        x     += (cupsGetRand() & 63) + 1;
+        count = (cupsGetRand() & 15) + 1;
+
+        if (x >= ENCODE_WIDTH)
+          break;
+      }
+
+      for (j = 0; j < bpp; j ++)
+        data[(y * ENCODE_WIDTH + x) * bpp + j] = (unsigned char)cupsGetRand();
+    }
+  }
+}
+
+
+//
+// 'encode_header()' - Create a page header for the compression benchmarks.
+//
+
+static void
+encode_header(
+    cups_page_header_t *header,		// I - Page header
+    size_t             i)		// I - Index into color spaces
+{
+  size_t	bpp = encode_spaces[i].bits * encode_spaces[i].colors / 8;
+					// Bytes per pixel
+
+
+  memset(header, 0, sizeof(cups_page_header_t));
+  cupsCopyString(header->MediaClass, "PwgRaster", sizeof(header->MediaClass));
+  header->cupsWidth        = ENCODE_WIDTH;
+  header->cupsHeight       = ENCODE_LINES;
+  header->cupsBitsPerColor = encode_spaces[i].bits;
+  header->cupsBitsPerPixel = (unsigned)(bpp * 8);
+  header->cupsBytesPerLine = (unsigned)(bpp * ENCODE_WIDTH);
+  header->cupsColorOrder   = CUPS_ORDER_CHUNKED;
+  header->cupsColorSpace   = encode_spaces[i].cspace;
+  header->cupsNumColors    = encode_spaces[i].colors;
+  header->HWResolution[0]  = 600;
+  header->HWResolution[1]  = 600;
+}
+
+
+//
+// 'encode_test()' - Benchmark PWG raster compression and decompression for
+//                   each color space.
+//
+// Compression is timed with 1, 2, 4, ... "max_threads" threads.
+//
+
+static void
+encode_test(size_t max_threads)		// I - Maximum number of threads
+{
+  size_t		i, j;		// Looping vars
+  unsigned		y,		// Current line
+			pass;		// Current pass
+  cups_raster_t		*r;		// Raster stream
+  cups_page_header_t	header;		// Page header
+  size_t		bpp,		// Bytes per pixel
+			num_threads;	// Number of compression threads
+  encode_buffer_t	buffer;		// Compressed data
+  unsigned char		*data;		// Raster data to write
+  double		start_secs,	// Start time
+			write_secs[TEST_THREADS],
+					// Median write times
+			pass_secs[TEST_PASSES];
+					// Time for each pass
+
+
+  printf("Test PWG raster compression of %dx%d pixel pages...\n\n", ENCODE_WIDTH, ENCODE_LINES);
+
+  memset(&buffer, 0, sizeof(buffer));
+
+  if ((data = malloc(33 * 8 * ENCODE_WIDTH)) == NULL)
+  {
+    perror("Unable to allocate raster data");
+    return;
+  }
+
+  for (i = 0; i < (sizeof(encode_spaces) / sizeof(encode_spaces[0])); i ++)
+  {
+    bpp = encode_spaces[i].bits * encode_spaces[i].colors / 8;
+
+    encode_data(data, bpp);
+    encode_header(&header, i);
+
+    for (j = 0, num_threads = 1; num_threads <= max_threads && j < TEST_THREADS; j ++, num_threads = (num_threads < max_threads && 2 * num_threads > max_threads) ? max_threads : 2 * num_threads)
+    {
+      for (pass = 0; pass < TEST_PASSES; pass ++)
+      {
+        buffer.used = 0;
+        start_secs  = get_time();
+
+        if ((r = cupsRasterOpenIO(encode_write, &buffer, CUPS_RASTER_WRITE_PWG)) == NULL)
+        {
+          perror("Unable to create raster output stream");
+          break;
+        }
+
+        cupsRasterSetThreads(r, num_threads);
+        cupsRasterWriteHeader(r, &header);
+
+        for (y = 0; y < ENCODE_LINES; y ++)
+          cupsRasterWritePixels(r, data + (y & 31) * bpp * ENCODE_WIDTH, header.cupsBytesPerLine);
+
+        cupsRasterClose(r);
+
+        pass_secs[pass] = get_time() - start_secs;
+      }
+
+      if (pass < TEST_PASSES)
+        break;
+
+      write_secs[j] = compute_median(pass_secs, TEST_PASSES);
+    }
+
+    if (pass < TEST_PASSES)
+      break;
+
+    for (pass = 0; pass < TEST_PASSES; pass ++)
+    {
+      buffer.pos = 0;
+      start_secs = get_time();
+
+      if ((r = cupsRasterOpenIO(encode_read, &buffer, CUPS_RASTER_READ)) == NULL)
+      {
+        perror("Unable to create raster input stream");
+        break;
+      }
+
+      while (cupsRasterReadHeader(r, &header))
+      {
+        for (y = 0; y < header.cupsHeight; y ++)
+          cupsRasterReadPixels(r, data + 32 * bpp * ENCODE_WIDTH, header.cupsBytesPerLine);
+      }
+
+      cupsRasterClose(r);
+
+      pass_secs[pass] = get_time() - start_secs;
+    }
+
+    if (pass < TEST_PASSES)
+      break;
+
+    start_secs = compute_median(pass_secs, TEST_PASSES);
+
+    printf("%-8s read %.1f MiB/s, %.1f%% of original size\n", encode_spaces[i].name, (double)header.cupsBytesPerLine * ENCODE_LINES / start_secs / 1048576.0, 100.0 * buffer.used / header.cupsBytesPerLine / ENCODE_LINES);
+
+    for (j = 0, num_threads = 1; num_threads <= max_threads && j < TEST_THREADS; j ++, num_threads = (num_threads < max_threads && 2 * num_threads > max_threads) ? max_threads : 2 * num_threads)
+      printf("         write %.1f MiB/s with %u thread%s\n", (double)header.cupsBytesPerLine * ENCODE_LINES / write_secs[j] / 1048576.0, (unsigned)num_threads, num_threads == 1 ? "" : "s");
+  }
+
+  free(buffer.data);
+  free(data);
+}
+
+
+//
+// 'encode_read()' - Read compressed raster data.
+//
+
+static ssize_t				// O - Number of bytes read
+encode_read(void          *ctx,		// I - Compressed data
+            unsigned char *buffer,	// I - Read buffer
+            size_t        length)	// I - Size of read buffer
+{
+  encode_buffer_t	*eb = (encode_buffer_t *)ctx;
+					// Compressed data
+
+
+  if (length > (eb->used - eb->pos))
+    length = eb->used - eb->pos;
+
+  memcpy(buffer, eb->data + eb->pos, length);
+  eb->pos += length;
+
+  return ((ssize_t)length);
+}
+
+
+//
+// 'encode_write()' - Save compressed raster data.
+//
+
+static ssize_t				// O - Number of bytes written
+encode_write(void          *ctx,	// I - Compressed data
+             unsigned char *buffer,	// I - Bytes to write
+             size_t        length)	// I - Number of bytes
+{
+  encode_buffer_t	*eb = (encode_buffer_t *)ctx;
+					// Compressed data
+
+
+  if ((eb->used + length) > eb->size)
+  {
+    size_t		size = 2 * (eb->used + length);
+					// New size
+    unsigned char	*data;		// New buffer
+
+    if ((data = realloc(eb->data, size)) == NULL)
+      return (-1);
+
+    eb->data = data;
+    eb->size = size;
+  }
+
+  memcpy(eb->data + eb->used, buffer, length);
+  eb->used += length;
+
+  return ((ssize_t)length);
+}
+
+
+//
+// 'get_memory()' - Get the number of bytes currently allocated.
+//
+// Returns 0 when the C library does not report memory use.
+//
+
+static size_t				// O - Bytes allocated
+get_memory(void)
+{
+#ifdef HAVE_MALLINFO2
+  return (mallinfo2().uordblks);
+#else
+  return (0);
+#endif // HAVE_MALLINFO2
 }
 
 
@@ -146,6 +692,340 @@ get_time(void)
 }
 
 
+//
+// 'matrix_data()' - Create raster lines for the benchmark matrix.
+//
+
+static void
+matrix_data(
+    unsigned char    *data,		// I - Raster data (MATRIX_LINES lines)
+    matrix_content_t content,		// I - Page content
+    size_t           space,		// I - Index into color spaces
+    unsigned         width)		// I - Width in pixels
+{
+  unsigned	x, y,			// Current position
+		c,			// Current color
+		colors = encode_spaces[space].colors,
+					// Number of colors
+		bytes = encode_spaces[space].bits / 8,
+					// Bytes per color
+		count,			// Pixels left in run
+		value;			// Color value
+  bool		ink;			// Draw ink in the current run?
+  unsigned char	white = encode_spaces[space].cspace == CUPS_CSPACE_CMYK ? 0 : 255,
+					// White color value
+		*ptr;			// Pointer into line
+  static const unsigned char bayer[4][4] =
+  {					// 4x4 ordered dither matrix
+    { 0, 8, 2, 10 },
+    { 12, 4, 14, 6 },
+    { 3, 11, 1, 9 },
+    { 15, 7, 13, 5 }
+  };
+
+
+  for (y = 0, ptr = data; y < MATRIX_LINES; y ++)
+  {
+    for (x = 0, count = 0, ink = false; x < width; x ++)
+    {
+      if (content == MATRIX_TEXT && count == 0)
+      {
+        // Alternate between short runs of ink and white space on 10 of every
+        // 16 lines to simulate lines of text...
+        ink   = (y & 15) < 10 && !ink;
+        count = ink ? (cupsGetRand() & 3) + 1 : (cupsGetRand() & 31) + 2;
+      }
+
+      for (c = 0; c < colors; c ++)
+      {
+        switch (content)
+        {
+          default :
+          case MATRIX_BLANK :
+              value = white;
+              break;
+
+          case MATRIX_TEXT :
+              value = ink ? 255 - white : white;
+              break;
+
+          case MATRIX_PHOTO :
+              value = (x * 255 / width + y * 2 + c * 64 + ((x & 3) ? 0 : cupsGetRand() & 7)) & 255;
+              break;
+
+          case MATRIX_HALFTONE :
+              value = ((x * 255 / width + c * 64) & 255) > (unsigned)(bayer[y & 3][x & 3] * 16 + 8) ? 255 - white : white;
+              break;
+        }
+
+        *ptr++ = (unsigned char)value;
+
+        if (bytes == 2)
+          *ptr++ = content == MATRIX_PHOTO ? (unsigned char)cupsGetRand() : (unsigned char)value;
+      }
+
+      if (count > 0)
+        count --;
+    }
+  }
+}
+
+
+//
+// 'matrix_test()' - Run the benchmark matrix.
+//
+// Each combination of color space, resolution, page content, and write mode
+// is written to and read from memory.  The results can be saved to a JSON
+// file and compared to the results from a previous run.
+//
+// A case is reported as slower when its speed drops by more than the
+// threshold plus the pass-to-pass spread of both runs, so that noisy cases
+// need a larger drop before they are reported.
+//
+
+static int				// O - Exit status
+matrix_test(
+    unsigned   passes,			// I - Number of passes
+    size_t     num_threads,		// I - Number of compression threads
+    const char *jsonfile,		// I - JSON results file or `NULL`
+    const char *comparefile,		// I - JSON baseline file or `NULL`
+    double     threshold)		// I - Slowdown threshold in percent
+{
+  size_t		space,		// Current color space
+			bpp,		// Bytes per pixel
+			memory,		// Memory before opening stream
+			write_memory,	// Memory used for writing
+			read_memory;	// Memory used for reading
+  unsigned		res,		// Current resolution
+			pass,		// Current pass
+			y,		// Current line
+			slowdowns = 0;	// Number of slowdowns
+  int			content,	// Current content
+			mode,		// Current write mode
+			status = 1;	// Exit status
+  cups_raster_t		*r;		// Raster stream
+  cups_page_header_t	header;		// Page header
+  encode_buffer_t	buffer;		// Raster data
+  unsigned char		*data = NULL,	// Raster lines
+			*line;		// Line buffer
+  double		start_secs,	// Start time
+			*pass_secs,	// Time for each pass
+			write_secs,	// Median write time
+			write_spread,	// Relative spread of write times
+			read_secs,	// Median read time
+			read_spread,	// Relative spread of read times
+			raw_bytes,	// Uncompressed bytes
+			write_mib,	// Write speed in MiB/s
+			read_mib;	// Read speed in MiB/s
+  char			name[256];	// Name of test
+  cups_json_t		*json,		// JSON results
+			*results,	// Results object
+			*result,	// Current result
+			*baseline = NULL,
+					// Baseline results
+			*base;		// Baseline result
+  static const unsigned	resolutions[] = { 150, 300, 600 };
+					// Resolutions to test
+  static const char * const contents[] =
+  {					// Page contents
+    "blank",
+    "text",
+    "photo",
+    "halftone"
+  };
+  static const char * const modes[] =	// Write modes
+  {
+    "",
+    "cups",
+    "cups-compressed",
+    "pwg",
+    "apple"
+  };
+
+
+  if (comparefile && ((baseline = cupsJSONImportFile(comparefile)) == NULL || !cupsJSONFind(baseline, "results")))
+  {
+    printf("rasterbench: Unable to load baseline '%s'.\n", comparefile);
+    cupsJSONDelete(baseline);
+    return (1);
+  }
+
+  if ((pass_secs = calloc(passes, sizeof(double))) == NULL)
+  {
+    perror("Unable to allocate memory");
+    cupsJSONDelete(baseline);
+    return (1);
+  }
+
+  json = cupsJSONNew(NULL, NULL, CUPS_JTYPE_OBJECT);
+  cupsJSONNewNumber(json, cupsJSONNewKey(json, NULL, "passes"), passes);
+  cupsJSONNewNumber(json, cupsJSONNewKey(json, NULL, "threads"), num_threads);
+  results = cupsJSONNew(json, cupsJSONNewKey(json, NULL, "results"), CUPS_JTYPE_OBJECT);
+
+  memset(&buffer, 0, sizeof(buffer));
+
+  printf("Test raster read/write speed of US Letter pages, %u passes...\n\n", passes);
+  printf("%-8s %4s %-8s %-15s %10s %10s %10s %10s %7s %9s %9s\n", "Space", "DPI", "Content", "Mode", "Write MiB", "Lines/s", "Read MiB", "Lines/s", "Ratio", "Write KiB", "Read KiB");
+
+  for (space = 0; space < (sizeof(encode_spaces) / sizeof(encode_spaces[0])); space ++)
+  {
+    bpp = encode_spaces[space].bits * encode_spaces[space].colors / 8;
+
+    for (res = 0; res < (sizeof(resolutions) / sizeof(resolutions[0])); res ++)
+    {
+      encode_header(&header, space);
+      header.cupsWidth        = 17 * resolutions[res] / 2;
+      header.cupsHeight       = 11 * resolutions[res];
+      header.cupsBytesPerLine = (unsigned)(bpp * header.cupsWidth);
+      header.HWResolution[0]  = resolutions[res];
+      header.HWResolution[1]  = resolutions[res];
+      header.PageSize[0]      = 612;
+      header.PageSize[1]      = 792;
+
+      raw_bytes = (double)header.cupsBytesPerLine * header.cupsHeight;
+
+      free(data);
+      if ((data = malloc((MATRIX_LINES + 1) * header.cupsBytesPerLine)) == NULL)
+      {
+        perror("Unable to allocate raster data");
+        goto done;
+      }
+
+      line = data + MATRIX_LINES * header.cupsBytesPerLine;
+
+      for (content = MATRIX_BLANK; content < MATRIX_MAX; content ++)
+      {
+        matrix_data(data, (matrix_content_t)content, space, header.cupsWidth);
+
+        for (mode = CUPS_RASTER_WRITE; mode <= CUPS_RASTER_WRITE_APPLE; mode ++)
+        {
+          // Time writing...
+          for (pass = 0, write_memory = 0; pass < passes; pass ++)
+          {
+            buffer.used = 0;
+            memory      = get_memory();
+            start_secs  = get_time();
+
+            if ((r = cupsRasterOpenIO(encode_write, &buffer, (cups_raster_mode_t)mode)) == NULL)
+            {
+              perror("Unable to create raster output stream");
+              goto done;
+            }
+
+            cupsRasterSetThreads(r, num_threads);
+            cupsRasterWriteHeader(r, &header);
+
+            for (y = 0; y < header.cupsHeight; y ++)
+            {
+              cupsRasterWritePixels(r, data + (y % MATRIX_LINES) * header.cupsBytesPerLine, header.cupsBytesPerLine);
+
+              if (y == 0 && pass == (passes - 1) && get_memory() > memory)
+                write_memory = get_memory() - memory;
+            }
+
+            cupsRasterClose(r);
+
+            pass_secs[pass] = get_time() - start_secs;
+          }
+
+          // compute_median() sorts the times, so the spread is last - first...
+          write_secs   = compute_median(pass_secs, passes);
+          write_spread = (pass_secs[passes - 1] - pass_secs[0]) / write_secs;
+
+          // Time reading...
+          for (pass = 0, read_memory = 0; pass < passes; pass ++)
+          {
+            buffer.pos = 0;
+            memory     = get_memory();
+            start_secs = get_time();
+
+            if ((r = cupsRasterOpenIO(encode_read, &buffer, CUPS_RASTER_READ)) == NULL)
+            {
+              perror("Unable to create raster input stream");
+              goto done;
+            }
+
+            while (cupsRasterReadHeader(r, &header))
+            {
+              for (y = 0; y < header.cupsHeight; y ++)
+              {
+                cupsRasterReadPixels(r, line, header.cupsBytesPerLine);
+
+                if (y == 0 && pass == (passes - 1) && get_memory() > memory)
+                  read_memory = get_memory() - memory;
+              }
+            }
+
+            cupsRasterClose(r);
+
+            pass_secs[pass] = get_time() - start_secs;
+          }
+
+          read_secs   = compute_median(pass_secs, passes);
+          read_spread = (pass_secs[passes - 1] - pass_secs[0]) / read_secs;
+
+          // Report the results...
+          write_mib = raw_bytes / write_secs / 1048576.0;
+          read_mib  = raw_bytes / read_secs / 1048576.0;
+
+          snprintf(name, sizeof(name), "%s/%udpi/%s/%s", encode_spaces[space].name, resolutions[res], contents[content], modes[mode]);
+
+          result = cupsJSONNew(results, cupsJSONNewKey(results, NULL, name), CUPS_JTYPE_OBJECT);
+          cupsJSONNewNumber(result, cupsJSONNewKey(result, NULL, "write_mib_s"), write_mib);
+          cupsJSONNewNumber(result, cupsJSONNewKey(result, NULL, "write_lines_s"), header.cupsHeight / write_secs);
+          cupsJSONNewNumber(result, cupsJSONNewKey(result, NULL, "write_spread"), write_spread);
+          cupsJSONNewNumber(result, cupsJSONNewKey(result, NULL, "read_mib_s"), read_mib);
+          cupsJSONNewNumber(result, cupsJSONNewKey(result, NULL, "read_lines_s"), header.cupsHeight / read_secs);
+          cupsJSONNewNumber(result, cupsJSONNewKey(result, NULL, "read_spread"), read_spread);
+          cupsJSONNewNumber(result, cupsJSONNewKey(result, NULL, "ratio"), buffer.used / raw_bytes);
+          cupsJSONNewNumber(result, cupsJSONNewKey(result, NULL, "write_memory"), write_memory);
+          cupsJSONNewNumber(result, cupsJSONNewKey(result, NULL, "read_memory"), read_memory);
+
+          printf("%-8s %4u %-8s %-15s %10.1f %10.0f %10.1f %10.0f %6.1f%% %9.0f %9.0f", encode_spaces[space].name, resolutions[res], contents[content], modes[mode], write_mib, header.cupsHeight / write_secs, read_mib, header.cupsHeight / read_secs, 100.0 * buffer.used / raw_bytes, write_memory / 1024.0, read_memory / 1024.0);
+
+          if (baseline && (base = cupsJSONFind(cupsJSONFind(baseline, "results"), name)) != NULL)
+          {
+            double	base_write = cupsJSONGetNumber(cupsJSONFind(base, "write_mib_s")),
+			base_read = cupsJSONGetNumber(cupsJSONFind(base, "read_mib_s")),
+					// Baseline speeds
+			write_allowed = 0.01 * threshold + write_spread + cupsJSONGetNumber(cupsJSONFind(base, "write_spread")),
+			read_allowed = 0.01 * threshold + read_spread + cupsJSONGetNumber(cupsJSONFind(base, "read_spread"));
+					// Allowed fractional slowdowns
+
+            if (write_mib < base_write * (1.0 - write_allowed) || read_mib < base_read * (1.0 - read_allowed))
+            {
+              printf("  SLOWER (write %+.1f%%, read %+.1f%%)", 100.0 * (write_mib - base_write) / base_write, 100.0 * (read_mib - base_read) / base_read);
+              slowdowns ++;
+            }
+          }
+
+          putchar('\n');
+          fflush(stdout);
+        }
+      }
+    }
+  }
+
+  if (baseline)
+    printf("\n%u slowdown%s of more than %g%% (plus pass-to-pass spread) compared to '%s'.\n", slowdowns, slowdowns == 1 ? "" : "s", threshold, comparefile);
+
+  if (jsonfile && !cupsJSONExportFile(json, jsonfile))
+    printf("rasterbench: Unable to save '%s'.\n", jsonfile);
+  else
+    status = slowdowns > 0;
+
+  done:
+
+  cupsJSONDelete(json);
+  cupsJSONDelete(baseline);
+  free(pass_secs);
+  free(buffer.data);
+  free(data);
+
+  return (status);
+}
+
+
 //
 // 'read_test()' - Benchmark the raster read functions.
 //
@@ -221,7 +1101,9 @@ run_read_test(void)
 
 static void
 write_test(int                fd,	// I - File descriptor to write to
-           cups_raster_mode_t mode)	// I - Write mode
+           cups_raster_mode_t mode,	// I - Write mode
+           size_t             num_threads)
+					// I - Number of compression threads
 {
   unsigned		page, x, y;	// Looping vars
   unsigned		count;		// Number of bytes to set
@@ -261,6 +1143,8 @@ write_test(int                fd,	// I - File descriptor to write to
     return;
   }
 
+  cupsRasterSetThreads(r, num_threads);
+
   for (page = 0; page < TEST_PAGES; page ++)
   {
     memset(&header, 0, sizeof(header));
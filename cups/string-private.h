@@ -125,8 +125,8 @@ extern void	_cupsStrFlush(void) _CUPS_PRIVATE;
 extern void	_cupsStrFree(const char *s) _CUPS_PRIVATE;
 extern char	*_cupsStrRetain(const char *s) _CUPS_PRIVATE;
 extern size_t	_cupsStrStatistics(size_t *alloc_bytes, size_t *total_bytes) _CUPS_PRIVATE;
-extern char	*_cupsStrFormatd(char *buf, char *bufend, double number, struct lconv *loc) _CUPS_PRIVATE;
-extern double	_cupsStrScand(const char *buf, char **bufptr, struct lconv *loc) _CUPS_PRIVATE;
+extern char	*_cupsStrFormatd(char *buf, char *bufend, double number) _CUPS_PRIVATE;
+extern double	_cupsStrScand(const char *buf, char **bufptr) _CUPS_PRIVATE;
 
 
 #  ifdef __cplusplus
@@ -13,6 +13,29 @@
 #include "cups-private.h"
 #include <stddef.h>
 #include <limits.h>
+#include <float.h>
+#include <math.h>
+
+
+//
+// Local constants...
+//
+
+#define _CUPS_BIGNUM_WORDS	160	// Words in a big integer (5120 bits)
+#define _CUPS_MAX_DIGITS	800	// Maximum number of formatted digits
+#define _CUPS_MAX_SCAN_DIGITS	768	// Maximum number of significant digits
+
+
+//
+// Local types...
+//
+
+typedef struct _cups_bignum_s		// Big integer for exact conversions
+{
+  int		num_words;		// Number of words
+  uint32_t	words[_CUPS_BIGNUM_WORDS];
+					// Words, least significant first
+} _cups_bignum_t;
 
 
 //
@@ -23,13 +46,35 @@ static cups_mutex_t	sp_mutex = CUPS_MUTEX_INITIALIZER;
 					// Mutex to control access to pool
 static cups_array_t	*stringpool = NULL;
 					// Global string pool
+static const double	exact_pow10[] =	// Powers of 10 that are exact doubles
+{
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const uint32_t	pow10_32[] =	// Powers of 10 that fit in 32 bits
+{
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
 
 
 //
 // Local functions...
 //
 
+static void	bignum_add(_cups_bignum_t *a, const _cups_bignum_t *b);
+static int	bignum_cmp(const _cups_bignum_t *a, const _cups_bignum_t *b);
+static void	bignum_mul(_cups_bignum_t *a, uint32_t m, uint32_t add);
+static void	bignum_pow10(_cups_bignum_t *a, int n);
+static void	bignum_set(_cups_bignum_t *a, uint64_t v);
+static void	bignum_shl(_cups_bignum_t *a, int n);
+static void	bignum_sub(_cups_bignum_t *a, const _cups_bignum_t *b);
+static int	compare_scaled(const _cups_bignum_t *value, int decexp, uint64_t m, int k);
 static int	compare_sp_items(_cups_sp_item_t *a, _cups_sp_item_t *b);
+static void	format_double(char *buf, size_t bufsize, const char *tformat, char type, double number);
+static int	get_digits(double number, bool fixed, int prec, char *digits, int *decexp);
+static int	get_mantissa(double number, uint64_t *m);
+static int	get_shortest(double number, char *digits, int *decexp);
+static size_t	hash_sp_item(_cups_sp_item_t *item);
 static void	validate_end(char *s, char *end);
 
 
@@ -312,7 +357,7 @@ cupsFormatStringv(
 	    if ((size_t)(width + 2) > sizeof(temp))
 	      break;
 
-	    snprintf(temp, sizeof(temp), tformat, va_arg(ap, double));
+	    format_double(temp, sizeof(temp), tformat, type, va_arg(ap, double));
 
             bytes += (int)strlen(temp);
 
@@ -514,7 +559,7 @@ _cupsStrAlloc(const char *s)		// I - String
   cupsMutexLock(&sp_mutex);
 
   if (!stringpool)
-    stringpool = cupsArrayNew((cups_array_cb_t)compare_sp_items, NULL, NULL, 0, NULL, NULL);
+    stringpool = cupsArrayNewHash((cups_array_cb_t)compare_sp_items, NULL, (cups_ahash_cb_t)hash_sp_item, false, NULL, NULL);
 
   if (!stringpool)
   {
@@ -598,73 +643,126 @@ _cupsStrFlush(void)
 //
 // '_cupsStrFormatd()' - Format a floating-point number.
 //
+// This function formats the shortest string that scans back to the same
+// number, always using a period (".") for the decimal point.  Numbers between
+// 1e-6 and 1e21 are formatted without an exponent.
+//
 
 char *					// O - Pointer to end of string
-_cupsStrFormatd(char         *buf,	// I - String
-                char         *bufend,	// I - End of string buffer
-		double       number,	// I - Number to format
-                struct lconv *loc)	// I - Locale data
+_cupsStrFormatd(char   *buf,		// I - String
+                char   *bufend,		// I - End of string buffer
+		double number)		// I - Number to format
 {
-  char		*bufptr,		// Pointer into buffer
-		temp[1024],		// Temporary string
-		*tempdec,		// Pointer to decimal point
-		*tempptr;		// Pointer into temporary string
-  const char	*dec;			// Decimal point
-  int		declen;			// Length of decimal point
+  char		temp[64],		// Temporary string
+		*tempptr,		// Pointer into temporary string
+		digits[32];		// Significant digits
+  int		i,			// Looping var
+		ndigits,		// Number of digits
+		decexp;			// Decimal exponent
+  uint64_t	inumber;		// Integer value
 
 
-  // Format the number using the "%.12f" format and then eliminate unnecessary trailing 0's.
-  snprintf(temp, sizeof(temp), "%.12f", number);
-  tempptr = temp + strlen(temp) - 1;
-  while (tempptr > temp && *tempptr == '0')
-    *tempptr-- = '\0';
+  tempptr = temp;
 
-  // Next, find the decimal point...
-  if (loc && loc->decimal_point)
+  if (isnan(number))
   {
-    dec    = loc->decimal_point;
-    declen = (int)strlen(dec);
+    cupsCopyString(temp, "nan", sizeof(temp));
+    tempptr += 3;
   }
   else
   {
-    dec    = ".";
-    declen = 1;
-  }
-
-  if (declen == 1)
-    tempdec = strchr(temp, *dec);
-  else
-    tempdec = strstr(temp, dec);
+    if (signbit(number))
+    {
+      *tempptr++ = '-';
+      number     = -number;
+    }
 
-  // Copy everything up to the decimal point...
-  if (tempdec)
-  {
-    tempptr = temp;
-    bufptr  = buf;
-    while (tempptr < tempdec && bufptr < bufend)
+    if (isinf(number))
     {
-      *bufptr++ = *tempptr++;
+      cupsCopyString(tempptr, "inf", sizeof(temp) - 1);
+      tempptr += 3;
     }
+    else if (number < 9007199254740992.0 && number == floor(number))
+    {
+      // Integers up to 2^53 are exact, so just format the digits...
+      inumber = (uint64_t)number;
+      ndigits = 0;
 
-    tempptr += declen;
+      do
+      {
+        digits[ndigits ++] = (char)('0' + inumber % 10);
+        inumber /= 10;
+      }
+      while (inumber);
 
-    if (*tempptr && bufptr < bufend)
+      while (ndigits > 0)
+        *tempptr++ = digits[-- ndigits];
+    }
+    else
     {
-      *bufptr++ = '.';
+      // Get the shortest digits that uniquely identify the number, where the
+      // number is 0.DDDDDD * 10^decexp...
+      ndigits = get_shortest(number, digits, &decexp);
 
-      while (*tempptr && bufptr < bufend)
-        *bufptr++ = *tempptr++;
-    }
+      if (decexp > 0 && decexp <= 21)
+      {
+        // DDD[.DDD]
+        for (i = 0; i < decexp; i ++)
+          *tempptr++ = i < ndigits ? digits[i] : '0';
+
+        if (ndigits > decexp)
+        {
+          *tempptr++ = '.';
+          memcpy(tempptr, digits + decexp, (size_t)(ndigits - decexp));
+          tempptr += ndigits - decexp;
+        }
+      }
+      else if (decexp <= 0 && decexp > -6)
+      {
+        // 0.000DDD
+        *tempptr++ = '0';
+        *tempptr++ = '.';
 
-    *bufptr = '\0';
-  }
-  else
-  {
-    cupsCopyString(buf, temp, (size_t)(bufend - buf + 1));
-    bufptr = buf + strlen(buf);
+        for (i = decexp; i < 0; i ++)
+          *tempptr++ = '0';
+
+        memcpy(tempptr, digits, (size_t)ndigits);
+        tempptr += ndigits;
+      }
+      else
+      {
+        // D[.DDD]e+/-NNN
+        *tempptr++ = digits[0];
+
+        if (ndigits > 1)
+        {
+          *tempptr++ = '.';
+          memcpy(tempptr, digits + 1, (size_t)(ndigits - 1));
+          tempptr += ndigits - 1;
+        }
+
+        decexp --;
+
+        *tempptr++ = 'e';
+        *tempptr++ = decexp < 0 ? '-' : '+';
+
+        if (decexp < 0)
+          decexp = -decexp;
+
+        if (decexp >= 100)
+          *tempptr++ = (char)('0' + decexp / 100);
+        if (decexp >= 10)
+          *tempptr++ = (char)('0' + (decexp / 10) % 10);
+        *tempptr++ = (char)('0' + decexp % 10);
+      }
+    }
   }
 
-  return (bufptr);
+  *tempptr = '\0';
+
+  cupsCopyString(buf, temp, (size_t)(bufend - buf + 1));
+
+  return (buf + strlen(buf));
 }
 
 
@@ -754,17 +852,25 @@ _cupsStrRetain(const char *s)		// I - String to retain
 //
 // '_cupsStrScand()' - Scan a string for a floating-point number.
 //
-// This function handles the locale-specific BS so that a decimal
-// point is always the period (".")...
+// This function always uses a period (".") for the decimal point and returns
+// the nearest floating-point number, regardless of the number of digits.
 //
 
 double					// O - Number
-_cupsStrScand(const char   *buf,	// I - Pointer to number
-              char         **bufptr,	// O - New pointer or NULL on error
-              struct lconv *loc)	// I - Locale data
+_cupsStrScand(const char *buf,		// I - Pointer to number
+              char       **bufptr)	// O - New pointer
 {
-  char	temp[1024],			// Temporary buffer
-	*tempptr;			// Pointer into temporary buffer
+  bool		negative = false,	// Negative number?
+		truncated = false;	// Were non-zero digits dropped?
+  char		digits[_CUPS_MAX_SCAN_DIGITS];
+					// Significant digits
+  int		ndigits = 0,		// Number of significant digits
+		decexp = 0,		// Decimal exponent
+		expval = 0,		// Exponent value
+		i;			// Looping var
+  bool		expneg = false;		// Negative exponent?
+  uint64_t	mantissa;		// Mantissa
+  double	number;			// Number
 
 
   // Range check input...
@@ -775,60 +881,46 @@ _cupsStrScand(const char   *buf,	// I - Pointer to number
   while (_cups_isspace(*buf))
     buf ++;
 
-  // Copy leading sign, numbers, period, and then numbers...
-  tempptr = temp;
+  // Get the leading sign, numbers, period, and then numbers, keeping the
+  // significant digits and the decimal exponent...
   if (*buf == '-' || *buf == '+')
-    *tempptr++ = *buf++;
+    negative = *buf++ == '-';
 
-  while (isdigit(*buf & 255))
+  for (; isdigit(*buf & 255); buf ++)
   {
-    if (tempptr < (temp + sizeof(temp) - 1))
+    if (ndigits == 0 && *buf == '0')
+      continue;
+
+    if (ndigits < _CUPS_MAX_SCAN_DIGITS)
     {
-      *tempptr++ = *buf++;
+      digits[ndigits ++] = *buf;
     }
     else
     {
-      if (bufptr)
-	*bufptr = NULL;
+      decexp ++;
 
-      return (0.0);
+      if (*buf != '0')
+        truncated = true;
     }
   }
 
   if (*buf == '.')
   {
     // Read fractional portion of number...
-    buf ++;
-
-    if (loc && loc->decimal_point)
+    for (buf ++; isdigit(*buf & 255); buf ++)
     {
-      cupsCopyString(tempptr, loc->decimal_point, sizeof(temp) - (size_t)(tempptr - temp));
-      tempptr += strlen(tempptr);
-    }
-    else if (tempptr < (temp + sizeof(temp) - 1))
-    {
-      *tempptr++ = '.';
-    }
-    else
-    {
-      if (bufptr)
-        *bufptr = NULL;
-
-      return (0.0);
-    }
-
-    while (isdigit(*buf & 255))
-    {
-      if (tempptr < (temp + sizeof(temp) - 1))
+      if (ndigits == 0 && *buf == '0')
       {
-	*tempptr++ = *buf++;
+        decexp --;
       }
-      else
+      else if (ndigits < _CUPS_MAX_SCAN_DIGITS)
       {
-	if (bufptr)
-	  *bufptr = NULL;
-
-	return (0.0);
+        digits[ndigits ++] = *buf;
+        decexp --;
+      }
+      else if (*buf != '0')
+      {
+        truncated = true;
       }
     }
   }
@@ -836,56 +928,124 @@ _cupsStrScand(const char   *buf,	// I - Pointer to number
   if (*buf == 'e' || *buf == 'E')
   {
     // Read exponent...
-    if (tempptr < (temp + sizeof(temp) - 1))
+    buf ++;
+
+    if (*buf == '+' || *buf == '-')
+      expneg = *buf++ == '-';
+
+    for (; isdigit(*buf & 255); buf ++)
+    {
+      if (expval < 100000)
+        expval = expval * 10 + *buf - '0';
+    }
+
+    decexp += expneg ? -expval : expval;
+  }
+
+  if (bufptr)
+    *bufptr = (char *)buf;
+
+  // Drop trailing zeros...
+  while (ndigits > 0 && digits[ndigits - 1] == '0')
+  {
+    ndigits --;
+    decexp ++;
+  }
+
+  if (ndigits == 0)
+    return (negative ? -0.0 : 0.0);
+  else if (ndigits + decexp > 310)
+    return (negative ? -HUGE_VAL : HUGE_VAL);
+  else if (ndigits + decexp < -324)
+    return (negative ? -0.0 : 0.0);
+
+  for (i = 0, mantissa = 0; i < ndigits && i < 19; i ++)
+    mantissa = mantissa * 10 + (uint64_t)(digits[i] - '0');
+
+  if (ndigits <= 19 && mantissa <= 9007199254740992ULL && !truncated && decexp >= -22 && decexp <= 22 + 15 - ndigits)
+  {
+    // The mantissa and power of 10 are exact, so a single multiply or divide
+    // gives the correctly rounded result...
+    if (decexp > 22)
     {
-      *tempptr++ = *buf++;
+      mantissa *= (uint64_t)exact_pow10[decexp - 22];
+      decexp   = 22;
     }
+
+    if (decexp < 0)
+      number = (double)mantissa / exact_pow10[-decexp];
     else
+      number = (double)mantissa * exact_pow10[decexp];
+  }
+  else
+  {
+    _cups_bignum_t	value;		// Significant digits as an integer
+    uint64_t		m;		// Mantissa of current guess
+    int			k,		// Binary exponent of current guess
+			ret;		// Comparison result
+
+    // Start with a close guess...
+    if ((i = decexp + ndigits - i) >= -22 && i <= 22)
+      number = i < 0 ? (double)mantissa / exact_pow10[-i] : (double)mantissa * exact_pow10[i];
+    else if (i < -290)
+      number = (double)mantissa * pow(10.0, i + 300) * 1e-300;
+    else
+      number = (double)mantissa * pow(10.0, i);
+
+    if (isinf(number))
+      number = DBL_MAX;
+    else if (number == 0.0)
+      number = nextafter(0.0, 1.0);
+
+    // Then correct it by comparing against the halfway points to the
+    // neighboring numbers...
+    bignum_set(&value, 0);
+    for (i = 0; i < ndigits; i += 9)
     {
-      if (bufptr)
-	*bufptr = NULL;
+      int	j,			// Looping var
+		len;			// Length of chunk
+      uint32_t	chunk;			// Chunk of digits
+
+      for (j = 0, len = ndigits - i > 9 ? 9 : ndigits - i, chunk = 0; j < len; j ++)
+        chunk = chunk * 10 + (uint32_t)(digits[i + j] - '0');
 
-      return (0.0);
+      bignum_mul(&value, pow10_32[len], chunk);
     }
 
-    if (*buf == '+' || *buf == '-')
+    for (;;)
     {
-      if (tempptr < (temp + sizeof(temp) - 1))
+      k = get_mantissa(number, &m);
+
+      if ((ret = compare_scaled(&value, decexp, 2 * m + 1, k - 1)) == 0 && truncated)
+        ret = 1;
+
+      if (ret > 0 || (ret == 0 && (m & 1)))
       {
-	*tempptr++ = *buf++;
+        if (isinf(number = nextafter(number, HUGE_VAL)))
+          break;
+        continue;
       }
+
+      if (m == 0x10000000000000ULL && k > -1074)
+        ret = compare_scaled(&value, decexp, 4 * m - 1, k - 2);
       else
-      {
-	if (bufptr)
-	  *bufptr = NULL;
+        ret = compare_scaled(&value, decexp, 2 * m - 1, k - 1);
 
-	return (0.0);
-      }
-    }
+      if (ret == 0 && truncated)
+        ret = 1;
 
-    while (isdigit(*buf & 255))
-    {
-      if (tempptr < (temp + sizeof(temp) - 1))
+      if (ret < 0 || (ret == 0 && (m & 1)))
       {
-	*tempptr++ = *buf++;
+        if ((number = nextafter(number, 0.0)) == 0.0)
+          break;
+        continue;
       }
-      else
-      {
-	if (bufptr)
-	  *bufptr = NULL;
 
-	return (0.0);
-      }
+      break;
     }
   }
 
-  // Nul-terminate the temporary string and return the value...
-  if (bufptr)
-    *bufptr = (char *)buf;
-
-  *tempptr = '\0';
-
-  return (strtod(temp, NULL));
+  return (negative ? -number : number);
 }
 
 
@@ -1003,6 +1163,216 @@ _cups_strncasecmp(const char *s,	// I - First string
 }
 
 
+//
+// 'bignum_add()' - Add two big integers.
+//
+
+static void
+bignum_add(_cups_bignum_t       *a,	// I - Big integer (sum)
+           const _cups_bignum_t *b)	// I - Big integer to add
+{
+  int		i,			// Looping var
+		num_words;		// Number of words
+  uint64_t	carry;			// Carry
+
+
+  num_words = a->num_words > b->num_words ? a->num_words : b->num_words;
+
+  for (i = 0, carry = 0; i < num_words; i ++)
+  {
+    carry       += (uint64_t)(i < a->num_words ? a->words[i] : 0) + (i < b->num_words ? b->words[i] : 0);
+    a->words[i] = (uint32_t)carry;
+    carry       >>= 32;
+  }
+
+  if (carry && num_words < _CUPS_BIGNUM_WORDS)
+    a->words[num_words ++] = (uint32_t)carry;
+
+  a->num_words = num_words;
+}
+
+
+//
+// 'bignum_cmp()' - Compare two big integers.
+//
+
+static int				// O - Result of comparison
+bignum_cmp(const _cups_bignum_t *a,	// I - First big integer
+           const _cups_bignum_t *b)	// I - Second big integer
+{
+  int	i;				// Looping var
+
+
+  if (a->num_words != b->num_words)
+    return (a->num_words < b->num_words ? -1 : 1);
+
+  for (i = a->num_words - 1; i >= 0; i --)
+  {
+    if (a->words[i] != b->words[i])
+      return (a->words[i] < b->words[i] ? -1 : 1);
+  }
+
+  return (0);
+}
+
+
+//
+// 'bignum_mul()' - Multiply a big integer and add a small integer.
+//
+
+static void
+bignum_mul(_cups_bignum_t *a,		// I - Big integer
+           uint32_t       m,		// I - Multiplier
+           uint32_t       add)		// I - Value to add
+{
+  int		i;			// Looping var
+  uint64_t	carry;			// Carry
+
+
+  for (i = 0, carry = add; i < a->num_words; i ++)
+  {
+    carry       += (uint64_t)a->words[i] * m;
+    a->words[i] = (uint32_t)carry;
+    carry       >>= 32;
+  }
+
+  if (carry && a->num_words < _CUPS_BIGNUM_WORDS)
+    a->words[a->num_words ++] = (uint32_t)carry;
+}
+
+
+//
+// 'bignum_pow10()' - Multiply a big integer by a power of 10.
+//
+
+static void
+bignum_pow10(_cups_bignum_t *a,		// I - Big integer
+             int            n)		// I - Power of 10
+{
+  for (; n >= 9; n -= 9)
+    bignum_mul(a, pow10_32[9], 0);
+
+  if (n > 0)
+    bignum_mul(a, pow10_32[n], 0);
+}
+
+
+//
+// 'bignum_set()' - Set a big integer to a 64-bit value.
+//
+
+static void
+bignum_set(_cups_bignum_t *a,		// I - Big integer
+           uint64_t       v)		// I - Value
+{
+  for (a->num_words = 0; v; v >>= 32)
+    a->words[a->num_words ++] = (uint32_t)v;
+}
+
+
+//
+// 'bignum_shl()' - Multiply a big integer by a power of 2.
+//
+
+static void
+bignum_shl(_cups_bignum_t *a,		// I - Big integer
+           int            n)		// I - Power of 2
+{
+  int		i,			// Looping var
+		words = n / 32,		// Number of words to shift
+		bits = n % 32;		// Number of bits to shift
+  uint32_t	carry,			// Carry
+		word;			// Current word
+
+
+  if (a->num_words == 0 || n <= 0)
+    return;
+
+  if (bits)
+  {
+    for (i = 0, carry = 0; i < a->num_words; i ++)
+    {
+      word        = a->words[i];
+      a->words[i] = (word << bits) | carry;
+      carry       = word >> (32 - bits);
+    }
+
+    if (carry && a->num_words < _CUPS_BIGNUM_WORDS)
+      a->words[a->num_words ++] = carry;
+  }
+
+  if (words)
+  {
+    if (a->num_words + words > _CUPS_BIGNUM_WORDS)
+      words = _CUPS_BIGNUM_WORDS - a->num_words;
+
+    memmove(a->words + words, a->words, (size_t)a->num_words * sizeof(uint32_t));
+    memset(a->words, 0, (size_t)words * sizeof(uint32_t));
+    a->num_words += words;
+  }
+}
+
+
+//
+// 'bignum_sub()' - Subtract a smaller big integer from a big integer.
+//
+
+static void
+bignum_sub(_cups_bignum_t       *a,	// I - Big integer (difference)
+           const _cups_bignum_t *b)	// I - Big integer to subtract
+{
+  int		i;			// Looping var
+  uint64_t	borrow;			// Borrow
+
+
+  for (i = 0, borrow = 0; i < a->num_words; i ++)
+  {
+    uint64_t sub = (i < b->num_words ? b->words[i] : 0) + borrow;
+					// Amount to subtract
+
+    borrow      = (uint64_t)a->words[i] < sub;
+    a->words[i] = (uint32_t)((uint64_t)a->words[i] - sub);
+  }
+
+  while (a->num_words > 0 && a->words[a->num_words - 1] == 0)
+    a->num_words --;
+}
+
+
+//
+// 'compare_scaled()' - Compare "value * 10^decexp" against "m * 2^k".
+//
+
+static int				// O - Result of comparison
+compare_scaled(
+    const _cups_bignum_t *value,	// I - Decimal value
+    int                  decexp,	// I - Decimal exponent
+    uint64_t             m,		// I - Binary mantissa
+    int                  k)		// I - Binary exponent
+{
+  _cups_bignum_t	left,		// Left side
+			right;		// Right side
+
+
+  left.num_words = value->num_words;
+  memcpy(left.words, value->words, (size_t)value->num_words * sizeof(uint32_t));
+
+  bignum_set(&right, m);
+
+  if (decexp > 0)
+    bignum_pow10(&left, decexp);
+  else
+    bignum_pow10(&right, -decexp);
+
+  if (k > 0)
+    bignum_shl(&right, k);
+  else
+    bignum_shl(&left, -k);
+
+  return (bignum_cmp(&left, &right));
+}
+
+
 //
 // 'compare_sp_items()' - Compare two string pool items...
 //
@@ -1015,6 +1385,578 @@ compare_sp_items(_cups_sp_item_t *a,	// I - First item
 }
 
 
+//
+// 'format_double()' - Format a floating-point number for a printf format.
+//
+// Unlike snprintf(), this function always uses a period (".") for the decimal
+// point and produces the exactly rounded digits on every platform.
+//
+
+static void
+format_double(char       *buf,		// I - Output buffer
+              size_t     bufsize,	// I - Size of output buffer
+              const char *tformat,	// I - Format ("%[flags][width][.prec][size]type")
+              char       type,		// I - Format type character ('e', 'f', 'g', etc.)
+              double     number)	// I - Number to format
+{
+  char		*bufptr,		// Pointer into buffer
+		*bufend,		// End of buffer
+		*body,			// Start of number after sign
+		sign = 0,		// Sign character, if any
+		digits[_CUPS_MAX_DIGITS + 1];
+					// Significant digits
+  bool		left = false,		// Left-justify?
+		zero = false,		// Pad with zeros?
+		alt = false,		// Alternate form?
+		upper,			// Uppercase?
+		fixed;			// Fixed point?
+  int		width = 0,		// Width of field
+		prec = -1,		// Precision
+		ndigits,		// Number of digits
+		decexp,			// Exponent of first digit
+		pos,			// Digit position
+		last;			// Last non-zero digit
+  size_t	len,			// Length of number
+		pad;			// Padding
+
+
+  // Parse the format...
+  for (tformat ++; *tformat && strchr("-+ #0\'", *tformat); tformat ++)
+  {
+    if (*tformat == '-')
+      left = true;
+    else if (*tformat == '+')
+      sign = '+';
+    else if (*tformat == ' ' && !sign)
+      sign = ' ';
+    else if (*tformat == '#')
+      alt = true;
+    else if (*tformat == '0')
+      zero = true;
+  }
+
+  for (; isdigit(*tformat & 255); tformat ++)
+  {
+    if (width < 100000)
+      width = width * 10 + *tformat - '0';
+  }
+
+  if (*tformat == '.')
+  {
+    for (tformat ++, prec = 0; isdigit(*tformat & 255); tformat ++)
+    {
+      if (prec < 100000)
+        prec = prec * 10 + *tformat - '0';
+    }
+  }
+
+  if (prec < 0)
+    prec = 6;
+
+  upper = isupper(type & 255) != 0;
+  type  = (char)tolower(type & 255);
+
+  // Format the sign...
+  bufptr = buf;
+  bufend = buf + bufsize - 1;
+
+  if (signbit(number))
+  {
+    sign   = '-';
+    number = -number;
+  }
+
+  if (sign)
+    *bufptr++ = sign;
+
+  body = bufptr;
+
+  if (isnan(number) || isinf(number))
+  {
+    // Format "inf" or "nan"...
+    cupsCopyString(bufptr, isnan(number) ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf"), (size_t)(bufend - bufptr + 1));
+    bufptr += strlen(bufptr);
+    zero   = false;
+  }
+  else
+  {
+    // Get the digits for the number...
+    if (type == 'g' && prec == 0)
+      prec = 1;
+
+    if (number == 0.0)
+    {
+      digits[0] = '0';
+      ndigits   = 1;
+      decexp    = 0;
+    }
+    else
+    {
+      ndigits = get_digits(number, type == 'f', type == 'g' ? prec - 1 : prec, digits, &decexp);
+    }
+
+    if (type == 'g')
+    {
+      // Use fixed point for exponents from -4 to prec - 1, dropping trailing
+      // zeros for the non-alternate form...
+      fixed = decexp >= -4 && decexp < prec;
+      prec  = fixed ? prec - 1 - decexp : prec - 1;
+
+      if (!alt)
+      {
+        for (last = ndigits - 1; last > 0 && digits[last] == '0'; last --);
+
+        if (fixed && prec > last - decexp)
+          prec = last - decexp > 0 ? last - decexp : 0;
+        else if (!fixed && prec > last)
+          prec = last;
+      }
+    }
+    else
+    {
+      fixed = type == 'f';
+    }
+
+    if (fixed)
+    {
+      // [-]DDD.DDD
+      if (decexp < 0 && bufptr < bufend)
+        *bufptr++ = '0';
+
+      for (pos = decexp < 0 ? -1 : decexp; pos >= -prec && bufptr < bufend; pos --)
+      {
+        if (pos == -1 && bufptr < bufend)
+          *bufptr++ = '.';
+
+        if (bufptr < bufend)
+          *bufptr++ = (decexp - pos < ndigits && pos <= decexp) ? digits[decexp - pos] : '0';
+      }
+
+      if (prec == 0 && alt && bufptr < bufend)
+        *bufptr++ = '.';
+    }
+    else
+    {
+      // [-]D.DDDe+/-NN
+      if (bufptr < bufend)
+        *bufptr++ = digits[0];
+
+      if ((prec > 0 || alt) && bufptr < bufend)
+        *bufptr++ = '.';
+
+      for (pos = 1; pos <= prec && bufptr < bufend; pos ++)
+        *bufptr++ = pos < ndigits ? digits[pos] : '0';
+
+      if (bufptr < bufend)
+        *bufptr++ = upper ? 'E' : 'e';
+      if (bufptr < bufend)
+        *bufptr++ = decexp < 0 ? '-' : '+';
+
+      if (decexp < 0)
+        decexp = -decexp;
+
+      if (decexp >= 100 && bufptr < bufend)
+        *bufptr++ = (char)('0' + decexp / 100);
+      if (bufptr < bufend)
+        *bufptr++ = (char)('0' + (decexp / 10) % 10);
+      if (bufptr < bufend)
+        *bufptr++ = (char)('0' + decexp % 10);
+    }
+  }
+
+  *bufptr = '\0';
+
+  // Pad to the field width as needed...
+  if ((len = (size_t)(bufptr - buf)) < (size_t)width && (size_t)width < bufsize)
+  {
+    pad = (size_t)width - len;
+
+    if (left)
+    {
+      memset(bufptr, ' ', pad);
+      bufptr[pad] = '\0';
+    }
+    else if (zero)
+    {
+      memmove(body + pad, body, (size_t)(bufptr - body + 1));
+      memset(body, '0', pad);
+    }
+    else
+    {
+      memmove(buf + pad, buf, len + 1);
+      memset(buf, ' ', pad);
+    }
+  }
+}
+
+
+//
+// 'get_digits()' - Get the correctly rounded digits of a number.
+//
+// The number must be positive and finite.  The first digit has the value
+// 10^decexp.  For fixed point the digits end with the 10^-prec digit,
+// otherwise "prec + 1" significant digits are returned.
+//
+
+static int				// O - Number of digits
+get_digits(double number,		// I - Number
+           bool   fixed,		// I - Fixed point?
+           int    prec,			// I - Precision
+           char   *digits,		// I - Digit buffer (_CUPS_MAX_DIGITS + 1 chars)
+           int    *decexp)		// O - Exponent of first digit
+{
+  _cups_bignum_t	r,		// Remainder
+			s,		// Scale
+			t;		// Temporary value
+  uint64_t		m;		// Mantissa
+  int			k,		// Binary exponent
+			x,		// Decimal exponent
+			i,		// Looping var
+			d,		// Current digit
+			ndigits;	// Number of digits
+
+
+  // Scale the number so that 1 <= r/s < 10...
+  k = get_mantissa(number, &m);
+
+  bignum_set(&r, m);
+  bignum_set(&s, 1);
+
+  if (k > 0)
+    bignum_shl(&r, k);
+  else
+    bignum_shl(&s, -k);
+
+  if ((x = (int)floor(log10(number))) > 0)
+    bignum_pow10(&s, x);
+  else
+    bignum_pow10(&r, -x);
+
+  t = s;
+  bignum_mul(&t, 10, 0);
+
+  if (bignum_cmp(&r, &t) >= 0)
+  {
+    s = t;
+    x ++;
+  }
+  else if (bignum_cmp(&r, &s) < 0)
+  {
+    bignum_mul(&r, 10, 0);
+    x --;
+  }
+
+  // Figure out how many digits we need...
+  if (!fixed)
+  {
+    ndigits = prec + 1;
+  }
+  else if (x >= -prec)
+  {
+    ndigits = x + prec + 1;
+  }
+  else
+  {
+    // Number is smaller than the last digit, start at 10^-prec...
+    bignum_pow10(&s, -prec - x);
+    x       = -prec;
+    ndigits = 1;
+  }
+
+  if (ndigits > _CUPS_MAX_DIGITS)
+    ndigits = _CUPS_MAX_DIGITS;
+
+  // Generate the digits...
+  for (i = 0; i < ndigits; i ++)
+  {
+    if (i > 0)
+      bignum_mul(&r, 10, 0);
+
+    for (d = 0; bignum_cmp(&r, &s) >= 0; d ++)
+      bignum_sub(&r, &s);
+
+    digits[i] = (char)('0' + d);
+
+    if (r.num_words == 0)
+    {
+      // The rest of the digits are 0...
+      memset(digits + i + 1, '0', (size_t)(ndigits - i - 1));
+      break;
+    }
+  }
+
+  // Round the last digit, with ties going to the even digit...
+  if (r.num_words > 0)
+  {
+    t = r;
+    bignum_shl(&t, 1);
+
+    if ((d = bignum_cmp(&t, &s)) > 0 || (d == 0 && (digits[ndigits - 1] & 1)))
+    {
+      for (i = ndigits - 1; i >= 0 && digits[i] == '9'; i --)
+        digits[i] = '0';
+
+      if (i >= 0)
+      {
+        digits[i] ++;
+      }
+      else
+      {
+        // Carried into a new digit...
+        digits[0] = '1';
+        x ++;
+
+        if (fixed)
+          digits[ndigits ++] = '0';
+      }
+    }
+  }
+
+  *decexp = x;
+
+  return (ndigits);
+}
+
+
+//
+// 'get_mantissa()' - Get the binary mantissa and exponent of a number.
+//
+
+static int				// O - Binary exponent
+get_mantissa(double   number,		// I - Number
+             uint64_t *m)		// O - Mantissa
+{
+  uint64_t	bits;			// IEEE-754 bits
+  int		e;			// Biased exponent
+
+
+  memcpy(&bits, &number, sizeof(bits));
+
+  e  = (int)((bits >> 52) & 0x7ff);
+  *m = bits & 0xfffffffffffffULL;
+
+  if (e == 0)
+    return (-1074);			// Subnormal
+
+  *m |= 0x10000000000000ULL;
+
+  return (e - 1075);
+}
+
+
+//
+// 'get_shortest()' - Get the shortest digits that uniquely identify a number.
+//
+// Numbers with up to 15 significant digits are found using exact powers of
+// 10, otherwise this is the "free-format" algorithm from Burger and Dybvig,
+// "Printing Floating-Point Numbers Quickly and Accurately".  The number must
+// be positive and finite, and is returned as 0.DDDDD * 10^decexp.
+//
+
+static int				// O - Number of digits
+get_shortest(double number,		// I - Number
+             char   *digits,		// I - Digit buffer (32 chars)
+             int    *decexp)		// O - Decimal exponent
+{
+  _cups_bignum_t	r,		// Remainder
+			s,		// Scale
+			mplus,		// Distance to upper boundary
+			mminus,		// Distance to lower boundary
+			t;		// Temporary value
+  uint64_t		m;		// Mantissa
+  int			e,		// Binary exponent
+			k,		// Decimal exponent
+			d,		// Current digit
+			ret,		// Comparison result
+			ndigits = 0;	// Number of digits
+  bool			even,		// Are the boundaries included?
+			unequal,	// Is the lower boundary closer?
+			low,		// Can we stop at the lower digit?
+			high;		// Can we stop at the higher digit?
+  double		scaled;		// Scaled number
+
+
+  // Most numbers have a short decimal form "N / 10^d", so look for the fewest
+  // decimal places that divide back to the same number - the division is
+  // correctly rounded when N and 10^d are exact...
+  for (d = 1; d < (int)(sizeof(exact_pow10) / sizeof(exact_pow10[0])); d ++)
+  {
+    if ((scaled = number * exact_pow10[d]) >= 9007199254740992.0)
+      break;
+
+    m = (uint64_t)(scaled + 0.5);
+
+    if ((double)m / exact_pow10[d] != number)
+    {
+      // Try the other neighbor...
+      m = (double)m > scaled ? m - 1 : m + 1;
+
+      if ((double)m / exact_pow10[d] != number)
+        continue;
+    }
+
+    for (; m; m /= 10)
+      digits[ndigits ++] = (char)('0' + m % 10);
+
+    *decexp = ndigits - d;
+
+    // Reverse the digits and drop any trailing zeros...
+    for (e = 0; e < ndigits / 2; e ++)
+    {
+      char temp = digits[e];		// Temporary digit
+
+      digits[e]               = digits[ndigits - 1 - e];
+      digits[ndigits - 1 - e] = temp;
+    }
+
+    while (ndigits > 1 && digits[ndigits - 1] == '0')
+      ndigits --;
+
+    return (ndigits);
+  }
+
+  // Setup the remainder, scale, and boundaries so that r/s is the number and
+  // the boundaries are the halfway points to the neighboring numbers...
+  e       = get_mantissa(number, &m);
+  even    = !(m & 1);
+  unequal = m == 0x10000000000000ULL && e > -1074;
+
+  bignum_set(&r, m);
+
+  if (e >= 0)
+  {
+    bignum_set(&mminus, 1);
+    bignum_shl(&mminus, e);
+    mplus = mminus;
+
+    if (unequal)
+    {
+      bignum_shl(&mplus, 1);
+      bignum_shl(&r, e + 2);
+      bignum_set(&s, 4);
+    }
+    else
+    {
+      bignum_shl(&r, e + 1);
+      bignum_set(&s, 2);
+    }
+  }
+  else
+  {
+    bignum_set(&mminus, 1);
+
+    if (unequal)
+    {
+      bignum_set(&mplus, 2);
+      bignum_shl(&r, 2);
+      bignum_set(&s, 1);
+      bignum_shl(&s, 2 - e);
+    }
+    else
+    {
+      bignum_set(&mplus, 1);
+      bignum_shl(&r, 1);
+      bignum_set(&s, 1);
+      bignum_shl(&s, 1 - e);
+    }
+  }
+
+  // Scale by the estimated decimal exponent and fix it up as needed...
+  if ((k = (int)ceil(log10(number) - 1e-10)) >= 0)
+  {
+    bignum_pow10(&s, k);
+  }
+  else
+  {
+    bignum_pow10(&r, -k);
+    bignum_pow10(&mplus, -k);
+    bignum_pow10(&mminus, -k);
+  }
+
+  t = r;
+  bignum_add(&t, &mplus);
+
+  if ((ret = bignum_cmp(&t, &s)) > 0 || (ret == 0 && even))
+  {
+    k ++;
+  }
+  else
+  {
+    bignum_mul(&r, 10, 0);
+    bignum_mul(&mplus, 10, 0);
+    bignum_mul(&mminus, 10, 0);
+  }
+
+  // Generate digits until the remaining digits are within the boundaries...
+  for (;;)
+  {
+    for (d = 0; bignum_cmp(&r, &s) >= 0; d ++)
+      bignum_sub(&r, &s);
+
+    ret = bignum_cmp(&r, &mminus);
+    low = ret < 0 || (ret == 0 && even);
+
+    t = r;
+    bignum_add(&t, &mplus);
+    ret  = bignum_cmp(&t, &s);
+    high = ret > 0 || (ret == 0 && even);
+
+    if (low && high)
+    {
+      // Use the closer digit...
+      t = r;
+      bignum_shl(&t, 1);
+
+      if ((ret = bignum_cmp(&t, &s)) > 0 || (ret == 0 && (d & 1)))
+        d ++;
+      break;
+    }
+    else if (low)
+    {
+      break;
+    }
+    else if (high)
+    {
+      d ++;
+      break;
+    }
+
+    digits[ndigits ++] = (char)('0' + d);
+
+    if (ndigits >= 30)
+      break;
+
+    bignum_mul(&r, 10, 0);
+    bignum_mul(&mplus, 10, 0);
+    bignum_mul(&mminus, 10, 0);
+  }
+
+  digits[ndigits ++] = (char)('0' + d);
+  *decexp = k;
+
+  return (ndigits);
+}
+
+
+//
+// 'hash_sp_item()' - Compute the hash value of a string pool item.
+//
+
+static size_t				// O - Hash value
+hash_sp_item(_cups_sp_item_t *item)	// I - Item
+{
+  const unsigned char	*s;		// Pointer into string
+  size_t		h;		// Hash value
+
+
+  // Use the FNV-1a hash; the item may be a search key that is not aligned...
+  for (s = (const unsigned char *)item + offsetof(_cups_sp_item_t, str), h = 2166136261U; *s; s ++)
+    h = (h ^ *s) * 16777619U;
+
+  return (h);
+}
+
+
 //
 // 'validate_end()' - Validate the last UTF-8 character in a buffer.
 //
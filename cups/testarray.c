@@ -13,15 +13,38 @@
 #include "debug-private.h"
 #include "cups.h"
 #include "dir.h"
+#include "thread.h"
 #include "test-internal.h"
 
 
+//
+// Types and structures...
+//
+
+typedef struct snapshot_test_s		// Snapshot test data
+{
+  cups_mutex_t		mutex;		// Mutex for published snapshot
+  cups_array_t		*published;	// Published snapshot
+  bool			done;		// Writer done?
+  size_t		window;		// Number of elements in array
+  size_t		num_reads,	// Number of snapshots read
+			num_errors;	// Number of bad snapshots
+} snapshot_test_t;
+
+
 //
 // Local functions...
 //
 
+static int	batch_tests(void);
+static int	compare_prefix(const char *a, const char *b, void *data);
+static bool	equal_arrays(cups_array_t *a, cups_array_t *b);
 static double	get_seconds(void);
+static size_t	hash_string(const char *s, void *data);
+static int	hash_tests(void);
 static int	load_words(const char *filename, cups_array_t *array);
+static void	*snapshot_reader(snapshot_test_t *data);
+static int	snapshot_tests(void);
 
 
 //
@@ -453,10 +476,243 @@ main(void)
 
   cupsArrayDelete(array);
 
+  // Test hash arrays...
+  status += hash_tests();
+
+  // Test batches...
+  status += batch_tests();
+
+  // Test iterators and snapshots...
+  status += snapshot_tests();
+
   return (status);
 }
 
 
+//
+// 'batch_tests()' - Test adding batches of elements.
+//
+
+static int				// O - Number of failures
+batch_tests(void)
+{
+  int		status = 0;		// Number of failures
+  size_t	i;			// Looping var
+  cups_array_t	*array,			// Array built one at a time
+		*batch_array;		// Array built in batches
+  char		**keys,			// Keys to add
+		*text;			// Text from array
+  double	start,			// Start time
+		end;			// End time
+  const size_t	num_keys = 200000;	// Number of keys
+
+
+  // Make keys with lots of duplicate prefixes; the suffix records the order
+  // the keys were added so we can verify that equal elements stay in order...
+  if ((keys = calloc(num_keys, sizeof(char *))) == NULL)
+    return (1);
+
+  for (i = 0; i < num_keys; i ++)
+  {
+    char	key[32];		// Key string
+
+    snprintf(key, sizeof(key), "%06u-%06u", (unsigned)((i * 7919) % 50000), (unsigned)i);
+    keys[i] = strdup(key);
+  }
+
+  // cupsArrayAddBatch()
+  testBegin("cupsArrayAdd(%u keys)", (unsigned)num_keys);
+  array = cupsArrayNew((cups_array_cb_t)compare_prefix, NULL, NULL, 0, NULL, NULL);
+  start = get_seconds();
+
+  for (i = 0; i < num_keys; i ++)
+    cupsArrayAdd(array, keys[i]);
+
+  end = get_seconds();
+  testEndMessage(cupsArrayGetCount(array) == num_keys, "%.3f seconds", end - start);
+
+  testBegin("cupsArrayAddBatch(%u keys)", (unsigned)num_keys);
+  batch_array = cupsArrayNew((cups_array_cb_t)compare_prefix, NULL, NULL, 0, NULL, NULL);
+  start       = get_seconds();
+
+  cupsArrayAdd(batch_array, keys[0]);
+  cupsArrayAddBatch(batch_array, (void **)keys + 1, num_keys / 2 - 1);
+  cupsArrayAddBatch(batch_array, (void **)keys + num_keys / 2, num_keys - num_keys / 2);
+
+  end = get_seconds();
+
+  if (!equal_arrays(array, batch_array))
+  {
+    status ++;
+  }
+  else
+  {
+    testEndMessage(true, "%.3f seconds", end - start);
+  }
+
+  cupsArrayDelete(array);
+  cupsArrayDelete(batch_array);
+
+  // cupsArrayBeginBatch(unique=true)
+  testBegin("cupsArrayBeginBatch(unique=true)");
+  array       = cupsArrayNew((cups_array_cb_t)compare_prefix, NULL, NULL, 0, (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free);
+  batch_array = cupsArrayNew((cups_array_cb_t)compare_prefix, NULL, NULL, 0, (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free);
+
+  for (i = 0; i < num_keys; i ++)
+  {
+    if (!cupsArrayFind(array, keys[i]))
+      cupsArrayAdd(array, keys[i]);
+  }
+
+  for (i = 0; i < 1000; i ++)
+    cupsArrayAdd(batch_array, keys[i]);
+
+  cupsArrayBeginBatch(batch_array, true);
+  for (i = 1000; i < num_keys; i ++)
+  {
+    cupsArrayAdd(batch_array, keys[i]);
+
+    if (i == num_keys / 2 && (text = (char *)cupsArrayFind(batch_array, keys[10])) != NULL && strcmp(text, keys[10]))
+      break;
+  }
+
+  if (i < num_keys)
+  {
+    testEndMessage(false, "cupsArrayFind returned \"%s\", expected \"%s\"", text, keys[10]);
+    status ++;
+  }
+  else if (!cupsArrayEndBatch(batch_array) || cupsArrayEndBatch(batch_array))
+  {
+    testEndMessage(false, "cupsArrayEndBatch returned the wrong value");
+    status ++;
+  }
+  else if (cupsArrayGetCount(batch_array) != 50000)
+  {
+    testEndMessage(false, "got %u elements, expected 50000", (unsigned)cupsArrayGetCount(batch_array));
+    status ++;
+  }
+  else if (!equal_arrays(array, batch_array))
+  {
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  cupsArrayDelete(array);
+  cupsArrayDelete(batch_array);
+
+  // cupsArrayInsert() in a batch places equal elements like cupsArrayAdd()
+  testBegin("cupsArrayInsert(batch)");
+  array = cupsArrayNew((cups_array_cb_t)compare_prefix, NULL, NULL, 0, NULL, NULL);
+
+  cupsArrayAdd(array, "000001-0");
+  cupsArrayBeginBatch(array, false);
+  cupsArrayInsert(array, "000001-1");
+  cupsArrayAdd(array, "000001-2");
+  cupsArrayInsert(array, "000001-3");
+  cupsArrayInsert(array, "000000-4");
+  cupsArrayEndBatch(array);
+
+  {
+    static const char * const expected[] =
+    {					// Expected order
+      "000000-4",
+      "000001-0",
+      "000001-1",
+      "000001-2",
+      "000001-3"
+    };
+
+    for (i = 0, text = (char *)cupsArrayGetFirst(array); i < (sizeof(expected) / sizeof(expected[0])) && text; i ++, text = (char *)cupsArrayGetNext(array))
+    {
+      if (strcmp(text, expected[i]))
+        break;
+    }
+
+    if (i < (sizeof(expected) / sizeof(expected[0])) || text)
+    {
+      testEndMessage(false, "element %u is \"%s\", expected \"%s\"", (unsigned)i, text ? text : "(null)", i < (sizeof(expected) / sizeof(expected[0])) ? expected[i] : "(null)");
+      status ++;
+    }
+    else
+    {
+      testEnd(true);
+    }
+  }
+
+  cupsArrayDelete(array);
+
+  // cupsArrayAddStrings() with duplicates
+  testBegin("cupsArrayAddStrings(\"c,b,a,b,c,d\")");
+  array = cupsArrayNewStrings("b,e", ',');
+  cupsArrayAddStrings(array, "c,b,a,b,c,d", ',');
+
+  if (cupsArrayGetCount(array) != 5 || strcmp(text = (char *)cupsArrayGetFirst(array), "a") || strcmp(text = (char *)cupsArrayGetLast(array), "e"))
+  {
+    testEndMessage(false, "got %u elements, expected 5", (unsigned)cupsArrayGetCount(array));
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  cupsArrayDelete(array);
+
+  for (i = 0; i < num_keys; i ++)
+    free(keys[i]);
+  free(keys);
+
+  return (status);
+}
+
+
+//
+// 'compare_prefix()' - Compare the first 6 characters of two strings.
+//
+
+static int				// O - Result of comparison
+compare_prefix(const char *a,		// I - First string
+               const char *b,		// I - Second string
+               void       *data)	// I - User data (unused)
+{
+  (void)data;
+
+  return (strncmp(a, b, 6));
+}
+
+
+//
+// 'equal_arrays()' - Compare the elements of two arrays.
+//
+
+static bool				// O - `true` if equal, `false` otherwise
+equal_arrays(cups_array_t *a,		// I - First array
+             cups_array_t *b)		// I - Second array
+{
+  size_t	i;			// Looping var
+  char		*atext,			// Element from first array
+		*btext;			// Element from second array
+
+
+  for (i = 0, atext = (char *)cupsArrayGetFirst(a), btext = (char *)cupsArrayGetFirst(b); atext && btext; i ++, atext = (char *)cupsArrayGetNext(a), btext = (char *)cupsArrayGetNext(b))
+  {
+    if (strcmp(atext, btext))
+      break;
+  }
+
+  if (atext || btext)
+  {
+    testEndMessage(false, "element %u is \"%s\", expected \"%s\"", (unsigned)i, btext ? btext : "(null)", atext ? atext : "(null)");
+    return (false);
+  }
+
+  return (true);
+}
+
+
 //
 // 'get_seconds()' - Get the current time in seconds...
 //
@@ -485,6 +741,330 @@ get_seconds(void)
 #endif // _WIN32
 
 
+//
+// 'hash_string()' - Compute the hash value of a string.
+//
+
+static size_t				// O - Hash value
+hash_string(const char *s,		// I - String
+            void       *data)		// I - User data (unused)
+{
+  size_t	h;			// Hash value
+
+
+  (void)data;
+
+  for (h = 2166136261U; *s; s ++)
+    h = (h ^ (*s & 255)) * 16777619U;
+
+  return (h);
+}
+
+
+//
+// 'hash_tests()' - Test hash arrays.
+//
+
+static int				// O - Number of failures
+hash_tests(void)
+{
+  int		status = 0;		// Number of failures
+  size_t	i,			// Looping var
+		count;			// Number of elements
+  cups_array_t	*array,			// Hash array
+		*dup_array,		// Duplicate array
+		*sorted_array;		// Sorted array
+  cups_dir_t	*dir;			// Current directory
+  cups_dentry_t	*dent;			// Directory entry
+  char		*text,			// Text from array
+		word[256];		// Word buffer
+  double	start,			// Start time
+		end;			// End time
+  const size_t	num_keys = 200000;	// Number of keys for large tests
+
+
+  // cupsArrayNewHash()
+  testBegin("cupsArrayNewHash");
+  if ((array = cupsArrayNewHash((cups_array_cb_t)strcmp, NULL, (cups_ahash_cb_t)hash_string, true, (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free)) == NULL)
+  {
+    testEndMessage(false, "returned NULL, expected pointer");
+    return (1);
+  }
+  testEnd(true);
+
+  // Load the words from the source files and make sure they are sorted...
+  testBegin("Load unique words (hash)");
+  start = get_seconds();
+
+  if ((dir = cupsDirOpen(".")) != NULL)
+  {
+    while ((dent = cupsDirRead(dir)) != NULL)
+    {
+      i = strlen(dent->filename);
+
+      if (i > 2 && dent->filename[i - 2] == '.' && (dent->filename[i - 1] == 'c' || dent->filename[i - 1] == 'h'))
+        load_words(dent->filename, array);
+    }
+
+    cupsDirClose(dir);
+  }
+
+  end = get_seconds();
+
+  for (text = (char *)cupsArrayGetFirst(array); text;)
+  {
+    cupsCopyString(word, text, sizeof(word));
+
+    if ((text = (char *)cupsArrayGetNext(array)) == NULL || strcmp(word, text) >= 0)
+      break;
+  }
+
+  if (cupsArrayGetCount(array) == 0)
+  {
+    testEndMessage(false, "no words loaded");
+    status ++;
+  }
+  else if (text)
+  {
+    testEndMessage(false, "\"%s\" >= \"%s\"", word, text);
+    status ++;
+  }
+  else
+  {
+    testEndMessage(true, "%u words in %.3f seconds - %.0f words/sec", (unsigned)cupsArrayGetCount(array), end - start, cupsArrayGetCount(array) / (end - start));
+  }
+
+  // cupsArrayDup()
+  testBegin("cupsArrayDup (hash)");
+  if ((dup_array = cupsArrayDup(array)) == NULL || cupsArrayGetCount(dup_array) != cupsArrayGetCount(array))
+  {
+    testEndMessage(false, "returned %p with %u elements, expected %u elements", (void *)dup_array, (unsigned)cupsArrayGetCount(dup_array), (unsigned)cupsArrayGetCount(array));
+    status ++;
+  }
+  else
+  {
+    for (text = (char *)cupsArrayGetFirst(array); text; text = (char *)cupsArrayGetNext(array))
+    {
+      if (!cupsArrayFind(dup_array, text))
+        break;
+    }
+
+    if (text)
+    {
+      testEndMessage(false, "unable to find \"%s\"", text);
+      status ++;
+    }
+    else
+    {
+      testEnd(true);
+    }
+  }
+
+  // Remove every other word while iterating...
+  testBegin("Delete While Iterating (hash)");
+  count = cupsArrayGetCount(array);
+
+  for (i = 0, text = (char *)cupsArrayGetFirst(array); text; i ++, text = (char *)cupsArrayGetNext(array))
+  {
+    if (i & 1)
+      cupsArrayRemove(array, text);
+  }
+
+  if (i != count || cupsArrayGetCount(array) != (count + 1) / 2)
+  {
+    testEndMessage(false, "iterated %u of %u words, %u remaining", (unsigned)i, (unsigned)count, (unsigned)cupsArrayGetCount(array));
+    status ++;
+  }
+  else
+  {
+    for (i = 0, text = (char *)cupsArrayGetFirst(dup_array); text; i ++, text = (char *)cupsArrayGetNext(dup_array))
+    {
+      if ((cupsArrayFind(array, text) != NULL) == ((i & 1) != 0))
+        break;
+    }
+
+    if (text)
+    {
+      testEndMessage(false, "\"%s\" %s", text, (i & 1) ? "not removed" : "not found");
+      status ++;
+    }
+    else
+    {
+      testEnd(true);
+    }
+  }
+
+  cupsArrayDelete(array);
+  cupsArrayDelete(dup_array);
+
+  // Saved positions do not survive sorting a hash array...
+  testBegin("cupsArrayRestore after sort (hash)");
+  array = cupsArrayNewHash((cups_array_cb_t)strcmp, NULL, (cups_ahash_cb_t)hash_string, true, (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free);
+
+  cupsArrayAdd(array, "bravo");
+  cupsArrayAdd(array, "charlie");
+  cupsArrayGetFirst(array);
+  cupsArraySave(array);
+  cupsArrayAdd(array, "alpha");
+  cupsArrayGetFirst(array);
+
+  if ((text = (char *)cupsArrayRestore(array)) != NULL)
+  {
+    testEndMessage(false, "got \"%s\", expected NULL", text);
+    status ++;
+  }
+  else if ((text = (char *)cupsArrayGetNext(array)) == NULL || strcmp(text, "alpha"))
+  {
+    testEndMessage(false, "next element is \"%s\", expected \"alpha\"", text ? text : "(null)");
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  cupsArrayDelete(array);
+
+  // Build large sorted and hash arrays and compare the times...
+  testBegin("cupsArrayAdd(%u keys, sorted)", (unsigned)num_keys);
+  sorted_array = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free);
+  start        = get_seconds();
+
+  for (i = 0; i < num_keys; i ++)
+  {
+    snprintf(word, sizeof(word), "key%06u", (unsigned)((i * 7919) % num_keys));
+    if (!cupsArrayFind(sorted_array, word))
+      cupsArrayAdd(sorted_array, word);
+  }
+
+  end = get_seconds();
+  testEndMessage(cupsArrayGetCount(sorted_array) == num_keys, "%.3f seconds", end - start);
+
+  testBegin("cupsArrayAdd(%u keys, hash)", (unsigned)num_keys);
+  array = cupsArrayNewHash((cups_array_cb_t)strcmp, NULL, (cups_ahash_cb_t)hash_string, false, (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free);
+  start = get_seconds();
+
+  for (i = 0; i < num_keys; i ++)
+  {
+    snprintf(word, sizeof(word), "key%06u", (unsigned)((i * 7919) % num_keys));
+    if (!cupsArrayFind(array, word))
+      cupsArrayAdd(array, word);
+  }
+
+  end = get_seconds();
+
+  if (cupsArrayGetCount(array) != num_keys)
+  {
+    testEndMessage(false, "got %u elements, expected %u", (unsigned)cupsArrayGetCount(array), (unsigned)num_keys);
+    status ++;
+  }
+  else
+  {
+    testEndMessage(true, "%.3f seconds", end - start);
+  }
+
+  cupsArrayDelete(sorted_array);
+
+  // Unsorted hash arrays keep the order elements were added...
+  testBegin("cupsArrayGetNext (hash, order added)");
+  for (i = 0, text = (char *)cupsArrayGetFirst(array); text; i ++, text = (char *)cupsArrayGetNext(array))
+  {
+    snprintf(word, sizeof(word), "key%06u", (unsigned)((i * 7919) % num_keys));
+    if (strcmp(text, word))
+      break;
+  }
+
+  if (text || i != num_keys)
+  {
+    testEndMessage(false, "element %u is \"%s\", expected \"%s\"", (unsigned)i, text ? text : "(null)", word);
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  // Remove half of the keys, add them back, and verify they can all be found...
+  testBegin("cupsArrayRemove (hash)");
+  start = get_seconds();
+
+  for (i = 0; i < num_keys; i += 2)
+  {
+    snprintf(word, sizeof(word), "key%06u", (unsigned)i);
+    if (!cupsArrayRemove(array, word))
+      break;
+  }
+
+  if (i < num_keys || cupsArrayGetCount(array) != num_keys / 2 || cupsArrayRemove(array, word))
+  {
+    testEndMessage(false, "got %u elements, expected %u", (unsigned)cupsArrayGetCount(array), (unsigned)(num_keys / 2));
+    status ++;
+  }
+  else
+  {
+    for (i = num_keys; i > 0; i -= 2)
+    {
+      snprintf(word, sizeof(word), "key%06u", (unsigned)(i - 2));
+      if (!cupsArrayAdd(array, word))
+        break;
+    }
+
+    for (i = 0; i < num_keys; i ++)
+    {
+      snprintf(word, sizeof(word), "key%06u", (unsigned)i);
+      if ((text = (char *)cupsArrayFind(array, word)) == NULL || strcmp(text, word))
+        break;
+    }
+
+    end = get_seconds();
+
+    if (i < num_keys || cupsArrayGetCount(array) != num_keys)
+    {
+      testEndMessage(false, "unable to find \"%s\" in %u elements", word, (unsigned)cupsArrayGetCount(array));
+      status ++;
+    }
+    else if ((text = (char *)cupsArrayGetLast(array)) == NULL || strcmp(text, "key000000"))
+    {
+      testEndMessage(false, "last element \"%s\", expected \"key000000\"", text ? text : "(null)");
+      status ++;
+    }
+    else
+    {
+      testEndMessage(true, "%.3f seconds", end - start);
+    }
+  }
+
+  // cupsArrayInsert()
+  testBegin("cupsArrayInsert (hash)");
+  if (!cupsArrayInsert(array, "first") || (text = (char *)cupsArrayGetFirst(array)) == NULL || strcmp(text, "first") || !cupsArrayFind(array, "key000001"))
+  {
+    testEndMessage(false, "first element \"%s\", expected \"first\"", text ? text : "(null)");
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  // cupsArrayClear()
+  testBegin("cupsArrayClear (hash)");
+  cupsArrayClear(array);
+  if (cupsArrayGetCount(array) != 0 || cupsArrayFind(array, "first") || cupsArrayGetFirst(array))
+  {
+    testEndMessage(false, "%u elements, expected 0 elements", (unsigned)cupsArrayGetCount(array));
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  cupsArrayDelete(array);
+
+  return (status);
+}
+
+
 //
 // 'load_words()' - Load words from a file.
 //
@@ -515,3 +1095,333 @@ load_words(const char   *filename,	// I - File to load
 
   return (1);
 }
+
+
+//
+// 'snapshot_reader()' - Read published snapshots without locking the array.
+//
+
+static void *				// O - Thread exit status (unused)
+snapshot_reader(snapshot_test_t *data)	// I - Test data
+{
+  bool			done = false;	// Writer done?
+  cups_array_t		*snapshot;	// Snapshot
+  cups_array_iter_t	iter;		// Iterator
+  const char		*text;		// Current element
+  unsigned		prev,		// Previous value
+			value;		// Current value
+  size_t		count;		// Number of elements
+
+
+  while (!done)
+  {
+    // Get our own snapshot of the published snapshot...
+    cupsMutexLock(&data->mutex);
+    done     = data->done;
+    snapshot = cupsArraySnapshot(data->published);
+    cupsMutexUnlock(&data->mutex);
+
+    if (!snapshot)
+      continue;
+
+    // Then verify that it contains a consecutive run of values...
+    for (text = (const char *)cupsArrayIterFirst(snapshot, &iter), count = 0, prev = 0; text; text = (const char *)cupsArrayIterNext(&iter), count ++, prev = value)
+    {
+      value = (unsigned)strtoul(text, NULL, 10);
+
+      if (count > 0 && value != (prev + 1))
+        break;
+    }
+
+    cupsMutexLock(&data->mutex);
+    data->num_reads ++;
+    if (text || count != data->window || cupsArrayGetCount(snapshot) != data->window)
+      data->num_errors ++;
+    cupsMutexUnlock(&data->mutex);
+
+    cupsArrayDelete(snapshot);
+  }
+
+  return (NULL);
+}
+
+
+//
+// 'snapshot_tests()' - Test iterators and snapshots.
+//
+
+static int				// O - Number of failures
+snapshot_tests(void)
+{
+  int			status = 0;	// Number of failures
+  size_t		i,		// Looping var
+			count;		// Number of elements
+  cups_array_t		*array,		// Array
+			*snapshot,	// Snapshot of array
+			*snapshot2;	// Snapshot of snapshot
+  cups_array_iter_t	iter,		// Iterator
+			iter2;		// Second iterator
+  char			key[32];	// Key string
+  const char		*text,		// Text from array
+			*text2;		// Text from second iterator
+  snapshot_test_t	data;		// Threaded test data
+  cups_thread_t		readers[4];	// Reader threads
+  const size_t		num_readers = sizeof(readers) / sizeof(readers[0]),
+					// Number of reader threads
+			num_changes = 20000;
+					// Number of writer changes
+
+
+  // cupsArrayIterFirst/Next/Last/Prev
+  testBegin("cupsArrayIterFirst/Next");
+  array = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free);
+
+  for (i = 0; i < 100; i ++)
+  {
+    snprintf(key, sizeof(key), "%03u", (unsigned)i);
+    cupsArrayAdd(array, key);
+  }
+
+  for (text = (const char *)cupsArrayIterFirst(array, &iter), count = 0; text; text = (const char *)cupsArrayIterNext(&iter), count ++)
+  {
+    // Run a second iterator backwards to verify iterators are independent...
+    for (text2 = (const char *)cupsArrayIterLast(array, &iter2), i = 99; text2 && i > count; text2 = (const char *)cupsArrayIterPrev(&iter2), i --);
+
+    if (!text2 || strcmp(text, text2))
+      break;
+  }
+
+  if (count != 100)
+  {
+    testEndMessage(false, "got %u elements, expected 100", (unsigned)count);
+    status ++;
+  }
+  else if (cupsArrayIterNext(&iter) || !cupsArrayIterFirst(array, &iter2) || cupsArrayIterPrev(&iter2))
+  {
+    testEndMessage(false, "iterators did not stop at the ends of the array");
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  // cupsArraySnapshot
+  testBegin("cupsArraySnapshot");
+  snapshot = cupsArraySnapshot(array);
+
+  for (i = 0; i < 100; i += 2)
+  {
+    snprintf(key, sizeof(key), "%03u", (unsigned)i);
+    cupsArrayRemove(array, key);
+  }
+
+  cupsArrayAdd(array, "new");
+  snapshot2 = cupsArraySnapshot(snapshot);
+
+  if (cupsArrayGetCount(array) != 51)
+  {
+    testEndMessage(false, "got %u elements in array, expected 51", (unsigned)cupsArrayGetCount(array));
+    status ++;
+  }
+  else if (cupsArrayGetCount(snapshot) != 100 || cupsArrayFind(snapshot, "new") || !cupsArrayFind(snapshot, "050"))
+  {
+    testEndMessage(false, "snapshot changed");
+    status ++;
+  }
+  else
+  {
+    // Delete the array before the snapshots; removed elements must remain
+    // valid until the last snapshot is deleted...
+    cupsArrayDelete(array);
+    cupsArrayRemove(snapshot, "000");
+
+    for (text = (const char *)cupsArrayIterFirst(snapshot2, &iter), count = 0; text; text = (const char *)cupsArrayIterNext(&iter), count ++)
+    {
+      snprintf(key, sizeof(key), "%03u", (unsigned)count);
+      if (strcmp(text, key))
+        break;
+    }
+
+    if (count != 100)
+    {
+      testEndMessage(false, "got %u elements in snapshot, expected 100", (unsigned)count);
+      status ++;
+    }
+    else if (cupsArrayGetCount(snapshot) != 99)
+    {
+      testEndMessage(false, "got %u elements in changed snapshot, expected 99", (unsigned)cupsArrayGetCount(snapshot));
+      status ++;
+    }
+    else
+    {
+      testEnd(true);
+    }
+  }
+
+  cupsArrayDelete(snapshot);
+  cupsArrayDelete(snapshot2);
+
+  // cupsArraySnapshot (hash)
+  testBegin("cupsArraySnapshot (hash)");
+  array = cupsArrayNewHash((cups_array_cb_t)strcmp, NULL, (cups_ahash_cb_t)hash_string, false, (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free);
+  cupsArrayAdd(array, "one");
+  cupsArrayAdd(array, "two");
+  cupsArrayAdd(array, "three");
+
+  snapshot = cupsArraySnapshot(array);
+
+  cupsArrayRemove(array, "two");
+  cupsArrayAdd(array, "four");
+
+  if (!cupsArrayFind(snapshot, "two") || cupsArrayFind(snapshot, "four") || cupsArrayGetCount(snapshot) != 3)
+  {
+    testEndMessage(false, "snapshot changed");
+    status ++;
+  }
+  else if (cupsArrayFind(array, "two") || !cupsArrayFind(array, "four") || cupsArrayGetCount(array) != 3)
+  {
+    testEndMessage(false, "array not changed");
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  cupsArrayDelete(snapshot);
+  cupsArrayDelete(array);
+
+  // cupsArraySnapshot (changed snapshot)
+  testBegin("cupsArraySnapshot (changed snapshot)");
+  array = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free);
+  cupsArrayAdd(array, "one");
+  cupsArrayAdd(array, "two");
+  cupsArrayAdd(array, "three");
+
+  snapshot = cupsArraySnapshot(array);
+  cupsArrayAdd(snapshot, "four");
+  snapshot2 = cupsArraySnapshot(snapshot);
+  cupsArrayAdd(snapshot, "five");
+
+  cupsArrayRemove(array, "two");
+
+  // Removed elements must remain valid for the snapshot and the snapshot of
+  // the snapshot...
+  text  = (const char *)cupsArrayFind(snapshot, "two");
+  count = cupsArrayGetCount(snapshot);
+
+  cupsArrayDelete(snapshot);
+
+  if (!text || strcmp(text, "two") || count != 5)
+  {
+    testEndMessage(false, "removed element not kept for snapshot");
+    status ++;
+  }
+  else if ((text = (const char *)cupsArrayFind(snapshot2, "two")) == NULL || strcmp(text, "two") || cupsArrayGetCount(snapshot2) != 4)
+  {
+    testEndMessage(false, "removed element not kept for snapshot of snapshot");
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  cupsArrayDelete(array);
+  cupsArrayDelete(snapshot2);
+
+  // cupsArraySnapshot (batch)
+  testBegin("cupsArraySnapshot (batch)");
+  array = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free);
+  cupsArrayBeginBatch(array, false);
+  cupsArrayAdd(array, "zulu");
+  cupsArrayAdd(array, "alpha");
+  cupsArrayAdd(array, "mike");
+
+  snapshot = cupsArraySnapshot(array);
+  cupsArrayEndBatch(array);
+
+  // Reading the snapshot sorts its pending batch...
+  text = (const char *)cupsArrayGetFirst(snapshot);
+
+  cupsArrayRemove(array, "alpha");
+  cupsArrayRemove(array, "zulu");
+
+  if (!text || strcmp(text, "alpha") || (text = (const char *)cupsArrayGetLast(snapshot)) == NULL || strcmp(text, "zulu") || cupsArrayGetCount(snapshot) != 3)
+  {
+    testEndMessage(false, "removed elements not kept for snapshot");
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  cupsArrayDelete(snapshot);
+  cupsArrayDelete(array);
+
+  // Threaded readers
+  testBegin("cupsArraySnapshot (%u readers)", (unsigned)num_readers);
+  memset(&data, 0, sizeof(data));
+  cupsMutexInit(&data.mutex);
+  data.window = 1000;
+
+  array = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free);
+
+  for (i = 0; i < data.window; i ++)
+  {
+    snprintf(key, sizeof(key), "%08u", (unsigned)i);
+    cupsArrayAdd(array, key);
+  }
+
+  data.published = cupsArraySnapshot(array);
+
+  for (i = 0; i < num_readers; i ++)
+    readers[i] = cupsThreadCreate((cups_thread_func_t)snapshot_reader, &data);
+
+  for (i = 0; i < num_changes; i ++)
+  {
+    // Slide the window of values...
+    snprintf(key, sizeof(key), "%08u", (unsigned)(i + data.window));
+    cupsArrayAdd(array, key);
+    snprintf(key, sizeof(key), "%08u", (unsigned)i);
+    cupsArrayRemove(array, key);
+
+    // Publish a new snapshot every 10 changes...
+    if ((i % 10) == 9)
+    {
+      snapshot = cupsArraySnapshot(array);
+
+      cupsMutexLock(&data.mutex);
+      snapshot2      = data.published;
+      data.published = snapshot;
+      cupsMutexUnlock(&data.mutex);
+
+      cupsArrayDelete(snapshot2);
+    }
+  }
+
+  cupsMutexLock(&data.mutex);
+  data.done = true;
+  cupsMutexUnlock(&data.mutex);
+
+  for (i = 0; i < num_readers; i ++)
+    cupsThreadWait(readers[i]);
+
+  if (data.num_errors)
+  {
+    testEndMessage(false, "%u of %u snapshots were bad", (unsigned)data.num_errors, (unsigned)data.num_reads);
+    status ++;
+  }
+  else
+  {
+    testEndMessage(true, "%u snapshots", (unsigned)data.num_reads);
+  }
+
+  cupsArrayDelete(data.published);
+  cupsArrayDelete(array);
+  cupsMutexDestroy(&data.mutex);
+
+  return (status);
+}
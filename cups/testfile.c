@@ -29,9 +29,14 @@
 // Local functions...
 //
 
+static int	conf_benchmark(void);
 static int	count_lines(cups_file_t *fp);
-static int	random_tests(void);
-static int	read_write_tests(bool compression);
+static int	index_tests(void);
+static int	line_tests(void);
+static size_t	make_line(int linenum, char *buf, size_t bufsize, const char **eol);
+static int	random_tests(bool mapped);
+static int	read_write_tests(bool compression, bool mapped, size_t threads);
+static int	seek_records(cups_file_t *fp, int num_records, int count, double *secs);
 
 
 //
@@ -56,13 +61,31 @@ main(int  argc,				// I - Number of command-line arguments
   if (argc == 1)
   {
     // Do uncompressed file tests...
-    status = read_write_tests(false);
+    status = read_write_tests(false, false, 1);
 
     // Do compressed file tests...
-    status += read_write_tests(true);
+    status += read_write_tests(true, false, 1);
+
+    // Do multi-threaded compressed file tests...
+    status += read_write_tests(true, false, 4);
+
+    // Do memory-mapped file tests...
+    status += read_write_tests(false, true, 1);
+
+    // Do memory-mapped fallback tests for compressed files...
+    status += read_write_tests(true, true, 1);
 
     // Do uncompressed random I/O tests...
-    status += random_tests();
+    status += random_tests(false);
+
+    // Do memory-mapped random I/O tests...
+    status += random_tests(true);
+
+    // Do compressed random I/O tests with checkpoints...
+    status += index_tests();
+
+    // Do line scanning tests with different buffer sizes...
+    status += line_tests();
 
 #ifndef _WIN32
     // Test fdopen and close without reading...
@@ -92,52 +115,58 @@ main(int  argc,				// I - Number of command-line arguments
     }
 #endif // !_WIN32
 
-    // Count lines in test file, rewind, then count again.
-    testBegin("cupsFileOpen(\"testfile.txt\", \"r\")");
-
-    if ((fp = cupsFileOpen("testfile.txt", "r")) == NULL)
+    // Count lines in test file, rewind, then count again, with and without
+    // memory mapping.
+    for (i = 0; i < 2; i ++)
     {
-      testEnd(false);
-      status ++;
-    }
-    else
-    {
-      testEnd(true);
-      testBegin("cupsFileGets");
+      const char *readmode = i ? "rm" : "r";	// Read mode
 
-      if ((count = count_lines(fp)) != 477)
+      testBegin("cupsFileOpen(\"testfile.txt\", \"%s\")", readmode);
+
+      if ((fp = cupsFileOpen("testfile.txt", readmode)) == NULL)
       {
-        testEndMessage(false, "got %d lines, expected 477", count);
+	testEnd(false);
 	status ++;
       }
       else
       {
-        testEnd(true);
-	testBegin("cupsFileRewind");
+	testEnd(true);
+	testBegin("cupsFileGets");
 
-	if (cupsFileRewind(fp) != 0)
+	if ((count = count_lines(fp)) != 477)
 	{
-	  testEnd(false);
+	  testEndMessage(false, "got %d lines, expected 477", count);
 	  status ++;
 	}
 	else
 	{
 	  testEnd(true);
-	  testBegin("cupsFileGets");
+	  testBegin("cupsFileRewind");
 
-	  if ((count = count_lines(fp)) != 477)
+	  if (cupsFileRewind(fp) != 0)
 	  {
-	    testEndMessage(false, "got %d lines, expected 477", count);
+	    testEnd(false);
 	    status ++;
 	  }
 	  else
 	  {
 	    testEnd(true);
+	    testBegin("cupsFileGets");
+
+	    if ((count = count_lines(fp)) != 477)
+	    {
+	      testEndMessage(false, "got %d lines, expected 477", count);
+	      status ++;
+	    }
+	    else
+	    {
+	      testEnd(true);
+	    }
 	  }
-        }
-      }
+	}
 
-      cupsFileClose(fp);
+	cupsFileClose(fp);
+      }
     }
 
     // Test path functions...
@@ -252,6 +281,11 @@ main(int  argc,				// I - Number of command-line arguments
       rmdir("test.d");
     }
   }
+  else if (!strcmp(argv[1], "--benchmark"))
+  {
+    // Time parsing of a large configuration file...
+    status = conf_benchmark();
+  }
   else
   {
     // Cat the filename on the command-line...
@@ -295,6 +329,95 @@ main(int  argc,				// I - Number of command-line arguments
 }
 
 
+//
+// 'conf_benchmark()' - Time parsing of a 100MB configuration file.
+//
+
+static int				// O - Status
+conf_benchmark(void)
+{
+  int		i,			// Looping var
+		linenum,		// Line number
+		count;			// Number of directives
+  cups_file_t	*fp;			// File
+  char		line[1024],		// Line from file
+		*value;			// Value from line
+  double	start,			// Start time
+		secs;			// Elapsed seconds
+  off_t		length;			// Length of file
+  size_t	bufsize;		// Buffer size
+  static const char * const modes[] =	// Read modes
+  {
+    "r",
+    "rm"
+  };
+
+
+  // Write a 100MB configuration file...
+  testBegin("cupsFileOpen(write testfile.conf)");
+
+  if ((fp = cupsFileOpen("testfile.conf", "w")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (1);
+  }
+
+  for (i = 0; cupsFileTell(fp) < (100 * 1024 * 1024); i ++)
+  {
+    if ((i % 100) == 0)
+      cupsFilePrintf(fp, "# Section %d of the benchmark configuration file\n\n<Section %d>\n", i / 100, i / 100);
+
+    cupsFilePrintf(fp, "  Directive%03d value-%d with several words of text  # trailing comment\n", i % 100, i);
+
+    if ((i % 100) == 99)
+      cupsFilePuts(fp, "</Section>\n");
+  }
+
+  length = cupsFileTell(fp);
+
+  if (!cupsFileClose(fp))
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (1);
+  }
+
+  testEndMessage(true, "%.1fMB, %d directives", length / 1048576.0, i);
+
+  // Parse the file with different modes and buffer sizes...
+  for (i = 0; i < 4; i ++)
+  {
+    bufsize = (i & 1) ? 256 * 1024 : 4096;
+
+    testBegin("cupsFileGetConf(\"%s\", %uk buffer)", modes[i / 2], (unsigned)(bufsize / 1024));
+
+    if ((fp = cupsFileOpen("testfile.conf", modes[i / 2])) == NULL)
+    {
+      testEndMessage(false, "%s", strerror(errno));
+      return (1);
+    }
+
+    cupsFileSetBufferSize(fp, bufsize);
+
+    start   = cupsGetClock();
+    linenum = 0;
+    count   = 0;
+
+    while (cupsFileGetConf(fp, line, sizeof(line), &value, &linenum))
+      count ++;
+
+    secs = cupsGetClock() - start;
+
+    cupsFileClose(fp);
+
+    testEndMessage(true, "%d lines, %d directives, %.3fs, %.1fMB/sec", linenum, count, secs, length / secs / 1048576.0);
+  }
+
+  unlink("testfile.conf");
+
+  return (0);
+}
+
+
 //
 // 'count_lines()' - Count the number of lines in a file.
 //
@@ -313,12 +436,363 @@ count_lines(cups_file_t *fp)		// I - File to read from
 }
 
 
+//
+// 'index_tests()' - Do random access tests with checkpoints in a gzip'd file.
+//
+
+static int				// O - Status
+index_tests(void)
+{
+  int		status = 0,		// Status of tests
+		i,			// Looping var
+		bad;			// Bad record
+  cups_file_t	*fp;			// File
+  char		line[256];		// Line from file
+  double	secs,			// Seconds for seeks with checkpoints
+		nosecs;			// Seconds for seeks without checkpoints
+  static const int num_records = 1000000;
+					// Number of 16-byte records
+
+
+  // Write 1,000,000 numbered records...
+  testBegin("cupsFileOpen(write compressed index)");
+
+  if ((fp = cupsFileOpen("testfile.dat.gz", "w6")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (1);
+  }
+
+  for (i = 0; i < num_records; i ++)
+  {
+    if (!cupsFilePrintf(fp, "%015d\n", i))
+      break;
+  }
+
+  if (!cupsFileClose(fp) || i < num_records)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (1);
+  }
+
+  testEnd(true);
+
+  // Seek without checkpoints...
+  unlink("testfile.idx");
+
+  testBegin("cupsFileSeek(no checkpoints)");
+
+  if ((fp = cupsFileOpen("testfile.dat.gz", "r")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (1);
+  }
+
+  if ((bad = seek_records(fp, num_records, 20, &nosecs)) >= 0)
+  {
+    testEndMessage(false, "bad record %d", bad);
+    status ++;
+  }
+  else
+  {
+    testEndMessage(true, "%.3fms per seek", 1000.0 * nosecs / 20);
+  }
+
+  cupsFileClose(fp);
+
+  // Read the file sequentially to build the checkpoints...
+  testBegin("cupsFileSetIndex(testfile.idx)");
+
+  if ((fp = cupsFileOpen("testfile.dat.gz", "r")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (1);
+  }
+
+  if (!cupsFileSetIndex(fp, 256 * 1024, "testfile.idx"))
+  {
+    testEnd(false);
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  testBegin("cupsFileGets(index)");
+
+  for (i = 0; cupsFileGets(fp, line, sizeof(line)); i ++)
+  {
+    if (strtol(line, NULL, 10) != i)
+      break;
+  }
+
+  if (i != num_records)
+  {
+    testEndMessage(false, "got %d records, expected %d", i, num_records);
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  // Seek with the new checkpoints, starting from the end of the file...
+  testBegin("cupsFileSeek(checkpoints)");
+
+  if ((bad = seek_records(fp, num_records, 1000, &secs)) >= 0)
+  {
+    testEndMessage(false, "bad record %d", bad);
+    status ++;
+  }
+  else
+  {
+    testEndMessage(true, "%.3fms per seek, %.0fx faster", 1000.0 * secs / 1000, (nosecs / 20) / (secs / 1000));
+  }
+
+  cupsFileClose(fp);
+
+  // Seek with the saved checkpoints...
+  testBegin("cupsFileSeek(saved checkpoints)");
+
+  if ((fp = cupsFileOpen("testfile.dat.gz", "r")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (1);
+  }
+
+  if (!cupsFileSetIndex(fp, 256 * 1024, "testfile.idx"))
+  {
+    testEndMessage(false, "cupsFileSetIndex failed");
+    status ++;
+  }
+  else if ((bad = seek_records(fp, num_records, 1000, &secs)) >= 0)
+  {
+    testEndMessage(false, "bad record %d", bad);
+    status ++;
+  }
+  else if ((secs / 1000) > (nosecs / 20))
+  {
+    testEndMessage(false, "%.3fms per seek, checkpoints not loaded", 1000.0 * secs / 1000);
+    status ++;
+  }
+  else
+  {
+    testEndMessage(true, "%.3fms per seek", 1000.0 * secs / 1000);
+  }
+
+  cupsFileClose(fp);
+
+  // Remove the test files...
+  unlink("testfile.dat.gz");
+  unlink("testfile.idx");
+
+  return (status);
+}
+
+
+//
+// 'line_tests()' - Read lines with different buffer sizes and line endings.
+//
+
+static int				// O - Status
+line_tests(void)
+{
+  int		status = 0,		// Status of tests
+		i,			// Looping var
+		linenum;		// Line number
+  cups_file_t	*fp;			// File
+  char		line[1024],		// Line from file
+		expected[1024];		// Expected line
+  size_t	length,			// Length of line
+		bytes;			// Bytes read
+  off_t		total;			// Total bytes in file
+  const char	*eol;			// End of line
+  static const int num_lines = 20000;	// Number of lines in file
+  static const struct			// Read variations
+  {
+    const char	*filename,		// File to read
+		*mode;			// Read mode
+    size_t	bufsize;		// Buffer size
+  }		tests[] =
+  {
+    { "testfile.lines", "r", 1024 },
+    { "testfile.lines", "r", 4096 },
+    { "testfile.lines", "r", 1024 * 1024 },
+    { "testfile.lines", "rm", 4096 },
+    { "testfile.lines.gz", "r", 1024 },
+    { "testfile.lines.gz", "r", 1024 * 1024 }
+  };
+
+
+  // Write files with LF, CR LF, and CR line endings...
+  testBegin("cupsFilePuts(lines)");
+
+  for (i = 0; i < 2; i ++)
+  {
+    if ((fp = cupsFileOpen(i ? "testfile.lines.gz" : "testfile.lines", i ? "w9" : "w")) == NULL)
+    {
+      testEndMessage(false, "%s", strerror(errno));
+      return (1);
+    }
+
+    for (linenum = 0; linenum < num_lines; linenum ++)
+    {
+      make_line(linenum, line, sizeof(line), &eol);
+      cupsFilePuts(fp, line);
+      cupsFilePuts(fp, eol);
+    }
+
+    if (!cupsFileClose(fp))
+    {
+      testEndMessage(false, "%s", strerror(errno));
+      return (1);
+    }
+  }
+
+  testEnd(true);
+
+  // Read the lines back...
+  for (i = 0; i < (int)(sizeof(tests) / sizeof(tests[0])); i ++)
+  {
+    testBegin("cupsFileGets/GetLine(%s, \"%s\", %u)", tests[i].filename, tests[i].mode, (unsigned)tests[i].bufsize);
+
+    if ((fp = cupsFileOpen(tests[i].filename, tests[i].mode)) == NULL)
+    {
+      testEndMessage(false, "%s", strerror(errno));
+      status ++;
+      continue;
+    }
+
+    if (!cupsFileSetBufferSize(fp, tests[i].bufsize))
+    {
+      testEndMessage(false, "cupsFileSetBufferSize failed");
+      status ++;
+      cupsFileClose(fp);
+      continue;
+    }
+
+    for (linenum = 0, total = 0; linenum < num_lines; linenum ++)
+    {
+      length = make_line(linenum, expected, sizeof(expected), &eol);
+      total  += (off_t)(length + strlen(eol));
+
+      if ((linenum & 1) == 0)
+      {
+        // Even lines use cupsFileGets...
+        if (!cupsFileGets(fp, line, sizeof(line)) || strcmp(line, expected))
+          break;
+      }
+      else
+      {
+        // Odd lines use cupsFileGetLine, which keeps the line ending...
+        cupsConcatString(expected, eol, sizeof(expected));
+        length += strlen(eol);
+
+        if ((bytes = cupsFileGetLine(fp, line, sizeof(line))) != length || memcmp(line, expected, length))
+          break;
+      }
+    }
+
+    if (linenum < num_lines)
+    {
+      testEndMessage(false, "line %d does not match", linenum + 1);
+      status ++;
+    }
+    else if (cupsFileGets(fp, line, sizeof(line)))
+    {
+      testEndMessage(false, "extra line \"%s\"", line);
+      status ++;
+    }
+    else if (cupsFileTell(fp) != total)
+    {
+      testEndMessage(false, "file position " CUPS_LLFMT " instead of " CUPS_LLFMT, CUPS_LLCAST cupsFileTell(fp), CUPS_LLCAST total);
+      status ++;
+    }
+    else
+    {
+      testEnd(true);
+    }
+
+    cupsFileClose(fp);
+  }
+
+  // Changing the buffer size after reading must fail...
+  testBegin("cupsFileSetBufferSize(after read)");
+
+  if ((fp = cupsFileOpen("testfile.lines", "r")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    status ++;
+  }
+  else
+  {
+    cupsFileGets(fp, line, sizeof(line));
+
+    if (cupsFileSetBufferSize(fp, 65536))
+    {
+      testEnd(false);
+      status ++;
+    }
+    else
+    {
+      testEnd(true);
+    }
+
+    cupsFileClose(fp);
+  }
+
+  unlink("testfile.lines");
+  unlink("testfile.lines.gz");
+
+  return (status);
+}
+
+
+//
+// 'make_line()' - Make a test line for the line scanning tests.
+//
+// Lines vary in length from 0 to 1000 characters and end with LF, CR LF, or
+// CR.  Empty lines always end with CR LF so that they cannot be mistaken for
+// the LF of a CR LF sequence.
+//
+
+static size_t				// O - Length of line
+make_line(int        linenum,		// I - Line number
+          char       *buf,		// I - Line buffer
+          size_t     bufsize,		// I - Size of line buffer
+          const char **eol)		// O - Line ending
+{
+  size_t	i,			// Looping var
+		length;			// Length of line
+  static const char * const eols[] =	// Line endings
+  {
+    "\n",
+    "\r\n",
+    "\r"
+  };
+
+
+  length = (size_t)(linenum * 7919) % 1001;
+  if (length >= bufsize)
+    length = bufsize - 1;
+
+  for (i = 0; i < length; i ++)
+    buf[i] = (char)('!' + (linenum + (int)i) % 94);
+
+  buf[length] = '\0';
+  *eol        = length ? eols[linenum % 3] : "\r\n";
+
+  return (length);
+}
+
+
 //
 // 'random_tests()' - Do random access tests.
 //
 
 static int				// O - Status
-random_tests(void)
+random_tests(bool mapped)		// I - Memory-map the file for reading?
 {
   int		status,			// Status of tests
 		pass,			// Current pass
@@ -404,9 +878,9 @@ random_tests(void)
     cupsFileClose(fp);
 
     // cupsFileOpen(read)
-    testBegin("cupsFileOpen(read %d)", pass);
+    testBegin("cupsFileOpen(read%s %d)", mapped ? " mapped" : "", pass);
 
-    if ((fp = cupsFileOpen("testfile.dat", "r")) == NULL)
+    if ((fp = cupsFileOpen("testfile.dat", mapped ? "rm" : "r")) == NULL)
     {
       testEndMessage(false, "%s", strerror(errno));
       status ++;
@@ -476,7 +950,9 @@ random_tests(void)
 //
 
 static int				// O - Status
-read_write_tests(bool compression)	// I - Use compression?
+read_write_tests(bool   compression,	// I - Use compression?
+                 bool   mapped,		// I - Memory-map the file for reading?
+                 size_t threads)	// I - Number of compression threads
 {
   int		i, j;			// Looping vars
   cups_file_t	*fp;			// File
@@ -521,6 +997,22 @@ read_write_tests(bool compression)	// I - Use compression?
       status ++;
     }
 
+    if (threads > 1)
+    {
+      // cupsFileSetThreads()
+      testBegin("cupsFileSetThreads(%u)", (unsigned)threads);
+
+      if (cupsFileSetThreads(fp, threads))
+      {
+        testEnd(true);
+      }
+      else
+      {
+        testEnd(false);
+        status ++;
+      }
+    }
+
     // cupsFilePuts()
     testBegin("cupsFilePuts()");
 
@@ -637,9 +1129,9 @@ read_write_tests(bool compression)	// I - Use compression?
   }
 
   // cupsFileOpen(read)
-  testBegin("cupsFileOpen(read)");
+  testBegin("cupsFileOpen(read%s)", mapped ? " mapped" : "");
 
-  fp = cupsFileOpen(compression ? "testfile.dat.gz" : "testfile.dat", "r");
+  fp = cupsFileOpen(compression ? "testfile.dat.gz" : "testfile.dat", mapped ? "rm" : "r");
   if (fp)
   {
     testEnd(true);
@@ -824,3 +1316,37 @@ read_write_tests(bool compression)	// I - Use compression?
   // Return the test status...
   return (status);
 }
+
+
+//
+// 'seek_records()' - Seek to and validate random records in a file.
+//
+
+static int				// O - Bad record number or `-1` if all are good
+seek_records(cups_file_t *fp,		// I - File
+             int         num_records,	// I - Number of 16-byte records
+             int         count,		// I - Number of seeks
+             double      *secs)		// O - Elapsed seconds
+{
+  int		i,			// Looping var
+		record;			// Current record
+  char		buffer[17],		// Record from file
+		expected[17];		// Expected record
+  double	start = cupsGetClock();	// Start time
+
+
+  for (i = 0; i < count; i ++)
+  {
+    // Start with the last record, then pick random ones...
+    record = i ? (int)(cupsGetRand() % (unsigned)num_records) : num_records - 1;
+
+    snprintf(expected, sizeof(expected), "%015d\n", record);
+
+    if (cupsFileSeek(fp, 16 * (off_t)record) != 16 * (off_t)record || cupsFileRead(fp, buffer, 16) != 16 || memcmp(buffer, expected, 16))
+      return (record);
+  }
+
+  *secs = cupsGetClock() - start;
+
+  return (-1);
+}
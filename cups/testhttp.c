@@ -11,6 +11,7 @@
 
 #include "cups-private.h"
 #include "test-internal.h"
+#include <zlib.h>
 
 
 //
@@ -30,6 +31,36 @@ typedef struct uri_test_s		// URI test cases
   http_uri_coding_t	assemble_coding;// Coding for httpAssembleURI()
 } uri_test_t;
 
+typedef struct chunk_test_s		// Chunked transfer test data
+{
+  http_t		*http;		// Server connection
+  char			*buffer;	// Receive buffer
+  size_t		bufsize,	// Size of receive buffer
+			bytes;		// Bytes received
+} chunk_test_t;
+
+typedef struct coding_test_s		// Content coding test data
+{
+  http_t		*http;		// Server connection
+  const char		*block;		// Block of data to send
+  size_t		blocksize,	// Size of block
+			total;		// Total bytes to send
+} coding_test_t;
+
+
+//
+// Local functions...
+//
+
+static void		*chunk_read(chunk_test_t *data);
+static bool		chunk_test(bool buffered, size_t num_writes, size_t bytes_per_write, size_t max_calls);
+static bool		coding_test(size_t total);
+static bool		coding_send(http_t *http, const void *buffer, size_t length);
+static void		*coding_write(coding_test_t *data);
+static bool		loopback_connect(http_t **client, http_t **server);
+static bool		precoded_test(void);
+static void		*precoded_write(coding_test_t *data);
+
 
 //
 // Local globals...
@@ -381,6 +412,53 @@ main(int  argc,				// I - Number of command-line arguments
       testEnd(false);
     }
 
+    // httpAddrGetList() with the address cache...
+    testBegin("httpAddrGetList(%s) cache", hostname);
+
+    httpAddrFlushCache();
+
+    if ((addrlist = httpAddrGetList(hostname, AF_UNSPEC, "631")) != NULL)
+    {
+      http_addrcache_stats_t before,	// Cache statistics before lookups
+			after;		// Cache statistics after lookups
+      double		lstart,		// Start time
+			lend;		// End time
+
+      httpAddrFreeList(addrlist);
+      httpAddrGetCacheStatistics(&before);
+
+      lstart = cupsGetClock();
+      for (i = 0; i < 1000; i ++)
+      {
+        if ((addrlist = httpAddrGetList(hostname, AF_UNSPEC, "631")) == NULL)
+          break;
+
+	httpAddrFreeList(addrlist);
+      }
+      lend = cupsGetClock();
+
+      httpAddrGetCacheStatistics(&after);
+
+      if (i < 1000)
+      {
+	failures ++;
+	testEndMessage(false, "lookup %d failed", i + 1);
+      }
+      else if ((after.hits - before.hits) != 1000)
+      {
+	failures ++;
+	testEndMessage(false, "%u cache hits, expected 1000", (unsigned)(after.hits - before.hits));
+      }
+      else
+      {
+        testEndMessage(true, "%.1fus per cached lookup", 1000.0 * (lend - lstart));
+      }
+    }
+    else
+    {
+      testEndMessage(true, "ignored because hostname does not resolve");
+    }
+
     // Test httpSeparateURI()...
     testBegin("httpSeparateURI()");
     for (i = 0, j = 0; i < (int)(sizeof(uri_tests) / sizeof(uri_tests[0])); i ++)
@@ -471,8 +549,31 @@ main(int  argc,				// I - Number of command-line arguments
     else
       testEndMessage(true, "%s", buffer);
 
+    // Chunked transfers...
+    if (!chunk_test(false, 16, 4096, 17))
+      failures ++;
+
+    if (!chunk_test(true, 1000, 100, 48))
+      failures ++;
+
+    // Chunked and compressed transfers...
+    if (!coding_test(16 * 1024 * 1024))
+      failures ++;
+
+    // Pre-compressed fixed-length responses...
+    if (!precoded_test())
+      failures ++;
+
     return (failures);
   }
+  else if (!strcmp(argv[1], "--bench"))
+  {
+    // Benchmark a chunked, gzip-compressed download over loopback...
+    size_t	mbytes = argc > 2 ? (size_t)strtoul(argv[2], NULL, 10) : 1024;
+					// Number of megabytes to download
+
+    return (coding_test(mbytes * 1024 * 1024) ? 0 : 1);
+  }
   else if (strstr(argv[1], "._tcp"))
   {
     // Test resolving an mDNS name.
@@ -867,3 +968,634 @@ main(int  argc,				// I - Number of command-line arguments
 
   return (0);
 }
+
+
+//
+// 'chunk_read()' - Read a chunked request body on the server side.
+//
+
+static void *				// O - Thread exit status
+chunk_read(chunk_test_t *data)		// I - Test data
+{
+  char		uri[1024];		// Request URI
+  http_state_t	state;			// Request state
+  http_status_t	status;			// Status of request
+  ssize_t	bytes;			// Bytes read
+
+
+  while ((state = httpReadRequest(data->http, uri, sizeof(uri))) == HTTP_STATE_WAITING)
+    ;
+
+  if (state != HTTP_STATE_POST)
+    return (NULL);
+
+  while ((status = httpUpdate(data->http)) == HTTP_STATUS_CONTINUE)
+    ;
+
+  if (status != HTTP_STATUS_OK)
+    return (NULL);
+
+  while (data->bytes < data->bufsize && (bytes = httpRead(data->http, data->buffer + data->bytes, data->bufsize - data->bytes)) > 0)
+    data->bytes += (size_t)bytes;
+
+  return (NULL);
+}
+
+
+//
+// 'chunk_test()' - Send a chunked request over the loopback interface and
+//                  count the number of write calls.
+//
+
+static bool				// O - `true` on success, `false` on failure
+chunk_test(bool   buffered,		// I - Use small (buffered) writes?
+           size_t num_writes,		// I - Number of writes
+           size_t bytes_per_write,	// I - Bytes per write
+           size_t max_calls)		// I - Maximum number of write calls
+{
+  bool			ret = false;	// Return value
+  http_t		*http = NULL;	// Client connection
+  chunk_test_t		data;		// Server data
+  cups_thread_t		thread;		// Server thread
+  char			*buffer;	// Send buffer
+  size_t		i,		// Looping var
+			total,		// Total bytes
+			calls;		// Number of write calls
+  http_stats_t		stats;		// Connection statistics
+
+
+  testBegin("httpWrite(%s, %u x %u bytes, chunked)", buffered ? "buffered" : "direct", (unsigned)num_writes, (unsigned)bytes_per_write);
+
+  memset(&data, 0, sizeof(data));
+
+  total = num_writes * bytes_per_write;
+
+  if ((buffer = malloc(bytes_per_write)) == NULL || (data.buffer = malloc(total + 1)) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    free(buffer);
+    return (false);
+  }
+
+  data.bufsize = total + 1;
+
+  for (i = 0; i < bytes_per_write; i ++)
+    buffer[i] = (char)('A' + (i % 26));
+
+  if (!loopback_connect(&http, &data.http))
+    goto done;
+
+  httpSetStatistics(http, true);
+
+  thread = cupsThreadCreate((cups_thread_func_t)chunk_read, &data);
+
+  // Send the request...
+  httpClearFields(http);
+  httpSetField(http, HTTP_FIELD_TRANSFER_ENCODING, "chunked");
+
+  if (!httpWriteRequest(http, "POST", "/"))
+  {
+    testEndMessage(false, "httpWriteRequest: %s", cupsGetErrorString());
+    httpShutdown(data.http);
+    cupsThreadWait(thread);
+    goto done;
+  }
+
+  httpGetStatistics(http, &stats);
+  calls = stats.write_calls;
+
+  for (i = 0; i < num_writes; i ++)
+  {
+    if (httpWrite(http, buffer, bytes_per_write) < 0)
+      break;
+  }
+
+  httpWrite(http, "", 0);
+
+  httpGetStatistics(http, &stats);
+  calls = stats.write_calls - calls;
+
+  cupsThreadWait(thread);
+
+  // Check results...
+  if (i < num_writes)
+  {
+    testEndMessage(false, "httpWrite: %s", cupsGetErrorString());
+  }
+  else if (data.bytes != total)
+  {
+    testEndMessage(false, "got %u bytes, expected %u", (unsigned)data.bytes, (unsigned)total);
+  }
+  else if (calls > max_calls)
+  {
+    testEndMessage(false, "%u write calls, expected no more than %u", (unsigned)calls, (unsigned)max_calls);
+  }
+  else if (stats.requests != 1 || stats.bytes_out < total)
+  {
+    testEndMessage(false, "statistics report %u requests and %u bytes written", (unsigned)stats.requests, (unsigned)stats.bytes_out);
+  }
+  else
+  {
+    for (i = 0; i < total; i ++)
+    {
+      if (data.buffer[i] != buffer[i % bytes_per_write])
+        break;
+    }
+
+    if (i < total)
+      testEndMessage(false, "data mismatch at offset %u", (unsigned)i);
+    else
+      testEndMessage(true, "%u write calls", (unsigned)calls);
+
+    ret = i >= total;
+  }
+
+  // Clean up...
+  done:
+
+  httpClose(data.http);
+  httpClose(http);
+  free(buffer);
+  free(data.buffer);
+
+  return (ret);
+}
+
+
+//
+// 'coding_test()' - Download a chunked, gzip-compressed response over the
+//                   loopback interface and report the throughput.
+//
+
+static bool				// O - `true` on success, `false` on failure
+coding_test(size_t total)		// I - Total bytes to download
+{
+  bool			ret = false;	// Return value
+  http_t		*http = NULL;	// Client connection
+  coding_test_t		data;		// Server data
+  cups_thread_t		thread;		// Server thread
+  http_status_t		status;		// Response status
+  char			*block = NULL,	// Block of data
+			*buffer = NULL;	// Receive buffer
+  ssize_t		bytes;		// Bytes read
+  size_t		i,		// Looping var
+			offset,		// Offset in block
+			count,		// Bytes to compare
+			received = 0;	// Total bytes received
+  unsigned		seed = 1;	// Pseudo-random seed
+  double		start,		// Start time
+			elapsed;	// Elapsed time
+  static const char * const words[] =	// Words for test data
+  {
+    "black ", "color ", "copies ", "duplex ", "finishings ", "job ",
+    "media ", "printer ", "quality ", "resolution ", "sheet ", "sides ",
+    "staple ", "tray ", "white ", "\n"
+  };
+
+
+  testBegin("httpRead(%u MiB, chunked+gzip)", (unsigned)(total / 1048576));
+
+  memset(&data, 0, sizeof(data));
+
+  if ((block = malloc(65536)) == NULL || (buffer = malloc(65536)) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    goto done;
+  }
+
+  // Fill the block with compressible text...
+  for (i = 0; i < 65536;)
+  {
+    const char	*word;			// Current word
+
+    seed = seed * 1103515245 + 12345;
+    word = words[(seed >> 16) % (sizeof(words) / sizeof(words[0]))];
+
+    while (*word && i < 65536)
+      block[i ++] = *word++;
+  }
+
+  data.block     = block;
+  data.blocksize = 65536;
+  data.total     = total;
+
+  if (!loopback_connect(&http, &data.http))
+    goto done;
+
+  thread = cupsThreadCreate((cups_thread_func_t)coding_write, &data);
+
+  // Send the request and wait for the response...
+  httpClearFields(http);
+  httpSetField(http, HTTP_FIELD_ACCEPT_ENCODING, "gzip");
+
+  if (!httpWriteRequest(http, "GET", "/"))
+  {
+    testEndMessage(false, "httpWriteRequest: %s", cupsGetErrorString());
+    httpShutdown(data.http);
+    cupsThreadWait(thread);
+    goto done;
+  }
+
+  while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE)
+    ;
+
+  if (status != HTTP_STATUS_OK)
+  {
+    testEndMessage(false, "httpUpdate: %s", httpStatusString(status));
+    httpShutdown(data.http);
+    cupsThreadWait(thread);
+    goto done;
+  }
+
+  // Read and validate the response...
+  start = cupsGetClock();
+
+  while ((bytes = httpRead(http, buffer, 65536)) > 0)
+  {
+    for (i = 0; i < (size_t)bytes; i += count)
+    {
+      offset = (received + i) % data.blocksize;
+      count  = data.blocksize - offset;
+
+      if (count > ((size_t)bytes - i))
+        count = (size_t)bytes - i;
+
+      if (memcmp(buffer + i, block + offset, count))
+        break;
+    }
+
+    if (i < (size_t)bytes)
+      break;
+
+    received += (size_t)bytes;
+  }
+
+  elapsed = cupsGetClock() - start;
+
+  cupsThreadWait(thread);
+
+  if (bytes < 0)
+    testEndMessage(false, "httpRead: %s", cupsGetErrorString());
+  else if (bytes > 0)
+    testEndMessage(false, "data mismatch near offset %u", (unsigned)received);
+  else if (received != total)
+    testEndMessage(false, "got %u bytes, expected %u", (unsigned)received, (unsigned)total);
+  else
+    testEndMessage(ret = true, "%.1f MiB/sec", total / 1048576.0 / (elapsed > 0.0 ? elapsed : 0.000001));
+
+  // Clean up...
+  done:
+
+  httpClose(data.http);
+  httpClose(http);
+  free(block);
+  free(buffer);
+
+  return (ret);
+}
+
+
+//
+// 'coding_send()' - Send raw bytes on a connection.
+//
+
+static bool				// O - `true` on success, `false` on failure
+coding_send(http_t     *http,		// I - HTTP connection
+            const void *buffer,		// I - Buffer
+            size_t     length)		// I - Number of bytes
+{
+  const char	*ptr = (const char *)buffer;
+					// Pointer into buffer
+  ssize_t	bytes;			// Bytes sent
+
+
+  while (length > 0)
+  {
+    if ((bytes = send(httpGetFd(http), ptr, length, 0)) < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+
+      return (false);
+    }
+
+    ptr    += bytes;
+    length -= (size_t)bytes;
+  }
+
+  return (true);
+}
+
+
+//
+// 'coding_write()' - Send a chunked, gzip-compressed response on the server
+//                    side.
+//
+// The block is compressed once and the compressed bytes are repeated so that
+// the sender is not the bottleneck when measuring the receive path.
+//
+
+static void *				// O - Thread exit status
+coding_write(coding_test_t *data)	// I - Test data
+{
+  char		uri[1024];		// Request URI
+  http_state_t	state;			// Request state
+  http_status_t	status;			// Status of request
+  z_stream	stream;			// Compression stream
+  unsigned char	*chunk = NULL,		// Chunk buffer
+		trailer[64];		// Gzip trailer chunk
+  size_t	i,			// Looping var
+		chunklen,		// Length of chunk
+		packedlen;		// Length of compressed block
+  uLong		blockcrc,		// CRC-32 of block
+		crc;			// CRC-32 of all data
+  int		hdrlen;			// Length of chunk header
+  static const char response[] =	// Response header
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Encoding: gzip\r\n"
+  "Transfer-Encoding: chunked\r\n"
+  "\r\n"
+  "a\r\n\037\213\010\000\000\000\000\000\000\003\r\n";
+					// Response header and gzip header chunk
+
+
+  while ((state = httpReadRequest(data->http, uri, sizeof(uri))) == HTTP_STATE_WAITING)
+    ;
+
+  if (state != HTTP_STATE_GET)
+    return (NULL);
+
+  while ((status = httpUpdate(data->http)) == HTTP_STATUS_CONTINUE)
+    ;
+
+  if (status != HTTP_STATUS_OK)
+    return (NULL);
+
+  // Compress the block as a self-contained run of raw deflate data...
+  memset(&stream, 0, sizeof(stream));
+
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return (NULL);
+
+  chunklen = deflateBound(&stream, (uLong)data->blocksize) + 32;
+
+  if ((chunk = malloc(chunklen)) == NULL)
+  {
+    deflateEnd(&stream);
+    return (NULL);
+  }
+
+  stream.next_in   = (Bytef *)data->block;
+  stream.avail_in  = (uInt)data->blocksize;
+  stream.next_out  = chunk + 16;
+  stream.avail_out = (uInt)(chunklen - 32);
+
+  deflate(&stream, Z_FULL_FLUSH);
+
+  packedlen = chunklen - 32 - stream.avail_out;
+
+  deflateEnd(&stream);
+
+  // Add the chunk framing...
+  hdrlen = snprintf((char *)chunk, 16, "%x\r\n", (unsigned)packedlen);
+  memmove(chunk + hdrlen, chunk + 16, packedlen);
+  memcpy(chunk + hdrlen + packedlen, "\r\n", 2);
+  chunklen = (size_t)hdrlen + packedlen + 2;
+
+  // Send the response...
+  if (!coding_send(data->http, response, sizeof(response) - 1))
+    goto done;
+
+  blockcrc = crc32(0, (const Bytef *)data->block, (uInt)data->blocksize);
+
+  for (i = 0, crc = crc32(0, NULL, 0); i < data->total; i += data->blocksize)
+  {
+    if (!coding_send(data->http, chunk, chunklen))
+      goto done;
+
+    crc = crc32_combine(crc, blockcrc, (z_off_t)data->blocksize);
+  }
+
+  // Send the final (empty) deflate block, gzip trailer, and 0-length chunk...
+  memcpy(trailer, "a\r\n\003\000", 5);
+  for (i = 0; i < 4; i ++)
+  {
+    trailer[5 + i] = (unsigned char)(crc >> (8 * i));
+    trailer[9 + i] = (unsigned char)(data->total >> (8 * i));
+  }
+  memcpy(trailer + 13, "\r\n0\r\n\r\n", 7);
+
+  coding_send(data->http, trailer, 20);
+
+  done:
+
+  free(chunk);
+
+  return (NULL);
+}
+
+
+//
+// 'loopback_connect()' - Connect to ourselves over the loopback interface.
+//
+
+static bool				// O - `true` on success, `false` on failure
+loopback_connect(http_t **client,	// O - Client connection
+                 http_t **server)	// O - Server connection
+{
+  http_addrlist_t	*addrlist;	// Listen address
+  http_addr_t		addr;		// Bound address
+  socklen_t		addrlen;	// Length of bound address
+  int			fd;		// Listen socket
+
+
+  *client = NULL;
+  *server = NULL;
+
+  // Listen on an ephemeral loopback port...
+  if ((addrlist = httpAddrGetList("127.0.0.1", AF_INET, "0")) == NULL)
+  {
+    testEndMessage(false, "httpAddrGetList: %s", cupsGetErrorString());
+    return (false);
+  }
+
+  fd = httpAddrListen(&addrlist->addr, 0);
+  httpAddrFreeList(addrlist);
+
+  addrlen = sizeof(addr);
+  if (fd < 0 || getsockname(fd, (struct sockaddr *)&addr, &addrlen))
+  {
+    testEndMessage(false, "httpAddrListen: %s", cupsGetErrorString());
+    return (false);
+  }
+
+  if ((*client = httpConnect("127.0.0.1", httpAddrGetPort(&addr), NULL, AF_INET, HTTP_ENCRYPTION_NEVER, true, 30000, NULL)) == NULL)
+  {
+    testEndMessage(false, "httpConnect: %s", cupsGetErrorString());
+    httpAddrClose(NULL, fd);
+    return (false);
+  }
+
+  *server = httpAcceptConnection(fd, true);
+  httpAddrClose(NULL, fd);
+
+  if (!*server)
+  {
+    testEndMessage(false, "httpAcceptConnection: %s", cupsGetErrorString());
+    return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'precoded_test()' - Download a pre-compressed, fixed-length response over
+//                     the loopback interface.
+//
+
+static bool				// O - `true` on success, `false` on failure
+precoded_test(void)
+{
+  bool			ret = false;	// Return value
+  http_t		*http = NULL;	// Client connection
+  coding_test_t		data;		// Server data
+  cups_thread_t		thread;		// Server thread
+  http_status_t		status;		// Response status
+  z_stream		stream;		// Compression stream
+  char			text[4096],	// Uncompressed text
+			packed[4096],	// Compressed text
+			buffer[8192];	// Receive buffer
+  ssize_t		bytes;		// Bytes read
+  size_t		i,		// Looping var
+			received = 0;	// Total bytes received
+
+
+  testBegin("httpWriteResponse(Content-Length, gzip)");
+
+  memset(&data, 0, sizeof(data));
+
+  // Compress some text using gzip framing...
+  for (i = 0; i < sizeof(text); i ++)
+    text[i] = "Pre-compressed fixed-length content.\n"[i % 37];
+
+  memset(&stream, 0, sizeof(stream));
+
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    testEndMessage(false, "deflateInit2 failed");
+    return (false);
+  }
+
+  stream.next_in   = (Bytef *)text;
+  stream.avail_in  = (uInt)sizeof(text);
+  stream.next_out  = (Bytef *)packed;
+  stream.avail_out = (uInt)sizeof(packed);
+
+  if (deflate(&stream, Z_FINISH) != Z_STREAM_END)
+  {
+    testEndMessage(false, "deflate failed");
+    deflateEnd(&stream);
+    return (false);
+  }
+
+  data.block     = packed;
+  data.blocksize = sizeof(packed) - stream.avail_out;
+
+  deflateEnd(&stream);
+
+  if (!loopback_connect(&http, &data.http))
+    goto done;
+
+  thread = cupsThreadCreate((cups_thread_func_t)precoded_write, &data);
+
+  // Send the request and wait for the response...
+  httpClearFields(http);
+  httpSetField(http, HTTP_FIELD_ACCEPT_ENCODING, "gzip");
+
+  if (!httpWriteRequest(http, "GET", "/"))
+  {
+    testEndMessage(false, "httpWriteRequest: %s", cupsGetErrorString());
+    httpShutdown(data.http);
+    cupsThreadWait(thread);
+    goto done;
+  }
+
+  while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE)
+    ;
+
+  if (status != HTTP_STATUS_OK)
+  {
+    testEndMessage(false, "httpUpdate: %s", httpStatusString(status));
+    httpShutdown(data.http);
+    cupsThreadWait(thread);
+    goto done;
+  }
+
+  // Read and validate the response...
+  while (received < sizeof(buffer) && (bytes = httpRead(http, buffer + received, sizeof(buffer) - received)) > 0)
+    received += (size_t)bytes;
+
+  cupsThreadWait(thread);
+
+  if (received != sizeof(text))
+    testEndMessage(false, "got %u bytes, expected %u", (unsigned)received, (unsigned)sizeof(text));
+  else if (memcmp(buffer, text, sizeof(text)))
+    testEndMessage(false, "data mismatch");
+  else
+    testEndMessage(ret = true, "%u bytes sent as-is", (unsigned)data.blocksize);
+
+  // Clean up...
+  done:
+
+  httpClose(data.http);
+  httpClose(http);
+
+  return (ret);
+}
+
+
+//
+// 'precoded_write()' - Send a pre-compressed response with a Content-Length
+//                      on the server side.
+//
+
+static void *				// O - Thread exit status
+precoded_write(coding_test_t *data)	// I - Test data
+{
+  char		uri[1024];		// Request URI
+  http_state_t	state;			// Request state
+  http_status_t	status;			// Status of request
+
+
+  while ((state = httpReadRequest(data->http, uri, sizeof(uri))) == HTTP_STATE_WAITING)
+    ;
+
+  if (state != HTTP_STATE_GET)
+    return (NULL);
+
+  while ((status = httpUpdate(data->http)) == HTTP_STATUS_CONTINUE)
+    ;
+
+  if (status != HTTP_STATUS_OK)
+    return (NULL);
+
+  httpClearFields(data->http);
+  httpSetField(data->http, HTTP_FIELD_CONTENT_ENCODING, "gzip");
+  httpSetLength(data->http, data->blocksize);
+
+  if (httpWriteResponse(data->http, HTTP_STATUS_OK))
+  {
+    httpWrite(data->http, data->block, data->blocksize);
+    httpFlushWrite(data->http);
+  }
+
+  // Close our end so that a short response is seen right away...
+#ifdef _WIN32
+  shutdown(httpGetFd(data->http), SD_SEND);
+#else
+  shutdown(httpGetFd(data->http), SHUT_WR);
+#endif // _WIN32
+
+  return (NULL);
+}
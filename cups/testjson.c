@@ -7,9 +7,17 @@
 // information.
 //
 
-#include "cups.h"
+#include "cups-private.h"
 #include "json.h"
 #include "test-internal.h"
+#include <math.h>
+
+
+//
+// Local functions...
+//
+
+static void	number_tests(void);
 
 
 //
@@ -218,6 +226,8 @@ main(int  argc,				// I - Number of command-line arguments
     cupsJSONDelete(json);
     testEnd(true);
 
+    number_tests();
+
     testBegin("cupsJSONImportURL('https://accounts.google.com/.well-known/openid-configuration', no last modified)");
     json = cupsJSONImportURL("https://accounts.google.com/.well-known/openid-configuration", &last_modified);
 
@@ -276,3 +286,177 @@ main(int  argc,				// I - Number of command-line arguments
 
   return (0);
 }
+
+
+//
+// 'number_tests()' - Test formatting and scanning of numbers.
+//
+
+static void
+number_tests(void)
+{
+  int		i;			// Looping var
+  cups_json_t	*json,			// JSON array
+		*current;		// Current node
+  char		*s,			// JSON string
+		*end,			// End of number
+		buffer[1024],		// Formatted number
+		expected[1024];		// Expected number
+  double	number,			// Number
+		scanned;		// Scanned number
+  uint64_t	bits;			// Bits for number
+  size_t	count;			// Number of failures
+  double	start,			// Start time
+		format_secs,		// Time for _cupsStrFormatd/_cupsStrScand
+		snprintf_secs;		// Time for snprintf/strtod
+  static const double numbers[] =	// Numbers to export
+  {
+    0.1, -2.5e-7, 123456789123456789.0, 1e300, 42.0, 5e-324
+  };
+  static const char * const scans[] =	// Strings to scan
+  {
+    "0.1",
+    "1e23",
+    "9007199254740993",
+    "9007199254740993.00000000000000000000000000000000000001",
+    "2.2250738585072011e-308",
+    "2.4703282292062327e-324",
+    "2.4703282292062328e-324",
+    "1.7976931348623158e308",
+    "1.7976931348623159e308",
+    "1e-400",
+    "3.14159265358979323846264338327950288419716939937510582097494459230781640628620899862803482534211706798214808651328230664709384460955058223172535940812848111745028410270193852110555964462294895493038196"
+  };
+  static const char * const formats[] =	// Formats to test
+  {
+    "%g", "%.3f", "%e", "%.17g", "%10.2f", "%-12.4e", "%+G", "%#g", "%08.3f", "%.0f", "%.0e", "% .10g", "%.30f"
+  };
+
+
+  // Export numbers...
+  testBegin("cupsJSONExportString(numbers)");
+  json = cupsJSONNew(NULL, NULL, CUPS_JTYPE_ARRAY);
+  for (i = 0, current = NULL; i < (int)(sizeof(numbers) / sizeof(numbers[0])); i ++)
+    current = cupsJSONNewNumber(json, current, numbers[i]);
+
+  if ((s = cupsJSONExportString(json)) != NULL && !strcmp(s, "[0.1,-2.5e-7,123456789123456780,1e+300,42,5e-324]"))
+    testEnd(true);
+  else
+    testEndMessage(false, "got '%s'", s ? s : "(null)");
+
+  free(s);
+  cupsJSONDelete(json);
+
+  // Scan numbers...
+  for (i = 0; i < (int)(sizeof(scans) / sizeof(scans[0])); i ++)
+  {
+    testBegin("_cupsStrScand('%.40s')", scans[i]);
+    scanned = _cupsStrScand(scans[i], &end);
+    number  = strtod(scans[i], NULL);
+
+    if (memcmp(&scanned, &number, sizeof(number)) || *end)
+      testEndMessage(false, "got %.17g, expected %.17g", scanned, number);
+    else
+      testEndMessage(true, "%.17g", scanned);
+  }
+
+  // Fuzz format and scan for round-trip equality...
+  testBegin("_cupsStrFormatd/_cupsStrScand(1000000 random numbers)");
+  for (i = 0, count = 0; i < 1000000; i ++)
+  {
+    bits = ((uint64_t)cupsGetRand() << 32) | cupsGetRand();
+    memcpy(&number, &bits, sizeof(number));
+
+    if (isnan(number) || isinf(number))
+      continue;
+
+    _cupsStrFormatd(buffer, buffer + sizeof(buffer) - 1, number);
+    scanned = _cupsStrScand(buffer, &end);
+
+    if (memcmp(&scanned, &number, sizeof(number)) || *end || strtod(buffer, NULL) != number || strlen(buffer) > 25)
+    {
+      if (count == 0)
+        testEndMessage(false, "%.17g formatted as '%s' and scanned as %.17g", number, buffer, scanned);
+
+      count ++;
+    }
+
+    // Scan with strtod for comparison...
+    snprintf(buffer, sizeof(buffer), "%.*e", (int)(cupsGetRand() % 25), number);
+    scanned = _cupsStrScand(buffer, NULL);
+    number  = strtod(buffer, NULL);
+
+    if (memcmp(&scanned, &number, sizeof(number)))
+    {
+      if (count == 0)
+        testEndMessage(false, "'%s' scanned as %.17g, expected %.17g", buffer, scanned, number);
+
+      count ++;
+    }
+  }
+
+  if (count == 0)
+    testEnd(true);
+
+  // Compare cupsFormatString with snprintf...
+  testBegin("cupsFormatString(floating point)");
+  for (i = 0, count = 0; i < 100000; i ++)
+  {
+    const char *format = formats[i % (int)(sizeof(formats) / sizeof(formats[0]))];
+					// Current format
+
+    if (i & 1)
+    {
+      bits = ((uint64_t)cupsGetRand() << 32) | cupsGetRand();
+      memcpy(&number, &bits, sizeof(number));
+    }
+    else
+    {
+      number = ldexp((double)(cupsGetRand() % 100000), -(int)(cupsGetRand() % 20));
+    }
+
+    cupsFormatString(buffer, sizeof(buffer), format, number);
+    snprintf(expected, sizeof(expected), format, number);
+
+    if (strcmp(buffer, expected))
+    {
+      if (count == 0)
+        testEndMessage(false, "'%s' got '%s', expected '%s'", format, buffer, expected);
+
+      count ++;
+    }
+  }
+
+  if (count == 0)
+    testEnd(true);
+
+  // Benchmark against snprintf and strtod...
+  testBegin("snprintf/strtod(1000000 numbers)");
+  start = cupsGetClock();
+
+  for (i = 0, scanned = 0.0; i < 1000000; i ++)
+  {
+    snprintf(buffer, sizeof(buffer), "%.17g", i * 0.001 + 0.5);
+    scanned += strtod(buffer, NULL);
+  }
+
+  snprintf_secs = cupsGetClock() - start;
+
+  testEndMessage(true, "%.3f seconds", snprintf_secs);
+
+  testBegin("_cupsStrFormatd/_cupsStrScand(1000000 numbers)");
+  start = cupsGetClock();
+
+  for (i = 0, number = 0.0; i < 1000000; i ++)
+  {
+    _cupsStrFormatd(buffer, buffer + sizeof(buffer) - 1, i * 0.001 + 0.5);
+    number += _cupsStrScand(buffer, NULL);
+  }
+
+  format_secs = cupsGetClock() - start;
+
+  if (number != scanned)
+    testEndMessage(false, "got sum %.17g, expected %.17g", number, scanned);
+  else
+    testEndMessage(true, "%.3f seconds, %.1fx faster", format_secs, snprintf_secs / format_secs);
+}
@@ -12,6 +12,14 @@
 #include "test-internal.h"
 
 
+//
+// Local functions...
+//
+
+static int	optset_tests(void);
+static int	preset_tests(void);
+
+
 //
 // 'main()' - Test option processing functions.
 //
@@ -139,6 +147,13 @@ main(int  argc,				// I - Number of command-line arguments
     }
     else
       testEnd(true);
+
+    cupsFreeOptions(num_options, options);
+    ippDelete(request);
+
+    // Test option sets and presets...
+    status += optset_tests();
+    status += preset_tests();
   }
   else
   {
@@ -154,3 +169,325 @@ main(int  argc,				// I - Number of command-line arguments
 
   exit (status);
 }
+
+
+//
+// 'optset_tests()' - Test option sets.
+//
+
+static int				// O - Number of failures
+optset_tests(void)
+{
+  int		status = 0;		// Number of failures
+  size_t	i, j,			// Looping vars
+		num_options,		// Number of parsed options
+		num_exported;		// Number of exported options
+  cups_option_t	*options,		// Parsed options
+		*exported;		// Exported options
+  cups_optset_t	*set;			// Option set
+  const char	*end,			// End of parsed options
+		*setend,		// End of option set options
+		*value;			// Value of an option
+  char		job[4096];		// Job options string
+  double	start,			// Start time
+		parse_secs,		// Time for cupsParseOptions
+		optset_secs;		// Time for cupsOptSetParse
+  static const char * const args[] =	// Option strings
+  {
+    "foo=1234 bar=\"One Fish\",\"Two Fish\",\"Red Fish\",\"Blue Fish\" baz={param1=1 param2=2} foobar=FOO\\ BAR barfoo=barfoo barfoo=\"'BAR FOO'\" auth-info=user,pass\\\\,word\\\\\\\\",
+    "{media-size={x-dimension=21000 y-dimension=29700} media-type=stationery} more=options",
+    "{a=1 b=two}c=3 d=4",
+    "  nocollate duplex sides=two-sided-long-edge NoFitPlot no",
+    "cupsPrintQuality=4 print-quality=5 PRINT-QUALITY=3",
+    "a='\\'quoted\\'' b=\"x\\\"y\" c={x={y=\\}} z=1} d=e\\",
+    "name=",
+    "=value other=1",
+    ""
+  };
+
+
+  // cupsOptSetParse() should produce the same options as cupsParseOptions()
+  testBegin("cupsOptSetParse");
+  set = cupsOptSetNew();
+
+  for (i = 0; i < (sizeof(args) / sizeof(args[0])) && !status; i ++)
+  {
+    num_options = cupsParseOptions(args[i], &end, 0, &options);
+
+    cupsOptSetClear(set);
+    if (!cupsOptSetParse(set, args[i], &setend))
+    {
+      testEndMessage(false, "unable to parse \"%s\"", args[i]);
+      status ++;
+      break;
+    }
+
+    exported     = NULL;
+    num_exported = cupsOptSetExport(set, 0, &exported);
+
+    // cupsParseOptions reports the end relative to its unescaped copy, so
+    // only compare the end pointers for strings without escapes or quotes...
+    if (num_exported != num_options || (setend != end && !strpbrk(args[i], "\\\"'")))
+    {
+      testEndMessage(false, "got %u options and end offset %d for \"%s\", expected %u and %d", (unsigned)num_exported, (int)(setend - args[i]), args[i], (unsigned)num_options, (int)(end - args[i]));
+      status ++;
+    }
+
+    for (j = 0; j < num_options && !status; j ++)
+    {
+      if (strcmp(options[j].name, exported[j].name) || strcmp(options[j].value, exported[j].value))
+      {
+        testEndMessage(false, "got %s=\"%s\" for \"%s\", expected %s=\"%s\"", exported[j].name, exported[j].value, args[i], options[j].name, options[j].value);
+        status ++;
+      }
+      else if ((value = cupsOptSetGetValue(set, options[j].name)) == NULL || strcmp(value, options[j].value))
+      {
+        testEndMessage(false, "cupsOptSetGetValue(\"%s\") returned \"%s\", expected \"%s\"", options[j].name, value, options[j].value);
+        status ++;
+      }
+    }
+
+    cupsFreeOptions(num_options, options);
+    cupsFreeOptions(num_exported, exported);
+  }
+
+  if (!status)
+    testEnd(true);
+
+  // cupsOptSetAdd/Remove/Export
+  testBegin("cupsOptSetAdd/Remove");
+  cupsOptSetClear(set);
+  cupsOptSetAdd(set, "media", "na_letter_8.5x11in");
+  cupsOptSetAdd(set, "copies", "2");
+  cupsOptSetAdd(set, "Copies", "3");
+  cupsOptSetAdd(set, "sides", "one-sided");
+
+  num_options = cupsAddOption("sides", "two-sided-long-edge", 0, &options);
+  num_options = cupsAddOption("job-name", "test", num_options, &options);
+  num_options = cupsOptSetExport(set, num_options, &options);
+
+  if (cupsOptSetGetCount(set) != 3 || strcmp(cupsOptSetGetName(set, 1), "copies") || (value = cupsOptSetGetValue(set, "COPIES")) == NULL || strcmp(value, "3"))
+  {
+    testEndMessage(false, "wrong option set contents");
+    status ++;
+  }
+  else if (!cupsOptSetRemove(set, "media") || cupsOptSetRemove(set, "media") || cupsOptSetGetValue(set, "media") || (value = cupsOptSetGetValue(set, "sides")) == NULL || strcmp(value, "one-sided"))
+  {
+    testEndMessage(false, "cupsOptSetRemove failed");
+    status ++;
+  }
+  else if (num_options != 4 || (value = cupsGetOption("sides", num_options, options)) == NULL || strcmp(value, "one-sided"))
+  {
+    testEndMessage(false, "cupsOptSetExport merged %u options, expected 4", (unsigned)num_options);
+    status ++;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  cupsFreeOptions(num_options, options);
+
+  // Benchmark with a typical job submission...
+  snprintf(job, sizeof(job), "copies=1 sides=two-sided-long-edge media-col={media-size={x-dimension=21590 y-dimension=27940} media-source=auto media-type=stationery} job-name=\"Quarterly Report\\ (final)\"");
+
+  for (i = 0; i < 46; i ++)
+  {
+    size_t	joblen = strlen(job);	// Length of string
+
+    snprintf(job + joblen, sizeof(job) - joblen, " x-option-%02u=value-%u", (unsigned)i, (unsigned)(i * 37));
+  }
+
+  testBegin("cupsParseOptions(50 options x 10000)");
+  start = cupsGetClock();
+
+  for (i = 0; i < 10000; i ++)
+  {
+    num_options = cupsParseOptions(job, NULL, 0, &options);
+
+    if (!cupsGetOption("job-name", num_options, options))
+      break;
+
+    cupsFreeOptions(num_options, options);
+  }
+
+  parse_secs = cupsGetClock() - start;
+
+  testEndMessage(i == 10000, "%.3f seconds", parse_secs);
+
+  testBegin("cupsOptSetParse(50 options x 10000)");
+  start = cupsGetClock();
+
+  for (i = 0; i < 10000; i ++)
+  {
+    cupsOptSetClear(set);
+    cupsOptSetParse(set, job, NULL);
+
+    if (!cupsOptSetGetValue(set, "job-name"))
+      break;
+  }
+
+  optset_secs = cupsGetClock() - start;
+
+  if (i < 10000 || cupsOptSetGetCount(set) != 50)
+  {
+    testEndMessage(false, "got %u options, expected 50", (unsigned)cupsOptSetGetCount(set));
+    status ++;
+  }
+  else
+  {
+    testEndMessage(true, "%.3f seconds, %.1fx faster", optset_secs, parse_secs / optset_secs);
+  }
+
+  cupsOptSetDelete(set);
+
+  return (status);
+}
+
+
+//
+// 'preset_tests()' - Test compiled presets.
+//
+
+static int				// O - Number of failures
+preset_tests(void)
+{
+  int			status = 0;	// Number of failures
+  size_t		i,		// Looping var
+			num_options;	// Number of options
+  cups_option_t		*options;	// Options
+  ipp_preset_t		*preset;	// Compiled preset
+  ipp_t			*encoded,	// Request from cupsEncodeOptions
+			*applied,	// Request from ippPresetApply
+			*validate;	// Request for a different operation
+  ipp_t			*requests[1000];// Requests for benchmark
+  ipp_attribute_t	*eattr,		// Encoded attribute
+			*aattr;		// Applied attribute
+  char			evalue[1024],	// Encoded value
+			avalue[1024];	// Applied value
+  double		start,		// Start time
+			encode_secs,	// Time for cupsEncodeOptions
+			apply_secs;	// Time for ippPresetApply
+
+
+  num_options = cupsParseOptions("copies=2 sides=two-sided-long-edge media=na_letter_8.5x11in "
+                                 "media-col={media-size={x-dimension=21590 y-dimension=27940} media-source=tray-1 media-type=stationery} "
+                                 "page-ranges=1-5,7 print-quality=5 print-color-mode=monochrome "
+                                 "job-name=\"Quarterly Report\" finishings=4,5 printer-resolution=600dpi "
+                                 "x-vendor-option=value document-format=application/pdf", NULL, 0, &options);
+
+  // ippPresetCompile/Apply should produce the same attributes as
+  // cupsEncodeOptions...
+  testBegin("ippPresetApply");
+  preset = ippPresetCompile(IPP_OP_PRINT_JOB, IPP_TAG_JOB, num_options, options);
+
+  encoded  = ippNewRequest(IPP_OP_PRINT_JOB);
+  applied  = ippNewRequest(IPP_OP_PRINT_JOB);
+  validate = ippNewRequest(IPP_OP_VALIDATE_JOB);
+
+  cupsEncodeOptions(encoded, num_options, options, IPP_TAG_JOB);
+
+  if (!preset || !ippPresetApply(preset, applied))
+  {
+    testEndMessage(false, "unable to compile and apply preset");
+    status ++;
+  }
+  else if (ippPresetApply(preset, validate))
+  {
+    testEndMessage(false, "applied preset to the wrong operation");
+    status ++;
+  }
+  else
+  {
+    for (eattr = ippGetFirstAttribute(encoded), aattr = ippGetFirstAttribute(applied); eattr && aattr; eattr = ippGetNextAttribute(encoded), aattr = ippGetNextAttribute(applied))
+    {
+      ippAttributeString(eattr, evalue, sizeof(evalue));
+      ippAttributeString(aattr, avalue, sizeof(avalue));
+
+      if (strcmp(ippGetName(eattr), ippGetName(aattr)) || ippGetValueTag(eattr) != ippGetValueTag(aattr) || ippGetGroupTag(eattr) != ippGetGroupTag(aattr) || strcmp(evalue, avalue))
+        break;
+    }
+
+    if (eattr || aattr)
+    {
+      testEndMessage(false, "got %s=%s, expected %s=%s", aattr ? ippGetName(aattr) : "(null)", aattr ? avalue : "", eattr ? ippGetName(eattr) : "(null)", eattr ? evalue : "");
+      status ++;
+    }
+    else
+    {
+      testEnd(true);
+    }
+  }
+
+  ippDelete(encoded);
+  ippDelete(applied);
+  ippDelete(validate);
+
+  // Benchmark against cupsEncodeOptions...
+  memset(requests, 0, sizeof(requests));
+
+  testBegin("cupsEncodeOptions(%u options x 10000)", (unsigned)num_options);
+  start = cupsGetClock();
+
+  for (i = 0; i < 10000; i ++)
+  {
+    if (!requests[i % 1000])
+      requests[i % 1000] = ippNewRequest(IPP_OP_PRINT_JOB);
+
+    cupsEncodeOptions(requests[i % 1000], num_options, options, IPP_TAG_JOB);
+
+    if ((i % 1000) == 999)
+    {
+      size_t	j;			// Looping var
+
+      for (j = 0; j < 1000; j ++)
+      {
+        ippDelete(requests[j]);
+        requests[j] = NULL;
+      }
+    }
+  }
+
+  encode_secs = cupsGetClock() - start;
+  testEndMessage(true, "%.3f seconds", encode_secs);
+
+  testBegin("ippPresetApply(%u options x 10000)", (unsigned)num_options);
+  start = cupsGetClock();
+
+  for (i = 0; i < 10000; i ++)
+  {
+    if (!requests[i % 1000])
+      requests[i % 1000] = ippNewRequest(IPP_OP_PRINT_JOB);
+
+    if (!ippPresetApply(preset, requests[i % 1000]))
+      break;
+
+    if ((i % 1000) == 999)
+    {
+      size_t	j;			// Looping var
+
+      for (j = 0; j < 1000; j ++)
+      {
+        ippDelete(requests[j]);
+        requests[j] = NULL;
+      }
+    }
+  }
+
+  apply_secs = cupsGetClock() - start;
+
+  if (i < 10000)
+  {
+    testEndMessage(false, "ippPresetApply failed");
+    status ++;
+  }
+  else
+  {
+    testEndMessage(true, "%.3f seconds, %.1fx faster", apply_secs, encode_secs / apply_secs);
+  }
+
+  ippPresetDelete(preset);
+  cupsFreeOptions(num_options, options);
+
+  return (status);
+}
@@ -14,13 +14,32 @@
 #include <math.h>
 
 
+//
+// Local types...
+//
+
+typedef struct run_buffer_s		// Memory buffer for raster data
+{
+  unsigned char	*data;			// Raster data
+  size_t	used,			// Bytes used
+		size,			// Allocated size
+		pos;			// Current read position
+} run_buffer_t;
+
+
 //
 // Local functions...
 //
 
+static int	do_copy_tests(run_buffer_t *pwg, unsigned char *data, size_t bpp, size_t linelen);
 static int	do_ras_file(const char *filename);
 static int	do_raster_tests(cups_raster_mode_t mode);
+static int	do_run_tests(void);
+static int	do_seek_tests(void);
 static void	print_changes(cups_page_header_t *header, cups_page_header_t *expected);
+static unsigned	run_line(unsigned y);
+static ssize_t	run_read(void *ctx, unsigned char *buffer, size_t length);
+static ssize_t	run_write(void *ctx, unsigned char *buffer, size_t length);
 
 
 //
@@ -40,6 +59,7 @@ main(int  argc,				// I - Number of command-line args
     errors += do_raster_tests(CUPS_RASTER_WRITE_COMPRESSED);
     errors += do_raster_tests(CUPS_RASTER_WRITE_PWG);
     errors += do_raster_tests(CUPS_RASTER_WRITE_APPLE);
+    errors += do_run_tests();
   }
   else
   {
@@ -53,6 +73,101 @@ main(int  argc,				// I - Number of command-line args
 }
 
 
+//
+// 'do_copy_tests()' - Test copying a page to each raster format.
+//
+// The page is copied from a PWG raster stream containing the 1024 lines from
+// @code run_line@ and the copy is read back and compared.
+//
+
+static int				// O - Number of errors
+do_copy_tests(run_buffer_t  *pwg,	// I - PWG raster data
+              unsigned char *data,	// I - Raster lines (65 lines)
+              size_t        bpp,	// I - Bytes per pixel
+              size_t        linelen)	// I - Bytes per line
+{
+  int			mode;		// Output mode
+  unsigned		y;		// Current line
+  cups_raster_t		*in,		// Input stream
+			*out;		// Output stream
+  cups_page_header_t	header;		// Page header
+  run_buffer_t		copy;		// Copied raster data
+  unsigned char		*line = data + 64 * linelen;
+					// Line buffer
+  int			errors = 0;	// Number of errors
+  static const char * const modes[] =	// Output modes
+  {
+    "CUPS_RASTER_READ",
+    "CUPS_RASTER_WRITE",
+    "CUPS_RASTER_WRITE_COMPRESSED",
+    "CUPS_RASTER_WRITE_PWG",
+    "CUPS_RASTER_WRITE_APPLE"
+  };
+
+
+  for (mode = CUPS_RASTER_WRITE; mode <= CUPS_RASTER_WRITE_APPLE; mode ++)
+  {
+    testBegin("cupsRasterCopyPage(%u bytes per pixel runs, %s)", (unsigned)bpp, modes[mode]);
+
+    memset(&copy, 0, sizeof(copy));
+    pwg->pos = 0;
+
+    in  = cupsRasterOpenIO(run_read, pwg, CUPS_RASTER_READ);
+    out = cupsRasterOpenIO(run_write, &copy, (cups_raster_mode_t)mode);
+
+    if (!cupsRasterCopyPage(in, out))
+    {
+      testEndMessage(false, "%s", cupsRasterGetErrorString());
+      errors ++;
+    }
+    else if (cupsRasterCopyPage(in, out))
+    {
+      testEndMessage(false, "copied a second page");
+      errors ++;
+    }
+    else if (mode == CUPS_RASTER_WRITE_PWG && (copy.used != pwg->used || memcmp(copy.data, pwg->data, copy.used)))
+    {
+      testEndMessage(false, "PWG copy differs from original");
+      errors ++;
+    }
+    else
+    {
+      // Read the copy back...
+      cupsRasterClose(in);
+      in = cupsRasterOpenIO(run_read, &copy, CUPS_RASTER_READ);
+
+      if (!cupsRasterReadHeader(in, &header) || header.cupsBytesPerLine != linelen || header.cupsHeight != 1024)
+      {
+        testEndMessage(false, "bad page header");
+        errors ++;
+      }
+      else
+      {
+        for (y = 0; y < 1024; y ++)
+        {
+          if (!cupsRasterReadPixels(in, line, (unsigned)linelen) || memcmp(line, data + run_line(y) * linelen, linelen))
+            break;
+        }
+
+        if (y < 1024)
+        {
+          testEndMessage(false, "raster line %u corrupt", y);
+          errors ++;
+        }
+        else
+          testEnd(true);
+      }
+    }
+
+    cupsRasterClose(in);
+    cupsRasterClose(out);
+    free(copy.data);
+  }
+
+  return (errors);
+}
+
+
 //
 // 'do_ras_file()' - Test reading of a raster file.
 //
@@ -524,6 +639,311 @@ do_raster_tests(cups_raster_mode_t mode)// O - Write mode
   cupsRasterClose(r);
   fclose(fp);
 
+  // Test random page access...
+  errors += do_seek_tests();
+
+  return (errors);
+}
+
+
+//
+// 'do_run_tests()' - Test compression of repeated and literal pixel runs.
+//
+// Each pixel size is written using the SIMD, scalar, and threaded code paths,
+// which must produce identical results, and read back using both the SIMD and
+// scalar code paths.
+//
+
+static int				// O - Number of errors
+do_run_tests(void)
+{
+  size_t		i,		// Looping var
+			bpp,		// Bytes per pixel
+			linelen;	// Bytes per line
+  unsigned		x, y,		// Current position
+			count;		// Pixels in run
+  int			pass;		// Current pass
+  bool			repeat;		// Repeat pixels?
+  cups_raster_t		*r;		// Raster stream
+  cups_page_header_t	header;		// Page header
+  run_buffer_t		buffers[3];	// SIMD, scalar, and threaded output
+  unsigned char		*data,		// Raster data to write
+			*line,		// Current line
+			*pixel;		// Current pixel
+  int			errors = 0;	// Number of errors
+  static const unsigned	formats[][3] =	// Bits per color, colors, and color space
+  {
+    { 8, 1, CUPS_CSPACE_SW },
+    { 8, 3, CUPS_CSPACE_SRGB },
+    { 8, 4, CUPS_CSPACE_CMYK },
+    { 16, 1, CUPS_CSPACE_SW },
+    { 16, 3, CUPS_CSPACE_SRGB },
+    { 16, 4, CUPS_CSPACE_CMYK }
+  };
+
+
+  for (i = 0; i < (sizeof(formats) / sizeof(formats[0])); i ++)
+  {
+    bpp     = formats[i][0] * formats[i][1] / 8;
+    linelen = 1023 * bpp;
+
+    testBegin("cupsRasterWritePixels(%u bytes per pixel runs)", (unsigned)bpp);
+
+    if ((data = malloc(65 * linelen)) == NULL)
+    {
+      testEndMessage(false, "%s", strerror(errno));
+      return (errors + 1);
+    }
+
+    // Generate lines with runs of every length up to the 128 pixel limit,
+    // and runs that end exactly at the end of the line...
+    for (y = 0, line = data; y < 64; y ++, line += linelen)
+    {
+      for (x = 0, pixel = line; x < 1023;)
+      {
+        count  = (y & 1) ? (cupsGetRand() % 160) + 1 : (cupsGetRand() % 8) + 1;
+        repeat = (cupsGetRand() & 1) != 0;
+
+        if (x == 0 && y >= 60)
+          count = 1023;
+
+        for (; count > 0 && x < 1023; count --, x ++, pixel += bpp)
+        {
+          if (x == 0 || !repeat)
+          {
+            size_t j;			// Looping var
+
+            for (j = 0; j < bpp; j ++)
+              pixel[j] = (unsigned char)((y & 2) ? cupsGetRand() & 1 : cupsGetRand());
+          }
+          else
+            memcpy(pixel, pixel - bpp, bpp);
+        }
+      }
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.cupsWidth        = 1023;
+    header.cupsHeight       = 1024;
+    header.cupsBitsPerColor = formats[i][0];
+    header.cupsBitsPerPixel = (unsigned)(bpp * 8);
+    header.cupsBytesPerLine = (unsigned)linelen;
+    header.cupsColorOrder   = CUPS_ORDER_CHUNKED;
+    header.cupsColorSpace   = (cups_cspace_t)formats[i][2];
+    header.cupsNumColors    = formats[i][1];
+    header.HWResolution[0]  = 300;
+    header.HWResolution[1]  = 300;
+
+    // Write the lines with the SIMD, scalar, and threaded code, repeating
+    // lines in the second half of the page so that row repeats cross band
+    // boundaries...
+    memset(buffers, 0, sizeof(buffers));
+
+    for (pass = 0; pass < 3; pass ++)
+    {
+      if ((r = cupsRasterOpenIO(run_write, buffers + pass, CUPS_RASTER_WRITE_PWG)) == NULL)
+        break;
+
+      _cupsRasterSetScalar(r, pass == 1);
+
+      if (pass == 2 && !cupsRasterSetThreads(r, 4))
+      {
+        cupsRasterClose(r);
+        break;
+      }
+
+      cupsRasterWriteHeader(r, &header);
+      for (y = 0; y < 1024; y ++)
+        cupsRasterWritePixels(r, data + run_line(y) * linelen, (unsigned)linelen);
+
+      cupsRasterClose(r);
+    }
+
+    if (pass < 3)
+    {
+      testEndMessage(false, "%s", cupsRasterGetErrorString());
+      errors ++;
+    }
+    else if (!buffers[0].data || buffers[0].used != buffers[1].used || memcmp(buffers[0].data, buffers[1].data, buffers[0].used))
+    {
+      testEndMessage(false, "SIMD and scalar output differ");
+      errors ++;
+    }
+    else if (buffers[0].used != buffers[2].used || memcmp(buffers[0].data, buffers[2].data, buffers[0].used))
+    {
+      testEndMessage(false, "threaded and unthreaded output differ");
+      errors ++;
+    }
+    else
+    {
+      testEnd(true);
+
+      // Read them back with the SIMD and scalar code...
+      for (pass = 0; pass < 2; pass ++)
+      {
+        testBegin("cupsRasterReadPixels(%u bytes per pixel runs, %s)", (unsigned)bpp, pass ? "scalar" : "SIMD");
+
+        buffers[0].pos = 0;
+
+        if ((r = cupsRasterOpenIO(run_read, buffers, CUPS_RASTER_READ)) == NULL)
+        {
+          testEndMessage(false, "%s", cupsRasterGetErrorString());
+          errors ++;
+          continue;
+        }
+
+        _cupsRasterSetScalar(r, pass == 1);
+
+        if (!cupsRasterReadHeader(r, &header) || header.cupsBytesPerLine != linelen)
+        {
+          testEndMessage(false, "%s", cupsRasterGetErrorString());
+          errors ++;
+        }
+        else
+        {
+          pixel = data + 64 * linelen;
+
+          for (y = 0; y < 1024; y ++)
+          {
+            if (!cupsRasterReadPixels(r, pixel, (unsigned)linelen) || memcmp(pixel, data + run_line(y) * linelen, linelen))
+              break;
+          }
+
+          if (y < 1024)
+          {
+            testEndMessage(false, "raster line %u corrupt", y);
+            errors ++;
+          }
+          else
+            testEnd(true);
+        }
+
+        cupsRasterClose(r);
+      }
+
+      // Copy the page to the other formats...
+      errors += do_copy_tests(buffers, data, bpp, linelen);
+    }
+
+    free(buffers[0].data);
+    free(buffers[1].data);
+    free(buffers[2].data);
+    free(data);
+  }
+
+  return (errors);
+}
+
+
+//
+// 'do_seek_tests()' - Test random page access for the current test file.
+//
+// The file is opened twice, first building and saving the page index and then
+// loading the saved index.
+//
+
+static int				// O - Number of errors
+do_seek_tests(void)
+{
+  int			i;		// Looping var
+  unsigned		x, y;		// Looping vars
+  size_t		page;		// Current page
+  cups_raster_t		*r;		// Raster stream
+  cups_page_header_t	header;		// Page header
+  unsigned char		data[2048];	// Raster data
+  int			errors = 0;	// Number of errors
+  static const size_t	pages[] = { 4, 2, 3, 1 };
+					// Order of pages to read
+
+
+  unlink("test.rasterindex");
+
+  for (i = 0; i < 2; i ++)
+  {
+    testBegin("cupsRasterOpenFile(%s)", i ? "saved index" : "new index");
+
+    if ((r = cupsRasterOpenFile("test.raster", "test.rasterindex")) == NULL)
+    {
+      testEndMessage(false, "%s", cupsRasterGetErrorString());
+      return (errors + 1);
+    }
+
+    testEnd(true);
+
+    testBegin("cupsRasterGetPageCount");
+    if ((page = cupsRasterGetPageCount(r)) == 4)
+    {
+      testEnd(true);
+    }
+    else
+    {
+      testEndMessage(false, "got %u, expected 4", (unsigned)page);
+      errors ++;
+    }
+
+    for (page = 0; page < (sizeof(pages) / sizeof(pages[0])); page ++)
+    {
+      testBegin("cupsRasterSeekPage(%u)", (unsigned)pages[page]);
+
+      if (!cupsRasterSeekPage(r, pages[page]))
+      {
+        testEnd(false);
+        errors ++;
+        continue;
+      }
+      else if (!cupsRasterReadHeader(r, &header))
+      {
+        testEndMessage(false, "%s", cupsRasterGetErrorString());
+        errors ++;
+        continue;
+      }
+      else if (header.cupsBitsPerPixel != (((pages[page] - 1) & 2) ? 16 : 8) * (((pages[page] - 1) & 1) ? 4 : 1))
+      {
+        testEndMessage(false, "got %u bits per pixel", header.cupsBitsPerPixel);
+        errors ++;
+        continue;
+      }
+
+      // Skip the blank lines and check the first line of the ramp...
+      for (y = 0; y < 65; y ++)
+      {
+        if (!cupsRasterReadPixels(r, data, header.cupsBytesPerLine))
+          break;
+      }
+
+      for (x = 0; x < header.cupsBytesPerLine; x ++)
+      {
+        if (data[x] != (x & 255))
+          break;
+      }
+
+      if (y < 65 || x < header.cupsBytesPerLine)
+      {
+        testEndMessage(false, "raster line 64 corrupt");
+        errors ++;
+      }
+      else
+      {
+        testEnd(true);
+      }
+    }
+
+    testBegin("cupsRasterSeekPage(5)");
+    if (cupsRasterSeekPage(r, 5))
+    {
+      testEndMessage(false, "expected failure");
+      errors ++;
+    }
+    else
+    {
+      testEnd(true);
+    }
+
+    cupsRasterClose(r);
+  }
+
+  unlink("test.rasterindex");
+
   return (errors);
 }
 
@@ -697,3 +1117,70 @@ print_changes(
   if (strcmp(header->cupsPageSizeName, expected->cupsPageSizeName))
     testMessage("    cupsPageSizeName (%s), expected (%s)", header->cupsPageSizeName, expected->cupsPageSizeName);
 }
+
+
+//
+// 'run_line()' - Return the source line to use for a row.
+//
+
+static unsigned				// O - Source line (0 to 63)
+run_line(unsigned y)			// I - Row
+{
+  return (y < 512 ? y & 63 : (y / 24) & 63);
+}
+
+
+//
+// 'run_read()' - Read raster data from a memory buffer.
+//
+
+static ssize_t				// O - Number of bytes read
+run_read(void          *ctx,		// I - Memory buffer
+         unsigned char *buffer,		// I - Read buffer
+         size_t        length)		// I - Size of read buffer
+{
+  run_buffer_t	*rb = (run_buffer_t *)ctx;
+					// Memory buffer
+
+
+  if (length > (rb->used - rb->pos))
+    length = rb->used - rb->pos;
+
+  memcpy(buffer, rb->data + rb->pos, length);
+  rb->pos += length;
+
+  return ((ssize_t)length);
+}
+
+
+//
+// 'run_write()' - Write raster data to a memory buffer.
+//
+
+static ssize_t				// O - Number of bytes written
+run_write(void          *ctx,		// I - Memory buffer
+          unsigned char *buffer,	// I - Bytes to write
+          size_t        length)		// I - Number of bytes
+{
+  run_buffer_t	*rb = (run_buffer_t *)ctx;
+					// Memory buffer
+
+
+  if ((rb->used + length) > rb->size)
+  {
+    size_t		size = 2 * (rb->used + length);
+					// New size
+    unsigned char	*data;		// New buffer
+
+    if ((data = realloc(rb->data, size)) == NULL)
+      return (-1);
+
+    rb->data = data;
+    rb->size = size;
+  }
+
+  memcpy(rb->data + rb->used, buffer, length);
+  rb->used += length;
+
+  return ((ssize_t)length);
+}
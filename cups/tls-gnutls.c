@@ -1655,6 +1655,8 @@ _httpTLSStart(http_t *http)		// I - Connection to server
   double		old_timeout;	// Old timeout value
   http_timeout_cb_t	old_cb;		// Old timeout callback
   void			*old_data;	// Old timeout data
+  double		start = http->stats ? cupsGetClock() : 0.0;
+					// Start time for statistics
   _cups_globals_t	*cg = _cupsGlobals();
 					// Per-thread globals
   static const char * const versions[] =// SSL/TLS versions
@@ -1967,6 +1969,9 @@ _httpTLSStart(http_t *http)		// I - Connection to server
 
   http->tls_credentials = credentials;
 
+  if (http->stats)
+    _httpAddLatency(http, HTTP_LATENCY_TLS, start);
+
   return (true);
 }
 
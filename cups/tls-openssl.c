@@ -1729,6 +1729,8 @@ _httpTLSStart(http_t *http)		// I - Connection to server
 		cipherlist[256];	// List of cipher suites
   unsigned long	error;			// Error code, if any
   _cups_globals_t *cg = _cupsGlobals();	// Per-thread globals
+  double	start = http->stats ? cupsGetClock() : 0.0;
+					// Start time for statistics
   static const uint16_t versions[] =	// SSL/TLS versions
   {
     TLS1_VERSION,			// No more SSL support in OpenSSL
@@ -2008,6 +2010,9 @@ _httpTLSStart(http_t *http)		// I - Connection to server
 
   DEBUG_puts("4_httpTLSStart: Returning true.");
 
+  if (http->stats)
+    _httpAddLatency(http, HTTP_LATENCY_TLS, start);
+
   return (true);
 }
 
@@ -73,6 +73,10 @@ typedef struct _cups_client_conf_s	// client.conf config data
 			any_root,	// Allow any (e.g., self-signed) root
 			expired_certs,	// Allow expired certs
 			validate_certs;	// Validate certificates
+  int			resolver_size,	// ResolverCacheSize value
+			resolver_ttl,	// ResolverCacheTTL value
+			resolver_negative_ttl;
+					// ResolverCacheNegativeTTL value
   http_encryption_t	encryption;	// Encryption setting
   char			user[65],	// User name
 			server_name[256],
@@ -104,6 +108,7 @@ static void	cups_set_digestoptions(_cups_client_conf_t *cc, const char *value);
 static void	cups_set_encryption(_cups_client_conf_t *cc, const char *value);
 static void	cups_set_filter_location(_cups_client_conf_t *cc, const char *value);
 static void	cups_set_filter_type(_cups_client_conf_t *cc, const char *value);
+static void	cups_set_integer(int *ivalue, const char *value);
 static void	cups_set_server_name(_cups_client_conf_t *cc, const char *value);
 static void	cups_set_ssl_options(_cups_client_conf_t *cc, const char *value);
 static void	cups_set_uatokens(_cups_client_conf_t *cc, const char *value);
@@ -1122,7 +1127,12 @@ _cupsSetDefaults(void)
   DEBUG_printf("1_cupsSetDefaults: UserAgentTokens %s", uatokens[cg->uatokens]);
   DEBUG_printf("1_cupsSetDefaults: ValidateCerts %s", cg->validate_certs ? "Yes" : "No");
 
+  DEBUG_printf("1_cupsSetDefaults: ResolverCacheSize %d", cc.resolver_size);
+  DEBUG_printf("1_cupsSetDefaults: ResolverCacheTTL %d", cc.resolver_ttl);
+  DEBUG_printf("1_cupsSetDefaults: ResolverCacheNegativeTTL %d", cc.resolver_negative_ttl);
+
   _httpTLSSetOptions(cc.ssl_options | _HTTP_TLS_SET_DEFAULT, cc.ssl_min_version, cc.ssl_max_version);
+  _httpAddrSetCacheOptions(cc.resolver_size, cc.resolver_ttl, cc.resolver_negative_ttl);
 
   cg->client_conf_loaded = true;
 }
@@ -1244,6 +1254,15 @@ cups_finalize_client_conf(
   if (cc->expired_certs < 0)
     cc->expired_certs = 0;
 
+  if (cc->resolver_size < 0)
+    cc->resolver_size = 256;
+
+  if (cc->resolver_ttl < 0)
+    cc->resolver_ttl = 60;
+
+  if (cc->resolver_negative_ttl < 0)
+    cc->resolver_negative_ttl = 10;
+
 #ifdef HAVE_DBUS
   if (!cc->server_name[0])
   {
@@ -1389,6 +1408,10 @@ cups_init_client_conf(
   cc->expired_certs   = -1;
   cc->validate_certs  = -1;
 
+  cc->resolver_size         = -1;
+  cc->resolver_ttl          = -1;
+  cc->resolver_negative_ttl = -1;
+
 #if defined(__APPLE__)
   // Load settings from the org.cups.PrintingPrefs plist (which trump everything...)
   char	sval[1024];			// String value
@@ -1468,6 +1491,12 @@ cups_read_client_conf(
       cups_set_filter_location(cc, value);
     else if (!_cups_strcasecmp(line, "FilterType"))
       cups_set_filter_type(cc, value);
+    else if (!_cups_strcasecmp(line, "ResolverCacheNegativeTTL") && value)
+      cups_set_integer(&cc->resolver_negative_ttl, value);
+    else if (!_cups_strcasecmp(line, "ResolverCacheSize") && value)
+      cups_set_integer(&cc->resolver_size, value);
+    else if (!_cups_strcasecmp(line, "ResolverCacheTTL") && value)
+      cups_set_integer(&cc->resolver_ttl, value);
 #ifndef __APPLE__
     // The ServerName directive is not supported on macOS due to app
     // sandboxing restrictions, i.e. not all apps request network access.
@@ -1602,6 +1631,27 @@ cups_set_filter_type(
 }
 
 
+//
+// 'cups_set_integer()' - Set a non-negative integer value.
+//
+
+static void
+cups_set_integer(int        *ivalue,	// O - Integer value
+                 const char *value)	// I - String value
+{
+  long	lvalue;				// Value
+  char	*end;				// End of value
+
+
+  lvalue = strtol(value, &end, 10);
+
+  if (end > value && !*end && lvalue >= 0 && lvalue <= INT_MAX)
+    *ivalue = (int)lvalue;
+  else
+    DEBUG_printf("4cups_set_integer: Bad integer value '%s'.", value);
+}
+
+
 //
 // 'cups_set_server_name()' - Set the ServerName value.
 //
@@ -21,6 +21,7 @@
 
 #include <limits.h>
 #include <sys/stat.h>
+#include <zlib.h>
 
 #ifdef _WIN32
 #  include <fcntl.h>
@@ -149,6 +150,19 @@ typedef struct ippeve_filter_s		// Attribute filter
 
 typedef struct ippeve_job_s ippeve_job_t;
 
+typedef struct ippeve_resource_s	// Cached web resource
+{
+  char			*uri;		// Resource path
+  const char		*type;		// MIME media type
+  char			etag[64];	// ETag value
+  time_t		mtime;		// Last-Modified time
+  char			*data,		// Raw data
+			*gzdata;	// gzip-encoded data, if smaller
+  size_t		datalen,	// Length of raw data
+			gzdatalen;	// Length of gzip-encoded data
+  int			refcount;	// Reference count
+} ippeve_resource_t;
+
 typedef struct ippeve_printer_s		// Printer data
 {
   // Note: A "real" IPP implementation will support more than one IPv4 and one IPv6 listener
@@ -180,6 +194,8 @@ typedef struct ippeve_printer_s		// Printer data
   ippeve_job_t		*active_job;	// Current active/pending job
   int			next_job_id;	// Next job-id value
   cups_rwlock_t		rwlock;		// Printer lock
+  cups_array_t		*resources;	// Cached web resources
+  cups_mutex_t		resources_mutex;// Mutex for cached web resources
 } ippeve_printer_t;
 
 struct ippeve_job_s			// Job data
@@ -222,6 +238,10 @@ typedef struct ippeve_client_s		// Client data
 					// Authenticated username, if any
   ippeve_printer_t	*printer;	// Printer
   ippeve_job_t		*job;		// Current job, if any
+  bool			html_cache;	// Capture HTML for the resource cache?
+  char			*html;		// Captured HTML
+  size_t		htmllen,	// Length of captured HTML
+			htmlsize;	// Size of capture buffer
 } ippeve_client_t;
 
 
@@ -229,9 +249,11 @@ typedef struct ippeve_client_s		// Client data
 // Local functions...
 //
 
+static ippeve_resource_t *add_resource(ippeve_printer_t *printer, const char *uri, const char *type, const char *etag, time_t mtime, char *data, size_t datalen);
 static http_status_t	authenticate_request(ippeve_client_t *client);
 static void		clean_jobs(ippeve_printer_t *printer);
 static int		compare_jobs(ippeve_job_t *a, ippeve_job_t *b);
+static int		compare_resources(ippeve_resource_t *a, ippeve_resource_t *b);
 static void		copy_attributes(ipp_t *to, ipp_t *from, cups_array_t *ra, ipp_tag_t group_tag, bool quickcopy);
 static void		copy_job_attributes(ippeve_client_t *client, ippeve_job_t *job, cups_array_t *ra);
 static ippeve_client_t	*create_client(ippeve_printer_t *printer, int sock);
@@ -246,17 +268,21 @@ static void		debug_attributes(const char *title, ipp_t *ipp, int response);
 static void		delete_client(ippeve_client_t *client);
 static void		delete_job(ippeve_job_t *job);
 static void		delete_printer(ippeve_printer_t *printer);
+static void		delete_resource(ippeve_resource_t *resource);
 static void		dnssd_callback(cups_dnssd_service_t *service, ippeve_printer_t *printer, cups_dnssd_flags_t flags);
 static int		filter_cb(ippeve_filter_t *filter, ipp_t *dst, ipp_attribute_t *attr);
 static ippeve_job_t	*find_job(ippeve_client_t *client);
+static ippeve_resource_t *find_resource(ippeve_printer_t *printer, const char *uri);
 static void		finish_document_data(ippeve_client_t *client, ippeve_job_t *job);
 static void		finish_document_uri(ippeve_client_t *client, ippeve_job_t *job);
 static void		flush_document_data(ippeve_client_t *client);
 static bool		have_document_data(ippeve_client_t *client);
 static bool		html_escape(ippeve_client_t *client, const char *s, size_t slen);
+static int		html_finish(ippeve_client_t *client, const char *etag);
 static bool		html_footer(ippeve_client_t *client);
 static bool		html_header(ippeve_client_t *client, const char *title, int refresh);
 static bool		html_printf(ippeve_client_t *client, const char *format, ...) _CUPS_FORMAT(2, 3);
+static bool		html_write(ippeve_client_t *client, const char *s, size_t slen);
 static void		ipp_cancel_job(ippeve_client_t *client);
 static void		ipp_cancel_my_jobs(ippeve_client_t *client);
 static void		ipp_close_job(ippeve_client_t *client);
@@ -283,11 +309,15 @@ static int		process_ipp(ippeve_client_t *client);
 static void		*process_job(ippeve_job_t *job);
 static void		process_state_message(ippeve_job_t *job, char *message);
 static bool		register_printer(ippeve_printer_t *printer);
+static void		release_resource(ippeve_printer_t *printer, ippeve_resource_t *resource);
+static int		respond_cached(ippeve_client_t *client, const char *etag);
 static bool		respond_http(ippeve_client_t *client, http_status_t code, const char *content_coding, const char *type, size_t length);
 static void		respond_ignored(ippeve_client_t *client, ipp_attribute_t *attr);
 static void		respond_ipp(ippeve_client_t *client, ipp_status_t status, const char *message, ...) _CUPS_FORMAT(3, 4);
+static int		respond_resource(ippeve_client_t *client, ippeve_resource_t *resource);
 static void		respond_unsupported(ippeve_client_t *client, ipp_attribute_t *attr);
 static void		run_printer(ippeve_printer_t *printer);
+static int		show_file(ippeve_client_t *client, const char *filename, const char *type, const unsigned char *builtin, size_t builtinlen);
 static int		show_media(ippeve_client_t *client);
 static int		show_status(ippeve_client_t *client);
 static int		show_supplies(ippeve_client_t *client);
@@ -699,6 +729,104 @@ main(int  argc,				// I - Number of command-line args
 }
 
 
+//
+// 'add_resource()' - Add a resource to the web cache.
+//
+// The resource takes ownership of "data" and replaces any existing resource
+// with the same path.  The returned resource is referenced and must be released
+// with @link release_resource@.
+//
+
+static ippeve_resource_t *		// O - Resource or `NULL` on error
+add_resource(ippeve_printer_t *printer,	// I - Printer
+             const char       *uri,	// I - Resource path
+             const char       *type,	// I - MIME media type
+             const char       *etag,	// I - ETag value or `NULL` to compute one
+             time_t           mtime,	// I - Last modification time
+             char             *data,	// I - Data
+             size_t           datalen)	// I - Length of data
+{
+  ippeve_resource_t	*resource,	// New resource
+			*old;		// Existing resource
+  z_stream		stream;		// Compression stream
+  size_t		gzsize;		// Size of compression buffer
+
+
+  // Allocate the resource...
+  if ((resource = calloc(1, sizeof(ippeve_resource_t))) == NULL)
+  {
+    free(data);
+    return (NULL);
+  }
+
+  if ((resource->uri = strdup(uri)) == NULL)
+  {
+    free(resource);
+    free(data);
+    return (NULL);
+  }
+
+  resource->type     = type;
+  resource->mtime    = mtime;
+  resource->data     = data;
+  resource->datalen  = datalen;
+  resource->refcount = 2;		// One for the cache, one for the caller
+
+  if (etag)
+    cupsCopyString(resource->etag, etag, sizeof(resource->etag));
+  else
+    snprintf(resource->etag, sizeof(resource->etag), "\"%08lx-%lx\"", (unsigned long)crc32(0, (const Bytef *)data, (uInt)datalen), (unsigned long)datalen);
+
+  // Compress the data once, keeping the result only if it is smaller...
+  memset(&stream, 0, sizeof(stream));
+
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+  {
+    gzsize = deflateBound(&stream, (uLong)datalen);
+
+    if ((resource->gzdata = malloc(gzsize)) != NULL)
+    {
+      stream.next_in   = (Bytef *)data;
+      stream.avail_in  = (uInt)datalen;
+      stream.next_out  = (Bytef *)resource->gzdata;
+      stream.avail_out = (uInt)gzsize;
+
+      if (deflate(&stream, Z_FINISH) == Z_STREAM_END && stream.total_out < datalen)
+      {
+        resource->gzdatalen = (size_t)stream.total_out;
+      }
+      else
+      {
+        free(resource->gzdata);
+        resource->gzdata = NULL;
+      }
+    }
+
+    deflateEnd(&stream);
+  }
+
+  // Add it to the cache...
+  cupsMutexLock(&printer->resources_mutex);
+
+  if ((old = (ippeve_resource_t *)cupsArrayFind(printer->resources, resource)) != NULL)
+  {
+    cupsArrayRemove(printer->resources, old);
+
+    if (-- old->refcount > 0)
+      old = NULL;
+  }
+
+  cupsArrayAdd(printer->resources, resource);
+
+  cupsMutexUnlock(&printer->resources_mutex);
+
+  if (old)
+    delete_resource(old);
+
+  return (resource);
+}
+
+
 //
 // 'authenticate_request()' - Try to authenticate the request.
 //
@@ -834,6 +962,19 @@ compare_jobs(ippeve_job_t *a,		// I - First job
 }
 
 
+//
+// 'compare_resources()' - Compare two cached web resources.
+//
+
+static int				// O - Result of comparison
+compare_resources(
+    ippeve_resource_t *a,		// I - First resource
+    ippeve_resource_t *b)		// I - Second resource
+{
+  return (strcmp(a->uri, b->uri));
+}
+
+
 //
 // 'copy_attributes()' - Copy attributes from one request to another.
 //
@@ -1625,6 +1766,9 @@ create_printer(
 
   cupsRWInit(&(printer->rwlock));
 
+  printer->resources = cupsArrayNew((cups_array_cb_t)compare_resources, NULL, NULL, 0, NULL, NULL);
+  cupsMutexInit(&(printer->resources_mutex));
+
   // Create the listener sockets...
   if (printer->port)
   {
@@ -1969,6 +2113,7 @@ delete_client(ippeve_client_t *client)	// I - Client
   ippDelete(client->request);
   ippDelete(client->response);
 
+  free(client->html);
   free(client);
 }
 
@@ -2029,10 +2174,36 @@ delete_printer(
   ippDelete(printer->attrs);
   cupsArrayDelete(printer->jobs);
 
+  if (printer->resources)
+  {
+    ippeve_resource_t	*resource;	// Current resource
+
+    for (resource = (ippeve_resource_t *)cupsArrayGetFirst(printer->resources); resource; resource = (ippeve_resource_t *)cupsArrayGetNext(printer->resources))
+      delete_resource(resource);
+
+    cupsArrayDelete(printer->resources);
+    cupsMutexDestroy(&(printer->resources_mutex));
+  }
+
   free(printer);
 }
 
 
+//
+// 'delete_resource()' - Free memory used by a cached web resource.
+//
+
+static void
+delete_resource(
+    ippeve_resource_t *resource)	// I - Resource
+{
+  free(resource->uri);
+  free(resource->data);
+  free(resource->gzdata);
+  free(resource);
+}
+
+
 //
 // 'dnssd_callback()' - Handle DNS-SD registration events.
 //
@@ -2112,6 +2283,34 @@ find_job(ippeve_client_t *client)		// I - Client
 }
 
 
+//
+// 'find_resource()' - Find a resource in the web cache.
+//
+// The returned resource is referenced and must be released with
+// @link release_resource@.
+//
+
+static ippeve_resource_t *		// O - Resource or `NULL` if not cached
+find_resource(ippeve_printer_t *printer,// I - Printer
+              const char       *uri)	// I - Resource path
+{
+  ippeve_resource_t	key,		// Search key
+			*resource;	// Matching resource
+
+
+  key.uri = (char *)uri;
+
+  cupsMutexLock(&printer->resources_mutex);
+
+  if ((resource = (ippeve_resource_t *)cupsArrayFind(printer->resources, &key)) != NULL)
+    resource->refcount ++;
+
+  cupsMutexUnlock(&printer->resources_mutex);
+
+  return (resource);
+}
+
+
 //
 // 'finish_document()' - Finish receiving a document file and start processing.
 //
@@ -2537,16 +2736,16 @@ html_escape(ippeve_client_t *client,	// I - Client
     {
       if (s > start)
       {
-        if (httpWrite(client->http, start, (size_t)(s - start)) < 0)
+        if (!html_write(client, start, (size_t)(s - start)))
           return (false);
       }
 
       if (*s == '&')
       {
-        if (httpWrite(client->http, "&amp;", 5) < 0)
+        if (!html_write(client, "&amp;", 5))
           return (false);
       }
-      else if (httpWrite(client->http, "&lt;", 4) < 0)
+      else if (!html_write(client, "&lt;", 4))
         return (false);
 
       start = s + 1;
@@ -2557,7 +2756,7 @@ html_escape(ippeve_client_t *client,	// I - Client
 
   if (s > start)
   {
-    if (httpWrite(client->http, start, (size_t)(s - start)) < 0)
+    if (!html_write(client, start, (size_t)(s - start)))
       return (false);
   }
 
@@ -2565,6 +2764,44 @@ html_escape(ippeve_client_t *client,	// I - Client
 }
 
 
+//
+// 'html_finish()' - Finish a web interface page.
+//
+// When the page was captured for the web cache, this function adds it to the
+// cache and sends it to the client.
+//
+
+static int				// O - 1 on success, 0 on failure
+html_finish(ippeve_client_t *client,	// I - Client
+            const char      *etag)	// I - ETag value
+{
+  ippeve_resource_t	*resource;	// Cached page
+  int			ret;		// Return value
+
+
+  html_footer(client);
+
+  if (!client->html_cache)
+    return (1);
+
+  resource = add_resource(client->printer, client->uri, "text/html", etag, time(NULL), client->html, client->htmllen);
+
+  client->html_cache = false;
+  client->html       = NULL;
+  client->htmllen    = 0;
+  client->htmlsize   = 0;
+
+  if (!resource)
+    return (0);
+
+  ret = respond_resource(client, resource);
+
+  release_resource(client->printer, resource);
+
+  return (ret);
+}
+
+
 //
 // 'html_footer()' - Show the web interface footer.
 //
@@ -2580,6 +2817,9 @@ html_footer(ippeve_client_t *client)	// I - Client
 		   "</html>\n"))
     return (false);
 
+  if (client->html_cache)
+    return (true);
+
   return (httpWrite(client->http, "", 0) >= 0);
 }
 
@@ -2674,7 +2914,7 @@ html_printf(ippeve_client_t *client,	// I - Client
     {
       if (format > start)
       {
-        if (httpWrite(client->http, start, (size_t)(format - start)) < 0)
+        if (!html_write(client, start, (size_t)(format - start)))
 	  goto error;
       }
 
@@ -2683,7 +2923,7 @@ html_printf(ippeve_client_t *client,	// I - Client
 
       if (*format == '%')
       {
-        if (httpWrite(client->http, "%", 1) < 0)
+        if (!html_write(client, "%", 1))
 	  goto error;
 
         format ++;
@@ -2792,7 +3032,7 @@ html_printf(ippeve_client_t *client,	// I - Client
 
 	    snprintf(temp, sizeof(temp), tformat, va_arg(ap, double));
 
-            if (httpWrite(client->http, temp, strlen(temp)) < 0)
+            if (!html_write(client, temp, strlen(temp)))
 	      goto error;
 	    break;
 
@@ -2817,7 +3057,7 @@ html_printf(ippeve_client_t *client,	// I - Client
 	    else
 	      snprintf(temp, sizeof(temp), tformat, va_arg(ap, int));
 
-            if (httpWrite(client->http, temp, strlen(temp)) < 0)
+            if (!html_write(client, temp, strlen(temp)))
 	      goto error;
 	    break;
 
@@ -2827,7 +3067,7 @@ html_printf(ippeve_client_t *client,	// I - Client
 
 	    snprintf(temp, sizeof(temp), tformat, va_arg(ap, void *));
 
-            if (httpWrite(client->http, temp, strlen(temp)) < 0)
+            if (!html_write(client, temp, strlen(temp)))
 	      goto error;
 	    break;
 
@@ -2856,7 +3096,7 @@ html_printf(ippeve_client_t *client,	// I - Client
 
   if (format > start)
   {
-    if (httpWrite(client->http, start, (size_t)(format - start)) < 0)
+    if (!html_write(client, start, (size_t)(format - start)))
       goto error;
   }
 
@@ -2870,6 +3110,43 @@ html_printf(ippeve_client_t *client,	// I - Client
 }
 
 
+//
+// 'html_write()' - Write HTML to the client or the capture buffer.
+//
+
+static bool				// O - `true` on success, `false` on error
+html_write(ippeve_client_t *client,	// I - Client
+           const char      *s,		// I - String to write
+           size_t          slen)	// I - Number of bytes to write
+{
+  if (client->html_cache)
+  {
+    // Append to the capture buffer...
+    if ((client->htmllen + slen) > client->htmlsize)
+    {
+      char	*html;			// New buffer
+      size_t	htmlsize;		// New size
+
+      for (htmlsize = client->htmlsize ? client->htmlsize : 16384; htmlsize < (client->htmllen + slen); htmlsize *= 2)
+        ;
+
+      if ((html = realloc(client->html, htmlsize)) == NULL)
+        return (false);
+
+      client->html     = html;
+      client->htmlsize = htmlsize;
+    }
+
+    memcpy(client->html + client->htmllen, s, slen);
+    client->htmllen += slen;
+
+    return (true);
+  }
+
+  return (httpWrite(client->http, s, slen) >= 0);
+}
+
+
 //
 // 'ipp_cancel_job()' - Cancel a job.
 //
@@ -3103,6 +3380,7 @@ ipp_get_jobs(ippeve_client_t *client)	// I - Client
 			count;		// Number of jobs that match
   const char		*username;	// Username
   ippeve_job_t		*job;		// Current job pointer
+  cups_array_iter_t	iter;		// Job iterator
   cups_array_t		*ra;		// Requested attributes array
 
 
@@ -3213,14 +3491,15 @@ ipp_get_jobs(ippeve_client_t *client)	// I - Client
     }
   }
 
-  // OK, build a list of jobs for this printer...
+  // OK, build a list of jobs for this printer; use an iterator since other
+  // threads can be reading the jobs array at the same time...
   ra = ippCreateRequestedArray(client->request);
 
   respond_ipp(client, IPP_STATUS_OK, NULL);
 
   cupsRWLockRead(&(client->printer->rwlock));
 
-  for (count = 0, job = (ippeve_job_t *)cupsArrayGetFirst(client->printer->jobs); (limit <= 0 || count < limit) && job; job = (ippeve_job_t *)cupsArrayGetNext(client->printer->jobs))
+  for (count = 0, job = (ippeve_job_t *)cupsArrayIterFirst(client->printer->jobs, &iter); (limit <= 0 || count < limit) && job; job = (ippeve_job_t *)cupsArrayIterNext(&iter))
   {
     // Filter out jobs that don't match...
     if ((job_comparison < 0 && job->state > job_state) ||
@@ -4932,170 +5211,22 @@ process_http(ippeve_client_t *client)	// I - Client connection
         if (!strcmp(client->uri, "/en.strings"))
 	{
 	  // Send strings file.
-          if (client->printer->strings)
-          {
-	    int		fd;		// Icon file
-	    struct stat	fileinfo;	// Icon file information
-	    char	buffer[4096];	// Copy buffer
-	    ssize_t	bytes;		// Bytes
-
-	    if ((fd = open(client->printer->strings, O_RDONLY | O_BINARY)) >= 0)
-	    {
-	      if (fstat(fd, &fileinfo))
-	      {
-		close(fd);
-		return (0);
-	      }
-	      else if (!respond_http(client, HTTP_STATUS_OK, NULL, "text/strings", (size_t)fileinfo.st_size))
-	      {
-		close(fd);
-		return (0);
-	      }
-
-	      while ((bytes = read(fd, buffer, sizeof(buffer))) > 0)
-		httpWrite(client->http, buffer, (size_t)bytes);
-
-	      httpFlushWrite(client->http);
-
-	      close(fd);
-	    }
-	    else
-	      return (respond_http(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0));
-	  }
-	  else
-	    return (respond_http(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0));
+	  return (show_file(client, client->printer->strings, "text/strings", NULL, 0));
         }
         else if (!strcmp(client->uri, "/icon.png"))
 	{
 	  // Send medium PNG icon file.
-          if (client->printer->icons[1])
-          {
-	    int		fd;		// Icon file
-	    struct stat	fileinfo;	// Icon file information
-	    char	buffer[4096];	// Copy buffer
-	    ssize_t	bytes;		// Bytes
-
-	    if ((fd = open(client->printer->icons[1], O_RDONLY | O_BINARY)) >= 0)
-	    {
-	      if (fstat(fd, &fileinfo))
-	      {
-		close(fd);
-		return (0);
-	      }
-	      else if (!respond_http(client, HTTP_STATUS_OK, NULL, "image/png", (size_t)fileinfo.st_size))
-	      {
-		close(fd);
-		return (0);
-	      }
-
-	      while ((bytes = read(fd, buffer, sizeof(buffer))) > 0)
-		httpWrite(client->http, buffer, (size_t)bytes);
-
-	      httpFlushWrite(client->http);
-
-	      close(fd);
-	    }
-	    else
-	      return (respond_http(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0));
-	  }
-	  else
-	  {
-	    fputs("Icon file is internal printer.png.\n", stderr);
-
-	    if (!respond_http(client, HTTP_STATUS_OK, NULL, "image/png", sizeof(printer_png)))
-	      return (0);
-
-            httpWrite(client->http, (const char *)printer_png, sizeof(printer_png));
-	    httpFlushWrite(client->http);
-	  }
+	  return (show_file(client, client->printer->icons[1], "image/png", printer_png, sizeof(printer_png)));
 	}
         else if (!strcmp(client->uri, "/icon-lg.png"))
 	{
 	  // Send large PNG icon file.
-          if (client->printer->icons[2])
-          {
-	    int		fd;		// Icon file
-	    struct stat	fileinfo;	// Icon file information
-	    char	buffer[4096];	// Copy buffer
-	    ssize_t	bytes;		// Bytes
-
-	    if ((fd = open(client->printer->icons[2], O_RDONLY | O_BINARY)) >= 0)
-	    {
-	      if (fstat(fd, &fileinfo))
-	      {
-		close(fd);
-		return (0);
-	      }
-	      else if (!respond_http(client, HTTP_STATUS_OK, NULL, "image/png", (size_t)fileinfo.st_size))
-	      {
-		close(fd);
-		return (0);
-	      }
-
-	      while ((bytes = read(fd, buffer, sizeof(buffer))) > 0)
-		httpWrite(client->http, buffer, (size_t)bytes);
-
-	      httpFlushWrite(client->http);
-
-	      close(fd);
-	    }
-	    else
-	      return (respond_http(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0));
-	  }
-	  else
-	  {
-	    fputs("Icon file is internal printer-lg.png.\n", stderr);
-
-	    if (!respond_http(client, HTTP_STATUS_OK, NULL, "image/png", sizeof(printer_lg_png)))
-	      return (0);
-
-            httpWrite(client->http, (const char *)printer_lg_png, sizeof(printer_lg_png));
-	    httpFlushWrite(client->http);
-	  }
+	  return (show_file(client, client->printer->icons[2], "image/png", printer_lg_png, sizeof(printer_lg_png)));
 	}
         else if (!strcmp(client->uri, "/icon-sm.png"))
 	{
 	  // Send small PNG icon file.
-          if (client->printer->icons[0])
-          {
-	    int		fd;		// Icon file
-	    struct stat	fileinfo;	// Icon file information
-	    char	buffer[4096];	// Copy buffer
-	    ssize_t	bytes;		// Bytes
-
-	    if ((fd = open(client->printer->icons[0], O_RDONLY | O_BINARY)) >= 0)
-	    {
-	      if (fstat(fd, &fileinfo))
-	      {
-		close(fd);
-		return (0);
-	      }
-	      else if (!respond_http(client, HTTP_STATUS_OK, NULL, "image/png", (size_t)fileinfo.st_size))
-	      {
-		close(fd);
-		return (0);
-	      }
-
-	      while ((bytes = read(fd, buffer, sizeof(buffer))) > 0)
-		httpWrite(client->http, buffer, (size_t)bytes);
-
-	      httpFlushWrite(client->http);
-
-	      close(fd);
-	    }
-	    else
-	      return (respond_http(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0));
-	  }
-	  else
-	  {
-	    fputs("Icon file is internal printer-sm.png.\n", stderr);
-
-	    if (!respond_http(client, HTTP_STATUS_OK, NULL, "image/png", sizeof(printer_sm_png)))
-	      return (0);
-
-            httpWrite(client->http, (const char *)printer_sm_png, sizeof(printer_sm_png));
-	    httpFlushWrite(client->http);
-	  }
+	  return (show_file(client, client->printer->icons[0], "image/png", printer_sm_png, sizeof(printer_sm_png)));
 	}
 	else
 	{
@@ -6032,6 +6163,58 @@ register_printer(
 }
 
 
+//
+// 'release_resource()' - Release a reference to a cached web resource.
+//
+
+static void
+release_resource(
+    ippeve_printer_t  *printer,		// I - Printer
+    ippeve_resource_t *resource)	// I - Resource
+{
+  int	refcount;			// New reference count
+
+
+  cupsMutexLock(&printer->resources_mutex);
+  refcount = -- resource->refcount;
+  cupsMutexUnlock(&printer->resources_mutex);
+
+  if (refcount == 0)
+    delete_resource(resource);
+}
+
+
+//
+// 'respond_cached()' - Send a cached web page if it is still current.
+//
+
+static int				// O - 1 on success, 0 on failure, -1 if not cached
+respond_cached(ippeve_client_t *client,	// I - Client
+               const char      *etag)	// I - Current ETag value
+{
+  ippeve_resource_t	*resource;	// Cached page
+  int			ret = -1;	// Return value
+
+
+  if ((resource = find_resource(client->printer, client->uri)) != NULL)
+  {
+    if (!strcmp(resource->etag, etag))
+      ret = respond_resource(client, resource);
+
+    release_resource(client->printer, resource);
+  }
+
+  if (ret < 0)
+  {
+    // Capture the page so it can be cached...
+    client->html_cache = true;
+    client->htmllen    = 0;
+  }
+
+  return (ret);
+}
+
+
 //
 // 'respond_http()' - Send a HTTP response.
 //
@@ -6179,6 +6362,91 @@ respond_ipp(ippeve_client_t *client,	// I - Client
 }
 
 
+//
+// 'respond_resource()' - Send a cached web resource.
+//
+// Requests with a matching "If-None-Match" value get a 304 response, and
+// clients that accept gzip get the pre-compressed data when available.
+//
+
+static int				// O - 1 on success, 0 on failure
+respond_resource(
+    ippeve_client_t   *client,		// I - Client
+    ippeve_resource_t *resource)	// I - Resource
+{
+  http_status_t	code;			// HTTP status
+  const char	*coding,		// Accepted content coding
+		*data;			// Data to send
+  size_t	datalen;		// Length of data
+  char		date[256];		// Last-Modified date
+
+
+  if (strstr(httpGetField(client->http, HTTP_FIELD_IF_NONE_MATCH), resource->etag))
+    code = HTTP_STATUS_NOT_MODIFIED;
+  else
+    code = HTTP_STATUS_OK;
+
+  if (resource->gzdata && (coding = httpGetContentEncoding(client->http)) != NULL && strstr(coding, "gzip"))
+  {
+    data    = resource->gzdata;
+    datalen = resource->gzdatalen;
+  }
+  else
+  {
+    coding  = NULL;
+    data    = resource->data;
+    datalen = resource->datalen;
+  }
+
+  fprintf(stderr, "%s %s\n", client->hostname, httpStatusString(code));
+
+  // Send the HTTP response header...
+  httpClearFields(client->http);
+  httpSetField(client->http, HTTP_FIELD_ETAG, resource->etag);
+  httpSetField(client->http, HTTP_FIELD_LAST_MODIFIED, httpGetDateString(resource->mtime, date, sizeof(date)));
+
+  if (resource->gzdata)
+    httpSetField(client->http, HTTP_FIELD_VARY, "Accept-Encoding");
+
+  if (!strcmp(resource->type, "text/html"))
+  {
+    // Dynamic pages need to be revalidated...
+    httpSetField(client->http, HTTP_FIELD_CACHE_CONTROL, "no-cache");
+  }
+
+  if (code == HTTP_STATUS_OK)
+  {
+    if (!strcmp(resource->type, "text/html"))
+      httpSetField(client->http, HTTP_FIELD_CONTENT_TYPE, "text/html; charset=utf-8");
+    else
+      httpSetField(client->http, HTTP_FIELD_CONTENT_TYPE, resource->type);
+
+    if (coding)
+      httpSetField(client->http, HTTP_FIELD_CONTENT_ENCODING, coding);
+
+    httpSetLength(client->http, datalen);
+  }
+  else
+  {
+    httpSetLength(client->http, 0);
+  }
+
+  if (!httpWriteResponse(client->http, code))
+    return (0);
+
+  // Send the data with a single write...
+  if (code == HTTP_STATUS_OK)
+  {
+    if (httpWrite(client->http, data, datalen) < 0)
+      return (0);
+
+    httpFlushWrite(client->http);
+  }
+
+  return (1);
+}
+
+
 //
 // 'respond_unsupported()' - Respond with an unsupported attribute.
 //
@@ -6284,6 +6552,108 @@ run_printer(ippeve_printer_t *printer)	// I - Printer
 }
 
 
+//
+// 'show_file()' - Send a static file or built-in resource.
+//
+// Files are loaded into the web cache on first use and reloaded when their
+// size or modification time changes.
+//
+
+static int				// O - 1 on success, 0 on failure
+show_file(
+    ippeve_client_t     *client,	// I - Client connection
+    const char          *filename,	// I - Filename or `NULL` to use built-in data
+    const char          *type,		// I - MIME media type
+    const unsigned char *builtin,	// I - Built-in data or `NULL` for none
+    size_t              builtinlen)	// I - Length of built-in data
+{
+  ippeve_resource_t	*resource;	// Cached resource
+  char			*data;		// Resource data
+  size_t		datalen;	// Length of data
+  time_t		mtime;		// Modification time
+  int			ret;		// Return value
+
+
+  resource = find_resource(client->printer, client->uri);
+
+  if (filename)
+  {
+    // Load the file if it isn't cached or has changed...
+    int			fd;		// File descriptor
+    struct stat		fileinfo;	// File information
+    ssize_t		bytes = 0;	// Bytes read
+
+    if (stat(filename, &fileinfo))
+    {
+      if (resource)
+        release_resource(client->printer, resource);
+
+      return (respond_http(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0));
+    }
+
+    if (resource && (resource->mtime != fileinfo.st_mtime || resource->datalen != (size_t)fileinfo.st_size))
+    {
+      release_resource(client->printer, resource);
+      resource = NULL;
+    }
+
+    if (!resource)
+    {
+      if ((fd = open(filename, O_RDONLY | O_BINARY)) < 0)
+	return (respond_http(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0));
+
+      if (fstat(fd, &fileinfo) || (data = malloc((size_t)fileinfo.st_size + 1)) == NULL)
+      {
+	close(fd);
+	return (0);
+      }
+
+      for (datalen = 0; datalen < (size_t)fileinfo.st_size; datalen += (size_t)bytes)
+      {
+        if ((bytes = read(fd, data + datalen, (size_t)fileinfo.st_size - datalen)) <= 0)
+          break;
+      }
+
+      close(fd);
+
+      if (datalen < (size_t)fileinfo.st_size)
+      {
+        // Don't cache a partial file...
+        fprintf(stderr, "%s Unable to read \"%s\": %s\n", client->hostname, filename, bytes < 0 ? strerror(errno) : "File changed while reading.");
+        free(data);
+	return (respond_http(client, HTTP_STATUS_SERVER_ERROR, NULL, NULL, 0));
+      }
+
+      if ((resource = add_resource(client->printer, client->uri, type, NULL, fileinfo.st_mtime, data, datalen)) == NULL)
+	return (0);
+    }
+  }
+  else if (!resource)
+  {
+    // Load the built-in data...
+    if (!builtin)
+      return (respond_http(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0));
+
+    if ((data = malloc(builtinlen)) == NULL)
+      return (0);
+
+    memcpy(data, builtin, builtinlen);
+
+    datalen = builtinlen;
+    mtime   = client->printer->start_time;
+
+    if ((resource = add_resource(client->printer, client->uri, type, NULL, mtime, data, datalen)) == NULL)
+      return (0);
+  }
+
+  ret = respond_resource(client, resource);
+
+  release_resource(client->printer, resource);
+
+  return (ret);
+}
+
+
 //
 // 'show_media()' - Show media load state.
 //
@@ -6614,8 +6984,12 @@ show_status(ippeve_client_t  *client)	// I - Client connection
   ippeve_printer_t *printer = client->printer;
 					// Printer
   ippeve_job_t		*job;		// Current job
+  cups_array_iter_t	iter;		// Job iterator
   size_t		i;		// Looping var
   ippeve_preason_t	reason;		// Current reason
+  uLong			key;		// Key for printer and job states
+  char			etag[64];	// ETag for page
+  int			ret;		// Cached response status
   static const char * const reasons[] =	// Reason strings
   {
     "Other",
@@ -6643,8 +7017,24 @@ show_status(ippeve_client_t  *client)	// I - Client connection
   };
 
 
-  if (!respond_http(client, HTTP_STATUS_OK, NULL, "text/html", 0))
-    return (0);
+  // Use the cached page unless the printer or job states have changed...
+  cupsRWLockRead(&(printer->rwlock));
+
+  key = crc32(0, (const Bytef *)&printer->state, sizeof(printer->state));
+  key = crc32(key, (const Bytef *)&printer->state_reasons, sizeof(printer->state_reasons));
+
+  for (job = (ippeve_job_t *)cupsArrayIterFirst(printer->jobs, &iter); job; job = (ippeve_job_t *)cupsArrayIterNext(&iter))
+  {
+    key = crc32(key, (const Bytef *)&job->id, sizeof(job->id));
+    key = crc32(key, (const Bytef *)&job->state, sizeof(job->state));
+  }
+
+  cupsRWUnlock(&(printer->rwlock));
+
+  snprintf(etag, sizeof(etag), "\"s%08lx\"", (unsigned long)key);
+
+  if ((ret = respond_cached(client, etag)) >= 0)
+    return (ret);
 
   html_header(client, printer->name, printer->state == IPP_PSTATE_PROCESSING ? 5 : 15);
   html_printf(client, "<h1><img style=\"background: %s; border-radius: 10px; float: left; margin-right: 10px; padding: 10px;\" src=\"/icon.png\" width=\"64\" height=\"64\">%s Jobs</h1>\n", state_colors[printer->state - IPP_PSTATE_IDLE], printer->name);
@@ -6659,7 +7049,7 @@ show_status(ippeve_client_t  *client)	// I - Client connection
     cupsRWLockRead(&(printer->rwlock));
 
     html_printf(client, "<table class=\"striped\" summary=\"Jobs\"><thead><tr><th>Job #</th><th>Name</th><th>Owner</th><th>Status</th></tr></thead><tbody>\n");
-    for (job = (ippeve_job_t *)cupsArrayGetFirst(printer->jobs); job; job = (ippeve_job_t *)cupsArrayGetNext(printer->jobs))
+    for (job = (ippeve_job_t *)cupsArrayIterFirst(printer->jobs, &iter); job; job = (ippeve_job_t *)cupsArrayIterNext(&iter))
     {
       char	when[256],		// When job queued/started/finished
 		hhmmss[64];		// Time HH:MM:SS
@@ -6692,9 +7082,7 @@ show_status(ippeve_client_t  *client)	// I - Client connection
     cupsRWUnlock(&(printer->rwlock));
   }
 
-  html_footer(client);
-
-  return (1);
+  return (html_finish(client, etag));
 }
 
 
@@ -6719,6 +7107,7 @@ show_supplies(
   const char	*supply_value;		// Supply value
   char		supply_text[1024],	// Supply string
 		*supply_ptr;		// Pointer into supply string
+  char		etag[64] = "";		// ETag for page
   static const char * const printer_supply[] =
   {					// printer-supply values
     "index=1;class=receptacleThatIsFilled;type=wasteToner;unit=percent;"
@@ -6750,16 +7139,43 @@ show_supplies(
   };
 
 
-  if (!respond_http(client, HTTP_STATUS_OK, NULL, "text/html", 0))
-    return (0);
+  if (printer->web_forms && client->options && *client->options)
+  {
+    // Form submissions change the supply levels, so don't use the cache...
+    if (!respond_http(client, HTTP_STATUS_OK, NULL, "text/html", 0))
+      return (0);
+  }
+  else
+  {
+    // Use the cached page unless the supply levels have changed...
+    uLong	key = crc32(0, NULL, 0);// Key for supply levels
+    int		ret;			// Cached response status
+
+    cupsRWLockRead(&printer->rwlock);
+
+    if ((supply = ippFindAttribute(printer->attrs, "printer-supply", IPP_TAG_STRING)) != NULL)
+    {
+      for (i = 0, num_supply = ippGetCount(supply); i < num_supply; i ++)
+      {
+        supply_value = ippGetOctetString(supply, i, &supply_len);
+        key          = crc32(key, (const Bytef *)supply_value, (uInt)supply_len);
+      }
+    }
+
+    cupsRWUnlock(&printer->rwlock);
+
+    snprintf(etag, sizeof(etag), "\"p%08lx\"", (unsigned long)key);
+
+    if ((ret = respond_cached(client, etag)) >= 0)
+      return (ret);
+  }
 
   html_header(client, printer->name, 0);
 
   if ((supply = ippFindAttribute(printer->attrs, "printer-supply", IPP_TAG_STRING)) == NULL)
   {
     html_printf(client, "<p>Error: No printer-supply defined for printer.</p>\n");
-    html_footer(client);
-    return (1);
+    return (html_finish(client, etag));
   }
 
   num_supply = ippGetCount(supply);
@@ -6767,15 +7183,13 @@ show_supplies(
   if ((supply_desc = ippFindAttribute(printer->attrs, "printer-supply-description", IPP_TAG_TEXT)) == NULL)
   {
     html_printf(client, "<p>Error: No printer-supply-description defined for printer.</p>\n");
-    html_footer(client);
-    return (1);
+    return (html_finish(client, etag));
   }
 
   if (num_supply != ippGetCount(supply_desc))
   {
     html_printf(client, "<p>Error: Different number of values for printer-supply and printer-supply-description defined for printer.</p>\n");
-    html_footer(client);
-    return (1);
+    return (html_finish(client, etag));
   }
 
   if (printer->web_forms)
@@ -6881,9 +7295,7 @@ show_supplies(
 
   cupsFreeOptions(num_options, options);
 
-  html_footer(client);
-
-  return (1);
+  return (html_finish(client, etag));
 }
 
 
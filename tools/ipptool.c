@@ -142,6 +142,7 @@ typedef struct ipptool_test_s		// Test Data
   int		family;			// Address family
   ipptool_output_t output;		// Output mode
   bool		repeat_on_busy;		// Repeat tests on server-error-busy
+  bool		show_stats;		// Show HTTP statistics?
   bool		stop_after_include_error;
 					// Stop after include errors?
   double	timeout;		// Timeout for connection
@@ -251,6 +252,7 @@ static void	print_ippserver_string(ipptool_test_t *data, const char *s, size_t l
 static void	print_json_attr(ipptool_test_t *data, ipp_attribute_t *attr, int indent);
 static void	print_json_string(ipptool_test_t *data, const char *s, size_t len);
 static ipp_attribute_t *print_line(ipptool_test_t *data, ipp_t *ipp, ipp_attribute_t *attr, int num_displayed, char **displayed, size_t *widths);
+static void	print_stats(void);
 static void	print_xml_header(ipptool_test_t *data);
 static void	print_xml_string(cups_file_t *outfile, const char *element, const char *s);
 static void	print_xml_trailer(ipptool_test_t *data, int success, const char *message);
@@ -375,6 +377,12 @@ main(int  argc,				// I - Number of command-line args
 
       data->output = IPPTOOL_OUTPUT_IPPFILE;
     }
+    else if (!strcmp(argv[i], "--stats"))
+    {
+      data->show_stats = true;
+
+      httpSetStatistics(NULL, true);
+    }
     else if (!strcmp(argv[i], "--stop-after-include-error"))
     {
       data->stop_after_include_error = true;
@@ -530,7 +538,7 @@ main(int  argc,				// I - Number of command-line args
               }
 	      else
 	      {
-		interval = (int)(_cupsStrScand(argv[i], NULL, localeconv()) * 1000000.0);
+		interval = (int)(_cupsStrScand(argv[i], NULL) * 1000000.0);
 		if (interval <= 0)
 		{
 		  cupsLangPrintf(stderr, _("%s: Invalid seconds \"%s\" for '-i'."), "ipptool", argv[i]);
@@ -633,7 +641,7 @@ main(int  argc,				// I - Number of command-line args
 		return (usage(stderr));
               }
 
-	      data->timeout = _cupsStrScand(argv[i], NULL, localeconv());
+	      data->timeout = _cupsStrScand(argv[i], NULL);
 	      break;
 
           case 'v' : // Be verbose
@@ -789,6 +797,9 @@ main(int  argc,				// I - Number of command-line args
     cupsFilePrintf(cupsFileStdout(), "\nSummary: %d tests, %d passed, %d failed, %d skipped\nScore: %d%%\n", data->test_count, data->pass_count, data->fail_count, data->skip_count, 100 * (data->pass_count + data->skip_count) / data->test_count);
   }
 
+  if (data->show_stats)
+    print_stats();
+
   cupsFileClose(data->outfile);
   free_data(data);
 
@@ -3842,7 +3853,7 @@ parse_monitor_printer_state(
 
       ippFileExpandVars(f, value, temp, sizeof(value));
 
-      if ((dval = _cupsStrScand(value, &ptr, localeconv())) < 0.0 || (*ptr && *ptr != ','))
+      if ((dval = _cupsStrScand(value, &ptr)) < 0.0 || (*ptr && *ptr != ','))
       {
 	print_fatal_error(data, "Bad DELAY value \"%s\" on line %d of '%s'.", value, ippFileGetLineNumber(f), ippFileGetFilename(f));
 	return (0);
@@ -3852,7 +3863,7 @@ parse_monitor_printer_state(
 
       if (*ptr == ',')
       {
-	if ((dval = _cupsStrScand(ptr + 1, &ptr, localeconv())) <= 0.0 || *ptr)
+	if ((dval = _cupsStrScand(ptr + 1, &ptr)) <= 0.0 || *ptr)
 	{
 	  print_fatal_error(data, "Bad DELAY value \"%s\" on line %d of '%s'.", value, ippFileGetLineNumber(f), ippFileGetFilename(f));
 	  return (0);
@@ -4981,6 +4992,59 @@ print_line(
 }
 
 
+//
+// 'print_stats()' - Print the aggregate HTTP statistics.
+//
+
+static void
+print_stats(void)
+{
+  http_stats_t	stats;			// HTTP statistics
+  int		type,			// Type of latency
+		bucket;			// Histogram bucket
+  static const char * const types[] =	// Latency names
+  {
+    "resolve",
+    "connect",
+    "tls",
+    "first-byte",
+    "wait"
+  };
+
+
+  httpGetStatistics(NULL, &stats);
+
+  fprintf(stderr, "\nHTTP Statistics:\n");
+  fprintf(stderr, "  connections: %u\n", (unsigned)stats.connections);
+  fprintf(stderr, "  requests: %u\n", (unsigned)stats.requests);
+  fprintf(stderr, "  bytes-in: " CUPS_LLFMT "\n", CUPS_LLCAST stats.bytes_in);
+  fprintf(stderr, "  bytes-out: " CUPS_LLFMT "\n", CUPS_LLCAST stats.bytes_out);
+  fprintf(stderr, "  read-calls: %u\n", (unsigned)stats.read_calls);
+  fprintf(stderr, "  write-calls: %u\n", (unsigned)stats.write_calls);
+
+  for (type = 0; type < HTTP_LATENCY_MAX; type ++)
+  {
+    if (!stats.count[type])
+      continue;
+
+    fprintf(stderr, "  %s: count=%u, avg=%.3fms, max=%.3fms\n", types[type], (unsigned)stats.count[type], 1000.0 * stats.total[type] / stats.count[type], 1000.0 * stats.maximum[type]);
+
+    for (bucket = 0; bucket < HTTP_STATS_BUCKETS; bucket ++)
+    {
+      if (!stats.histogram[type][bucket])
+        continue;
+
+      if (bucket == 0)
+        fprintf(stderr, "    <1us: %u\n", (unsigned)stats.histogram[type][bucket]);
+      else if (bucket == (HTTP_STATS_BUCKETS - 1))
+        fprintf(stderr, "    >=%luus: %u\n", 1UL << (bucket - 1), (unsigned)stats.histogram[type][bucket]);
+      else
+        fprintf(stderr, "    <%luus: %u\n", 1UL << bucket, (unsigned)stats.histogram[type][bucket]);
+    }
+  }
+}
+
+
 //
 // 'print_xml_header()' - Print a standard XML plist header.
 //
@@ -5608,7 +5672,7 @@ token_cb(ipp_file_t     *f,		// I - IPP file data
 
       ippFileExpandVars(f, value, temp, sizeof(value));
 
-      if ((dval = _cupsStrScand(value, &ptr, localeconv())) < 0.0 || (*ptr && *ptr != ','))
+      if ((dval = _cupsStrScand(value, &ptr)) < 0.0 || (*ptr && *ptr != ','))
       {
 	print_fatal_error(data, "Bad DELAY value \"%s\" on line %d of '%s'.", value, ippFileGetLineNumber(f), ippFileGetFilename(f));
 	return (false);
@@ -5618,7 +5682,7 @@ token_cb(ipp_file_t     *f,		// I - IPP file data
 
       if (*ptr == ',')
       {
-	if ((dval = _cupsStrScand(ptr + 1, &ptr, localeconv())) <= 0.0 || *ptr)
+	if ((dval = _cupsStrScand(ptr + 1, &ptr)) <= 0.0 || *ptr)
 	{
 	  print_fatal_error(data, "Bad DELAY value \"%s\" on line %d of '%s'.", value, ippFileGetLineNumber(f), ippFileGetFilename(f));
 	  return (false);
@@ -6596,6 +6660,7 @@ usage(FILE *out)
   cupsLangPuts(out, _("--help                         Show this help"));
   cupsLangPuts(out, _("--help                         Show this help"));
   cupsLangPuts(out, _("--ippfile FILENAME             Produce IPP attribute file"));
+  cupsLangPuts(out, _("--stats                        Show HTTP statistics"));
   cupsLangPuts(out, _("--stop-after-include-error     Stop tests after a failed INCLUDE"));
   cupsLangPuts(out, _("--version                      Show the program version"));
   cupsLangPuts(out, _("-4                             Connect using IPv4"));
@@ -15,6 +15,7 @@
 #include "ipp-options.h"
 #include <pdfio.h>
 #include <pdfio-content.h>
+#include <zlib.h>
 
 #ifdef HAVE_COREGRAPHICS_H
 #  include <CoreGraphics/CoreGraphics.h>
@@ -37,6 +38,11 @@ extern char **environ;
 #  include <sys/wait.h>
 #endif // _WIN32
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#  define XFORM_SIMD		1	// Use SSE2/SSSE3/AVX2 kernels
+#endif // __GNUC__ && (__x86_64__ || __i386__)
+
 
 // Macros...
 #define XFORM_MATCH(a,b)	(abs(a-b) <= 100)
@@ -46,6 +52,7 @@ extern char **environ;
 #define XFORM_MAX_LAYOUT	16
 #define XFORM_MAX_PAGES		10000
 #define XFORM_MAX_RASTER	16777216
+#define XFORM_MAX_THREADS	64	// Maximum number of pdftoppm workers
 
 #define XFORM_TEXT_SIZE		10.0	// Point size of plain text output
 #define XFORM_TEXT_HEIGHT	12.0	// Point height of plain text output
@@ -108,9 +115,54 @@ typedef struct xform_prepare_s		// Preparation data
   pdfio_matrix_t duplex_xform;		// Back side transform matrix
 } xform_prepare_t;
 
+typedef enum xform_sstate_e		// PCLm strip states
+{
+  XFORM_STRIP_EMPTY,			// Available for lines
+  XFORM_STRIP_QUEUED,			// Waiting to be compressed
+  XFORM_STRIP_COMPRESSING,		// Being compressed
+  XFORM_STRIP_DONE			// Compressed and ready to write
+} xform_sstate_t;
+
+typedef struct xform_strip_s		// PCLm strip for threaded compression
+{
+  xform_sstate_t state;			// Current state
+  size_t	index;			// Strip number on page
+  unsigned char	*pixels,		// Pixels for strip
+		*output;		// Compressed data
+  size_t	pixsize,		// Size of pixel buffer
+		outsize,		// Size of compressed data buffer
+		outused;		// Bytes of compressed data
+} xform_strip_t;
+
 typedef struct xform_raster_s xform_raster_t;
 					// Raster context
 
+#ifndef HAVE_COREGRAPHICS_H
+typedef struct xform_ppm_s		// Page rendered by pdftoppm
+{
+  bool		ready;			// Has the page been rendered?
+  unsigned	width,			// Width in columns
+		height,			// Height in lines
+		bpp;			// Bytes per pixel
+  unsigned char	*pixels;		// Pixels or `NULL` on error
+} xform_ppm_t;
+
+typedef struct xform_pdftoppm_s		// Parallel pdftoppm data
+{
+  cups_mutex_t	mutex;			// Mutex for this structure
+  cups_cond_t	cond;			// Condition for page updates
+  const char	*filename,		// PDF filename
+		*args;			// pdftoppm options
+  bool		poppler,		// Poppler version of pdftoppm?
+		cancel;			// Stop rendering?
+  unsigned	num_pages,		// Number of pages
+		next_render,		// Next page to render
+		next_page,		// Next page to write
+		window;			// Number of pages in reorder buffer
+  xform_ppm_t	*pages;			// Reorder buffer
+} xform_pdftoppm_t;
+#endif // !HAVE_COREGRAPHICS_H
+
 struct xform_raster_s			// Raster context
 {
   const char		*format;	// Output format
@@ -136,6 +188,13 @@ struct xform_raster_s			// Raster context
   unsigned		out_blanks;	// Blank lines
   unsigned		out_length;	// Byte width of image box
   unsigned char		*comp_buffer;	// Compression buffer
+  unsigned char		*pcl_delta,	// Delta row compression buffer
+			*pcl_seed;	// Seed (previous) row for delta row compression
+  int			pcl_method;	// Current PCL compression method
+  unsigned		pcl_lines[4];	// Lines sent as blank and with methods 2 and 3
+  size_t		pcl_in_bytes,	// Uncompressed bytes on page
+			pcl_out_bytes;	// Compressed bytes on page
+  double		pcl_secs;	// Seconds spent compressing page
 
   unsigned char		dither[64][64];	// Dither array
   unsigned char		white;		// White pixel value
@@ -146,7 +205,18 @@ struct xform_raster_s			// Raster context
 					// Strip objects
   unsigned		pclm_strip_height;
 					// Height of each strip
-  pdfio_stream_t	*pclm_strip_st;	// Current strip stream
+  int			pclm_level;	// Compression level
+  size_t		pclm_num_threads;
+					// Number of compression threads
+  cups_thread_t		*pclm_threads;	// Compression threads
+  cups_mutex_t		pclm_mutex;	// Mutex for strips
+  cups_cond_t		pclm_cond;	// Condition for strip state changes
+  bool			pclm_stop;	// Stop compression threads?
+  size_t		pclm_num_strips,// Number of strip buffers
+			pclm_fill_strip,// Strip being filled
+			pclm_write_strip;
+					// Next strip to write
+  xform_strip_t		*pclm_strips;	// Strip buffers
 
   // Callbacks
   void			(*end_job)(xform_raster_t *, xform_write_cb_t, void *);
@@ -165,6 +235,7 @@ static char		PdftoppmCommand[1024] = "";
 					// "pdftoppm" command path, if any
 #endif // !_HAVE_COREGRAPHICS_H
 static const char	*Prefix;	// Error message prefix (typically the command name or "ERROR" if running from ippeveprinter/ippserver
+static unsigned		Threads = 1;	// Number of worker threads
 static int		Verbosity = 0;	// Log level
 
 
@@ -174,16 +245,33 @@ static bool	convert_raster(xform_prepare_t *p, xform_document_t *d, int document
 static bool	convert_text(xform_prepare_t *p, xform_document_t *d, int document);
 static void	copy_page(xform_prepare_t *p, xform_page_t *outpage, size_t layout);
 static void	dither_gray(xform_raster_t *ras, unsigned y, unsigned char *row, size_t num_pixels);
+#ifdef XFORM_SIMD
+static size_t	dither_gray_avx2(const unsigned char *ditherline, unsigned char white, unsigned char *row, size_t num_pixels);
+static size_t	dither_gray_ssse3(const unsigned char *ditherline, unsigned char white, unsigned char *row, size_t num_pixels);
+#endif // XFORM_SIMD
 static bool	generate_job_error_sheet(xform_prepare_t *p);
 static bool	generate_job_sheets(xform_prepare_t *p);
 static void	media_to_rect(cups_media_t *size, pdfio_rect_t *media, pdfio_rect_t *crop);
 static void	*monitor_ipp(const char *device_uri);
 static void	pack_black(unsigned char *row, size_t num_pixels);
+#ifdef XFORM_SIMD
+static size_t	pack_black_sse2(unsigned char *row, size_t num_pixels);
+#endif // XFORM_SIMD
 #ifdef HAVE_COREGRAPHICS_H
 static void	pack_rgba(unsigned char *row, size_t num_pixels);
 static void	pack_rgba16(unsigned char *row, size_t num_pixels);
+#  ifdef XFORM_SIMD
+static size_t	pack_rgba16_ssse3(unsigned char *row, size_t num_pixels);
+static size_t	pack_rgba_ssse3(unsigned char *row, size_t num_pixels);
+#  endif // XFORM_SIMD
 #endif // HAVE_COREGRAPHICS_H
 static bool	page_dict_cb(pdfio_dict_t *dict, const char *key, xform_page_t *outpage);
+static size_t	pcl_compress_delta(const unsigned char *line, const unsigned char *seed, size_t length, unsigned char *comp);
+static size_t	pcl_compress_packbits(const unsigned char *line, size_t length, unsigned char *comp);
+static size_t	pcl_delta_skip(const unsigned char *line, const unsigned char *seed, size_t x, size_t length);
+#ifdef XFORM_SIMD
+static size_t	pcl_delta_skip_sse2(const unsigned char *line, const unsigned char *seed, size_t x, size_t length);
+#endif // XFORM_SIMD
 static void	pcl_end_job(xform_raster_t *ras, xform_write_cb_t cb, void *ctx);
 static void	pcl_end_page(xform_raster_t *ras, unsigned page, xform_write_cb_t cb, void *ctx);
 static void	pcl_init(xform_raster_t *ras);
@@ -196,6 +284,9 @@ static bool	pclm_error_cb(pdfio_file_t *pdf, const char *message, void *data);
 static void	pclm_init(xform_raster_t *ras);
 static bool	pclm_start_job(xform_raster_t *ras, xform_write_cb_t cb, void *ctx);
 static bool	pclm_start_page(xform_raster_t *ras, unsigned page, xform_write_cb_t cb, void *ctx);
+static void	pclm_strip_compress(xform_raster_t *ras, xform_strip_t *strip);
+static void	*pclm_strip_thread(xform_raster_t *ras);
+static void	pclm_strip_write(xform_raster_t *ras, xform_strip_t *until);
 static void	pclm_write_line(xform_raster_t *ras, unsigned y, const unsigned char *line, xform_write_cb_t cb, void *ctx);
 static bool	pclps_printf(xform_write_cb_t cb, void *ctx, const char *format, ...) _CUPS_FORMAT(3, 4);
 static int	ps_convert_pdf(const char *filename, xform_write_cb_t cb, void *ctx);
@@ -223,6 +314,12 @@ static bool	resource_dict_cb(pdfio_dict_t *dict, const char *key, xform_page_t *
 static int	usage(FILE *out);
 static ssize_t	write_fd(int *fd, const unsigned char *buffer, size_t bytes);
 static bool	xform_document(const char *filename, unsigned pages, ipp_options_t *options, const char *outformat, const char *resolutions, const char *sheet_back, const char *types, xform_write_cb_t cb, void *ctx);
+#ifndef HAVE_COREGRAPHICS_H
+static bool	xform_ppm_header(FILE *fp, unsigned *width, unsigned *height, unsigned *bpp);
+static xform_ppm_t xform_ppm_next(xform_pdftoppm_t *pp);
+static bool	xform_ppm_page(xform_raster_t *ras, unsigned page, FILE *fp, const unsigned char *pixels, unsigned width, unsigned height, unsigned bpp, xform_write_cb_t cb, void *ctx);
+static void	*xform_ppm_worker(xform_pdftoppm_t *pp);
+#endif // !HAVE_COREGRAPHICS_H
 static bool	xform_separator(xform_raster_t *ras, xform_write_cb_t cb, void *ctx);
 static bool	xform_setup(xform_raster_t *ras, ipp_options_t *options, const char *outformat, const char *resolutions, const char *types, const char *sheet_back, bool color, unsigned pages);
 
@@ -277,6 +374,9 @@ main(int  argc,				// I - Number of command-line args
   if (!sheet_back)
     sheet_back = getenv("IPP_PCLM_RASTER_BACK_SIDE");
 
+  if ((opt = getenv("IPPTRANSFORM_THREADS")) != NULL && atoi(opt) > 0)
+    Threads = (unsigned)atoi(opt);
+
   if ((opt = getenv("SERVER_LOGLEVEL")) != NULL)
   {
     // Use "ERROR" as the prefix for error messages since they will be logged...
@@ -313,6 +413,17 @@ main(int  argc,				// I - Number of command-line args
       {
         return (usage(stdout));
       }
+      else if (!strcmp(argv[i], "--threads"))
+      {
+        i ++;
+        if (i >= argc || atoi(argv[i]) < 1)
+        {
+          cupsLangPrintf(stderr, _("%s: Missing number of threads after '%s'."), Prefix, "--threads");
+          return (usage(stderr));
+        }
+
+        Threads = (unsigned)atoi(argv[i]);
+      }
       else if (!strcmp(argv[i], "--version"))
       {
         puts(LIBCUPS_VERSION);
@@ -1655,16 +1766,27 @@ dither_gray(xform_raster_t *ras,	// I - Raster info
             unsigned char  *row,	// I - Row pointer
             size_t         num_pixels)	// I - Number of pixels
 {
-  unsigned	x;			// Column number
+  size_t	x = 0;			// Column number
   unsigned char	bit,			// Current bit
 		byte,			// Current byte
-		*rowptr;		// Pointer into row buffer
+		*rowptr = row;		// Pointer into row buffer
   const unsigned char *ditherline;	// Pointer into dither table
 
 
   ditherline = ras->dither[y & 63];
 
-  for (x = 0, bit = 128, byte = ras->white, rowptr = row; x < num_pixels; x ++, row ++)
+#ifdef XFORM_SIMD
+  // Dither whole bytes of output using SIMD instructions when available...
+  if (__builtin_cpu_supports("avx2"))
+    x = dither_gray_avx2(ditherline, ras->white, row, num_pixels);
+  else if (__builtin_cpu_supports("ssse3"))
+    x = dither_gray_ssse3(ditherline, ras->white, row, num_pixels);
+
+  row    += x;
+  rowptr += x / 8;
+#endif // XFORM_SIMD
+
+  for (bit = 128, byte = ras->white; x < num_pixels; x ++, row ++)
   {
     if (*row <= ditherline[x & 63])
       byte ^= bit;
@@ -1686,6 +1808,100 @@ dither_gray(xform_raster_t *ras,	// I - Raster info
 }
 
 
+#ifdef XFORM_SIMD
+//
+// 'dither_gray_avx2()' - Dither grayscale pixels 32 at a time using AVX2.
+//
+// Each group of 8 pixels is compared to the dither thresholds and the
+// comparison results are reversed so that the first pixel becomes the most
+// significant bit of the output byte.  The output bytes are stored behind the
+// pixels that have already been read, so dithering can be done in place.
+//
+
+__attribute__((target("avx2")))
+static size_t				// O - Number of pixels dithered
+dither_gray_avx2(
+    const unsigned char *ditherline,	// I - Dither thresholds for row
+    unsigned char       white,		// I - White value
+    unsigned char       *row,		// I - Row pointer
+    size_t              num_pixels)	// I - Number of pixels
+{
+  size_t	x;			// Column number
+  unsigned	bits,			// Output bits
+		wbits = white * 0x01010101U;
+					// White bits
+  unsigned char	*rowptr = row;		// Pointer into row buffer
+  __m256i	pixels,			// Pixels
+		thresholds[2];		// Thresholds for 64 columns
+  const __m256i	reverse = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+					// Reverse the pixels in each byte
+
+
+  thresholds[0] = _mm256_loadu_si256((const __m256i *)ditherline);
+  thresholds[1] = _mm256_loadu_si256((const __m256i *)(ditherline + 32));
+
+  for (x = 0; (x + 32) <= num_pixels; x += 32, row += 32, rowptr += 4)
+  {
+    // pixel <= threshold when min(pixel, threshold) == pixel
+    pixels = _mm256_loadu_si256((const __m256i *)row);
+    pixels = _mm256_cmpeq_epi8(_mm256_min_epu8(pixels, thresholds[(x >> 5) & 1]), pixels);
+    bits   = (unsigned)_mm256_movemask_epi8(_mm256_shuffle_epi8(pixels, reverse)) ^ wbits;
+
+    rowptr[0] = (unsigned char)bits;
+    rowptr[1] = (unsigned char)(bits >> 8);
+    rowptr[2] = (unsigned char)(bits >> 16);
+    rowptr[3] = (unsigned char)(bits >> 24);
+  }
+
+  _mm256_zeroupper();
+
+  return (x);
+}
+
+
+//
+// 'dither_gray_ssse3()' - Dither grayscale pixels 16 at a time using SSSE3.
+//
+
+__attribute__((target("ssse3")))
+static size_t				// O - Number of pixels dithered
+dither_gray_ssse3(
+    const unsigned char *ditherline,	// I - Dither thresholds for row
+    unsigned char       white,		// I - White value
+    unsigned char       *row,		// I - Row pointer
+    size_t              num_pixels)	// I - Number of pixels
+{
+  size_t	x;			// Column number
+  unsigned	bits,			// Output bits
+		wbits = white * 0x0101U;// White bits
+  unsigned char	*rowptr = row;		// Pointer into row buffer
+  __m128i	pixels,			// Pixels
+		thresholds[4];		// Thresholds for 64 columns
+  const __m128i	reverse = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+					// Reverse the pixels in each byte
+
+
+  thresholds[0] = _mm_loadu_si128((const __m128i *)ditherline);
+  thresholds[1] = _mm_loadu_si128((const __m128i *)(ditherline + 16));
+  thresholds[2] = _mm_loadu_si128((const __m128i *)(ditherline + 32));
+  thresholds[3] = _mm_loadu_si128((const __m128i *)(ditherline + 48));
+
+  for (x = 0; (x + 16) <= num_pixels; x += 16, row += 16, rowptr += 2)
+  {
+    // pixel <= threshold when min(pixel, threshold) == pixel
+    pixels = _mm_loadu_si128((const __m128i *)row);
+    pixels = _mm_cmpeq_epi8(_mm_min_epu8(pixels, thresholds[(x >> 4) & 3]), pixels);
+    bits   = (unsigned)_mm_movemask_epi8(_mm_shuffle_epi8(pixels, reverse)) ^ wbits;
+
+    rowptr[0] = (unsigned char)bits;
+    rowptr[1] = (unsigned char)(bits >> 8);
+  }
+
+  return (x);
+}
+#endif // XFORM_SIMD
+
+
 //
 // 'generate_job_error_sheet()' - Generate a job error sheet.
 //
@@ -1984,6 +2200,17 @@ static void
 pack_black(unsigned char *row,		// I - Row of pixels to pack
            size_t        num_pixels)	// I - Number of pixels in row
 {
+#ifdef XFORM_SIMD
+  if (__builtin_cpu_supports("sse2"))
+  {
+    size_t count = pack_black_sse2(row, num_pixels);
+					// Number of pixels packed
+
+    row        += count;
+    num_pixels -= count;
+  }
+#endif // XFORM_SIMD
+
   while (num_pixels > 0)
   {
     *row = 255 - *row;
@@ -1993,6 +2220,38 @@ pack_black(unsigned char *row,		// I - Row of pixels to pack
 }
 
 
+#ifdef XFORM_SIMD
+//
+// 'pack_black_sse2()' - Invert grayscale pixels 64 at a time using SSE2.
+//
+
+__attribute__((target("sse2")))
+static size_t				// O - Number of pixels packed
+pack_black_sse2(unsigned char *row,	// I - Row of pixels to pack
+                size_t        num_pixels)
+					// I - Number of pixels in row
+{
+  size_t	x;			// Column number
+  const __m128i	ones = _mm_set1_epi8(-1);
+					// All bits set
+
+
+  for (x = 0; (x + 64) <= num_pixels; x += 64, row += 64)
+  {
+    _mm_storeu_si128((__m128i *)row, _mm_xor_si128(_mm_loadu_si128((const __m128i *)row), ones));
+    _mm_storeu_si128((__m128i *)(row + 16), _mm_xor_si128(_mm_loadu_si128((const __m128i *)(row + 16)), ones));
+    _mm_storeu_si128((__m128i *)(row + 32), _mm_xor_si128(_mm_loadu_si128((const __m128i *)(row + 32)), ones));
+    _mm_storeu_si128((__m128i *)(row + 48), _mm_xor_si128(_mm_loadu_si128((const __m128i *)(row + 48)), ones));
+  }
+
+  for (; (x + 16) <= num_pixels; x += 16, row += 16)
+    _mm_storeu_si128((__m128i *)row, _mm_xor_si128(_mm_loadu_si128((const __m128i *)row), ones));
+
+  return (x);
+}
+#endif // XFORM_SIMD
+
+
 #ifdef HAVE_COREGRAPHICS_H
 //
 // 'pack_rgba()' - Pack RGBX scanlines into RGB scanlines.
@@ -2015,6 +2274,18 @@ pack_rgba(unsigned char *row,		// I - Row of pixels to pack
   unsigned char *dest_byte;		// Remaining destination bytes
 
 
+#  ifdef XFORM_SIMD
+  if (__builtin_cpu_supports("ssse3"))
+  {
+    size_t count = pack_rgba_ssse3(row, num_pixels);
+					// Number of pixels packed (multiple of 4)
+
+    quad_row  += count;
+    dest      += count / 4 * 3;
+    num_quads = (num_pixels - count) / 4;
+  }
+#  endif // XFORM_SIMD
+
  /*
   * Copy all of the groups of 4 pixels we can...
   */
@@ -2063,6 +2334,18 @@ pack_rgba16(unsigned char *row,		// I - Row of pixels to pack
 					// Destination pointer
 
 
+#  ifdef XFORM_SIMD
+  if (__builtin_cpu_supports("ssse3"))
+  {
+    size_t count = pack_rgba16_ssse3(row, num_pixels);
+					// Number of pixels packed (multiple of 2)
+
+    from       += count * 2;
+    dest       += count / 2 * 3;
+    num_pixels -= count;
+  }
+#  endif // XFORM_SIMD
+
   while (num_pixels > 1)
   {
     *dest++ = from[0];
@@ -2078,6 +2361,60 @@ pack_rgba16(unsigned char *row,		// I - Row of pixels to pack
     *dest++ = *from++;
   }
 }
+
+
+#  ifdef XFORM_SIMD
+//
+// 'pack_rgba16_ssse3()' - Pack 16 bit per component RGBX scanlines into RGB
+//                         scanlines 2 pixels at a time using SSSE3.
+//
+// Each 16 byte store writes 12 bytes of packed pixels followed by 4 bytes that
+// are overwritten by the next store; the stores never pass the pixels that have
+// not been read yet.
+//
+
+__attribute__((target("ssse3")))
+static size_t				// O - Number of pixels packed
+pack_rgba16_ssse3(
+    unsigned char *row,			// I - Row of pixels to pack
+    size_t        num_pixels)		// I - Number of pixels in row
+{
+  size_t	x;			// Column number
+  unsigned char	*dest = row;		// Destination pointer
+  const __m128i	shuffle = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1);
+					// Drop the X component of each pixel
+
+
+  for (x = 0; (x + 2) <= num_pixels; x += 2, row += 16, dest += 12)
+    _mm_storeu_si128((__m128i *)dest, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)row), shuffle));
+
+  return (x);
+}
+
+
+//
+// 'pack_rgba_ssse3()' - Pack RGBX scanlines into RGB scanlines 4 pixels at a
+//                       time using SSSE3.
+//
+
+__attribute__((target("ssse3")))
+static size_t				// O - Number of pixels packed
+pack_rgba_ssse3(unsigned char *row,	// I - Row of pixels to pack
+                size_t        num_pixels)
+					// I - Number of pixels in row
+{
+  size_t	x;			// Column number
+  unsigned char	*dest = row;		// Destination pointer
+  const __m128i	shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+					// Drop the X component of each pixel
+
+
+  for (x = 0; (x + 4) <= num_pixels; x += 4, row += 16, dest += 12)
+    _mm_storeu_si128((__m128i *)dest, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)row), shuffle));
+
+  return (x);
+}
+#  endif // XFORM_SIMD
 #endif // HAVE_COREGRAPHICS_H
 
 
@@ -2173,6 +2510,187 @@ page_dict_cb(pdfio_dict_t *dict,	// I - Dictionary
 }
 
 
+//
+// 'pcl_compress_delta()' - Compress a line using PCL delta row compression.
+//
+// Each run of up to 8 bytes that differ from the seed row is sent as a
+// command byte with the byte count and offset, any additional offset bytes,
+// and the replacement bytes.
+//
+
+static size_t				// O - Number of compressed bytes
+pcl_compress_delta(
+    const unsigned char *line,		// I - Pixels on line
+    const unsigned char *seed,		// I - Seed row
+    size_t              length,		// I - Length of line in bytes
+    unsigned char       *comp)		// I - Compression buffer
+{
+  unsigned char	*compptr = comp;	// Pointer into compression buffer
+  size_t	x = 0,			// Current byte
+		last = 0,		// Byte after the last replacement
+		start,			// Start of replacement bytes
+		count,			// Number of replacement bytes
+		offset;			// Offset from last replacement
+
+
+  while (x < length)
+  {
+    // Find the next run of bytes that differ from the seed row...
+    if ((x = pcl_delta_skip(line, seed, x, length)) >= length)
+      break;
+
+    for (start = x; x < length && line[x] != seed[x]; x ++);
+
+    // Send the run, 8 bytes at a time...
+    while (start < x)
+    {
+      if ((count = x - start) > 8)
+        count = 8;
+
+      if ((offset = start - last) < 31)
+      {
+        *compptr++ = (unsigned char)(((count - 1) << 5) | offset);
+      }
+      else
+      {
+        *compptr++ = (unsigned char)(((count - 1) << 5) | 31);
+
+        for (offset -= 31; offset >= 255; offset -= 255)
+          *compptr++ = 255;
+
+        *compptr++ = (unsigned char)offset;
+      }
+
+      memcpy(compptr, line + start, count);
+      compptr += count;
+      start    += count;
+      last     = start;
+    }
+  }
+
+  return ((size_t)(compptr - comp));
+}
+
+
+//
+// 'pcl_compress_packbits()' - Compress a line using PCL PackBits compression.
+//
+
+static size_t				// O - Number of compressed bytes
+pcl_compress_packbits(
+    const unsigned char *line,		// I - Pixels on line
+    size_t              length,		// I - Length of line in bytes
+    unsigned char       *comp)		// I - Compression buffer
+{
+  const unsigned char	*lineptr,	// Pointer into line
+			*lineend,	// End of line
+			*start;		// Start of sequence
+  unsigned char		*compptr;	// Pointer into compression buffer
+  unsigned		count;		// Count of bytes for output
+
+
+  compptr = comp;
+  lineptr = line;
+  lineend = line + length;
+
+  while (lineptr < lineend)
+  {
+    if ((lineptr + 1) >= lineend)
+    {
+      // Single byte on the end...
+      *compptr++ = 0x00;
+      *compptr++ = *lineptr++;
+    }
+    else if (lineptr[0] == lineptr[1])
+    {
+      // Repeated sequence...
+      lineptr ++;
+      count = 2;
+
+      while (lineptr < (lineend - 1) && lineptr[0] == lineptr[1] && count < 127)
+      {
+	lineptr ++;
+	count ++;
+      }
+
+      *compptr++ = (unsigned char)(257 - count);
+      *compptr++ = *lineptr++;
+    }
+    else
+    {
+      // Non-repeated sequence...
+      start = lineptr;
+      lineptr ++;
+      count = 1;
+
+      while (lineptr < (lineend - 1) && lineptr[0] != lineptr[1] && count < 127)
+      {
+	lineptr ++;
+	count ++;
+      }
+
+      *compptr++ = (unsigned char)(count - 1);
+
+      memcpy(compptr, start, count);
+      compptr += count;
+    }
+  }
+
+  return ((size_t)(compptr - comp));
+}
+
+
+//
+// 'pcl_delta_skip()' - Skip bytes that match the seed row.
+//
+
+static size_t				// O - First byte that differs or "length"
+pcl_delta_skip(
+    const unsigned char *line,		// I - Pixels on line
+    const unsigned char *seed,		// I - Seed row
+    size_t              x,		// I - Starting byte
+    size_t              length)		// I - Length of line in bytes
+{
+#ifdef XFORM_SIMD
+  if (__builtin_cpu_supports("sse2"))
+    x = pcl_delta_skip_sse2(line, seed, x, length);
+#endif // XFORM_SIMD
+
+  while (x < length && line[x] == seed[x])
+    x ++;
+
+  return (x);
+}
+
+
+#ifdef XFORM_SIMD
+//
+// 'pcl_delta_skip_sse2()' - Skip bytes that match the seed row 16 at a time
+//                           using SSE2.
+//
+
+__attribute__((target("sse2")))
+static size_t				// O - First byte that differs or a byte within 16 bytes of "length"
+pcl_delta_skip_sse2(
+    const unsigned char *line,		// I - Pixels on line
+    const unsigned char *seed,		// I - Seed row
+    size_t              x,		// I - Starting byte
+    size_t              length)		// I - Length of line in bytes
+{
+  unsigned	mask;			// Bytes that match
+
+
+  for (; (x + 16) <= length; x += 16)
+  {
+    if ((mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(line + x)), _mm_loadu_si128((const __m128i *)(seed + x))))) != 0xffff)
+      return (x + (unsigned)__builtin_ctz(~mask));
+  }
+
+  return (x);
+}
+#endif // XFORM_SIMD
+
+
 //
 // 'pcl_end_job()' - End a PCL "job".
 //
@@ -2208,6 +2726,16 @@ pcl_end_page(xform_raster_t   *ras,	// I - Raster information
 
   (*cb)(ctx, (const unsigned char *)"\033*r0B", 5);
 
+  fprintf(stderr, "DEBUG: pcl_end_page(page=%u): %u blank lines, %u method 2 lines, %u method 3 lines, %lu bytes compressed to %lu bytes (%.1f%%), %.3f seconds\n", page, ras->pcl_lines[0], ras->pcl_lines[2], ras->pcl_lines[3], (unsigned long)ras->pcl_in_bytes, (unsigned long)ras->pcl_out_bytes, ras->pcl_in_bytes ? 100.0 * ras->pcl_out_bytes / ras->pcl_in_bytes : 0.0, ras->pcl_secs);
+
+  free(ras->comp_buffer);
+  free(ras->pcl_delta);
+  free(ras->pcl_seed);
+
+  ras->comp_buffer = NULL;
+  ras->pcl_delta   = NULL;
+  ras->pcl_seed    = NULL;
+
  /*
   * Formfeed as needed...
   */
@@ -2373,13 +2901,21 @@ pcl_start_page(xform_raster_t   *ras,	// I - Raster information
   pclps_printf(cb, ctx, "\033*r1A");	// Start graphics
 
  /*
-  * Allocate the output buffer...
+  * Allocate the output buffers, the seed row starts out blank...
   */
 
-  ras->out_blanks  = 0;
-  ras->comp_buffer = malloc((ras->right - ras->left + 7) / 8 * 2 + 2);
+  ras->out_blanks    = 0;
+  ras->comp_buffer   = malloc((ras->right - ras->left + 7) / 8 * 2 + 2);
+  ras->pcl_delta     = malloc((ras->right - ras->left + 7) / 8 * 2 + 2);
+  ras->pcl_seed      = calloc(1, (ras->right - ras->left + 7) / 8);
+  ras->pcl_method    = 2;
+  ras->pcl_in_bytes  = 0;
+  ras->pcl_out_bytes = 0;
+  ras->pcl_secs      = 0.0;
 
-  return (ras->comp_buffer != NULL);
+  memset(ras->pcl_lines, 0, sizeof(ras->pcl_lines));
+
+  return (ras->comp_buffer != NULL && ras->pcl_delta != NULL && ras->pcl_seed != NULL);
 }
 
 
@@ -2395,80 +2931,76 @@ pcl_write_line(
     xform_write_cb_t    cb,		// I - Write callback
     void                *ctx)		// I - Write context
 {
-  const unsigned char	*outptr,	// Pointer into output buffer
-			*outend,	// End of output buffer
-			*start;		// Start of sequence
-  unsigned char		*compptr;	// Pointer into compression buffer
-  unsigned		count;		// Count of bytes for output
+  size_t		length = ras->out_length;
+					// Length of line
+  size_t		packlen,	// Length of PackBits data
+			deltalen;	// Length of delta row data
+  int			method;		// Compression method
+  const unsigned char	*comp;		// Compressed data
+  size_t		complen;	// Length of compressed data
+  double		start = cupsGetClock();
+					// Start time
 
 
   (void)y;
 
-  if (line[0] == 255 && !memcmp(line, line + 1, ras->out_length - 1))
+  ras->pcl_in_bytes += length;
+
+  if (line[0] == 0 && !memcmp(line, line + 1, length - 1))
   {
     // Skip blank line...
     ras->out_blanks ++;
+    ras->pcl_lines[0] ++;
+    ras->pcl_secs += cupsGetClock() - start;
     return;
   }
 
-  // Apply compression...
-  compptr = ras->comp_buffer;
-  outptr  = line;
-  outend  = line + ras->out_length;
-
-  while (outptr < outend)
+  if (ras->out_blanks > 0)
   {
-    if ((outptr + 1) >= outend)
-    {
-      // Single byte on the end...
-      *compptr++ = 0x00;
-      *compptr++ = *outptr++;
-    }
-    else if (outptr[0] == outptr[1])
-    {
-      // Repeated sequence...
-      outptr ++;
-      count = 2;
+    // Skip blank lines first, which also clears the seed row...
+    pclps_printf(cb, ctx, "\033*b%dY", ras->out_blanks);
+    ras->out_blanks = 0;
 
-      while (outptr < (outend - 1) && outptr[0] == outptr[1] && count < 127)
-      {
-	outptr ++;
-	count ++;
-      }
+    memset(ras->pcl_seed, 0, length);
+  }
 
-      *compptr++ = (unsigned char)(257 - count);
-      *compptr++ = *outptr++;
-    }
-    else
-    {
-      // Non-repeated sequence...
-      start = outptr;
-      outptr ++;
-      count = 1;
+  // Apply PackBits (method 2) or delta row (method 3) compression, whichever
+  // is smaller after counting the bytes needed to switch methods...
+  packlen  = pcl_compress_packbits(line, length, ras->comp_buffer);
+  deltalen = pcl_compress_delta(line, ras->pcl_seed, length, ras->pcl_delta);
 
-      while (outptr < (outend - 1) && outptr[0] != outptr[1] && count < 127)
-      {
-	outptr ++;
-	count ++;
-      }
+  if ((deltalen + (ras->pcl_method == 3 ? 0 : 2)) < (packlen + (ras->pcl_method == 2 ? 0 : 2)))
+  {
+    method  = 3;
+    comp    = ras->pcl_delta;
+    complen = deltalen;
+  }
+  else
+  {
+    method  = 2;
+    comp    = ras->comp_buffer;
+    complen = packlen;
+  }
 
-      *compptr++ = (unsigned char)(count - 1);
+  memcpy(ras->pcl_seed, line, length);
 
-      memcpy(compptr, start, count);
-      compptr += count;
-    }
-  }
+  ras->pcl_lines[method] ++;
+  ras->pcl_out_bytes += complen;
+  ras->pcl_secs      += cupsGetClock() - start;
 
   // Output the line...
-  if (ras->out_blanks > 0)
+  if (method != ras->pcl_method)
   {
-    // Skip blank lines first...
-    pclps_printf(cb, ctx, "\033*b%dY", ras->out_blanks);
-    ras->out_blanks = 0;
+    pclps_printf(cb, ctx, "\033*b%dm%dW", method, (int)complen);
+    ras->pcl_method = method;
+  }
+  else
+  {
+    pclps_printf(cb, ctx, "\033*b%dW", (int)complen);
   }
 
-  pclps_printf(cb, ctx, "\033*b%dW", (int)(compptr - ras->comp_buffer));
-  (*cb)(ctx, ras->comp_buffer, (size_t)(compptr - ras->comp_buffer));
+  if (complen > 0)
+    (*cb)(ctx, comp, complen);
 }
 
 
@@ -2481,11 +3013,37 @@ pclm_end_job(xform_raster_t   *ras,	// I - Raster information
              xform_write_cb_t cb,	// I - Write callback
              void             *ctx)	// I - Write context
 {
+  size_t	i;			// Looping var
   int		fd;			// Temporary file
   char		buffer[16384];		// Copy buffer
   ssize_t	bytes;			// Bytes to write
 
 
+  // Stop the compression threads and free the strips...
+  cupsMutexLock(&ras->pclm_mutex);
+  ras->pclm_stop = true;
+  cupsCondBroadcast(&ras->pclm_cond);
+  cupsMutexUnlock(&ras->pclm_mutex);
+
+  for (i = 0; i < ras->pclm_num_threads; i ++)
+    cupsThreadWait(ras->pclm_threads[i]);
+
+  for (i = 0; i < ras->pclm_num_strips; i ++)
+  {
+    free(ras->pclm_strips[i].pixels);
+    free(ras->pclm_strips[i].output);
+  }
+
+  free(ras->pclm_strips);
+  free(ras->pclm_threads);
+  cupsCondDestroy(&ras->pclm_cond);
+  cupsMutexDestroy(&ras->pclm_mutex);
+
+  ras->pclm_strips      = NULL;
+  ras->pclm_threads     = NULL;
+  ras->pclm_num_strips  = 0;
+  ras->pclm_num_threads = 0;
+
   // Close the PCLm file and copy it...
   pdfioFileClose(ras->pclm);
 
@@ -2524,6 +3082,9 @@ pclm_end_page(xform_raster_t   *ras,	// I - Raster information
 
   fprintf(stderr, "DEBUG: pclm_end_page(page=%u)\n", page);
 
+  // Wait for the most recently filled strip to be written...
+  pclm_strip_write(ras, ras->pclm_strips + (ras->pclm_fill_strip + ras->pclm_num_strips - 1) % ras->pclm_num_strips);
+
   free(ras->pclm_strip_objs);
 
   ras->pclm_strip_objs     = NULL;
@@ -2573,16 +3134,61 @@ pclm_start_job(xform_raster_t   *ras,	// I - Raster information
               xform_write_cb_t cb,	// I - Write callback
               void             *ctx)	// I - Write context
 {
+  const char	*value;			// Environment variable value
+  size_t	i,			// Looping var
+		num_threads;		// Number of compression threads
+
+
   (void)cb;
   (void)ctx;
 
-  // Create a temporary PCLm file...
-  ras->pclm_media_box.x1 = 0.0;
-  ras->pclm_media_box.y1 = 0.0;
-  ras->pclm_media_box.x2 = ras->header.cupsPageSize[0];
-  ras->pclm_media_box.y2 = ras->header.cupsPageSize[1];
+  // Get the compression level...
+  if ((value = getenv("IPPTRANSFORM_COMPRESSION_LEVEL")) == NULL || (ras->pclm_level = atoi(value)) < 1 || ras->pclm_level > 9)
+    ras->pclm_level = Z_BEST_COMPRESSION;
 
-  if ((ras->pclm = pdfioFileCreateTemporary(ras->pclm_tempfile, sizeof(ras->pclm_tempfile), "PCLm-1.0", &ras->pclm_media_box, &ras->pclm_media_box, pclm_error_cb, /*error_cbdata*/NULL)) == NULL)
+  // Allocate strip buffers, two per compression thread so that lines can be
+  // collected while other strips are compressed...
+  if ((num_threads = Threads) > XFORM_MAX_THREADS)
+    num_threads = XFORM_MAX_THREADS;
+
+  ras->pclm_num_strips  = num_threads > 1 ? 2 * num_threads : 1;
+  ras->pclm_fill_strip  = 0;
+  ras->pclm_write_strip = 0;
+  ras->pclm_stop        = false;
+
+  if ((ras->pclm_strips = calloc(ras->pclm_num_strips, sizeof(xform_strip_t))) == NULL)
+    return (false);
+
+  cupsMutexInit(&ras->pclm_mutex);
+  cupsCondInit(&ras->pclm_cond);
+
+  if (num_threads > 1)
+  {
+    if ((ras->pclm_threads = calloc(num_threads, sizeof(cups_thread_t))) == NULL)
+      return (false);
+
+    for (i = 0; i < num_threads; i ++)
+    {
+      if ((ras->pclm_threads[i] = cupsThreadCreate((cups_thread_func_t)pclm_strip_thread, ras)) == CUPS_THREAD_INVALID)
+        break;
+    }
+
+    if ((ras->pclm_num_threads = i) == 0)
+    {
+      fprintf(stderr, "ERROR: Unable to create PCLm compression threads: %s\n", strerror(errno));
+      return (false);
+    }
+
+    fprintf(stderr, "DEBUG: pclm_start_job: num_threads=%u, level=%d\n", (unsigned)ras->pclm_num_threads, ras->pclm_level);
+  }
+
+  // Create a temporary PCLm file...
+  ras->pclm_media_box.x1 = 0.0;
+  ras->pclm_media_box.y1 = 0.0;
+  ras->pclm_media_box.x2 = ras->header.cupsPageSize[0];
+  ras->pclm_media_box.y2 = ras->header.cupsPageSize[1];
+
+  if ((ras->pclm = pdfioFileCreateTemporary(ras->pclm_tempfile, sizeof(ras->pclm_tempfile), "PCLm-1.0", &ras->pclm_media_box, &ras->pclm_media_box, pclm_error_cb, /*error_cbdata*/NULL)) == NULL)
     return (false);
 
   return (true);
@@ -2624,6 +3230,34 @@ pclm_start_page(xform_raster_t   *ras,	// I - Raster information
 
   fprintf(stderr, "DEBUG: pclm_start_page: num_strips=%u\n", (unsigned)ras->pclm_num_strip_objs);
 
+  // Size the strip buffers for this page...
+  for (i = 0; i < ras->pclm_num_strips; i ++)
+  {
+    xform_strip_t	*strip = ras->pclm_strips + i;
+					// Current strip
+    size_t		pixsize = ras->pclm_strip_height * ras->header.cupsBytesPerLine;
+					// Size of strip pixels
+    unsigned char	*buffer;	// New buffer
+
+    if (pixsize > strip->pixsize)
+    {
+      if ((buffer = realloc(strip->pixels, pixsize)) == NULL)
+        return (false);
+
+      strip->pixels  = buffer;
+      strip->pixsize = pixsize;
+    }
+
+    if (compressBound(pixsize) > strip->outsize)
+    {
+      if ((buffer = realloc(strip->output, compressBound(pixsize))) == NULL)
+        return (false);
+
+      strip->output  = buffer;
+      strip->outsize = compressBound(pixsize);
+    }
+  }
+
   // Create an image object for each strip...
   for (i = 0; i < ras->pclm_num_strip_objs; i ++)
   {
@@ -2662,6 +3296,129 @@ pclm_start_page(xform_raster_t   *ras,	// I - Raster information
 }
 
 
+//
+// 'pclm_strip_compress()' - Compress a PCLm strip.
+//
+
+static void
+pclm_strip_compress(
+    xform_raster_t *ras,		// I - Raster information
+    xform_strip_t  *strip)		// I - Strip
+{
+  uLongf	outlen = (uLongf)strip->outsize;
+					// Length of compressed data
+  int		status;			// Compression status
+
+
+  if ((status = compress2(strip->output, &outlen, strip->pixels, (uLong)(ras->pclm_strip_height * ras->header.cupsBytesPerLine), ras->pclm_level)) != Z_OK)
+  {
+    fprintf(stderr, "ERROR: Unable to compress PCLm strip %u: %d\n", (unsigned)strip->index, status);
+    outlen = 0;
+  }
+
+  strip->outused = (size_t)outlen;
+}
+
+
+//
+// 'pclm_strip_thread()' - Compress PCLm strips.
+//
+
+static void *				// O - Thread exit status
+pclm_strip_thread(xform_raster_t *ras)	// I - Raster information
+{
+  size_t	i;			// Looping var
+  xform_strip_t	*strip;			// Current strip
+
+
+  cupsMutexLock(&ras->pclm_mutex);
+
+  while (!ras->pclm_stop)
+  {
+    // Find the oldest queued strip...
+    for (i = 0, strip = NULL; i < ras->pclm_num_strips; i ++)
+    {
+      strip = ras->pclm_strips + (ras->pclm_write_strip + i) % ras->pclm_num_strips;
+
+      if (strip->state == XFORM_STRIP_QUEUED)
+        break;
+    }
+
+    if (i >= ras->pclm_num_strips)
+    {
+      cupsCondWait(&ras->pclm_cond, &ras->pclm_mutex, 0.0);
+      continue;
+    }
+
+    strip->state = XFORM_STRIP_COMPRESSING;
+    cupsMutexUnlock(&ras->pclm_mutex);
+
+    pclm_strip_compress(ras, strip);
+
+    cupsMutexLock(&ras->pclm_mutex);
+    strip->state = XFORM_STRIP_DONE;
+    cupsCondBroadcast(&ras->pclm_cond);
+  }
+
+  cupsMutexUnlock(&ras->pclm_mutex);
+
+  return (NULL);
+}
+
+
+//
+// 'pclm_strip_write()' - Write compressed PCLm strips in order.
+//
+// Finished strips are written until one is still being compressed.  If
+// "until" is not `NULL`, this function waits for strips to finish until that
+// strip has been written.  The strip data is already compressed, so each
+// FlateDecode image stream is written without a filter.
+//
+
+static void
+pclm_strip_write(xform_raster_t *ras,	// I - Raster information
+                 xform_strip_t  *until)	// I - Strip to wait for or `NULL`
+{
+  xform_strip_t		*strip;		// Current strip
+  pdfio_stream_t	*st;		// Image stream
+
+
+  cupsMutexLock(&ras->pclm_mutex);
+
+  for (;;)
+  {
+    strip = ras->pclm_strips + ras->pclm_write_strip;
+
+    if (strip->state == XFORM_STRIP_EMPTY)
+      break;
+
+    if (strip->state != XFORM_STRIP_DONE)
+    {
+      if (!until || until->state == XFORM_STRIP_EMPTY)
+        break;
+
+      cupsCondWait(&ras->pclm_cond, &ras->pclm_mutex, 0.0);
+      continue;
+    }
+
+    cupsMutexUnlock(&ras->pclm_mutex);
+
+    if ((st = pdfioObjCreateStream(ras->pclm_strip_objs[strip->index], PDFIO_FILTER_NONE)) != NULL)
+    {
+      pdfioStreamWrite(st, strip->output, strip->outused);
+      pdfioStreamClose(st);
+    }
+
+    cupsMutexLock(&ras->pclm_mutex);
+
+    strip->state          = XFORM_STRIP_EMPTY;
+    ras->pclm_write_strip = (ras->pclm_write_strip + 1) % ras->pclm_num_strips;
+  }
+
+  cupsMutexUnlock(&ras->pclm_mutex);
+}
+
+
 //
 // 'pclm_write_line()' - Write a line of raster data.
 //
@@ -2678,23 +3435,43 @@ pclm_write_line(
 					// Strip
   unsigned	ymod = y % ras->pclm_strip_height;
 					// Line within strip
+  xform_strip_t	*strip = ras->pclm_strips + ras->pclm_fill_strip;
+					// Strip being filled
 
 
+  (void)cb;
+  (void)ctx;
+
 //  fprintf(stderr, "DEBUG: pclm_write_line(y=%u)\n", y);
 
   if (ystrip >= ras->pclm_num_strip_objs)
     return;
 
-  if (ymod == 0)
-    ras->pclm_strip_st = pdfioObjCreateStream(ras->pclm_strip_objs[ystrip], PDFIO_FILTER_FLATE);
+  memcpy(strip->pixels + ymod * ras->header.cupsBytesPerLine, line, ras->header.cupsBytesPerLine);
 
-  pdfioStreamWrite(ras->pclm_strip_st, line, ras->header.cupsBytesPerLine);
+  if (ymod < (ras->pclm_strip_height - 1))
+    return;
+
+  // Compress the strip, either on a compression thread or right away...
+  strip->index = ystrip;
 
-  if (ymod == (ras->pclm_strip_height - 1))
+  if (ras->pclm_num_threads > 0)
+  {
+    cupsMutexLock(&ras->pclm_mutex);
+    strip->state = XFORM_STRIP_QUEUED;
+    cupsCondBroadcast(&ras->pclm_cond);
+    cupsMutexUnlock(&ras->pclm_mutex);
+  }
+  else
   {
-    pdfioStreamClose(ras->pclm_strip_st);
-    ras->pclm_strip_st = NULL;
+    pclm_strip_compress(ras, strip);
+    strip->state = XFORM_STRIP_DONE;
   }
+
+  ras->pclm_fill_strip = (ras->pclm_fill_strip + 1) % ras->pclm_num_strips;
+
+  // Write finished strips, waiting for the next strip to become available...
+  pclm_strip_write(ras, ras->pclm_strips + ras->pclm_fill_strip);
 }
 
 
@@ -3922,6 +4699,7 @@ usage(FILE *out)			// I - Output file
   cupsLangPuts(out, _("Usage: ipptransform [OPTIONS] FILENAME [ ... FILENAME]"));
   cupsLangPuts(out, _("Options:"));
   cupsLangPuts(out, _("--help                         Show this help"));
+  cupsLangPuts(out, _("--threads NUMBER               Use multiple threads for rendering and compression"));
   cupsLangPuts(out, _("--version                      Show the program version"));
   cupsLangPuts(out, _("-d DEVICE-URI                  Specify the output device"));
   cupsLangPuts(out, _("-f OUTPUT-FILENAME             Specify the output file"));
@@ -4395,14 +5173,17 @@ xform_document(
 		media_sheets = 0,
 		impressions = 0;	// Page/sheet counters
   char		command[1024],		// pdftoppm command
+		args[256],		// pdftoppm options
 		output[1024];		// Ouptut from pdftoppm
   FILE		*fp;			// Pipe for output
-  char		header[256];		// Header from file
-  unsigned char	*line = NULL,		// Pixel line from file
-		*linein,		// Pointer to input pixels
-		*lineout;		// Pointer to output pixels
-  size_t	linesize;		// Size of a line...
   bool		poppler = false;	// Are we using Poppler's pdftoppm?
+  unsigned	i,			// Looping var
+		num_workers,		// Number of pdftoppm workers
+		num_started = 0;	// Number of workers started
+  cups_thread_t	workers[XFORM_MAX_THREADS];
+					// pdftoppm worker threads
+  xform_pdftoppm_t pp;			// Parallel pdftoppm data
+  xform_ppm_t	ppm;			// Current page
 
 
   // Find the pdftoppm program...
@@ -4412,6 +5193,12 @@ xform_document(
     return (false);
   }
 
+  // Limit the number of pdftoppm workers...
+  if ((num_workers = Threads) > XFORM_MAX_THREADS)
+    num_workers = XFORM_MAX_THREADS;
+  if (num_workers > pages)
+    num_workers = pages;
+
   // Setup the raster headers...
   if (!xform_setup(&ras, options, outformat, resolutions, sheet_back, types, true, pages))
     return (false);
@@ -4500,179 +5287,115 @@ xform_document(
     // Run the pdftoppm command:
     //
     //   Poppler:
-    //     pdftoppm [-gray] -thinlinemode solid -aa no -r resolution -scale-to HEIGHT filename
+    //     pdftoppm [-gray] -thinlinemode solid -aa no -r resolution -scale-to HEIGHT [-f PAGE -l PAGE] filename
     //
     //   Xpdf:
-    //     pdftoppm [-gray] -aa no -r resolution filename -
+    //     pdftoppm [-gray] -aa no -r resolution [-f PAGE -l PAGE] filename -
     if (poppler)
-      snprintf(command, sizeof(command), "%s %s -aa no -r %u -scale-to %u '%s'", PdftoppmCommand, ras.header.cupsBitsPerPixel <= 8 ? "-gray" : "", ras.header.HWResolution[0], ras.header.cupsHeight, filename);
+      snprintf(args, sizeof(args), "%s -aa no -r %u -scale-to %u", ras.header.cupsBitsPerPixel <= 8 ? "-gray" : "", ras.header.HWResolution[0], ras.header.cupsHeight);
     else
-      snprintf(command, sizeof(command), "%s %s -aa no -r %u '%s' -", PdftoppmCommand, ras.header.cupsBitsPerPixel <= 8 ? "-gray" : "", ras.header.HWResolution[0], filename);
-
-    fprintf(stderr, "DEBUG: Running \"%s\".\n", command);
-#if _WIN32
-    if ((fp = _popen(command, "rb")) == NULL)
-#else
-    if ((fp = popen(command, "r")) == NULL)
-#endif // _WIN32
-    {
-      cupsLangPrintf(stderr, _("%s: Unable to run pdftoppm command: %s"), Prefix, strerror(errno));
-      return (false);
-    }
+      snprintf(args, sizeof(args), "%s -aa no -r %u", ras.header.cupsBitsPerPixel <= 8 ? "-gray" : "", ras.header.HWResolution[0]);
 
-    // Read lines from the file...
-    while (fgets(header, sizeof(header), fp))
+    if (num_workers > 1)
     {
-      // Got the P4/5/6 header...
-      unsigned	y,			// Current Y position
-		ystart,			// Start Y position
-		yend;			// End Y position
-      unsigned	width, height;		// Width and height from image...
-      unsigned	bpp;			// Bytes per pixel
-
-      if (!strcmp(header, "P5\n"))
+      // Render pages in parallel, one pdftoppm process per page, and write
+      // them in order from a reorder buffer of 2 pages per worker...
+      memset(&pp, 0, sizeof(pp));
+      cupsMutexInit(&pp.mutex);
+      cupsCondInit(&pp.cond);
+
+      pp.filename    = filename;
+      pp.args        = args;
+      pp.poppler     = poppler;
+      pp.num_pages   = pages;
+      pp.next_render = 1;
+      pp.next_page   = 1;
+      pp.window      = 2 * num_workers;
+
+      if ((pp.pages = calloc(pp.window, sizeof(xform_ppm_t))) == NULL)
       {
-        bpp = 1;
-      }
-      else if (!strcmp(header, "P6\n"))
-      {
-        bpp = 3;
-      }
-      else
-      {
-        cupsLangPrintf(stderr, _("%s: Bad page header - <%02X%02X%02X%02X%02X%02X%02X%02X>"), Prefix, header[0] & 255, header[1] & 255, header[2] & 255, header[3] & 255, header[4] & 255, header[5] & 255, header[6] & 255, header[7] & 255);
-        break;
-      }
-
-      if (Verbosity)
-      {
-	header[strlen(header) - 1] = '\0';
-        fprintf(stderr, "DEBUG: '%s'\n", header);
+	cupsLangPrintf(stderr, _("%s: Out of memory."), Prefix);
+	cupsCondDestroy(&pp.cond);
+	cupsMutexDestroy(&pp.mutex);
+	return (false);
       }
 
-      // Now get the bitmap dimensions...
-      if (!fgets(header, sizeof(header), fp))
-        break;
+      fprintf(stderr, "DEBUG: Running %u \"%s\" workers.\n", num_workers, PdftoppmCommand);
 
-      if (Verbosity)
+      for (num_started = 0; num_started < num_workers; num_started ++)
       {
-	header[strlen(header) - 1] = '\0';
-        fprintf(stderr, "DEBUG: '%s'\n", header);
+        if ((workers[num_started] = cupsThreadCreate((cups_thread_func_t)xform_ppm_worker, &pp)) == CUPS_THREAD_INVALID)
+          break;
       }
 
-      if (sscanf(header, "%u%u", &width, &height) != 2 || width > 0x10000000 || height > 0x40000000)
+      if (num_started == 0)
       {
-        cupsLangPrintf(stderr, _("%s: Bad page dimensions - <%02X%02X%02X%02X%02X%02X%02X%02X>"), Prefix, header[0] & 255, header[1] & 255, header[2] & 255, header[3] & 255, header[4] & 255, header[5] & 255, header[6] & 255, header[7] & 255);
-        break;
+        cupsLangPrintf(stderr, _("%s: Unable to run pdftoppm command: %s"), Prefix, strerror(errno));
+        free(pp.pages);
+        cupsCondDestroy(&pp.cond);
+        cupsMutexDestroy(&pp.mutex);
+        return (false);
       }
 
-      if (width > ras.header.cupsWidth)
-        linesize = width * bpp;
+      fp = NULL;
+    }
+    else
+    {
+      if (poppler)
+	snprintf(command, sizeof(command), "%s %s '%s'", PdftoppmCommand, args, filename);
       else
-	linesize = ras.header.cupsWidth * bpp;
+	snprintf(command, sizeof(command), "%s %s '%s' -", PdftoppmCommand, args, filename);
 
-      if ((line = malloc(linesize)) == NULL)
-      {
-	cupsLangPrintf(stderr, _("%s: Out of memory."), Prefix);
+      fprintf(stderr, "DEBUG: Running \"%s\".\n", command);
 #if _WIN32
-        _pclose(fp);
+      if ((fp = _popen(command, "rb")) == NULL)
 #else
-        pclose(fp);
+      if ((fp = popen(command, "r")) == NULL)
 #endif // _WIN32
+      {
+	cupsLangPrintf(stderr, _("%s: Unable to run pdftoppm command: %s"), Prefix, strerror(errno));
 	return (false);
       }
+    }
 
-      if (width > ras.header.cupsWidth)
-      {
-        linein  = line;
-        lineout = line + ((width - ras.header.cupsWidth) / 2 + ras.left) * bpp;
-      }
-      else
-      {
-        linein  = line + (ras.header.cupsWidth - width) / 2 * bpp;
-        lineout = line + ras.left * bpp;
-      }
+    // Read pages from pdftoppm...
+    for (;;)
+    {
+      unsigned	width, height;		// Width and height from image...
+      unsigned	bpp;			// Bytes per pixel
+      bool	ret;			// Return value
 
-      if (height > ras.header.cupsHeight)
+      if (fp)
       {
-        ystart = (height - ras.header.cupsHeight) / 2;
-        yend   = ystart + ras.header.cupsHeight;
+        if (!xform_ppm_header(fp, &width, &height, &bpp))
+          break;
+
+        ppm.pixels = NULL;
       }
       else
       {
-        ystart = (ras.header.cupsHeight - height) / 2;
-        yend   = ystart + height;
-      }
+        if (pp.next_page > pp.num_pages)
+          break;
 
-      memset(line, ras.white, linesize);
+        ppm = xform_ppm_next(&pp);
 
-      // Skip max value line...
-      if (!fgets(header, sizeof(header), fp))
-        break;
+        if (!ppm.pixels)
+          break;
 
-      if (Verbosity)
-      {
-	header[strlen(header) - 1] = '\0';
-        fprintf(stderr, "DEBUG: '%s'\n", header);
-        fprintf(stderr, "DEBUG: width=%u, height=%u, bpp=%u, ystart=%u, yend=%u\n", width, height, bpp, ystart, yend);
+        width  = ppm.width;
+        height = ppm.height;
+        bpp    = ppm.bpp;
       }
 
       // Send the page to the driver...
       page ++;
 
-      if (!(ras.start_page)(&ras, page, cb, ctx))
-        break;
-
-      ras.out_length = ((ras.right - ras.left) * ras.header.cupsBitsPerPixel + 7) / 8;
-
-      if (height > ras.header.cupsHeight)
-      {
-        // Skip leading lines...
-        for (y = 0; y < ystart; y ++)
-          fread(linein, width, bpp, fp);
-      }
-      else
-      {
-        // Write leading blank lines...
-        for (y = 0; y < ystart; y ++)
-          (ras.write_line)(&ras, y, lineout, cb, ctx);
-      }
+      ret = xform_ppm_page(&ras, page, fp, ppm.pixels, width, height, bpp, cb, ctx);
 
-      for (; y < yend; y ++)
-      {
-        // Copy lines...
-        memset(line, 255, linesize);
+      free(ppm.pixels);
 
-        if (fread(linein, width, bpp, fp))
-        {
-	  if (ras.header.cupsBitsPerPixel == 1)
-	    dither_gray(&ras, y, lineout, ras.right - ras.left);
-	  else if (ras.header.cupsColorSpace == CUPS_CSPACE_K)
-	    pack_black(lineout, ras.right - ras.left);
-
-          (ras.write_line)(&ras, y, lineout, cb, ctx);
-        }
-      }
-
-      if (height > ras.header.cupsHeight)
-      {
-        // Skip trailing lines...
-        for (; y < height; y ++)
-          fread(linein, width, bpp, fp);
-      }
-      else
-      {
-        // Write trailing blank lines...
-        memset(line, ras.white, linesize);
-
-        for (; y < ras.header.cupsHeight; y ++)
-          (ras.write_line)(&ras, y, lineout, cb, ctx);
-      }
-
-      (ras.end_page)(&ras, page, cb, ctx);
-
-      free(line);
-      line = NULL;
+      if (!ret)
+        break;
 
       // Log progress...
       impressions ++;
@@ -4685,11 +5408,32 @@ xform_document(
     }
 
     // Close things out...
+    if (fp)
+    {
 #if _WIN32
-    _pclose(fp);
+      _pclose(fp);
 #else
-    pclose(fp);
+      pclose(fp);
 #endif // _WIN32
+    }
+    else
+    {
+      // Stop the workers and free any pages that were not written...
+      cupsMutexLock(&pp.mutex);
+      pp.cancel = true;
+      cupsCondBroadcast(&pp.cond);
+      cupsMutexUnlock(&pp.mutex);
+
+      while (num_started > 0)
+        cupsThreadWait(workers[-- num_started]);
+
+      for (i = 0; i < pp.window; i ++)
+        free(pp.pages[i].pixels);
+
+      free(pp.pages);
+      cupsCondDestroy(&pp.cond);
+      cupsMutexDestroy(&pp.mutex);
+    }
 
     // Write a separator sheet as needed...
     switch (options->separator_type)
@@ -4706,8 +5450,6 @@ xform_document(
     }
   }
 
-  free(line);
-
   (ras.end_job)(&ras, cb, ctx);
 
   return (true);
@@ -4715,6 +5457,346 @@ xform_document(
 #endif // HAVE_COREGRAPHICS_H
 
 
+#ifndef HAVE_COREGRAPHICS_H
+//
+// 'xform_ppm_header()' - Read a PPM/PGM page header from pdftoppm.
+//
+
+static bool				// O - `true` on success, `false` on EOF/error
+xform_ppm_header(FILE     *fp,		// I - pdftoppm output
+                 unsigned *width,	// O - Width in columns
+                 unsigned *height,	// O - Height in lines
+                 unsigned *bpp)		// O - Bytes per pixel
+{
+  char	header[256];			// Header from file
+
+
+  // Get the P5/6 header...
+  if (!fgets(header, sizeof(header), fp))
+    return (false);
+
+  if (!strcmp(header, "P5\n"))
+  {
+    *bpp = 1;
+  }
+  else if (!strcmp(header, "P6\n"))
+  {
+    *bpp = 3;
+  }
+  else
+  {
+    cupsLangPrintf(stderr, _("%s: Bad page header - <%02X%02X%02X%02X%02X%02X%02X%02X>"), Prefix, header[0] & 255, header[1] & 255, header[2] & 255, header[3] & 255, header[4] & 255, header[5] & 255, header[6] & 255, header[7] & 255);
+    return (false);
+  }
+
+  if (Verbosity)
+  {
+    header[strlen(header) - 1] = '\0';
+    fprintf(stderr, "DEBUG: '%s'\n", header);
+  }
+
+  // Now get the bitmap dimensions...
+  if (!fgets(header, sizeof(header), fp))
+    return (false);
+
+  if (Verbosity)
+  {
+    header[strlen(header) - 1] = '\0';
+    fprintf(stderr, "DEBUG: '%s'\n", header);
+  }
+
+  if (sscanf(header, "%u%u", width, height) != 2 || *width > 0x10000000 || *height > 0x40000000)
+  {
+    cupsLangPrintf(stderr, _("%s: Bad page dimensions - <%02X%02X%02X%02X%02X%02X%02X%02X>"), Prefix, header[0] & 255, header[1] & 255, header[2] & 255, header[3] & 255, header[4] & 255, header[5] & 255, header[6] & 255, header[7] & 255);
+    return (false);
+  }
+
+  // Skip max value line...
+  if (!fgets(header, sizeof(header), fp))
+    return (false);
+
+  if (Verbosity)
+  {
+    header[strlen(header) - 1] = '\0';
+    fprintf(stderr, "DEBUG: '%s'\n", header);
+  }
+
+  return (true);
+}
+
+
+//
+// 'xform_ppm_next()' - Wait for the next page from the pdftoppm workers.
+//
+// The returned pixels are owned by the caller.  Pages are returned in order and
+// the reorder buffer slot is released for the worker that renders the page
+// "window" pages later.
+//
+
+static xform_ppm_t			// O - Page
+xform_ppm_next(xform_pdftoppm_t *pp)	// I - Parallel pdftoppm data
+{
+  xform_ppm_t	*slot,			// Reorder buffer slot
+		ppm;			// Page
+
+
+  cupsMutexLock(&pp->mutex);
+
+  slot = pp->pages + (pp->next_page - 1) % pp->window;
+
+  while (!slot->ready)
+    cupsCondWait(&pp->cond, &pp->mutex, 0.0);
+
+  ppm = *slot;
+
+  memset(slot, 0, sizeof(xform_ppm_t));
+
+  pp->next_page ++;
+
+  cupsCondBroadcast(&pp->cond);
+  cupsMutexUnlock(&pp->mutex);
+
+  return (ppm);
+}
+
+
+//
+// 'xform_ppm_page()' - Write a page from pdftoppm.
+//
+// The page pixels come from the pdftoppm pipe when "pixels" is `NULL`.
+//
+
+static bool				// O - `true` on success, `false` on error
+xform_ppm_page(
+    xform_raster_t      *ras,		// I - Raster information
+    unsigned            page,		// I - Page number
+    FILE                *fp,		// I - pdftoppm output or `NULL`
+    const unsigned char *pixels,	// I - Page pixels or `NULL`
+    unsigned            width,		// I - Width in columns
+    unsigned            height,		// I - Height in lines
+    unsigned            bpp,		// I - Bytes per pixel
+    xform_write_cb_t    cb,		// I - Write callback
+    void                *ctx)		// I - Write context
+{
+  unsigned	y,			// Current Y position
+		ystart,			// Start Y position
+		yend;			// End Y position
+  unsigned char	*line,			// Pixel line from file
+		*linein,		// Pointer to input pixels
+		*lineout;		// Pointer to output pixels
+  size_t	linesize,		// Size of a line...
+		rowsize = (size_t)width * bpp;
+					// Size of an input row
+
+
+  if (width > ras->header.cupsWidth)
+    linesize = width * bpp;
+  else
+    linesize = ras->header.cupsWidth * bpp;
+
+  if ((line = malloc(linesize)) == NULL)
+  {
+    cupsLangPrintf(stderr, _("%s: Out of memory."), Prefix);
+    return (false);
+  }
+
+  if (width > ras->header.cupsWidth)
+  {
+    linein  = line;
+    lineout = line + ((width - ras->header.cupsWidth) / 2 + ras->left) * bpp;
+  }
+  else
+  {
+    linein  = line + (ras->header.cupsWidth - width) / 2 * bpp;
+    lineout = line + ras->left * bpp;
+  }
+
+  if (height > ras->header.cupsHeight)
+  {
+    ystart = (height - ras->header.cupsHeight) / 2;
+    yend   = ystart + ras->header.cupsHeight;
+  }
+  else
+  {
+    ystart = (ras->header.cupsHeight - height) / 2;
+    yend   = ystart + height;
+  }
+
+  memset(line, ras->white, linesize);
+
+  if (Verbosity)
+    fprintf(stderr, "DEBUG: width=%u, height=%u, bpp=%u, ystart=%u, yend=%u\n", width, height, bpp, ystart, yend);
+
+  if (!(ras->start_page)(ras, page, cb, ctx))
+  {
+    free(line);
+    return (false);
+  }
+
+  ras->out_length = ((ras->right - ras->left) * ras->header.cupsBitsPerPixel + 7) / 8;
+
+  if (height > ras->header.cupsHeight)
+  {
+    // Skip leading lines...
+    if (pixels)
+    {
+      pixels += ystart * rowsize;
+    }
+    else
+    {
+      for (y = 0; y < ystart; y ++)
+	fread(linein, width, bpp, fp);
+    }
+
+    y = ystart;
+  }
+  else
+  {
+    // Write leading blank lines...
+    for (y = 0; y < ystart; y ++)
+      (ras->write_line)(ras, y, lineout, cb, ctx);
+  }
+
+  for (; y < yend; y ++)
+  {
+    // Copy lines...
+    memset(line, 255, linesize);
+
+    if (pixels)
+    {
+      memcpy(linein, pixels, rowsize);
+      pixels += rowsize;
+    }
+    else if (!fread(linein, width, bpp, fp))
+    {
+      continue;
+    }
+
+    if (ras->header.cupsBitsPerPixel == 1)
+      dither_gray(ras, y, lineout, ras->right - ras->left);
+    else if (ras->header.cupsColorSpace == CUPS_CSPACE_K)
+      pack_black(lineout, ras->right - ras->left);
+
+    (ras->write_line)(ras, y, lineout, cb, ctx);
+  }
+
+  if (height > ras->header.cupsHeight)
+  {
+    // Skip trailing lines...
+    if (!pixels)
+    {
+      for (; y < height; y ++)
+	fread(linein, width, bpp, fp);
+    }
+  }
+  else
+  {
+    // Write trailing blank lines...
+    memset(line, ras->white, linesize);
+
+    for (; y < ras->header.cupsHeight; y ++)
+      (ras->write_line)(ras, y, lineout, cb, ctx);
+  }
+
+  (ras->end_page)(ras, page, cb, ctx);
+
+  free(line);
+
+  return (true);
+}
+
+
+//
+// 'xform_ppm_worker()' - Render pages with pdftoppm.
+//
+// Each worker claims the next page to render, waits until that page fits in
+// the reorder buffer, and then runs pdftoppm for that single page.
+//
+
+static void *				// O - Thread exit status
+xform_ppm_worker(xform_pdftoppm_t *pp)	// I - Parallel pdftoppm data
+{
+  unsigned	page;			// Current page
+  char		command[1024];		// pdftoppm command
+  FILE		*fp;			// Pipe for output
+  xform_ppm_t	ppm;			// Rendered page
+  size_t	bytes;			// Size of page
+
+
+  cupsMutexLock(&pp->mutex);
+
+  while (!pp->cancel && pp->next_render <= pp->num_pages)
+  {
+    // Claim the next page and wait for room in the reorder buffer...
+    page = pp->next_render ++;
+
+    while (!pp->cancel && page >= (pp->next_page + pp->window))
+      cupsCondWait(&pp->cond, &pp->mutex, 0.0);
+
+    if (pp->cancel)
+      break;
+
+    cupsMutexUnlock(&pp->mutex);
+
+    // Render the page...
+    memset(&ppm, 0, sizeof(ppm));
+    ppm.ready = true;
+
+    if (pp->poppler)
+      snprintf(command, sizeof(command), "%s %s -f %u -l %u '%s'", PdftoppmCommand, pp->args, page, page, pp->filename);
+    else
+      snprintf(command, sizeof(command), "%s %s -f %u -l %u '%s' -", PdftoppmCommand, pp->args, page, page, pp->filename);
+
+    if (Verbosity > 1)
+      fprintf(stderr, "DEBUG: Running \"%s\".\n", command);
+
+#if _WIN32
+    if ((fp = _popen(command, "rb")) != NULL)
+#else
+    if ((fp = popen(command, "r")) != NULL)
+#endif // _WIN32
+    {
+      if (xform_ppm_header(fp, &ppm.width, &ppm.height, &ppm.bpp))
+      {
+        bytes = (size_t)ppm.width * ppm.height * ppm.bpp;
+
+        if ((ppm.pixels = malloc(bytes)) == NULL)
+        {
+	  cupsLangPrintf(stderr, _("%s: Out of memory."), Prefix);
+        }
+        else if (fread(ppm.pixels, 1, bytes, fp) < bytes)
+        {
+          free(ppm.pixels);
+          ppm.pixels = NULL;
+        }
+      }
+
+#if _WIN32
+      _pclose(fp);
+#else
+      pclose(fp);
+#endif // _WIN32
+    }
+    else
+    {
+      cupsLangPrintf(stderr, _("%s: Unable to run pdftoppm command: %s"), Prefix, strerror(errno));
+    }
+
+    // Add the page to the reorder buffer...
+    cupsMutexLock(&pp->mutex);
+
+    pp->pages[(page - 1) % pp->window] = ppm;
+
+    cupsCondBroadcast(&pp->cond);
+  }
+
+  cupsMutexUnlock(&pp->mutex);
+
+  return (NULL);
+}
+#endif // !HAVE_COREGRAPHICS_H
+
+
 //
 // 'xform_separator()' - Write a separator sheet.
 //